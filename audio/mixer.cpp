@@ -21,6 +21,8 @@
 
 #include "gui/EventRecorder.h"
 
+#include "common/config-manager.h"
+#include "common/profiler.h"
 #include "common/util.h"
 #include "common/textconsole.h"
 
@@ -42,7 +44,7 @@ namespace Audio {
  */
 class Channel {
 public:
-	Channel(Mixer *mixer, Mixer::SoundType type, AudioStream *stream, DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent);
+	Channel(Mixer *mixer, Mixer::SoundType type, AudioStream *stream, DisposeAfterUse::Flag autofreeStream, bool reverseStereo, RateConverterQuality quality, int id, bool permanent);
 	~Channel();
 
 	/**
@@ -141,9 +143,9 @@ public:
 	void notifyGlobalVolChange() { updateChannelVolumes(); }
 
 	/**
-	 * Queries how long the channel has been playing.
+	 * Queries the playback position of the channel.
 	 */
-	Timestamp getElapsedTime();
+	void getTiming(ChannelTiming &timing) const;
 
 	/**
 	 * Replaces the channel's stream with a version that loops indefinitely.
@@ -197,23 +199,31 @@ private:
 #pragma mark -
 
 MixerImpl::MixerImpl(uint sampleRate, bool stereo, uint outBufSize)
-	: _mutex(), _sampleRate(sampleRate), _stereo(stereo), _outBufSize(outBufSize), _mixerReady(false), _handleSeed(0), _soundTypeSettings() {
+	: _mutex(), _sampleRate(sampleRate), _stereo(stereo), _outBufSize(outBufSize), _mixerReady(false), _handleSeed(0), _soundTypeSettings(),
+	  _rateConverterQuality(kRateConverterLinear), _commandHead(0), _commandTail(0), _resyncChannels(false) {
 
 	assert(sampleRate > 0);
 
+	if (ConfMan.get("audio_resampler") == "sinc")
+		_rateConverterQuality = kRateConverterSinc;
+
 	for (int i = 0; i != NUM_CHANNELS; i++)
 		_channels[i] = nullptr;
+
+	for (uint32 i = 0; i != COMMAND_QUEUE_SIZE; i++)
+		_commands[i].seq.store(i, Common::kMemoryOrderRelaxed);
 }
 
 MixerImpl::~MixerImpl() {
+	// Take ownership of channels which are still queued for insertion
+	processCommands();
+
 	for (int i = 0; i != NUM_CHANNELS; i++)
 		delete _channels[i];
 }
 
 void MixerImpl::setReady(bool ready) {
-	Common::StackLock lock(_mutex);
-
-	_mixerReady = ready;
+	_mixerReady.store(ready, Common::kMemoryOrderRelease);
 }
 
 uint MixerImpl::getOutputRate() const {
@@ -228,29 +238,229 @@ uint MixerImpl::getOutputBufSize() const {
 	return _outBufSize;
 }
 
-void MixerImpl::insertChannel(SoundHandle *handle, Channel *chan) {
-	int index = -1;
-	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] == nullptr) {
-			index = i;
+bool MixerImpl::postCommand(CommandType type, uint32 handle, int32 value, Channel *channel) {
+	uint32 pos = _commandHead.load(Common::kMemoryOrderRelaxed);
+	for (;;) {
+		CommandCell &cell = _commands[pos % COMMAND_QUEUE_SIZE];
+		const int32 diff = (int32)(cell.seq.load(Common::kMemoryOrderAcquire) - pos);
+
+		if (diff == 0) {
+			// The cell is free, claim it unless another producer was faster
+			if (_commandHead.compareExchange(pos, pos + 1, Common::kMemoryOrderRelaxed)) {
+				cell.command.type = type;
+				cell.command.handle = handle;
+				cell.command.value = value;
+				cell.command.channel = channel;
+				cell.seq.store(pos + 1, Common::kMemoryOrderRelease);
+				return true;
+			}
+		} else if (diff < 0) {
+			// The mixer did not read the cell yet, so the queue is full
+			return false;
+		} else {
+			pos = _commandHead.load(Common::kMemoryOrderRelaxed);
+		}
+	}
+}
+
+void MixerImpl::postSync(uint32 handle) {
+	// The settings are in the published state, so nothing is lost when the
+	// mixer picks them up for all channels at once instead
+	if (!postCommand(kCommandSync, handle))
+		_resyncChannels.store(true, Common::kMemoryOrderRelease);
+}
+
+void MixerImpl::processCommands() {
+	for (;;) {
+		CommandCell &cell = _commands[_commandTail % COMMAND_QUEUE_SIZE];
+
+		// Stop at cells which are not written yet, even if later ones are
+		if (cell.seq.load(Common::kMemoryOrderAcquire) != _commandTail + 1)
 			break;
+
+		executeCommand(cell.command);
+		cell.seq.store(_commandTail + COMMAND_QUEUE_SIZE, Common::kMemoryOrderRelease);
+		_commandTail++;
+	}
+
+	bool resync = true;
+	if (_resyncChannels.compareExchange(resync, false, Common::kMemoryOrderAcquire)) {
+		for (int i = 0; i != NUM_CHANNELS; i++) {
+			if (_channels[i])
+				syncChannel(i);
 		}
 	}
-	if (index == -1) {
-		warning("MixerImpl::out of mixer slots");
-		delete chan;
+}
+
+void MixerImpl::executeCommand(const Command &cmd) {
+	switch (cmd.type) {
+	case kCommandInsert:
+		// playStream() only hands out slots without a channel
+		assert(!_channels[cmd.value]);
+		_channels[cmd.value] = cmd.channel;
 		return;
+
+	case kCommandUpdateTypeVolume:
+		for (int i = 0; i != NUM_CHANNELS; ++i) {
+			if (_channels[i] && _channels[i]->getType() == cmd.value)
+				_channels[i]->notifyGlobalVolChange();
+		}
+		return;
+
+	case kCommandPauseAll:
+		for (int i = 0; i != NUM_CHANNELS; i++) {
+			if (_channels[i]) {
+				_channels[i]->pause(cmd.value != 0);
+				publishTiming(i);
+			}
+		}
+		return;
+
+	case kCommandPauseID:
+		for (int i = 0; i != NUM_CHANNELS; i++) {
+			if (_channels[i] && _channels[i]->getId() == (int)cmd.handle) {
+				_channels[i]->pause(cmd.value != 0);
+				publishTiming(i);
+				return;
+			}
+		}
+		return;
+
+	default:
+		break;
 	}
 
-	_channels[index] = chan;
+	// Silently drop commands for sounds which terminated in the meantime
+	SoundHandle handle;
+	handle._val = cmd.handle;
+	const int index = findChannel(handle);
+	if (index < 0)
+		return;
 
-	SoundHandle chanHandle;
-	chanHandle._val = index + (_handleSeed * NUM_CHANNELS);
+	switch (cmd.type) {
+	case kCommandSync:
+		syncChannel(index);
+		break;
+	case kCommandPause:
+		_channels[index]->pause(cmd.value != 0);
+		publishTiming(index);
+		break;
+	case kCommandLoop:
+		_channels[index]->loop();
+		break;
+	default:
+		break;
+	}
+}
 
-	chan->setHandle(chanHandle);
-	_handleSeed++;
-	if (handle)
-		*handle = chanHandle;
+int MixerImpl::findChannel(SoundHandle handle) const {
+	const int index = handle._val % NUM_CHANNELS;
+	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+		return -1;
+	return index;
+}
+
+int MixerImpl::findChannelState(SoundHandle handle) const {
+	if (handle._val == kFreeSlot)
+		return -1;
+
+	const int index = handle._val % NUM_CHANNELS;
+	if (_channelStates[index].handle.load(Common::kMemoryOrderAcquire) != handle._val)
+		return -1;
+	return index;
+}
+
+bool MixerImpl::clearHandle(int index, uint32 handle) {
+	return _channelStates[index].handle.compareExchange(handle, kFreeSlot);
+}
+
+void MixerImpl::waitForMixing() {
+	// The mixer holds the mutex while it mixes, and checks the handles of
+	// the channels after taking it
+	Common::StackLock lock(_mutex);
+}
+
+void MixerImpl::syncChannel(int index) {
+	Channel *chan = _channels[index];
+	const ChannelState &state = _channelStates[index];
+	const uint32 handle = chan->getHandle()._val;
+
+	// Setting the volume also picks up the volume of the sound type
+	uint32 value;
+	if (loadSetting(state.volume, handle, kVolumeBits, value))
+		chan->setVolume((byte)value);
+	if (loadSetting(state.balance, handle, kBalanceBits, value))
+		chan->setBalance((int8)value);
+	if (loadSetting(state.rate, handle, kRateBits, value) && value != chan->getRate())
+		chan->setRate(value);
+}
+
+void MixerImpl::deleteChannel(int index) {
+	delete _channels[index];
+	_channels[index] = nullptr;
+	_channelStates[index].busy.store(false, Common::kMemoryOrderRelease);
+}
+
+void MixerImpl::publishTiming(int index) {
+	ChannelTiming timing;
+	_channels[index]->getTiming(timing);
+	storeTiming(_channelStates[index], timing);
+}
+
+void MixerImpl::initSetting(Common::Atomic<uint32> &setting, uint32 handle, uint32 value, int bits) {
+	setting.store(((handle / NUM_CHANNELS) << bits) | value, Common::kMemoryOrderRelaxed);
+}
+
+bool MixerImpl::storeSetting(Common::Atomic<uint32> &setting, uint32 handle, uint32 value, int bits) {
+	// Only the low bits of the generation are kept, which only allows a
+	// stale handle through once 2^15 sounds were played meanwhile
+	const uint32 tag = (handle / NUM_CHANNELS) << bits;
+	uint32 current = setting.load(Common::kMemoryOrderRelaxed);
+	do {
+		if ((current ^ tag) >> bits)
+			return false;
+	} while (!setting.compareExchange(current, tag | value, Common::kMemoryOrderRelaxed));
+	return true;
+}
+
+bool MixerImpl::loadSetting(const Common::Atomic<uint32> &setting, uint32 handle, int bits, uint32 &value) {
+	const uint32 current = setting.load(Common::kMemoryOrderRelaxed);
+	if ((current ^ ((handle / NUM_CHANNELS) << bits)) >> bits)
+		return false;
+
+	value = current & ((1 << bits) - 1);
+	return true;
+}
+
+void MixerImpl::storeTiming(ChannelState &state, const ChannelTiming &timing) {
+	// Readers retry while the sequence number is odd or has changed
+	const uint32 seq = state.timingSeq.load(Common::kMemoryOrderRelaxed);
+	state.timingSeq.store(seq + 1, Common::kMemoryOrderRelaxed);
+	Common::atomicThreadFence(Common::kMemoryOrderRelease);
+
+	state.samplesConsumed.store(timing.samplesConsumed, Common::kMemoryOrderRelaxed);
+	state.mixerTimeStamp.store(timing.mixerTimeStamp, Common::kMemoryOrderRelaxed);
+	state.pauseStartTime.store(timing.pauseStartTime, Common::kMemoryOrderRelaxed);
+	state.pauseTime.store(timing.pauseTime, Common::kMemoryOrderRelaxed);
+	state.paused.store(timing.paused, Common::kMemoryOrderRelaxed);
+
+	state.timingSeq.store(seq + 2, Common::kMemoryOrderRelease);
+}
+
+void MixerImpl::loadTiming(const ChannelState &state, ChannelTiming &timing) {
+	for (;;) {
+		const uint32 seq = state.timingSeq.load(Common::kMemoryOrderAcquire);
+
+		timing.samplesConsumed = state.samplesConsumed.load(Common::kMemoryOrderRelaxed);
+		timing.mixerTimeStamp = state.mixerTimeStamp.load(Common::kMemoryOrderRelaxed);
+		timing.pauseStartTime = state.pauseStartTime.load(Common::kMemoryOrderRelaxed);
+		timing.pauseTime = state.pauseTime.load(Common::kMemoryOrderRelaxed);
+		timing.paused = state.paused.load(Common::kMemoryOrderRelaxed);
+
+		Common::atomicThreadFence(Common::kMemoryOrderAcquire);
+		if (!(seq & 1) && state.timingSeq.load(Common::kMemoryOrderRelaxed) == seq)
+			return;
+	}
 }
 
 void MixerImpl::playStream(
@@ -261,20 +471,18 @@ void MixerImpl::playStream(
 			DisposeAfterUse::Flag autofreeStream,
 			bool permanent,
 			bool reverseStereo) {
-	Common::StackLock lock(_mutex);
-
 	if (stream == nullptr) {
 		warning("stream is 0");
 		return;
 	}
 
 
-	assert(_mixerReady);
+	assert(_mixerReady.load(Common::kMemoryOrderAcquire));
 
 	// Prevent duplicate sounds
 	if (id != -1) {
 		for (int i = 0; i != NUM_CHANNELS; i++)
-			if (_channels[i] != nullptr && _channels[i]->getId() == id) {
+			if (_channelStates[i].handle.load(Common::kMemoryOrderAcquire) != kFreeSlot && _channelStates[i].id.load(Common::kMemoryOrderRelaxed) == id) {
 				// Delete the stream if were asked to auto-dispose it.
 				// Note: This could cause trouble if the client code does not
 				// yet expect the stream to be gone. The primary example to
@@ -292,21 +500,74 @@ void MixerImpl::playStream(
 #endif
 
 	// Create the channel
-	Channel *chan = new Channel(this, type, stream, autofreeStream, reverseStereo, id, permanent);
+	const uint32 streamRate = stream->getRate();
+	Channel *chan = new Channel(this, type, stream, autofreeStream, reverseStereo, _rateConverterQuality, id, permanent);
 	chan->setVolume(volume);
 	chan->setBalance(balance);
-	insertChannel(handle, chan);
+
+	SoundHandle chanHandle;
+	int index = -1;
+	for (int i = 0; i != NUM_CHANNELS && index == -1; i++) {
+		bool busy = false;
+		if (_channelStates[i].busy.compareExchange(busy, true, Common::kMemoryOrderAcquire))
+			index = i;
+	}
+
+	if (index == -1) {
+		warning("MixerImpl::out of mixer slots");
+		delete chan;
+		return;
+	}
+
+	do {
+		chanHandle._val = index + (_handleSeed.fetchAdd(1, Common::kMemoryOrderRelaxed) * NUM_CHANNELS);
+	} while (chanHandle._val == kFreeSlot);
+
+	chan->setHandle(chanHandle);
+
+	// Publish the new channel before the mixer knows about it, so that
+	// queries made right after this call see it
+	ChannelState &state = _channelStates[index];
+	state.id.store(id, Common::kMemoryOrderRelaxed);
+	state.type.store(type, Common::kMemoryOrderRelaxed);
+	state.permanent.store(permanent, Common::kMemoryOrderRelaxed);
+	initSetting(state.volume, chanHandle._val, volume, kVolumeBits);
+	initSetting(state.balance, chanHandle._val, (byte)balance, kBalanceBits);
+	initSetting(state.rate, chanHandle._val, MIN<uint32>(streamRate, (1 << kRateBits) - 1), kRateBits);
+	state.streamRate.store(streamRate, Common::kMemoryOrderRelaxed);
+
+	ChannelTiming timing;
+	chan->getTiming(timing);
+	storeTiming(state, timing);
+
+	state.handle.store(chanHandle._val, Common::kMemoryOrderRelease);
+
+	if (!postCommand(kCommandInsert, chanHandle._val, index, chan)) {
+		// The mixer never saw the channel, so it can be dropped right away
+		warning("MixerImpl::command queue full, dropping sound");
+		state.handle.store(kFreeSlot, Common::kMemoryOrderRelease);
+		delete chan;
+		state.busy.store(false, Common::kMemoryOrderRelease);
+		return;
+	}
+
+	if (handle)
+		*handle = chanHandle;
 }
 
 int MixerImpl::mixCallback(byte *samples, uint len) {
+	PROFILE_ZONE("Mixer::mixCallback");
 	assert(samples);
 
+	// Only engines and the stop methods hold the mutex, see MixerImpl
 	Common::StackLock lock(_mutex);
 
+	processCommands();
+
 	int16 *buf = (int16 *)samples;
 
 	// Since the mixer callback has been called, the mixer must be ready...
-	_mixerReady = true;
+	_mixerReady.store(true, Common::kMemoryOrderRelease);
 
 	//  zero the buf
 	memset(buf, 0, len);
@@ -324,11 +585,17 @@ int MixerImpl::mixCallback(byte *samples, uint len) {
 	int res = 0, tmp;
 	for (int i = 0; i != NUM_CHANNELS; i++)
 		if (_channels[i]) {
-			if (_channels[i]->isFinished()) {
-				delete _channels[i];
-				_channels[i] = nullptr;
+			// Channels are stopped by clearing their handle, which the stop
+			// methods do before waiting for the mutex
+			const uint32 chanHandle = _channels[i]->getHandle()._val;
+			if (_channelStates[i].handle.load(Common::kMemoryOrderAcquire) != chanHandle) {
+				deleteChannel(i);
+			} else if (_channels[i]->isFinished()) {
+				clearHandle(i, chanHandle);
+				deleteChannel(i);
 			} else if (!_channels[i]->isPaused()) {
 				tmp = _channels[i]->mix(buf, len);
+				publishTiming(i);
 
 				if (tmp > res)
 					res = tmp;
@@ -339,114 +606,104 @@ int MixerImpl::mixCallback(byte *samples, uint len) {
 }
 
 void MixerImpl::stopAll() {
-	Common::StackLock lock(_mutex);
+	bool stopped = false;
 	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] != nullptr && !_channels[i]->isPermanent()) {
-			delete _channels[i];
-			_channels[i] = nullptr;
-		}
+		const uint32 handle = _channelStates[i].handle.load(Common::kMemoryOrderAcquire);
+		if (handle != kFreeSlot && !_channelStates[i].permanent.load(Common::kMemoryOrderRelaxed))
+			stopped |= clearHandle(i, handle);
 	}
+
+	if (stopped)
+		waitForMixing();
 }
 
 void MixerImpl::stopID(int id) {
-	Common::StackLock lock(_mutex);
+	bool stopped = false;
 	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] != nullptr && _channels[i]->getId() == id) {
-			delete _channels[i];
-			_channels[i] = nullptr;
-		}
+		const uint32 handle = _channelStates[i].handle.load(Common::kMemoryOrderAcquire);
+		if (handle != kFreeSlot && _channelStates[i].id.load(Common::kMemoryOrderRelaxed) == id)
+			stopped |= clearHandle(i, handle);
 	}
+
+	if (stopped)
+		waitForMixing();
 }
 
 void MixerImpl::stopHandle(SoundHandle handle) {
-	Common::StackLock lock(_mutex);
-
 	// Simply ignore stop requests for handles of sounds that already terminated
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	const int index = findChannelState(handle);
+	if (index < 0 || !clearHandle(index, handle._val))
 		return;
 
-	delete _channels[index];
-	_channels[index] = nullptr;
+	waitForMixing();
 }
 
 void MixerImpl::muteSoundType(SoundType type, bool mute) {
 	assert(0 <= (int)type && (int)type < ARRAYSIZE(_soundTypeSettings));
-	_soundTypeSettings[type].mute = mute;
+	_soundTypeSettings[type].mute.store(mute);
 
-	for (int i = 0; i != NUM_CHANNELS; ++i) {
-		if (_channels[i] && _channels[i]->getType() == type)
-			_channels[i]->notifyGlobalVolChange();
-	}
+	if (!postCommand(kCommandUpdateTypeVolume, 0, type))
+		_resyncChannels.store(true, Common::kMemoryOrderRelease);
 }
 
 bool MixerImpl::isSoundTypeMuted(SoundType type) const {
 	assert(0 <= (int)type && (int)type < ARRAYSIZE(_soundTypeSettings));
-	return _soundTypeSettings[type].mute;
+	return _soundTypeSettings[type].mute.load();
 }
 
 void MixerImpl::setChannelVolume(SoundHandle handle, byte volume) {
-	Common::StackLock lock(_mutex);
-
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
-		return;
-
-	_channels[index]->setVolume(volume);
+	const int index = findChannelState(handle);
+	if (index >= 0 && storeSetting(_channelStates[index].volume, handle._val, volume, kVolumeBits))
+		postSync(handle._val);
 }
 
 byte MixerImpl::getChannelVolume(SoundHandle handle) {
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	const int index = findChannelState(handle);
+	uint32 volume;
+	if (index < 0 || !loadSetting(_channelStates[index].volume, handle._val, kVolumeBits, volume))
 		return 0;
 
-	return _channels[index]->getVolume();
+	return (byte)volume;
 }
 
 void MixerImpl::setChannelBalance(SoundHandle handle, int8 balance) {
-	Common::StackLock lock(_mutex);
-
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
-		return;
-
-	_channels[index]->setBalance(balance);
+	const int index = findChannelState(handle);
+	if (index >= 0 && storeSetting(_channelStates[index].balance, handle._val, (byte)balance, kBalanceBits))
+		postSync(handle._val);
 }
 
 int8 MixerImpl::getChannelBalance(SoundHandle handle) {
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	const int index = findChannelState(handle);
+	uint32 balance;
+	if (index < 0 || !loadSetting(_channelStates[index].balance, handle._val, kBalanceBits, balance))
 		return 0;
 
-	return _channels[index]->getBalance();
+	return (int8)balance;
 }
 
 void MixerImpl::setChannelRate(SoundHandle handle, uint32 rate) {
-	Common::StackLock lock(_mutex);
-
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
-		return;
-
-	_channels[index]->setRate(rate);
+	const int index = findChannelState(handle);
+	if (index >= 0 && storeSetting(_channelStates[index].rate, handle._val, MIN<uint32>(rate, (1 << kRateBits) - 1), kRateBits))
+		postSync(handle._val);
 }
 
 uint32 MixerImpl::getChannelRate(SoundHandle handle) {
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	const int index = findChannelState(handle);
+	uint32 rate;
+	if (index < 0 || !loadSetting(_channelStates[index].rate, handle._val, kRateBits, rate))
 		return 0;
-	
-	return _channels[index]->getRate();
+
+	return rate;
 }
 
 void MixerImpl::resetChannelRate(SoundHandle handle) {
-	Common::StackLock lock(_mutex);
-
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	const int index = findChannelState(handle);
+	if (index < 0)
 		return;
-	
-	_channels[index]->resetRate();
+
+	const uint32 rate = _channelStates[index].streamRate.load(Common::kMemoryOrderRelaxed);
+	if (storeSetting(_channelStates[index].rate, handle._val, MIN<uint32>(rate, (1 << kRateBits) - 1), kRateBits))
+		postSync(handle._val);
 }
 
 uint32 MixerImpl::getSoundElapsedTime(SoundHandle handle) {
@@ -454,91 +711,94 @@ uint32 MixerImpl::getSoundElapsedTime(SoundHandle handle) {
 }
 
 Timestamp MixerImpl::getElapsedTime(SoundHandle handle) {
-	Common::StackLock lock(_mutex);
+	Timestamp ts(0, _sampleRate);
 
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
-		return Timestamp(0, _sampleRate);
+	const int index = findChannelState(handle);
+	if (index < 0)
+		return ts;
+
+	ChannelTiming timing;
+	loadTiming(_channelStates[index], timing);
+
+	if (timing.mixerTimeStamp == 0)
+		return ts;
+
+	uint32 delta;
+	if (timing.paused)
+		delta = timing.pauseStartTime - timing.mixerTimeStamp;
+	else
+		delta = g_system->getMillis(true) - timing.mixerTimeStamp - timing.pauseTime;
+
+	// Convert the number of samples into a time duration.
+
+	ts = ts.addFrames(timing.samplesConsumed);
+	ts = ts.addMsecs(delta);
 
-	return _channels[index]->getElapsedTime();
+	// In theory it would seem like a good idea to limit the approximation
+	// so that it never exceeds the theoretical upper bound set by the
+	// number of decoded samples. Meanwhile, back in the real world, doing
+	// so makes the Broken Sword cutscenes noticeably jerkier. I guess the
+	// mixer isn't invoked at the regular intervals that I first imagined.
+
+	return ts;
 }
 
 void MixerImpl::loopChannel(SoundHandle handle) {
-	Common::StackLock lock(_mutex);
-
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	if (findChannelState(handle) < 0)
 		return;
 
-	_channels[index]->loop();
+	if (!postCommand(kCommandLoop, handle._val))
+		warning("MixerImpl::command queue full, dropping loop request");
 }
 
 void MixerImpl::pauseAll(bool paused) {
-	Common::StackLock lock(_mutex);
-	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] != nullptr) {
-			_channels[i]->pause(paused);
-		}
-	}
+	if (!postCommand(kCommandPauseAll, 0, paused))
+		warning("MixerImpl::command queue full, dropping pause request");
 }
 
 void MixerImpl::pauseID(int id, bool paused) {
-	Common::StackLock lock(_mutex);
-	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] != nullptr && _channels[i]->getId() == id) {
-			_channels[i]->pause(paused);
-			return;
-		}
-	}
+	if (!postCommand(kCommandPauseID, (uint32)id, paused))
+		warning("MixerImpl::command queue full, dropping pause request");
 }
 
 void MixerImpl::pauseHandle(SoundHandle handle, bool paused) {
-	Common::StackLock lock(_mutex);
-
 	// Simply ignore (un)pause requests for sounds that already terminated
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	if (findChannelState(handle) < 0)
 		return;
 
-	_channels[index]->pause(paused);
+	if (!postCommand(kCommandPause, handle._val, paused))
+		warning("MixerImpl::command queue full, dropping pause request");
 }
 
 bool MixerImpl::isSoundIDActive(int id) {
-	Common::StackLock lock(_mutex);
-
 #ifdef ENABLE_EVENTRECORDER
 	g_eventRec.updateSubsystems();
 #endif
 
 	for (int i = 0; i != NUM_CHANNELS; i++)
-		if (_channels[i] && _channels[i]->getId() == id)
+		if (_channelStates[i].handle.load(Common::kMemoryOrderAcquire) != kFreeSlot && _channelStates[i].id.load(Common::kMemoryOrderRelaxed) == id)
 			return true;
 	return false;
 }
 
 int MixerImpl::getSoundID(SoundHandle handle) {
-	Common::StackLock lock(_mutex);
-	const int index = handle._val % NUM_CHANNELS;
-	if (_channels[index] && _channels[index]->getHandle()._val == handle._val)
-		return _channels[index]->getId();
-	return 0;
+	const int index = findChannelState(handle);
+	if (index < 0)
+		return 0;
+	return _channelStates[index].id.load(Common::kMemoryOrderRelaxed);
 }
 
 bool MixerImpl::isSoundHandleActive(SoundHandle handle) {
-	Common::StackLock lock(_mutex);
-
 #ifdef ENABLE_EVENTRECORDER
 	g_eventRec.updateSubsystems();
 #endif
 
-	const int index = handle._val % NUM_CHANNELS;
-	return _channels[index] && _channels[index]->getHandle()._val == handle._val;
+	return findChannelState(handle) >= 0;
 }
 
 bool MixerImpl::hasActiveChannelOfType(SoundType type) {
-	Common::StackLock lock(_mutex);
 	for (int i = 0; i != NUM_CHANNELS; i++)
-		if (_channels[i] && _channels[i]->getType() == type)
+		if (_channelStates[i].handle.load(Common::kMemoryOrderAcquire) != kFreeSlot && _channelStates[i].type.load(Common::kMemoryOrderRelaxed) == type)
 			return true;
 	return false;
 }
@@ -552,19 +812,16 @@ void MixerImpl::setVolumeForSoundType(SoundType type, int volume) {
 	// TODO: Maybe we should do logarithmic (not linear) volume
 	// scaling? See also Player_V2::setMasterVolume
 
-	Common::StackLock lock(_mutex);
-	_soundTypeSettings[type].volume = volume;
+	_soundTypeSettings[type].volume.store(volume);
 
-	for (int i = 0; i != NUM_CHANNELS; ++i) {
-		if (_channels[i] && _channels[i]->getType() == type)
-			_channels[i]->notifyGlobalVolChange();
-	}
+	if (!postCommand(kCommandUpdateTypeVolume, 0, type))
+		_resyncChannels.store(true, Common::kMemoryOrderRelease);
 }
 
 int MixerImpl::getVolumeForSoundType(SoundType type) const {
 	assert(0 <= (int)type && (int)type < ARRAYSIZE(_soundTypeSettings));
 
-	return _soundTypeSettings[type].volume;
+	return _soundTypeSettings[type].volume.load();
 }
 
 
@@ -573,7 +830,7 @@ int MixerImpl::getVolumeForSoundType(SoundType type) const {
 #pragma mark -
 
 Channel::Channel(Mixer *mixer, Mixer::SoundType type, AudioStream *stream,
-				 DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent)
+				 DisposeAfterUse::Flag autofreeStream, bool reverseStereo, RateConverterQuality quality, int id, bool permanent)
 	: _type(type), _mixer(mixer), _id(id), _permanent(permanent), _volume(Mixer::kMaxChannelVolume),
 	  _balance(0), _pauseLevel(0), _samplesConsumed(0), _samplesDecoded(0), _mixerTimeStamp(0),
 	  _pauseStartTime(0), _pauseTime(0), _converter(nullptr), _volL(0), _volR(0),
@@ -582,7 +839,7 @@ Channel::Channel(Mixer *mixer, Mixer::SoundType type, AudioStream *stream,
 	assert(stream);
 
 	// Get a rate converter instance
-	_converter = makeRateConverter(_stream->getRate(), mixer->getOutputRate(), _stream->isStereo(), mixer->getOutputStereo(), reverseStereo);
+	_converter = makeRateConverter(_stream->getRate(), mixer->getOutputRate(), _stream->isStereo(), mixer->getOutputStereo(), reverseStereo, quality);
 }
 
 Channel::~Channel() {
@@ -670,32 +927,12 @@ void Channel::pause(bool paused) {
 	}
 }
 
-Timestamp Channel::getElapsedTime() {
-	const uint32 rate = _mixer->getOutputRate();
-	uint32 delta = 0;
-
-	Audio::Timestamp ts(0, rate);
-
-	if (_mixerTimeStamp == 0)
-		return ts;
-
-	if (isPaused())
-		delta = _pauseStartTime - _mixerTimeStamp;
-	else
-		delta = g_system->getMillis(true) - _mixerTimeStamp - _pauseTime;
-
-	// Convert the number of samples into a time duration.
-
-	ts = ts.addFrames(_samplesConsumed);
-	ts = ts.addMsecs(delta);
-
-	// In theory it would seem like a good idea to limit the approximation
-	// so that it never exceeds the theoretical upper bound set by
-	// _samplesDecoded. Meanwhile, back in the real world, doing so makes
-	// the Broken Sword cutscenes noticeably jerkier. I guess the mixer
-	// isn't invoked at the regular intervals that I first imagined.
-
-	return ts;
+void Channel::getTiming(ChannelTiming &timing) const {
+	timing.samplesConsumed = _samplesConsumed;
+	timing.mixerTimeStamp = _mixerTimeStamp;
+	timing.pauseStartTime = _pauseStartTime;
+	timing.pauseTime = _pauseTime;
+	timing.paused = isPaused();
 }
 
 void Channel::loop() {
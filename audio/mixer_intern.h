@@ -23,8 +23,10 @@
 #define AUDIO_MIXER_INTERN_H
 
 #include "common/scummsys.h"
+#include "common/atomic.h"
 #include "common/mutex.h"
 #include "audio/mixer.h"
+#include "audio/rate.h"
 
 namespace Audio {
 
@@ -36,6 +38,17 @@ namespace Audio {
  * @{
  */
 
+/**
+ * Playback position of a channel, as published by the mixer thread.
+ */
+struct ChannelTiming {
+	uint32 samplesConsumed;
+	uint32 mixerTimeStamp;
+	uint32 pauseStartTime;
+	uint32 pauseTime;
+	bool paused;
+};
+
 /**
  * The (default) implementation of the ScummVM audio mixing subsystem.
  *
@@ -49,6 +62,18 @@ namespace Audio {
  * 4) Change the mixer into ready mode via setReady(true).
  * 5) Start audio processing (e.g. by resuming the audio thread, if applicable).
  *
+ * Only mixCallback() touches the channels. Engines post their changes to a
+ * lock-free command queue, which the callback drains before mixing, and the
+ * query methods read the channel state published in ChannelState. When the
+ * queue is full, settings are picked up from the published state instead,
+ * so they are never lost, and other commands are dropped with a warning.
+ *
+ * The callback still holds mutex() while it drains the queue and mixes, as
+ * engines lock it to keep the mixer from reading their streams while they
+ * change them. The mixer methods themselves never lock it, except for the
+ * stop methods, which wait for a running callback to finish: callers rely
+ * on the stream not being accessed anymore once they return.
+ *
  * In the future, we might make it possible for backends to provide
  * (partial) alternative implementations of the mixer, e.g. to make
  * better use of native sound mixing support on low-end devices.
@@ -58,34 +83,151 @@ namespace Audio {
 class MixerImpl : public Mixer {
 private:
 	enum {
-		NUM_CHANNELS = 32
+		NUM_CHANNELS = 32,
+		COMMAND_QUEUE_SIZE = 256 // Must be a power of two
 	};
 
+	/** Handle value stored in ChannelState::handle for unused slots. */
+	static const uint32 kFreeSlot = 0xFFFFFFFF;
+
 	Common::Mutex _mutex;
 
 	const uint _sampleRate;
 	const bool _stereo;
 	const uint _outBufSize;
-	bool _mixerReady;
-	uint32 _handleSeed;
+	Common::Atomic<bool> _mixerReady;
+	Common::Atomic<uint32> _handleSeed;
 
 	struct SoundTypeSettings {
 		SoundTypeSettings() : mute(false), volume(kMaxMixerVolume) {}
 
-		bool mute;
-		int volume;
+		Common::Atomic<bool> mute;
+		Common::Atomic<int> volume;
 	};
 
 	SoundTypeSettings _soundTypeSettings[4];
 	Channel *_channels[NUM_CHANNELS];
 
+	/** Resampling method for new channels, set by the "audio_resampler" config key */
+	RateConverterQuality _rateConverterQuality;
+
+	/**
+	 * State of a channel slot as seen by the query methods.
+	 *
+	 * A slot is claimed by playStream() through `busy`, and released by
+	 * the mixer once it deleted the channel. The handle is published by
+	 * playStream() and cleared when the channel is stopped or finished; the
+	 * mixer deletes channels whose handle was cleared.
+	 *
+	 * The settings are written by the thread changing them. Next to the
+	 * value, they hold the generation of the handle they belong to, so that
+	 * a stale handle cannot change them once the slot was given to another
+	 * channel. The timing values are written by the mixer and guarded by a
+	 * sequence counter.
+	 */
+	struct ChannelState {
+		ChannelState() : handle(kFreeSlot), busy(false) {}
+
+		Common::Atomic<uint32> handle;
+		Common::Atomic<bool> busy;
+		Common::Atomic<int> id;
+		Common::Atomic<int> type;
+		Common::Atomic<bool> permanent;
+		Common::Atomic<uint32> volume;  /*!< See storeSetting() */
+		Common::Atomic<uint32> balance; /*!< See storeSetting() */
+		Common::Atomic<uint32> rate;    /*!< See storeSetting() */
+		Common::Atomic<uint32> streamRate;
+
+		Common::Atomic<uint32> timingSeq;
+		Common::Atomic<uint32> samplesConsumed;
+		Common::Atomic<uint32> mixerTimeStamp;
+		Common::Atomic<uint32> pauseStartTime;
+		Common::Atomic<uint32> pauseTime;
+		Common::Atomic<bool> paused;
+	};
+
+	ChannelState _channelStates[NUM_CHANNELS];
+
+	/** Bits of the channel settings, the higher bits hold the handle generation. */
+	enum {
+		kVolumeBits = 8,
+		kBalanceBits = 8,
+		kRateBits = 17
+	};
+
+	enum CommandType {
+		kCommandInsert,
+		kCommandSync,
+		kCommandPause,
+		kCommandPauseAll,
+		kCommandPauseID,
+		kCommandLoop,
+		kCommandUpdateTypeVolume
+	};
+
+	struct Command {
+		CommandType type;
+		uint32 handle; /*!< Channel handle, or the sound id for kCommandPauseID */
+		int32 value;
+		Channel *channel;
+	};
+
+	struct CommandCell {
+		/** Position the cell can be written at, plus one once it was written. */
+		Common::Atomic<uint32> seq;
+		Command command;
+	};
+
+	/**
+	 * Commands for mixCallback(). Any thread may post commands: producers
+	 * claim a cell by advancing _commandHead, and publish it through its
+	 * sequence number. The mixer is the only consumer.
+	 */
+	CommandCell _commands[COMMAND_QUEUE_SIZE];
+	Common::Atomic<uint32> _commandHead;
+	/** Next cell to read, only used by the mixer. */
+	uint32 _commandTail;
+	/** Set when a change could not be queued, the mixer then syncs every channel. */
+	Common::Atomic<bool> _resyncChannels;
+
+	/** Queue a command. Return false if the queue is full. */
+	bool postCommand(CommandType type, uint32 handle, int32 value = 0, Channel *channel = nullptr);
+	/** Have the mixer pick up the published settings of a channel. */
+	void postSync(uint32 handle);
+	/** Apply all queued commands. Must only be called by the mixer. */
+	void processCommands();
+	void executeCommand(const Command &cmd);
+
+	/** Return the slot of a live channel, or -1. Must only be called by the mixer. */
+	int findChannel(SoundHandle handle) const;
+	/** Return the published slot of an active handle, or -1. */
+	int findChannelState(SoundHandle handle) const;
+
+	/** Clear the handle of a slot, if it is still the given one. */
+	bool clearHandle(int index, uint32 handle);
+	/** Wait until the mixer does not read any stream of a stopped channel. */
+	void waitForMixing();
+
+	/** Apply the published settings to the channel in the given slot. Must only be called by the mixer. */
+	void syncChannel(int index);
+	/** Delete the channel in the given slot and release it. Must only be called by the mixer. */
+	void deleteChannel(int index);
+	/** Publish the timing of the channel in the given slot. Must only be called by the mixer. */
+	void publishTiming(int index);
+
+	static void initSetting(Common::Atomic<uint32> &setting, uint32 handle, uint32 value, int bits);
+	static bool storeSetting(Common::Atomic<uint32> &setting, uint32 handle, uint32 value, int bits);
+	static bool loadSetting(const Common::Atomic<uint32> &setting, uint32 handle, int bits, uint32 &value);
+
+	static void storeTiming(ChannelState &state, const ChannelTiming &timing);
+	static void loadTiming(const ChannelState &state, ChannelTiming &timing);
 
 public:
 
 	MixerImpl(uint sampleRate, bool stereo = true, uint outBufSize = 0);
 	~MixerImpl();
 
-	virtual bool isReady() const { Common::StackLock lock(_mutex); return _mixerReady; }
+	virtual bool isReady() const { return _mixerReady.load(Common::kMemoryOrderAcquire); }
 
 	virtual Common::Mutex &mutex() { return _mutex; }
 
@@ -136,9 +278,6 @@ public:
 	virtual bool getOutputStereo() const;
 	virtual uint getOutputBufSize() const;
 
-protected:
-	void insertChannel(SoundHandle *handle, Channel *chan);
-
 public:
 	/**
 	 * The mixer callback function, to be called at regular intervals by
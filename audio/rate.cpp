@@ -24,14 +24,19 @@
  * Fabrice original code is part of SoX (http://sox.sourceforge.net).
  * Max Horn adapted that code to the needs of ScummVM and rewrote it partial,
  * in the process removing any use of floating point arithmetic. Various other
- * improvements over the original code were made.
+ * improvements over the original code were made. The sinc converter only uses
+ * floating point to set up its filter table.
  */
 
 #include "audio/audiostream.h"
 #include "audio/rate.h"
+#include "audio/rate_intern.h"
 #include "audio/mixer.h"
+#include "common/system.h"
 #include "common/util.h"
 
+#include <math.h>
+
 namespace Audio {
 
 /**
@@ -45,9 +50,91 @@ enum {
 	FRAC_HALF_LOW = (1L << (FRAC_BITS_LOW-1))
 };
 
+#pragma mark -
+#pragma mark --- Kernels ---
+#pragma mark -
+
+static void mixStereoGeneric(st_sample_t *out, const st_sample_t *in, uint frames, st_volume_t volL, st_volume_t volR) {
+	for (uint i = 0; i < frames; i++) {
+		clampedAdd(out[2 * i    ], (in[2 * i    ] * (int)volL) / Audio::Mixer::kMaxMixerVolume);
+		clampedAdd(out[2 * i + 1], (in[2 * i + 1] * (int)volR) / Audio::Mixer::kMaxMixerVolume);
+	}
+}
+
+static void mixMonoGeneric(st_sample_t *out, const st_sample_t *in, uint frames, st_volume_t volL, st_volume_t volR) {
+	for (uint i = 0; i < frames; i++) {
+		clampedAdd(out[2 * i    ], (in[i] * (int)volL) / Audio::Mixer::kMaxMixerVolume);
+		clampedAdd(out[2 * i + 1], (in[i] * (int)volR) / Audio::Mixer::kMaxMixerVolume);
+	}
+}
+
+static void interpolateGeneric(st_sample_t *out, const st_sample_t *pairs, const int16 *weights, uint count) {
+	for (uint i = 0; i < count; i++) {
+		const int last = pairs[2 * i], cur = pairs[2 * i + 1];
+		out[i] = (st_sample_t)(last + (((cur - last) * weights[2 * i + 1] + FRAC_HALF_LOW) >> FRAC_BITS_LOW));
+	}
+}
+
+static void filterGeneric(st_sample_t *out, const st_sample_t *const *windows, const int16 *const *coeffs, uint count) {
+	for (uint i = 0; i < count; i++) {
+		int sum = 0;
+		for (int k = 0; k < kSincTaps; k++)
+			sum += windows[i][k] * coeffs[i][k];
+
+		sum = (sum + (1 << (kSincCoeffBits - 1))) >> kSincCoeffBits;
+		out[i] = (st_sample_t)CLIP<int>(sum, ST_SAMPLE_MIN, ST_SAMPLE_MAX);
+	}
+}
+
+static const RateKernels rateKernelsGeneric = {
+	mixStereoGeneric,
+	mixMonoGeneric,
+	interpolateGeneric,
+	filterGeneric
+};
+
+const RateKernels &getGenericRateKernels() {
+	return rateKernelsGeneric;
+}
+
+const RateKernels &getRateKernels() {
+	static const RateKernels *kernels = nullptr;
+
+	// If no kernels have been selected yet, detect and select
+	if (!kernels) {
+		kernels = &rateKernelsGeneric;
+		// The vectorized mixing assumes signed output
+#ifndef OUTPUT_UNSIGNED_AUDIO
+#ifdef SCUMMVM_NEON
+		if (g_system->hasFeature(OSystem::kFeatureCpuNEON)) kernels = &g_rateKernelsNEON;
+#endif
+#ifdef SCUMMVM_SSE2
+		if (g_system->hasFeature(OSystem::kFeatureCpuSSE2)) kernels = &g_rateKernelsSSE2;
+#endif
+#ifdef SCUMMVM_AVX2
+		if (g_system->hasFeature(OSystem::kFeatureCpuAVX2)) kernels = &g_rateKernelsAVX2;
+#endif
+#endif
+	}
+
+	return *kernels;
+}
+
+#pragma mark -
+#pragma mark --- Linear rate converter ---
+#pragma mark -
+
 template<bool inStereo, bool outStereo, bool reverseStereo>
 class RateConverter_Impl : public RateConverter {
-private:
+protected:
+	enum {
+		kInChannels = inStereo ? 2 : 1,
+		kOutChannels = outStereo ? 2 : 1,
+
+		/** Number of frames converted before they are mixed into the output */
+		kChunkFrames = 256
+	};
+
 	/** Input and output rates */
 	st_rate_t _inRate, _outRate;
 
@@ -76,6 +163,36 @@ private:
 	/** Current sample(s) in the input stream (left/right channel) */
 	st_sample_t _inCurL, _inCurR;
 
+	const RateKernels &_kernels;
+
+	/** Refill the input cache if it is empty. Returns false at the end of the stream. */
+	bool fillBuffer(AudioStream &input) {
+		if (_bufferSize == 0) {
+			_bufferPos = _buffer;
+			_bufferSize = input.readBuffer(_buffer, ARRAYSIZE(_buffer));
+
+			if (_bufferSize <= 0)
+				return false;
+		}
+		return true;
+	}
+
+	/**
+	 * Store a converted frame. Frames are kept in input channel layout, with
+	 * reversed stereo channels already swapped.
+	 */
+	static void stageFrame(st_sample_t *frames, uint index, st_sample_t inL, st_sample_t inR) {
+		if (inStereo) {
+			frames[2 * index + reverseStereo    ] = inL;
+			frames[2 * index + (reverseStereo ^ 1)] = inR;
+		} else {
+			frames[index] = inL;
+		}
+	}
+
+	/** Apply the volume to staged frames and add them to the output. */
+	void mixFrames(st_sample_t *outBuffer, const st_sample_t *frames, uint count, st_volume_t volL, st_volume_t volR);
+
 	int copyConvert(AudioStream &input, st_sample_t *outBuffer, st_size_t numSamples, st_volume_t vol_l, st_volume_t vol_r);
 	int simpleConvert(AudioStream &input, st_sample_t *outBuffer, st_size_t numSamples, st_volume_t vol_l, st_volume_t vol_r);
 	int interpolateConvert(AudioStream &input, st_sample_t *outBuffer, st_size_t numSamples, st_volume_t vol_l, st_volume_t vol_r);
@@ -96,49 +213,63 @@ public:
 };
 
 template<bool inStereo, bool outStereo, bool reverseStereo>
-int RateConverter_Impl<inStereo, outStereo, reverseStereo>::copyConvert(AudioStream &input, st_sample_t *outBuffer, st_size_t numSamples, st_volume_t volL, st_volume_t volR) {
-	st_sample_t *outStart, *outEnd;
-
-	outStart = outBuffer;
-	outEnd = outBuffer + numSamples * (outStereo ? 2 : 1);
+void RateConverter_Impl<inStereo, outStereo, reverseStereo>::mixFrames(st_sample_t *outBuffer, const st_sample_t *frames, uint count, st_volume_t volL, st_volume_t volR) {
+	if (outStereo) {
+		if (!inStereo)
+			_kernels.mixMono(outBuffer, frames, count, volL, volR);
+		else if (reverseStereo)
+			_kernels.mixStereo(outBuffer, frames, count, volR, volL);
+		else
+			_kernels.mixStereo(outBuffer, frames, count, volL, volR);
+	} else {
+		for (uint i = 0; i < count; i++) {
+			st_sample_t inL, inR;
+			inL = frames[i * kInChannels];
+			inR = (inStereo ? frames[i * kInChannels + 1] : inL);
 
-	while (outBuffer < outEnd) {
-		// Check if we have to refill the buffer
-		if (_bufferSize == 0) {
-			_bufferPos = _buffer;
-			_bufferSize = input.readBuffer(_buffer, ARRAYSIZE(_buffer));
+			st_sample_t outL, outR;
+			outL = (inL * (int)volL) / Audio::Mixer::kMaxMixerVolume;
+			outR = (inR * (int)volR) / Audio::Mixer::kMaxMixerVolume;
 
-			if (_bufferSize <= 0)
-				return (outBuffer - outStart) / (outStereo ? 2 : 1);
+			// Output mono channel
+			clampedAdd(outBuffer[i], (outL + outR) / 2);
 		}
+	}
+}
 
-		// Mix the data into the output buffer
-		st_sample_t inL, inR;
-		inL = *_bufferPos++;
-		inR = (inStereo ? *_bufferPos++ : inL);
-		_bufferSize -= (inStereo ? 2 : 1);
-
-		st_sample_t outL, outR;
-		outL = (inL * (int)volL) / Audio::Mixer::kMaxMixerVolume;
-		outR = (inR * (int)volR) / Audio::Mixer::kMaxMixerVolume;
-
-		if (outStereo) {
-			// Output left channel
-			clampedAdd(outBuffer[reverseStereo    ], outL);
+template<bool inStereo, bool outStereo, bool reverseStereo>
+int RateConverter_Impl<inStereo, outStereo, reverseStereo>::copyConvert(AudioStream &input, st_sample_t *outBuffer, st_size_t numSamples, st_volume_t volL, st_volume_t volR) {
+	st_sample_t frames[kChunkFrames * kInChannels];
+	st_size_t produced = 0;
 
-			// Output right channel
-			clampedAdd(outBuffer[reverseStereo ^ 1], outR);
+	while (produced < numSamples) {
+		// Check if we have to refill the buffer
+		if (!fillBuffer(input))
+			break;
+
+		uint count = MIN<uint>(_bufferSize / kInChannels, numSamples - produced);
+		if (count == 0) {
+			// Drop an incomplete stereo frame
+			_bufferSize = 0;
+			continue;
+		}
 
-			outBuffer += 2;
+		// Mix the data into the output buffer
+		if (inStereo && reverseStereo) {
+			count = MIN<uint>(count, kChunkFrames);
+			for (uint i = 0; i < count; i++)
+				stageFrame(frames, i, _bufferPos[2 * i], _bufferPos[2 * i + 1]);
+			mixFrames(outBuffer + produced * kOutChannels, frames, count, volL, volR);
 		} else {
-			// Output mono channel
-			clampedAdd(outBuffer[0], (outL + outR) / 2);
-
-			outBuffer += 1;
+			mixFrames(outBuffer + produced * kOutChannels, _bufferPos, count, volL, volR);
 		}
+
+		_bufferPos += count * kInChannels;
+		_bufferSize -= count * kInChannels;
+		produced += count;
 	}
 
-	return (outBuffer - outStart) / (outStereo ? 2 : 1);
+	return produced;
 }
 
 template<bool inStereo, bool outStereo, bool reverseStereo>
@@ -146,58 +277,48 @@ int RateConverter_Impl<inStereo, outStereo, reverseStereo>::simpleConvert(AudioS
 	// How much to increment _outPos by
 	frac_t outPos_inc = _inRate / _outRate;
 
-	st_sample_t *outStart, *outEnd;
+	st_sample_t frames[kChunkFrames * kInChannels];
+	st_size_t produced = 0;
+	bool endOfStream = false;
 
-	outStart = outBuffer;
-	outEnd = outBuffer + numSamples * (outStereo ? 2 : 1);
+	while (produced < numSamples && !endOfStream) {
+		uint count = MIN<st_size_t>(numSamples - produced, kChunkFrames);
+		uint staged = 0;
 
-	while (outBuffer < outEnd) {
-		// Read enough input samples so that _outPos >= 0
-		do {
-			// Check if we have to refill the buffer
-			if (_bufferSize == 0) {
-				_bufferPos = _buffer;
-				_bufferSize = input.readBuffer(_buffer, ARRAYSIZE(_buffer));
-
-				if (_bufferSize <= 0)
-					return (outBuffer - outStart) / (outStereo ? 2 : 1);
-			}
-
-			_bufferSize -= (inStereo ? 2 : 1);
-			_outPos--;
-
-			if (_outPos >= 0) {
-				_bufferPos += (inStereo ? 2 : 1);
-			}
-		} while (_outPos >= 0);
+		while (staged < count) {
+			// Read enough input samples so that _outPos >= 0
+			do {
+				// Check if we have to refill the buffer
+				if (!fillBuffer(input)) {
+					endOfStream = true;
+					break;
+				}
 
-		st_sample_t inL, inR;
-		inL = *_bufferPos++;
-		inR = (inStereo ? *_bufferPos++ : inL);
+				_bufferSize -= kInChannels;
+				_outPos--;
 
-		// Increment output position
-		_outPos += outPos_inc;
+				if (_outPos >= 0) {
+					_bufferPos += kInChannels;
+				}
+			} while (_outPos >= 0);
 
-		st_sample_t outL, outR;
-		outL = (inL * (int)volL) / Audio::Mixer::kMaxMixerVolume;
-		outR = (inR * (int)volR) / Audio::Mixer::kMaxMixerVolume;
+			if (endOfStream)
+				break;
 
-		if (outStereo) {
-			// output left channel
-			clampedAdd(outBuffer[reverseStereo    ], outL);
-
-			// output right channel
-			clampedAdd(outBuffer[reverseStereo ^ 1], outR);
-
-			outBuffer += 2;
-		} else {
-			// output mono channel
-			clampedAdd(outBuffer[0], (outL + outR) / 2);
+			st_sample_t inL, inR;
+			inL = *_bufferPos++;
+			inR = (inStereo ? *_bufferPos++ : inL);
+			stageFrame(frames, staged++, inL, inR);
 
-			outBuffer += 1;
+			// Increment output position
+			_outPos += outPos_inc;
 		}
+
+		mixFrames(outBuffer + produced * kOutChannels, frames, staged, volL, volR);
+		produced += staged;
 	}
-	return (outBuffer - outStart) / (outStereo ? 2 : 1);
+
+	return produced;
 }
 
 template<bool inStereo, bool outStereo, bool reverseStereo>
@@ -205,68 +326,88 @@ int RateConverter_Impl<inStereo, outStereo, reverseStereo>::interpolateConvert(A
 	// How much to increment _outPosFrac by
 	frac_t outPos_inc = (_inRate << FRAC_BITS_LOW) / _outRate;
 
-	st_sample_t *outStart, *outEnd;
-	outStart = outBuffer;
-	outEnd = outBuffer + numSamples * (outStereo ? 2 : 1);
-
-	while (outBuffer < outEnd) {
-		// Read enough input samples so that _outPosFrac < 0
-		while ((frac_t)FRAC_ONE_LOW <= _outPosFrac) {
-			// Check if we have to refill the buffer
-			if (_bufferSize == 0) {
-				_bufferPos = _buffer;
-				_bufferSize = input.readBuffer(_buffer, ARRAYSIZE(_buffer));
-
-				if (_bufferSize <= 0)
-					return (outBuffer - outStart) / (outStereo ? 2 : 1);
+	// Interpolation is done in batches: first the input sample pairs and
+	// weights are gathered, then the kernel interpolates all of them.
+	st_sample_t pairs[kChunkFrames * kInChannels * 2];
+	int16 weights[kChunkFrames * kInChannels * 2];
+	st_sample_t frames[kChunkFrames * kInChannels];
+	st_size_t produced = 0;
+	bool endOfStream = false;
+
+	// Work on local copies, the compiler cannot keep the members in
+	// registers while storing to the sample arrays
+	st_sample_t inLastL = _inLastL, inLastR = _inLastR;
+	st_sample_t inCurL = _inCurL, inCurR = _inCurR;
+	frac_t outPosFrac = _outPosFrac;
+
+	while (produced < numSamples && !endOfStream) {
+		uint count = MIN<st_size_t>(numSamples - produced, kChunkFrames);
+		uint staged = 0;
+
+		while (staged < count) {
+			// Read enough input samples so that _outPosFrac < 0
+			while ((frac_t)FRAC_ONE_LOW <= outPosFrac) {
+				// Check if we have to refill the buffer
+				if (!fillBuffer(input)) {
+					endOfStream = true;
+					break;
+				}
+
+				_bufferSize -= kInChannels;
+				inLastL = inCurL;
+				inCurL = *_bufferPos++;
+
+				if (inStereo) {
+					inLastR = inCurR;
+					inCurR = *_bufferPos++;
+				}
+
+				outPosFrac -= FRAC_ONE_LOW;
 			}
 
-			_bufferSize -= (inStereo ? 2 : 1);
-			_inLastL = _inCurL;
-			_inCurL = *_bufferPos++;
-
-			if (inStereo) {
-				_inLastR = _inCurR;
-				_inCurR = *_bufferPos++;
+			if (endOfStream)
+				break;
+
+			// Loop as long as the _outPos trails behind, and as long as there is
+			// still space in the chunk.
+			while (outPosFrac < (frac_t)FRAC_ONE_LOW && staged < count) {
+				st_sample_t *pair = pairs + staged * kInChannels * 2;
+				int16 *weight = weights + staged * kInChannels * 2;
+
+				if (inStereo) {
+					pair[reverseStereo * 2    ] = inLastL;
+					pair[reverseStereo * 2 + 1] = inCurL;
+					pair[(reverseStereo ^ 1) * 2    ] = inLastR;
+					pair[(reverseStereo ^ 1) * 2 + 1] = inCurR;
+					weight[2] = (int16)(FRAC_ONE_LOW - 1 - outPosFrac);
+					weight[3] = (int16)outPosFrac;
+				} else {
+					pair[0] = inLastL;
+					pair[1] = inCurL;
+				}
+				weight[0] = (int16)(FRAC_ONE_LOW - 1 - outPosFrac);
+				weight[1] = (int16)outPosFrac;
+				staged++;
+
+				// Increment output position
+				outPosFrac += outPos_inc;
 			}
-
-			_outPosFrac -= FRAC_ONE_LOW;
 		}
 
-		// Loop as long as the _outPos trails behind, and as long as there is
-		// still space in the output buffer.
-		while (_outPosFrac < (frac_t)FRAC_ONE_LOW && outBuffer < outEnd) {
-			// Interpolate
-			st_sample_t inL, inR;
-			inL = (st_sample_t)(_inLastL + (((_inCurL - _inLastL) * _outPosFrac + FRAC_HALF_LOW) >> FRAC_BITS_LOW));
-			inR = (inStereo ?
-						(st_sample_t)(_inLastR + (((_inCurR - _inLastR) * _outPosFrac + FRAC_HALF_LOW) >> FRAC_BITS_LOW)) :
-						inL);
+		// Interpolate
+		_kernels.interpolate(frames, pairs, weights, staged * kInChannels);
 
-			st_sample_t outL, outR;
-			outL = (inL * (int)volL) / Audio::Mixer::kMaxMixerVolume;
-			outR = (inR * (int)volR) / Audio::Mixer::kMaxMixerVolume;
-
-			if (outStereo) {
-				// Output left channel
-				clampedAdd(outBuffer[reverseStereo    ], outL);
-
-				// Output right channel
-				clampedAdd(outBuffer[reverseStereo ^ 1], outR);
-
-				outBuffer += 2;
-			} else {
-				// Output mono channel
-				clampedAdd(outBuffer[0], (outL + outR) / 2);
+		mixFrames(outBuffer + produced * kOutChannels, frames, staged, volL, volR);
+		produced += staged;
+	}
 
-				outBuffer += 1;
-			}
+	_inLastL = inLastL;
+	_inLastR = inLastR;
+	_inCurL = inCurL;
+	_inCurR = inCurR;
+	_outPosFrac = outPosFrac;
 
-			// Increment output position
-			_outPosFrac += outPos_inc;
-		}
-	}
-	return (outBuffer - outStart) / (outStereo ? 2 : 1);
+	return produced;
 }
 
 template<bool inStereo, bool outStereo, bool reverseStereo>
@@ -280,7 +421,8 @@ RateConverter_Impl<inStereo, outStereo, reverseStereo>::RateConverter_Impl(st_ra
 	_inCurL(0),
 	_inCurR(0),
 	_bufferSize(0),
-	_bufferPos(nullptr) {}
+	_bufferPos(nullptr),
+	_kernels(getRateKernels()) {}
 
 template<bool inStereo, bool outStereo, bool reverseStereo>
 int RateConverter_Impl<inStereo, outStereo, reverseStereo>::convert(AudioStream &input, st_sample_t *outBuffer, st_size_t numSamples, st_volume_t volL, st_volume_t volR) {
@@ -297,20 +439,248 @@ int RateConverter_Impl<inStereo, outStereo, reverseStereo>::convert(AudioStream
 	}
 }
 
-RateConverter *makeRateConverter(st_rate_t inRate, st_rate_t outRate, bool inStereo, bool outStereo, bool reverseStereo) {
+#pragma mark -
+#pragma mark --- Sinc rate converter ---
+#pragma mark -
+
+/**
+ * Rate converter using a windowed sinc filter with kSincTaps taps. The filter
+ * is stored as a polyphase table with kSincPhases + 1 phases; the output
+ * position is rounded to the nearest phase. When downsampling, the cutoff is
+ * lowered to the output Nyquist frequency to avoid aliasing.
+ *
+ * Each output sample costs kSincTaps multiply-adds instead of the two of the
+ * linear converter. This is made up for by reading the input a block at a
+ * time instead of per output frame, so it is still cheaper than the scalar
+ * linear converter was before the kernels were vectorized.
+ */
+template<bool inStereo, bool outStereo, bool reverseStereo>
+class SincRateConverter_Impl : public RateConverter_Impl<inStereo, outStereo, reverseStereo> {
+	typedef RateConverter_Impl<inStereo, outStereo, reverseStereo> Base;
+
+	enum {
+		kSincPhaseBits = 6,
+		kSincPhases = 1 << kSincPhaseBits,
+
+		/** Number of input frames kept per channel */
+		kHistorySize = 512
+	};
+
+	/**
+	 * Past input samples per channel, in output channel order. The newest
+	 * kSincTaps samples form the filter window.
+	 */
+	st_sample_t _history[Base::kInChannels][kHistorySize];
+	uint _historyLen;
+
+	/** Filter coefficients for each phase */
+	int16 _coeffs[(kSincPhases + 1) * kSincTaps];
+
+	/** Relative cutoff frequency the coefficients were calculated for */
+	double _cutoff;
+
+	void updateCoefficients();
+
+	/** Append up to @p count input frames to the history. Returns the number read. */
+	uint readFrames(AudioStream &input, uint count);
+
+	int sincConvert(AudioStream &input, st_sample_t *outBuffer, st_size_t numSamples, st_volume_t vol_l, st_volume_t vol_r);
+
+public:
+	SincRateConverter_Impl(st_rate_t inputRate, st_rate_t outputRate);
+
+	int convert(AudioStream &input, st_sample_t *outBuffer, st_size_t numSamples, st_volume_t vol_l, st_volume_t vol_r) override;
+};
+
+template<bool inStereo, bool outStereo, bool reverseStereo>
+SincRateConverter_Impl<inStereo, outStereo, reverseStereo>::SincRateConverter_Impl(st_rate_t inputRate, st_rate_t outputRate) :
+	Base(inputRate, outputRate),
+	_historyLen(kSincTaps),
+	_cutoff(0.0) {
+	memset(_history, 0, sizeof(_history));
+	memset(_coeffs, 0, sizeof(_coeffs));
+}
+
+template<bool inStereo, bool outStereo, bool reverseStereo>
+void SincRateConverter_Impl<inStereo, outStereo, reverseStereo>::updateCoefficients() {
+	// Keep a bit of headroom below Nyquist, the filter is short
+	double cutoff = 0.9;
+	if (this->_outRate < this->_inRate)
+		cutoff *= (double)this->_outRate / this->_inRate;
+
+	if (cutoff == _cutoff)
+		return;
+	_cutoff = cutoff;
+
+	const int center = kSincTaps / 2 - 1;
+	for (int phase = 0; phase <= kSincPhases; phase++) {
+		double taps[kSincTaps];
+		double sum = 0.0;
+
+		for (int k = 0; k < kSincTaps; k++) {
+			const double t = (k - center) - (double)phase / kSincPhases;
+			const double x = M_PI * cutoff * t;
+			const double sinc = (x == 0.0) ? 1.0 : sin(x) / x;
+
+			// Blackman window spanning all taps
+			const double w = t / (kSincTaps / 2);
+			const double window = (w <= -1.0 || w >= 1.0) ? 0.0 : 0.42 + 0.5 * cos(M_PI * w) + 0.08 * cos(2.0 * M_PI * w);
+
+			taps[k] = sinc * window;
+			sum += taps[k];
+		}
+
+		// Normalize to unity gain, putting the rounding error on the largest tap
+		int16 *coeffs = _coeffs + phase * kSincTaps;
+		int total = 0, largest = 0;
+		for (int k = 0; k < kSincTaps; k++) {
+			coeffs[k] = (int16)floor(taps[k] / sum * (1 << kSincCoeffBits) + 0.5);
+			total += coeffs[k];
+			if (coeffs[k] > coeffs[largest])
+				largest = k;
+		}
+		coeffs[largest] += (1 << kSincCoeffBits) - total;
+	}
+}
+
+template<bool inStereo, bool outStereo, bool reverseStereo>
+uint SincRateConverter_Impl<inStereo, outStereo, reverseStereo>::readFrames(AudioStream &input, uint count) {
+	uint got = 0;
+	while (got < count) {
+		// Check if we have to refill the buffer
+		if (!this->fillBuffer(input))
+			break;
+
+		const uint frames = MIN<uint>(count - got, this->_bufferSize / Base::kInChannels);
+		if (frames == 0) {
+			// Drop an incomplete stereo frame
+			this->_bufferSize = 0;
+			continue;
+		}
+
+		const st_sample_t *in = this->_bufferPos;
+		if (inStereo) {
+			st_sample_t *left = _history[reverseStereo] + _historyLen + got;
+			st_sample_t *right = _history[reverseStereo ^ 1] + _historyLen + got;
+			for (uint i = 0; i < frames; i++) {
+				left[i] = in[2 * i];
+				right[i] = in[2 * i + 1];
+			}
+		} else {
+			memcpy(_history[0] + _historyLen + got, in, frames * sizeof(st_sample_t));
+		}
+
+		this->_bufferPos += frames * Base::kInChannels;
+		this->_bufferSize -= frames * Base::kInChannels;
+		got += frames;
+	}
+
+	_historyLen += got;
+	return got;
+}
+
+template<bool inStereo, bool outStereo, bool reverseStereo>
+int SincRateConverter_Impl<inStereo, outStereo, reverseStereo>::sincConvert(AudioStream &input, st_sample_t *outBuffer, st_size_t numSamples, st_volume_t volL, st_volume_t volR) {
+	// How much to increment _outPosFrac by
+	frac_t outPos_inc = (this->_inRate << FRAC_BITS_LOW) / this->_outRate;
+
+	updateCoefficients();
+
+	const st_sample_t *windows[Base::kChunkFrames * Base::kInChannels];
+	const int16 *coeffs[Base::kChunkFrames * Base::kInChannels];
+	st_sample_t frames[Base::kChunkFrames * Base::kInChannels];
+	st_size_t produced = 0;
+	bool endOfStream = false;
+
+	while (produced < numSamples && !endOfStream) {
+		// Only the newest window has to be kept
+		if (_historyLen > kSincTaps) {
+			for (int c = 0; c < Base::kInChannels; c++)
+				memmove(_history[c], _history[c] + _historyLen - kSincTaps, kSincTaps * sizeof(st_sample_t));
+			_historyLen = kSincTaps;
+		}
+
+		// The output positions only depend on the rates, so the windows and
+		// phases of a whole chunk are known before reading its input. An
+		// output frame needs the input frames up to its position.
+		const uint count = MIN<st_size_t>(numSamples - produced, Base::kChunkFrames);
+		const uint room = kHistorySize - _historyLen;
+		frac_t pos = this->_outPosFrac;
+		uint staged = 0;
+		while (staged < count && (uint)(pos >> FRAC_BITS_LOW) <= room) {
+			const uint start = _historyLen + (pos >> FRAC_BITS_LOW) - kSincTaps;
+			const int phase = ((pos & (FRAC_ONE_LOW - 1)) + (1 << (FRAC_BITS_LOW - kSincPhaseBits - 1))) >> (FRAC_BITS_LOW - kSincPhaseBits);
+
+			for (int c = 0; c < Base::kInChannels; c++) {
+				windows[staged * Base::kInChannels + c] = _history[c] + start;
+				coeffs[staged * Base::kInChannels + c] = _coeffs + phase * kSincTaps;
+			}
+			staged++;
+
+			// Increment output position
+			pos += outPos_inc;
+		}
+
+		const uint needed = (uint)((pos - outPos_inc) >> FRAC_BITS_LOW);
+		const uint got = readFrames(input, needed);
+		if (got < needed) {
+			// Keep the frames whose input is complete, the position of the
+			// next one is relative to the input read
+			endOfStream = true;
+			pos = this->_outPosFrac;
+			staged = 0;
+			while ((uint)(pos >> FRAC_BITS_LOW) <= got) {
+				staged++;
+				pos += outPos_inc;
+			}
+			this->_outPosFrac = pos - (frac_t)got * FRAC_ONE_LOW;
+		} else {
+			this->_outPosFrac = pos - (frac_t)needed * FRAC_ONE_LOW;
+		}
+
+		this->_kernels.filter(frames, windows, coeffs, staged * Base::kInChannels);
+
+		this->mixFrames(outBuffer + produced * Base::kOutChannels, frames, staged, volL, volR);
+		produced += staged;
+	}
+
+	return produced;
+}
+
+template<bool inStereo, bool outStereo, bool reverseStereo>
+int SincRateConverter_Impl<inStereo, outStereo, reverseStereo>::convert(AudioStream &input, st_sample_t *outBuffer, st_size_t numSamples, st_volume_t volL, st_volume_t volR) {
+	assert(input.isStereo() == inStereo);
+
+	if (this->_inRate == this->_outRate)
+		return this->copyConvert(input, outBuffer, numSamples, volL, volR);
+	else
+		return sincConvert(input, outBuffer, numSamples, volL, volR);
+}
+
+#pragma mark -
+
+template<bool inStereo, bool outStereo, bool reverseStereo>
+static RateConverter *makeRateConverterImpl(st_rate_t inRate, st_rate_t outRate, RateConverterQuality quality) {
+	if (quality == kRateConverterSinc)
+		return new SincRateConverter_Impl<inStereo, outStereo, reverseStereo>(inRate, outRate);
+	else
+		return new RateConverter_Impl<inStereo, outStereo, reverseStereo>(inRate, outRate);
+}
+
+RateConverter *makeRateConverter(st_rate_t inRate, st_rate_t outRate, bool inStereo, bool outStereo, bool reverseStereo, RateConverterQuality quality) {
 	if (inStereo) {
 		if (outStereo) {
 			if (reverseStereo)
-				return new RateConverter_Impl<true, true, true>(inRate, outRate);
+				return makeRateConverterImpl<true, true, true>(inRate, outRate, quality);
 			else
-				return new RateConverter_Impl<true, true, false>(inRate, outRate);
+				return makeRateConverterImpl<true, true, false>(inRate, outRate, quality);
 		} else
-			return new RateConverter_Impl<true, false, false>(inRate, outRate);
+			return makeRateConverterImpl<true, false, false>(inRate, outRate, quality);
 	} else {
 		if (outStereo) {
-			return new RateConverter_Impl<false, true, false>(inRate, outRate);
+			return makeRateConverterImpl<false, true, false>(inRate, outRate, quality);
 		} else
-			return new RateConverter_Impl<false, false, false>(inRate, outRate);
+			return makeRateConverterImpl<false, false, false>(inRate, outRate, quality);
 	}
 }
 
@@ -104,7 +104,15 @@ public:
 	virtual bool needsDraining() const = 0;
 };
 
-RateConverter *makeRateConverter(st_rate_t inRate, st_rate_t outRate, bool inStereo, bool outStereo, bool reverseStereo);
+/**
+ * Resampling method used by a RateConverter.
+ */
+enum RateConverterQuality {
+	kRateConverterLinear,	/*!< Linear interpolation. Fastest. */
+	kRateConverterSinc	/*!< Windowed sinc filter. Less aliasing and imaging, a little more CPU time than linear for stereo sounds. */
+};
+
+RateConverter *makeRateConverter(st_rate_t inRate, st_rate_t outRate, bool inStereo, bool outStereo, bool reverseStereo, RateConverterQuality quality = kRateConverterLinear);
 
 /** @} */
 } // End of namespace Audio
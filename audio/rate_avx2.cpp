@@ -0,0 +1,162 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "common/scummsys.h"
+
+#include "audio/mixer.h"
+#include "audio/rate_intern.h"
+
+#include <immintrin.h>
+
+#ifdef __GNUC__
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+
+namespace Audio {
+
+/**
+ * Multiply 16 samples by 16 volumes and divide by Mixer::kMaxMixerVolume (256),
+ * rounding towards zero like the generic code does.
+ */
+static FORCEINLINE __m256i scaleAVX2(__m256i in, __m256i vol) {
+	__m256i lo = _mm256_mullo_epi16(in, vol);
+	__m256i hi = _mm256_mulhi_epi16(in, vol);
+	__m256i prodLo = _mm256_unpacklo_epi16(lo, hi);
+	__m256i prodHi = _mm256_unpackhi_epi16(lo, hi);
+
+	prodLo = _mm256_srai_epi32(_mm256_add_epi32(prodLo, _mm256_and_si256(_mm256_srai_epi32(prodLo, 31), _mm256_set1_epi32(255))), 8);
+	prodHi = _mm256_srai_epi32(_mm256_add_epi32(prodHi, _mm256_and_si256(_mm256_srai_epi32(prodHi, 31), _mm256_set1_epi32(255))), 8);
+	return _mm256_packs_epi32(prodLo, prodHi);
+}
+
+static void mixStereoAVX2(st_sample_t *out, const st_sample_t *in, uint frames, st_volume_t volL, st_volume_t volR) {
+	const __m256i vol = _mm256_set1_epi32((int)volL | ((int)volR << 16));
+	const uint count = frames * 2;
+	uint i = 0;
+
+	for (; i + 16 <= count; i += 16) {
+		__m256i src = _mm256_loadu_si256((const __m256i *)(in + i));
+		__m256i dst = _mm256_loadu_si256((const __m256i *)(out + i));
+		_mm256_storeu_si256((__m256i *)(out + i), _mm256_adds_epi16(dst, scaleAVX2(src, vol)));
+	}
+
+	for (; i < count; i += 2) {
+		clampedAdd(out[i    ], (in[i    ] * (int)volL) / Audio::Mixer::kMaxMixerVolume);
+		clampedAdd(out[i + 1], (in[i + 1] * (int)volR) / Audio::Mixer::kMaxMixerVolume);
+	}
+}
+
+static void mixMonoAVX2(st_sample_t *out, const st_sample_t *in, uint frames, st_volume_t volL, st_volume_t volR) {
+	const __m256i vol = _mm256_set1_epi32((int)volL | ((int)volR << 16));
+	uint i = 0;
+
+	for (; i + 8 <= frames; i += 8) {
+		__m128i src = _mm_loadu_si128((const __m128i *)(in + i));
+		__m256i dup = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_unpacklo_epi16(src, src)), _mm_unpackhi_epi16(src, src), 1);
+		__m256i dst = _mm256_loadu_si256((const __m256i *)(out + 2 * i));
+		_mm256_storeu_si256((__m256i *)(out + 2 * i), _mm256_adds_epi16(dst, scaleAVX2(dup, vol)));
+	}
+
+	for (; i < frames; i++) {
+		clampedAdd(out[2 * i    ], (in[i] * (int)volL) / Audio::Mixer::kMaxMixerVolume);
+		clampedAdd(out[2 * i + 1], (in[i] * (int)volR) / Audio::Mixer::kMaxMixerVolume);
+	}
+}
+
+/** Interpolate 8 samples, see interpolate4SSE2(). */
+static FORCEINLINE __m256i interpolate8AVX2(const st_sample_t *pairs, const int16 *weights) {
+	__m256i p = _mm256_loadu_si256((const __m256i *)pairs);
+	__m256i w = _mm256_loadu_si256((const __m256i *)weights);
+	__m256i last = _mm256_srai_epi32(_mm256_slli_epi32(p, 16), 16);
+	__m256i sum = _mm256_add_epi32(_mm256_madd_epi16(p, w), _mm256_add_epi32(last, _mm256_set1_epi32(1 << 14)));
+	return _mm256_srai_epi32(sum, 15);
+}
+
+static void interpolateAVX2(st_sample_t *out, const st_sample_t *pairs, const int16 *weights, uint count) {
+	uint i = 0;
+
+	for (; i + 16 <= count; i += 16) {
+		__m256i lo = interpolate8AVX2(pairs + 2 * i, weights + 2 * i);
+		__m256i hi = interpolate8AVX2(pairs + 2 * i + 16, weights + 2 * i + 16);
+		// Packing works per 128-bit lane, so restore the order afterwards
+		__m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi32(lo, hi), _MM_SHUFFLE(3, 1, 2, 0));
+		_mm256_storeu_si256((__m256i *)(out + i), packed);
+	}
+
+	for (; i < count; i++) {
+		const int last = pairs[2 * i], cur = pairs[2 * i + 1];
+		out[i] = (st_sample_t)(last + (((cur - last) * weights[2 * i + 1] + (1 << 14)) >> 15));
+	}
+}
+
+/** Multiply-add the windows of filters i and i + 1, one per 128-bit lane. */
+static FORCEINLINE __m256i filter2AVX2(const st_sample_t *const *windows, const int16 *const *coeffs, uint i) {
+	__m256i w = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)windows[i])), _mm_loadu_si128((const __m128i *)windows[i + 1]), 1);
+	__m256i c = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)coeffs[i])), _mm_loadu_si128((const __m128i *)coeffs[i + 1]), 1);
+	return _mm256_madd_epi16(w, c);
+}
+
+static void filterAVX2(st_sample_t *out, const st_sample_t *const *windows, const int16 *const *coeffs, uint count) {
+	const __m256i round = _mm256_set1_epi32(1 << (kSincCoeffBits - 1));
+	uint i = 0;
+
+	for (; i + 8 <= count; i += 8) {
+		__m256i s0 = filter2AVX2(windows, coeffs, i);
+		__m256i s1 = filter2AVX2(windows, coeffs, i + 2);
+		__m256i s2 = filter2AVX2(windows, coeffs, i + 4);
+		__m256i s3 = filter2AVX2(windows, coeffs, i + 6);
+
+		// Transpose and add, leaving the even filters in the low lane and
+		// the odd filters in the high lane
+		__m256i t0 = _mm256_add_epi32(_mm256_unpacklo_epi32(s0, s1), _mm256_unpackhi_epi32(s0, s1));
+		__m256i t1 = _mm256_add_epi32(_mm256_unpacklo_epi32(s2, s3), _mm256_unpackhi_epi32(s2, s3));
+		__m256i sum = _mm256_add_epi32(_mm256_unpacklo_epi64(t0, t1), _mm256_unpackhi_epi64(t0, t1));
+
+		sum = _mm256_srai_epi32(_mm256_add_epi32(sum, round), kSincCoeffBits);
+		__m256i packed = _mm256_packs_epi32(sum, sum);
+		__m128i result = _mm_unpacklo_epi16(_mm256_castsi256_si128(packed), _mm256_extracti128_si256(packed, 1));
+		_mm_storeu_si128((__m128i *)(out + i), result);
+	}
+
+	for (; i < count; i++) {
+		int sum = 0;
+		for (int k = 0; k < kSincTaps; k++)
+			sum += windows[i][k] * coeffs[i][k];
+
+		sum = (sum + (1 << (kSincCoeffBits - 1))) >> kSincCoeffBits;
+		out[i] = (st_sample_t)CLIP<int>(sum, ST_SAMPLE_MIN, ST_SAMPLE_MAX);
+	}
+}
+
+const RateKernels g_rateKernelsAVX2 = {
+	mixStereoAVX2,
+	mixMonoAVX2,
+	interpolateAVX2,
+	filterAVX2
+};
+
+} // End of namespace Audio
+
+#ifdef __GNUC__
+#pragma GCC pop_options
+#endif
@@ -0,0 +1,87 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef AUDIO_RATE_INTERN_H
+#define AUDIO_RATE_INTERN_H
+
+#include "audio/rate.h"
+
+namespace Audio {
+
+/**
+ * Inner loops of the rate converters. The generic versions live in rate.cpp,
+ * vectorized versions in rate_sse2.cpp, rate_avx2.cpp and rate_neon.cpp. All
+ * versions must produce bit-identical results.
+ */
+struct RateKernels {
+	/**
+	 * Scale interleaved stereo frames by the channel volumes and add them to
+	 * the stereo output buffer, clamping the result.
+	 */
+	void (*mixStereo)(st_sample_t *out, const st_sample_t *in, uint frames, st_volume_t volL, st_volume_t volR);
+
+	/**
+	 * Scale mono frames by the channel volumes and add them to both channels
+	 * of the stereo output buffer, clamping the result.
+	 */
+	void (*mixMono)(st_sample_t *out, const st_sample_t *in, uint frames, st_volume_t volL, st_volume_t volR);
+
+	/**
+	 * Linearly interpolate @p count samples. Sample i is interpolated between
+	 * pairs[2 * i] and pairs[2 * i + 1]; weights[2 * i] and weights[2 * i + 1]
+	 * hold 32767 - frac and frac, with frac being the position in between in
+	 * 1/32768 units.
+	 */
+	void (*interpolate)(st_sample_t *out, const st_sample_t *pairs, const int16 *weights, uint count);
+
+	/**
+	 * Apply a kSincTaps FIR filter for each of @p count samples: sample i is
+	 * the dot product of windows[i] and coeffs[i], in 1/2^kSincCoeffBits
+	 * units and clamped.
+	 */
+	void (*filter)(st_sample_t *out, const st_sample_t *const *windows, const int16 *const *coeffs, uint count);
+};
+
+enum {
+	kSincTaps = 8,
+	kSincCoeffBits = 14
+};
+
+#ifdef SCUMMVM_NEON
+extern const RateKernels g_rateKernelsNEON;
+#endif
+#ifdef SCUMMVM_SSE2
+extern const RateKernels g_rateKernelsSSE2;
+#endif
+#ifdef SCUMMVM_AVX2
+extern const RateKernels g_rateKernelsAVX2;
+#endif
+
+/** Return the generic kernels. */
+const RateKernels &getGenericRateKernels();
+
+/** Return the fastest kernels supported by the CPU. */
+const RateKernels &getRateKernels();
+
+} // End of namespace Audio
+
+#endif
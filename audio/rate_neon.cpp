@@ -0,0 +1,159 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "common/scummsys.h"
+
+#ifdef SCUMMVM_NEON
+
+#include "audio/mixer.h"
+#include "audio/rate_intern.h"
+
+#include <arm_neon.h>
+
+#ifdef __GNUC__
+#pragma GCC push_options
+
+#if !defined(__aarch64__)
+#pragma GCC target("fpu=neon")
+#endif // !defined(__aarch64__)
+
+#endif // __GNUC__
+
+namespace Audio {
+
+/**
+ * Divide 4 products by Mixer::kMaxMixerVolume (256), rounding towards zero
+ * like the generic code does.
+ */
+static FORCEINLINE int32x4_t divideVolumeNEON(int32x4_t prod) {
+	int32x4_t bias = vandq_s32(vshrq_n_s32(prod, 31), vdupq_n_s32(255));
+	return vshrq_n_s32(vaddq_s32(prod, bias), 8);
+}
+
+/** Multiply 8 samples by 8 volumes and divide by Mixer::kMaxMixerVolume. */
+static FORCEINLINE int16x8_t scaleNEON(int16x8_t in, int16x8_t vol) {
+	int32x4_t lo = divideVolumeNEON(vmull_s16(vget_low_s16(in), vget_low_s16(vol)));
+	int32x4_t hi = divideVolumeNEON(vmull_s16(vget_high_s16(in), vget_high_s16(vol)));
+	return vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi));
+}
+
+static FORCEINLINE int16x8_t volumeNEON(st_volume_t volL, st_volume_t volR) {
+	const int16 vol[8] = {
+		(int16)volL, (int16)volR, (int16)volL, (int16)volR,
+		(int16)volL, (int16)volR, (int16)volL, (int16)volR
+	};
+	return vld1q_s16(vol);
+}
+
+static void mixStereoNEON(st_sample_t *out, const st_sample_t *in, uint frames, st_volume_t volL, st_volume_t volR) {
+	const int16x8_t vol = volumeNEON(volL, volR);
+	const uint count = frames * 2;
+	uint i = 0;
+
+	for (; i + 8 <= count; i += 8) {
+		int16x8_t src = vld1q_s16(in + i);
+		int16x8_t dst = vld1q_s16(out + i);
+		vst1q_s16(out + i, vqaddq_s16(dst, scaleNEON(src, vol)));
+	}
+
+	for (; i < count; i += 2) {
+		clampedAdd(out[i    ], (in[i    ] * (int)volL) / Audio::Mixer::kMaxMixerVolume);
+		clampedAdd(out[i + 1], (in[i + 1] * (int)volR) / Audio::Mixer::kMaxMixerVolume);
+	}
+}
+
+static void mixMonoNEON(st_sample_t *out, const st_sample_t *in, uint frames, st_volume_t volL, st_volume_t volR) {
+	const int16x8_t vol = volumeNEON(volL, volR);
+	uint i = 0;
+
+	for (; i + 8 <= frames; i += 8) {
+		int16x8_t src = vld1q_s16(in + i);
+		int16x8x2_t dup = vzipq_s16(src, src);
+		int16x8_t dstLo = vld1q_s16(out + 2 * i);
+		int16x8_t dstHi = vld1q_s16(out + 2 * i + 8);
+		vst1q_s16(out + 2 * i, vqaddq_s16(dstLo, scaleNEON(dup.val[0], vol)));
+		vst1q_s16(out + 2 * i + 8, vqaddq_s16(dstHi, scaleNEON(dup.val[1], vol)));
+	}
+
+	for (; i < frames; i++) {
+		clampedAdd(out[2 * i    ], (in[i] * (int)volL) / Audio::Mixer::kMaxMixerVolume);
+		clampedAdd(out[2 * i + 1], (in[i] * (int)volR) / Audio::Mixer::kMaxMixerVolume);
+	}
+}
+
+/**
+ * Interpolate 4 samples. Computes last * (32767 - frac) + cur * frac + last,
+ * which equals last * 32768 + (cur - last) * frac.
+ */
+static FORCEINLINE int16x4_t interpolate4NEON(int16x4_t last, int16x4_t cur, int16x4_t lastWeight, int16x4_t curWeight) {
+	int32x4_t sum = vmull_s16(last, lastWeight);
+	sum = vmlal_s16(sum, cur, curWeight);
+	sum = vaddq_s32(sum, vaddq_s32(vmovl_s16(last), vdupq_n_s32(1 << 14)));
+	return vmovn_s32(vshrq_n_s32(sum, 15));
+}
+
+static void interpolateNEON(st_sample_t *out, const st_sample_t *pairs, const int16 *weights, uint count) {
+	uint i = 0;
+
+	for (; i + 8 <= count; i += 8) {
+		int16x8x2_t p = vld2q_s16(pairs + 2 * i);
+		int16x8x2_t w = vld2q_s16(weights + 2 * i);
+		int16x4_t lo = interpolate4NEON(vget_low_s16(p.val[0]), vget_low_s16(p.val[1]), vget_low_s16(w.val[0]), vget_low_s16(w.val[1]));
+		int16x4_t hi = interpolate4NEON(vget_high_s16(p.val[0]), vget_high_s16(p.val[1]), vget_high_s16(w.val[0]), vget_high_s16(w.val[1]));
+		vst1q_s16(out + i, vcombine_s16(lo, hi));
+	}
+
+	for (; i < count; i++) {
+		const int last = pairs[2 * i], cur = pairs[2 * i + 1];
+		out[i] = (st_sample_t)(last + (((cur - last) * weights[2 * i + 1] + (1 << 14)) >> 15));
+	}
+}
+
+static void filterNEON(st_sample_t *out, const st_sample_t *const *windows, const int16 *const *coeffs, uint count) {
+	for (uint i = 0; i < count; i++) {
+		int16x8_t w = vld1q_s16(windows[i]);
+		int16x8_t c = vld1q_s16(coeffs[i]);
+		int32x4_t acc = vmull_s16(vget_low_s16(w), vget_low_s16(c));
+		acc = vmlal_s16(acc, vget_high_s16(w), vget_high_s16(c));
+
+		int32x2_t pair = vadd_s32(vget_low_s32(acc), vget_high_s32(acc));
+		int sum = vget_lane_s32(vpadd_s32(pair, pair), 0);
+
+		sum = (sum + (1 << (kSincCoeffBits - 1))) >> kSincCoeffBits;
+		out[i] = (st_sample_t)CLIP<int>(sum, ST_SAMPLE_MIN, ST_SAMPLE_MAX);
+	}
+}
+
+const RateKernels g_rateKernelsNEON = {
+	mixStereoNEON,
+	mixMonoNEON,
+	interpolateNEON,
+	filterNEON
+};
+
+} // End of namespace Audio
+
+#ifdef __GNUC__
+#pragma GCC pop_options
+#endif
+
+#endif // SCUMMVM_NEON
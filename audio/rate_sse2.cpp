@@ -0,0 +1,160 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "common/scummsys.h"
+
+#include "audio/mixer.h"
+#include "audio/rate_intern.h"
+
+#include <emmintrin.h>
+
+#ifdef __GNUC__
+#pragma GCC push_options
+
+#ifndef __x86_64__
+#pragma GCC target("sse2")
+#endif
+
+#endif
+
+namespace Audio {
+
+/**
+ * Multiply 8 samples by 8 volumes and divide by Mixer::kMaxMixerVolume (256),
+ * rounding towards zero like the generic code does.
+ */
+static FORCEINLINE __m128i scaleSSE2(__m128i in, __m128i vol) {
+	__m128i lo = _mm_mullo_epi16(in, vol);
+	__m128i hi = _mm_mulhi_epi16(in, vol);
+	__m128i prodLo = _mm_unpacklo_epi16(lo, hi);
+	__m128i prodHi = _mm_unpackhi_epi16(lo, hi);
+
+	prodLo = _mm_srai_epi32(_mm_add_epi32(prodLo, _mm_and_si128(_mm_srai_epi32(prodLo, 31), _mm_set1_epi32(255))), 8);
+	prodHi = _mm_srai_epi32(_mm_add_epi32(prodHi, _mm_and_si128(_mm_srai_epi32(prodHi, 31), _mm_set1_epi32(255))), 8);
+	return _mm_packs_epi32(prodLo, prodHi);
+}
+
+static void mixStereoSSE2(st_sample_t *out, const st_sample_t *in, uint frames, st_volume_t volL, st_volume_t volR) {
+	const __m128i vol = _mm_set1_epi32((int)volL | ((int)volR << 16));
+	const uint count = frames * 2;
+	uint i = 0;
+
+	for (; i + 8 <= count; i += 8) {
+		__m128i src = _mm_loadu_si128((const __m128i *)(in + i));
+		__m128i dst = _mm_loadu_si128((const __m128i *)(out + i));
+		_mm_storeu_si128((__m128i *)(out + i), _mm_adds_epi16(dst, scaleSSE2(src, vol)));
+	}
+
+	for (; i < count; i += 2) {
+		clampedAdd(out[i    ], (in[i    ] * (int)volL) / Audio::Mixer::kMaxMixerVolume);
+		clampedAdd(out[i + 1], (in[i + 1] * (int)volR) / Audio::Mixer::kMaxMixerVolume);
+	}
+}
+
+static void mixMonoSSE2(st_sample_t *out, const st_sample_t *in, uint frames, st_volume_t volL, st_volume_t volR) {
+	const __m128i vol = _mm_set1_epi32((int)volL | ((int)volR << 16));
+	uint i = 0;
+
+	for (; i + 8 <= frames; i += 8) {
+		__m128i src = _mm_loadu_si128((const __m128i *)(in + i));
+		__m128i srcLo = _mm_unpacklo_epi16(src, src);
+		__m128i srcHi = _mm_unpackhi_epi16(src, src);
+		__m128i dstLo = _mm_loadu_si128((const __m128i *)(out + 2 * i));
+		__m128i dstHi = _mm_loadu_si128((const __m128i *)(out + 2 * i + 8));
+		_mm_storeu_si128((__m128i *)(out + 2 * i), _mm_adds_epi16(dstLo, scaleSSE2(srcLo, vol)));
+		_mm_storeu_si128((__m128i *)(out + 2 * i + 8), _mm_adds_epi16(dstHi, scaleSSE2(srcHi, vol)));
+	}
+
+	for (; i < frames; i++) {
+		clampedAdd(out[2 * i    ], (in[i] * (int)volL) / Audio::Mixer::kMaxMixerVolume);
+		clampedAdd(out[2 * i + 1], (in[i] * (int)volR) / Audio::Mixer::kMaxMixerVolume);
+	}
+}
+
+/**
+ * Interpolate 4 samples. Computes last * (32767 - frac) + cur * frac with one
+ * multiply-add; adding last once more gives last * 32768 + (cur - last) * frac.
+ */
+static FORCEINLINE __m128i interpolate4SSE2(const st_sample_t *pairs, const int16 *weights) {
+	__m128i p = _mm_loadu_si128((const __m128i *)pairs);
+	__m128i w = _mm_loadu_si128((const __m128i *)weights);
+	__m128i last = _mm_srai_epi32(_mm_slli_epi32(p, 16), 16);
+	__m128i sum = _mm_add_epi32(_mm_madd_epi16(p, w), _mm_add_epi32(last, _mm_set1_epi32(1 << 14)));
+	return _mm_srai_epi32(sum, 15);
+}
+
+static void interpolateSSE2(st_sample_t *out, const st_sample_t *pairs, const int16 *weights, uint count) {
+	uint i = 0;
+
+	for (; i + 8 <= count; i += 8) {
+		__m128i lo = interpolate4SSE2(pairs + 2 * i, weights + 2 * i);
+		__m128i hi = interpolate4SSE2(pairs + 2 * i + 8, weights + 2 * i + 8);
+		_mm_storeu_si128((__m128i *)(out + i), _mm_packs_epi32(lo, hi));
+	}
+
+	for (; i < count; i++) {
+		const int last = pairs[2 * i], cur = pairs[2 * i + 1];
+		out[i] = (st_sample_t)(last + (((cur - last) * weights[2 * i + 1] + (1 << 14)) >> 15));
+	}
+}
+
+static void filterSSE2(st_sample_t *out, const st_sample_t *const *windows, const int16 *const *coeffs, uint count) {
+	const __m128i round = _mm_set1_epi32(1 << (kSincCoeffBits - 1));
+	uint i = 0;
+
+	for (; i + 4 <= count; i += 4) {
+		__m128i s0 = _mm_madd_epi16(_mm_loadu_si128((const __m128i *)windows[i    ]), _mm_loadu_si128((const __m128i *)coeffs[i    ]));
+		__m128i s1 = _mm_madd_epi16(_mm_loadu_si128((const __m128i *)windows[i + 1]), _mm_loadu_si128((const __m128i *)coeffs[i + 1]));
+		__m128i s2 = _mm_madd_epi16(_mm_loadu_si128((const __m128i *)windows[i + 2]), _mm_loadu_si128((const __m128i *)coeffs[i + 2]));
+		__m128i s3 = _mm_madd_epi16(_mm_loadu_si128((const __m128i *)windows[i + 3]), _mm_loadu_si128((const __m128i *)coeffs[i + 3]));
+
+		// Transpose and add, leaving the sum of filter i in lane i
+		__m128i t0 = _mm_add_epi32(_mm_unpacklo_epi32(s0, s1), _mm_unpackhi_epi32(s0, s1));
+		__m128i t1 = _mm_add_epi32(_mm_unpacklo_epi32(s2, s3), _mm_unpackhi_epi32(s2, s3));
+		__m128i sum = _mm_add_epi32(_mm_unpacklo_epi64(t0, t1), _mm_unpackhi_epi64(t0, t1));
+
+		sum = _mm_srai_epi32(_mm_add_epi32(sum, round), kSincCoeffBits);
+		_mm_storel_epi64((__m128i *)(out + i), _mm_packs_epi32(sum, sum));
+	}
+
+	for (; i < count; i++) {
+		int sum = 0;
+		for (int k = 0; k < kSincTaps; k++)
+			sum += windows[i][k] * coeffs[i][k];
+
+		sum = (sum + (1 << (kSincCoeffBits - 1))) >> kSincCoeffBits;
+		out[i] = (st_sample_t)CLIP<int>(sum, ST_SAMPLE_MIN, ST_SAMPLE_MAX);
+	}
+}
+
+const RateKernels g_rateKernelsSSE2 = {
+	mixStereoSSE2,
+	mixMonoSSE2,
+	interpolateSSE2,
+	filterSSE2
+};
+
+} // End of namespace Audio
+
+#ifdef __GNUC__
+#pragma GCC pop_options
+#endif
@@ -172,6 +172,15 @@ public:
 	 */
 	virtual bool isWritable() const = 0;
 
+	/**
+	 * Retrieves the size and the time of the last modification of the
+	 * file referred by this node. Callers use these to validate data they
+	 * cached about the file.
+	 *
+	 * @return bool true if both values are known, false otherwise.
+	 */
+	virtual bool getFileStatus(int64 &size, int64 &modificationTime) const { return false; }
+
 
 	/**
 	 * Creates a SeekableReadStream instance corresponding to the file
@@ -49,6 +49,10 @@
 #endif
 #include "common/text-to-speech.h"
 
+#if defined(SCUMMVM_SSE2) && defined(__x86_64__)
+#include <emmintrin.h>
+#endif
+
 #ifdef USE_OSD
 #if defined(MACOSX)
 #include "backends/platform/sdl/macosx/macosx-touchbar.h"
@@ -137,6 +141,7 @@ SurfaceSdlGraphicsManager::SurfaceSdlGraphicsManager(SdlEventSource *sdlEventSou
 	_transactionMode(kTransactionNone),
 	_scalerPlugins(ScalerMan.getPlugins()), _scalerPlugin(nullptr), _scaler(nullptr),
 	_needRestoreAfterOverlay(false), _isInOverlayPalette(false), _isDoubleBuf(false), _prevForceRedraw(false), _numPrevDirtyRects(0),
+	_dirtyChecksums(false), _screenChanged(false), _checksumTilesX(0), _checksumTilesY(0),
 	_prevCursorNeedsRedraw(false),
 	_mouseKeyColor(0) {
 
@@ -179,6 +184,7 @@ SurfaceSdlGraphicsManager::SurfaceSdlGraphicsManager(SdlEventSource *sdlEventSou
 	_videoMode.stretchMode = STRETCH_FIT;
 #endif
 	_videoMode.vsync = ConfMan.getBool("vsync");
+	_dirtyChecksums = ConfMan.getBool("dirty_checksums");
 
 	_videoMode.scalerIndex = getDefaultScaler();
 	_videoMode.scaleFactor = getDefaultScaleFactor();
@@ -1299,6 +1305,11 @@ void SurfaceSdlGraphicsManager::internUpdateScreen() {
 	if (_cursorNeedsRedraw || _cursorFormat.aBits() > 1)
 		undrawMouse();
 
+	if (_screenChanged) {
+		addChecksumDirtyRects();
+		_screenChanged = false;
+	}
+
 #ifdef USE_OSD
 	updateOSD();
 #endif
@@ -1652,7 +1663,10 @@ void SurfaceSdlGraphicsManager::copyRectToScreen(const void *buf, int pitch, int
 	assert(h > 0 && y + h <= _videoMode.screenHeight);
 	assert(w > 0 && x + w <= _videoMode.screenWidth);
 
-	addDirtyRect(x, y, w, h, false);
+	if (_dirtyChecksums)
+		_screenChanged = true;
+	else
+		addDirtyRect(x, y, w, h, false);
 
 	// Try to lock the screen surface
 	if (SDL_LockSurface(_screen) == -1)
@@ -1703,8 +1717,11 @@ void SurfaceSdlGraphicsManager::unlockScreen() {
 	// Unlock the screen surface
 	SDL_UnlockSurface(_screen);
 
-	// Trigger a full screen update
-	_forceRedraw = true;
+	// Trigger a full screen update, unless the changes can be found
+	if (_dirtyChecksums)
+		_screenChanged = true;
+	else
+		_forceRedraw = true;
 
 	// Finally unlock the graphics mutex
 	_graphicsMutex.unlock();
@@ -1793,6 +1810,97 @@ void SurfaceSdlGraphicsManager::addDirtyRect(int x, int y, int w, int h, bool in
 	}
 }
 
+/** Checksum of @p height rows of @p len bytes. */
+static uint32 checksumTile(const byte *src, int pitch, int len, int height) {
+	uint32 checksum = 0;
+	for (int y = 0; y < height; y++, src += pitch) {
+		int x = 0;
+#if defined(SCUMMVM_SSE2) && defined(__x86_64__)
+		if (len >= 16) {
+			// Rotate and add in four independent lanes, which are then
+			// combined like four more words
+			__m128i lanes = _mm_setzero_si128();
+			for (; x + 16 <= len; x += 16) {
+				__m128i value = _mm_loadu_si128((const __m128i *)(src + x));
+				lanes = _mm_add_epi32(_mm_or_si128(_mm_slli_epi32(lanes, 5), _mm_srli_epi32(lanes, 27)), value);
+			}
+			uint32 words[4];
+			_mm_storeu_si128((__m128i *)words, lanes);
+			for (int i = 0; i < 4; i++)
+				checksum = ((checksum << 5) | (checksum >> 27)) + words[i];
+		}
+#endif
+		for (; x < len; x++)
+			checksum = ((checksum << 5) | (checksum >> 27)) + src[x];
+	}
+	return checksum;
+}
+
+void SurfaceSdlGraphicsManager::addChecksumDirtyRects() {
+	const int tilesX = (_videoMode.screenWidth + kChecksumTileSize - 1) / kChecksumTileSize;
+	const int tilesY = (_videoMode.screenHeight + kChecksumTileSize - 1) / kChecksumTileSize;
+	bool newTiles = false;
+	if (tilesX != _checksumTilesX || tilesY != _checksumTilesY || _tileChecksums.size() != (uint)(tilesX * tilesY)) {
+		_checksumTilesX = tilesX;
+		_checksumTilesY = tilesY;
+		_tileChecksums.resize(tilesX * tilesY);
+		newTiles = true;
+	}
+
+	if (SDL_LockSurface(_screen) == -1)
+		error("SDL_LockSurface failed: %s", SDL_GetError());
+
+	// Changed tiles are gathered into rows of consecutive tiles, which are
+	// merged with the identical rows below them
+	Common::Array<Common::Rect> regions;
+	const int bpp = _screenFormat.bytesPerPixel;
+	for (int ty = 0; ty < tilesY; ty++) {
+		const int y = ty * kChecksumTileSize;
+		const int h = MIN<int>(kChecksumTileSize, _videoMode.screenHeight - y);
+		int runStart = -1;
+
+		for (int tx = 0; tx <= tilesX; tx++) {
+			bool changed = false;
+			if (tx < tilesX) {
+				const int x = tx * kChecksumTileSize;
+				const int w = MIN<int>(kChecksumTileSize, _videoMode.screenWidth - x);
+				const uint32 checksum = checksumTile((const byte *)_screen->pixels + y * _screen->pitch + x * bpp, _screen->pitch, w * bpp, h);
+				uint32 &previous = _tileChecksums[ty * tilesX + tx];
+				changed = checksum != previous;
+				previous = checksum;
+			}
+
+			if (changed && runStart < 0) {
+				runStart = tx;
+			} else if (!changed && runStart >= 0) {
+				const int left = runStart * kChecksumTileSize;
+				const int right = MIN<int>(tx * kChecksumTileSize, _videoMode.screenWidth);
+				bool merged = false;
+				for (uint i = 0; i < regions.size(); i++) {
+					if (regions[i].left == left && regions[i].right == right && regions[i].bottom == y) {
+						regions[i].bottom = y + h;
+						merged = true;
+						break;
+					}
+				}
+				if (!merged)
+					regions.push_back(Common::Rect(left, y, right, y + h));
+				runStart = -1;
+			}
+		}
+	}
+
+	SDL_UnlockSurface(_screen);
+
+	if (newTiles) {
+		_forceRedraw = true;
+		return;
+	}
+
+	for (uint i = 0; i < regions.size() && !_forceRedraw; i++)
+		addDirtyRect(regions[i].left, regions[i].top, regions[i].width(), regions[i].height(), false);
+}
+
 int16 SurfaceSdlGraphicsManager::getHeight() const {
 	return _videoMode.screenHeight;
 }
@@ -27,6 +27,7 @@
 #include "graphics/pixelformat.h"
 #include "graphics/scaler.h"
 #include "graphics/scalerplugin.h"
+#include "common/array.h"
 #include "common/events.h"
 #include "common/mutex.h"
 
@@ -356,6 +357,20 @@ protected:
 	SDL_Rect _prevDirtyRectList[NUM_DIRTY_RECT];
 	int _numPrevDirtyRects;
 
+	// Checksum based dirty rect detection
+	// When enabled, changes to the game screen are not tracked as they are
+	// made. Instead, the screen is split into tiles whose checksums are
+	// compared with the ones of the previous frame. This finds the small
+	// changes of engines which copy their whole screen every frame.
+	enum {
+		kChecksumTileSize = 16
+	};
+
+	bool _dirtyChecksums;
+	bool _screenChanged;
+	int _checksumTilesX, _checksumTilesY;
+	Common::Array<uint32> _tileChecksums;
+
 	struct MousePos {
 		// The size and hotspot of the original cursor image.
 		int16 w, h;
@@ -418,6 +433,7 @@ protected:
 #endif
 
 	virtual void addDirtyRect(int x, int y, int w, int h, bool inOverlay, bool realCoordinates = false);
+	void addChecksumDirtyRects();
 
 	virtual void drawMouse();
 	virtual void undrawMouse();
@@ -0,0 +1,122 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#define FORBIDDEN_SYMBOL_EXCEPTION_time_h
+#define FORBIDDEN_SYMBOL_EXCEPTION_unistd_h
+
+#include "common/scummsys.h"
+
+#if defined(HAS_PTHREADS)
+
+#include "backends/jobs/pthread/pthread-jobs.h"
+#include "backends/jobs/threaded/threaded-jobs.h"
+
+#include <pthread.h>
+#include <unistd.h>
+
+/**
+ * pthreads job manager implementation
+ */
+class PthreadJobManager final : public ThreadedJobManager {
+public:
+	explicit PthreadJobManager(uint workerCount);
+	~PthreadJobManager() override;
+
+protected:
+	bool createThread(uint index) override;
+	void joinThreads() override;
+	bool isCurrentThread(uint index) const override {
+		return index < _workers.size() && pthread_equal(_workers[index].thread, pthread_self());
+	}
+
+	void lock() override { pthread_mutex_lock(&_mutex); }
+	void unlock() override { pthread_mutex_unlock(&_mutex); }
+	void waitCondition() override { pthread_cond_wait(&_cond, &_mutex); }
+	void broadcastCondition() override { pthread_cond_broadcast(&_cond); }
+
+private:
+	struct Worker {
+		PthreadJobManager *manager;
+		uint index;
+		pthread_t thread;
+	};
+
+	static void *threadProc(void *arg);
+
+	pthread_mutex_t _mutex;
+	pthread_cond_t _cond;
+	Common::Array<Worker> _workers;
+};
+
+PthreadJobManager::PthreadJobManager(uint workerCount) {
+	pthread_mutex_init(&_mutex, nullptr);
+	pthread_cond_init(&_cond, nullptr);
+
+	// Worker addresses are handed to the threads and must stay valid
+	_workers.reserve(workerCount);
+	startWorkers(workerCount);
+}
+
+PthreadJobManager::~PthreadJobManager() {
+	stopWorkers();
+
+	pthread_cond_destroy(&_cond);
+	pthread_mutex_destroy(&_mutex);
+}
+
+bool PthreadJobManager::createThread(uint index) {
+	Worker worker;
+	worker.manager = this;
+	worker.index = index;
+	_workers.push_back(worker);
+
+	if (pthread_create(&_workers.back().thread, nullptr, threadProc, &_workers.back()) != 0) {
+		_workers.pop_back();
+		return false;
+	}
+	return true;
+}
+
+void PthreadJobManager::joinThreads() {
+	for (uint i = 0; i < _workers.size(); i++)
+		pthread_join(_workers[i].thread, nullptr);
+	_workers.clear();
+}
+
+void *PthreadJobManager::threadProc(void *arg) {
+	Worker *worker = (Worker *)arg;
+	worker->manager->workerMain(worker->index);
+	return nullptr;
+}
+
+Common::JobManager *createPthreadJobManager(int workerCount) {
+	if (workerCount < 0) {
+		long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+		workerCount = (cpus > 1) ? (int)(cpus - 1) : 0;
+	}
+
+	if (workerCount == 0)
+		return new Common::JobManager();
+
+	return new PthreadJobManager(workerCount);
+}
+
+#endif
@@ -0,0 +1,128 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#if defined(SDL_BACKEND)
+
+#include "backends/jobs/sdl/sdl-jobs.h"
+#include "backends/jobs/threaded/threaded-jobs.h"
+#include "backends/platform/sdl/sdl-sys.h"
+
+/**
+ * SDL job manager
+ */
+class SdlJobManager final : public ThreadedJobManager {
+public:
+	explicit SdlJobManager(uint workerCount);
+	~SdlJobManager() override;
+
+protected:
+	bool createThread(uint index) override;
+	void joinThreads() override;
+	bool isCurrentThread(uint index) const override {
+		return index < _workers.size() && SDL_GetThreadID(_workers[index].thread) == SDL_ThreadID();
+	}
+
+	void lock() override { SDL_mutexP(_mutex); }
+	void unlock() override { SDL_mutexV(_mutex); }
+	void waitCondition() override { SDL_CondWait(_cond, _mutex); }
+	void broadcastCondition() override { SDL_CondBroadcast(_cond); }
+
+private:
+	struct Worker {
+		SdlJobManager *manager;
+		uint index;
+		SDL_Thread *thread;
+	};
+
+	static int SDLCALL threadProc(void *arg);
+
+	SDL_mutex *_mutex;
+	SDL_cond *_cond;
+	Common::Array<Worker> _workers;
+};
+
+SdlJobManager::SdlJobManager(uint workerCount) {
+	_mutex = SDL_CreateMutex();
+	_cond = SDL_CreateCond();
+
+	// Worker addresses are handed to the threads and must stay valid
+	_workers.reserve(workerCount);
+	startWorkers(workerCount);
+}
+
+SdlJobManager::~SdlJobManager() {
+	stopWorkers();
+
+	SDL_DestroyCond(_cond);
+	SDL_DestroyMutex(_mutex);
+}
+
+bool SdlJobManager::createThread(uint index) {
+	Worker worker;
+	worker.manager = this;
+	worker.index = index;
+	worker.thread = nullptr;
+	_workers.push_back(worker);
+
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+	_workers.back().thread = SDL_CreateThread(threadProc, "ScummVM worker", &_workers.back());
+#else
+	_workers.back().thread = SDL_CreateThread(threadProc, &_workers.back());
+#endif
+
+	if (!_workers.back().thread) {
+		_workers.pop_back();
+		return false;
+	}
+	return true;
+}
+
+void SdlJobManager::joinThreads() {
+	for (uint i = 0; i < _workers.size(); i++)
+		SDL_WaitThread(_workers[i].thread, nullptr);
+	_workers.clear();
+}
+
+int SDLCALL SdlJobManager::threadProc(void *arg) {
+	Worker *worker = (Worker *)arg;
+	worker->manager->workerMain(worker->index);
+	return 0;
+}
+
+Common::JobManager *createSdlJobManager(int workerCount) {
+	if (workerCount < 0) {
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+		int cpus = SDL_GetCPUCount();
+		workerCount = (cpus > 1) ? cpus - 1 : 0;
+#else
+		workerCount = 0;
+#endif
+	}
+
+	if (workerCount == 0)
+		return new Common::JobManager();
+
+	return new SdlJobManager(workerCount);
+}
+
+#endif
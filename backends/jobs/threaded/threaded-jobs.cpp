@@ -0,0 +1,153 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "backends/jobs/threaded/threaded-jobs.h"
+
+#include "common/textconsole.h"
+
+ThreadedJobManager::ThreadedJobManager() : _nextQueue(0), _queuedJobs(0), _quit(false) {
+}
+
+void ThreadedJobManager::startWorkers(uint count) {
+	_queues.resize(count);
+
+	for (uint i = 0; i < count; i++) {
+		if (!createThread(i)) {
+			warning("ThreadedJobManager: Could only start %u of %u worker threads", i, count);
+			lock();
+			_queues.resize(i);
+			unlock();
+			break;
+		}
+	}
+}
+
+void ThreadedJobManager::stopWorkers() {
+	lock();
+	_quit = true;
+	broadcastCondition();
+	unlock();
+
+	joinThreads();
+
+	// Jobs without a wait group may still be queued
+	lock();
+	Job job;
+	while (popJob(0, job))
+		runJob(job);
+	_queues.clear();
+	unlock();
+}
+
+uint ThreadedJobManager::getCurrentThread() const {
+	for (uint i = 0; i < _queues.size(); i++) {
+		if (isCurrentThread(i))
+			return i + 1;
+	}
+	return 0;
+}
+
+void ThreadedJobManager::submit(JobProc proc, void *data, Common::WaitGroup *group) {
+	if (_queues.empty()) {
+		proc(data);
+		return;
+	}
+
+	Job job;
+	job.proc = proc;
+	job.data = data;
+	job.group = group;
+
+	lock();
+	if (group)
+		pendingCount(*group)++;
+	_queues[_nextQueue].push_back(job);
+	_nextQueue = (_nextQueue + 1) % _queues.size();
+	_queuedJobs++;
+	broadcastCondition();
+	unlock();
+}
+
+void ThreadedJobManager::wait(Common::WaitGroup &group) {
+	lock();
+	while (pendingCount(group) > 0) {
+		Job job;
+		if (popJob(_nextQueue, job))
+			runJob(job);
+		else
+			waitCondition();
+	}
+	unlock();
+}
+
+bool ThreadedJobManager::isDone(Common::WaitGroup &group) {
+	lock();
+	bool done = (pendingCount(group) == 0);
+	unlock();
+	return done;
+}
+
+void ThreadedJobManager::workerMain(uint index) {
+	lock();
+	while (!_quit) {
+		Job job;
+		if (popJob(index, job))
+			runJob(job);
+		else
+			waitCondition();
+	}
+	unlock();
+}
+
+bool ThreadedJobManager::popJob(uint preferredQueue, Job &job) {
+	if (_queuedJobs == 0)
+		return false;
+
+	uint count = _queues.size();
+	JobQueue &own = _queues[preferredQueue % count];
+	if (!own.empty()) {
+		job = own.back();
+		own.pop_back();
+		_queuedJobs--;
+		return true;
+	}
+
+	for (uint i = 1; i < count; i++) {
+		JobQueue &victim = _queues[(preferredQueue + i) % count];
+		if (!victim.empty()) {
+			job = victim.front();
+			victim.pop_front();
+			_queuedJobs--;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void ThreadedJobManager::runJob(const Job &job) {
+	unlock();
+	job.proc(job.data);
+	lock();
+
+	if (job.group && --pendingCount(*job.group) == 0)
+		broadcastCondition();
+}
@@ -0,0 +1,97 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef BACKENDS_JOBS_THREADED_H
+#define BACKENDS_JOBS_THREADED_H
+
+#include "common/jobs.h"
+#include "common/array.h"
+#include "common/list.h"
+
+/**
+ * Job manager running jobs on a pool of worker threads.
+ *
+ * Every worker owns a queue. Submitted jobs are distributed over the
+ * queues round-robin, a worker takes the newest job of its own queue and
+ * steals the oldest job of another queue once its own is empty. Threads
+ * waiting for a wait group execute queued jobs as well, so nested waits
+ * cannot starve the pool.
+ *
+ * Subclasses supply the threading primitives: one lock, one condition
+ * and the worker threads. They must call startWorkers() from their
+ * constructor and stopWorkers() from their destructor.
+ */
+class ThreadedJobManager : public Common::JobManager {
+public:
+	uint getThreadCount() const override { return _queues.size() + 1; }
+	uint getCurrentThread() const override;
+
+	void submit(JobProc proc, void *data, Common::WaitGroup *group = nullptr) override;
+	void wait(Common::WaitGroup &group) override;
+	bool isDone(Common::WaitGroup &group) override;
+
+protected:
+	ThreadedJobManager();
+
+	/** Create @p count workers. */
+	void startWorkers(uint count);
+
+	/** Finish all queued jobs, then stop and join the workers. */
+	void stopWorkers();
+
+	/** Main loop of a worker thread. */
+	void workerMain(uint index);
+
+	/** Start a thread calling workerMain(index). */
+	virtual bool createThread(uint index) = 0;
+	/** Wait for all threads created by createThread() to exit. */
+	virtual void joinThreads() = 0;
+	/** Return true if the calling thread is the one created for @p index. */
+	virtual bool isCurrentThread(uint index) const = 0;
+
+	virtual void lock() = 0;
+	virtual void unlock() = 0;
+	/** Atomically release the lock, wait for a broadcast and reacquire it. */
+	virtual void waitCondition() = 0;
+	/** Wake all threads sleeping in waitCondition(). */
+	virtual void broadcastCondition() = 0;
+
+private:
+	struct Job {
+		JobProc proc;
+		void *data;
+		Common::WaitGroup *group;
+	};
+
+	typedef Common::List<Job> JobQueue;
+
+	/** Pop a job, preferring the given queue. Must be called locked. */
+	bool popJob(uint preferredQueue, Job &job);
+	/** Run a job, dropping the lock meanwhile. Must be called locked. */
+	void runJob(const Job &job);
+
+	Common::Array<JobQueue> _queues;
+	uint _nextQueue;
+	uint _queuedJobs;
+	bool _quit;
+};
+
+#endif
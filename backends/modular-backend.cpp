@@ -26,6 +26,7 @@
 #include "backends/mixer/mixer.h"
 #include "gui/EventRecorder.h"
 
+#include "common/profiler.h"
 #include "common/timer.h"
 #include "graphics/pixelformat.h"
 
@@ -158,15 +159,27 @@ PaletteManager *ModularGraphicsBackend::getPaletteManager() {
 }
 
 void ModularGraphicsBackend::copyRectToScreen(const void *buf, int pitch, int x, int y, int w, int h) {
+#ifdef ENABLE_EVENTRECORDER
+	g_eventRec.beginBlit();
+#endif
 	_graphicsManager->copyRectToScreen(buf, pitch, x, y, w, h);
+#ifdef ENABLE_EVENTRECORDER
+	g_eventRec.endBlit();
+#endif
 }
 
 Graphics::Surface *ModularGraphicsBackend::lockScreen() {
+#ifdef ENABLE_EVENTRECORDER
+	g_eventRec.beginBlit();
+#endif
 	return _graphicsManager->lockScreen();
 }
 
 void ModularGraphicsBackend::unlockScreen() {
 	_graphicsManager->unlockScreen();
+#ifdef ENABLE_EVENTRECORDER
+	g_eventRec.endBlit();
+#endif
 }
 
 void ModularGraphicsBackend::fillScreen(uint32 col) {
@@ -178,17 +191,23 @@ void ModularGraphicsBackend::fillScreen(const Common::Rect &r, uint32 col) {
 }
 
 void ModularGraphicsBackend::updateScreen() {
+	{
+		PROFILE_ZONE("OSystem::updateScreen");
+
 #ifdef ENABLE_EVENTRECORDER
-	g_system->getMillis();		// force event recorder to update the tick count
-	g_eventRec.processScreenUpdate();
-	g_eventRec.preDrawOverlayGui();
+		g_system->getMillis();		// force event recorder to update the tick count
+		g_eventRec.processScreenUpdate();
+		g_eventRec.preDrawOverlayGui();
 #endif
 
-	_graphicsManager->updateScreen();
+		_graphicsManager->updateScreen();
 
 #ifdef ENABLE_EVENTRECORDER
-	g_eventRec.postDrawOverlayGui();
+		g_eventRec.postDrawOverlayGui();
 #endif
+	}
+
+	PROFILE_FRAME();
 }
 
 void ModularGraphicsBackend::setShakePos(int shakeXOffset, int shakeYOffset) {
@@ -189,13 +189,17 @@ static const char HELP_STRING4[] =
 	"  --aspect-ratio           Enable aspect ratio correction\n"
 	"  --[no-]dirtyrects        Enable dirty rectangles optimisation in software renderer\n"
 	"                           (default: enabled)\n"
+	"  --[no-]dirty-checksums   Find the changed parts of the game screen by comparing it\n"
+	"                           with the previous frame (SDL surface only, default: disabled)\n"
 	"  --render-mode=MODE       Enable additional render modes (hercGreen, hercAmber,\n"
 	"                           cga, ega, vga, amiga, fmtowns, pc9821, pc9801, 2gs,\n"
 	"                           atari, macintosh, macintoshbw)\n"
 #ifdef ENABLE_EVENTRECORDER
 	"  --record-mode=MODE       Specify record mode for event recorder (record, playback,\n"
-	"                           info, update, passthrough [default])\n"
+	"                           benchmark, info, update, passthrough [default])\n"
 	"  --record-file-name=FILE  Specify record file name\n"
+	"  --benchmark-file=FILE    Specify the JSON report written by the benchmark record\n"
+	"                           mode (default: benchmark.json)\n"
 	"  --disable-display        Disable any gfx output. Used for headless events\n"
 	"                           playback by Event Recorder\n"
 	"  --screenshot-period=NUM  When recording, trigger a screenshot every NUM milliseconds\n"
@@ -301,6 +305,7 @@ void registerDefaults() {
 	ConfMan.registerDefault("shader", Common::Path("default", Common::Path::kNoSeparator));
 	ConfMan.registerDefault("show_fps", false);
 	ConfMan.registerDefault("dirtyrects", true);
+	ConfMan.registerDefault("dirty_checksums", false);
 	ConfMan.registerDefault("vsync", true);
 
 	// Sound & Music
@@ -326,6 +331,10 @@ void registerDefaults() {
 
 	ConfMan.registerDefault("cdrom", 0);
 
+	// Archives
+	ConfMan.registerDefault("archive_cache_size", 32768);
+	ConfMan.registerDefault("archive_prefetch", 0);
+
 	ConfMan.registerDefault("enable_unsupported_game_warning", true);
 
 #ifdef USE_FLUIDSYNTH
@@ -373,6 +382,7 @@ void registerDefaults() {
 	ConfMan.registerDefault("disable_display", false);
 	ConfMan.registerDefault("record_mode", "none");
 	ConfMan.registerDefault("record_file_name", "record.bin");
+	ConfMan.registerDefault("benchmark_file", "benchmark.json");
 
 	ConfMan.registerDefault("gui_saveload_chooser", "grid");
 	ConfMan.registerDefault("gui_saveload_last_pos", "0");
@@ -781,6 +791,9 @@ Common::String parseCommandLine(Common::StringMap &settings, int argc, const cha
 			DO_LONG_OPTION("record-file-name")
 			END_OPTION
 
+			DO_LONG_OPTION("benchmark-file")
+			END_OPTION
+
 			DO_LONG_COMMAND("list-records")
 			END_COMMAND
 
@@ -896,6 +909,9 @@ Common::String parseCommandLine(Common::StringMap &settings, int argc, const cha
 			DO_LONG_OPTION_BOOL("dirtyrects")
 			END_OPTION
 
+			DO_LONG_OPTION_BOOL("dirty-checksums")
+			END_OPTION
+
 			DO_LONG_OPTION("gamma")
 			END_OPTION
 
@@ -293,6 +293,11 @@ static Common::Error runGame(const Plugin *plugin, const Plugin *enginePlugin, O
 		}
 	}
 
+	// Set up the memory cache for members of compressed archives
+	Common::ArchiveContentsCache &archiveCache = Common::ArchiveContentsCache::instance();
+	archiveCache.setBudget(MAX(ConfMan.getInt("archive_cache_size"), 0) * 1024);
+	archiveCache.setPrefetchCount(MAX(ConfMan.getInt("archive_prefetch"), 0));
+
 #ifdef USE_TRANSLATION
 	Common::String previousLanguage = TransMan.getCurrentLanguage();
 	if (ConfMan.hasKey("gui_use_game_language")
@@ -791,6 +796,9 @@ extern "C" int scummvm_main(int argc, const char * const argv[]) {
 				g_eventRec.init(recordFileName, GUI::EventRecorder::kRecorderUpdate);
 			} else if (recordMode == "playback") {
 				g_eventRec.init(recordFileName, GUI::EventRecorder::kRecorderPlayback);
+			} else if (recordMode == "benchmark") {
+				g_eventRec.init(recordFileName, GUI::EventRecorder::kRecorderPlayback);
+				g_eventRec.startBenchmark(ConfMan.get("benchmark_file"));
 			} else if ((recordMode == "info") && (!recordFileName.empty())) {
 				Common::PlaybackFile record;
 				record.openRead(recordFileName);
@@ -907,6 +915,7 @@ extern "C" int scummvm_main(int argc, const char * const argv[]) {
 	GUI::EventRecorder::destroy();
 #endif
 	Common::SearchManager::destroy();
+	Common::ArchiveContentsCache::destroy();
 #ifdef USE_TRANSLATION
 	Common::MainTranslationManager::destroy();
 #endif
@@ -22,6 +22,8 @@
 #include "common/archive.h"
 #include "common/file.h"
 #include "common/fs.h"
+#include "common/jobs.h"
+#include "common/mutex.h"
 #include "common/system.h"
 #include "common/textconsole.h"
 #include "common/memstream.h"
@@ -176,6 +178,17 @@ char Archive::getPathSeparator() const {
 	return '/';
 }
 
+MemcachingCaseInsensitiveArchive::MemcachingCaseInsensitiveArchive(uint32 maxStronglyCachedSize)
+	: _maxStronglyCachedSize(maxStronglyCachedSize), _readMutex(nullptr), _prefetchGroup(nullptr), _prefetchOrderValid(false) {
+}
+
+MemcachingCaseInsensitiveArchive::~MemcachingCaseInsensitiveArchive() {
+	clearCache();
+
+	delete _prefetchGroup;
+	delete _readMutex;
+}
+
 SeekableReadStream *MemcachingCaseInsensitiveArchive::createReadStreamForMember(const Path &path) const {
 	return createReadStreamForMemberImpl(path, false, Common::AltStreamType::Invalid);
 }
@@ -195,54 +208,283 @@ SeekableReadStream *MemcachingCaseInsensitiveArchive::createReadStreamForMemberI
 	cacheKey.path = translatePath(path);
 	cacheKey.altStreamType = isAltStream ? altStreamType : AltStreamType::Invalid;
 
-	bool isNew = false;
-	if (!_cache.contains(cacheKey)) {
-		SharedArchiveContents readResult = isAltStream ? readContentsForPathAltStream(cacheKey.path, altStreamType) : readContentsForPath(cacheKey.path);
+	ArchiveContentsCache &cache = ArchiveContentsCache::instance();
+	SeekableReadStream *stream = nullptr;
+
+	bool cached;
+	{
+		StackLock lock(*cache._mutex);
+		cached = openCachedMember(cacheKey, stream);
+	}
+
+	if (!cached) {
+		// Either a new entry, or the WeakPtr of an old one has expired.
+		// Extracting may take a while, so do it without holding the lock.
+		SharedArchiveContents readResult = readContents(cacheKey);
 		if (readResult._bypass)
 			return readResult._bypass;
-		_cache[cacheKey] = readResult;
-		isNew = true;
+
+		StackLock lock(*cache._mutex);
+		cache._stats.misses++;
+
+		CacheEntry &entry = storeContents(cacheKey, readResult);
+
+		// Errors and missing files. Just return nullptr,
+		// no need to create stream.
+		if (!entry.contents.isFileMissing()) {
+			// It's possible that another thread extracted this member
+			// meanwhile, but both copies are identical.
+			stream = new Common::MemoryReadStream(readResult.getContents(), readResult.getSize());
+		}
+
+		cache.evict(cache._budget);
 	}
 
-	SharedArchiveContents* entry = &_cache[cacheKey];
+	if (!isAltStream && stream)
+		schedulePrefetch(cacheKey.path);
 
-	// Errors and missing files. Just return nullptr,
-	// no need to create stream.
-	if (entry->isFileMissing())
-		return nullptr;
+	return stream;
+}
+
+SharedArchiveContents MemcachingCaseInsensitiveArchive::readContents(const CacheKey &key) const {
+	if (_readMutex) {
+		StackLock lock(*_readMutex);
+		return (key.altStreamType != AltStreamType::Invalid) ? readContentsForPathAltStream(key.path, key.altStreamType) : readContentsForPath(key.path);
+	}
+
+	return (key.altStreamType != AltStreamType::Invalid) ? readContentsForPathAltStream(key.path, key.altStreamType) : readContentsForPath(key.path);
+}
+
+bool MemcachingCaseInsensitiveArchive::openCachedMember(const CacheKey &key, SeekableReadStream *&stream) const {
+	ArchiveContentsCache &cache = ArchiveContentsCache::instance();
+
+	CacheMap::iterator it = _cache.find(key);
+	if (it == _cache.end())
+		return false;
+
+	CacheEntry &entry = it->_value;
+	if (entry.contents.isFileMissing()) {
+		cache._stats.hits++;
+		stream = nullptr;
+		return true;
+	}
 
 	// Check whether the entry is still valid as WeakPtr might have expired.
-	if (!entry->makeStrong()) {
-		// If it's expired, recreate the entry.
-		SharedArchiveContents readResult = isAltStream ? readContentsForPathAltStream(cacheKey.path, altStreamType) : readContentsForPath(cacheKey.path);
-		if (readResult._bypass)
-			return readResult._bypass;
-		_cache[cacheKey] = readResult;
-		entry = &_cache[cacheKey];
-		isNew = true;
+	if (!entry.contents.makeStrong())
+		return false;
+
+	cache._stats.hits++;
+	stream = new Common::MemoryReadStream(entry.contents.getContents(), entry.contents.getSize());
+
+	if (entry.inBudget) {
+		// Mark as most recently used
+		cache._entries.insert(cache._entries.begin(), *entry.budgetNode);
+		cache._entries.erase(entry.budgetNode);
+		entry.budgetNode = cache._entries.begin();
+	} else if (entry.contents.getSize() > _maxStronglyCachedSize) {
+		// An evicted member which was still open, put it back
+		ArchiveContentsCache::Entry budgetEntry;
+		budgetEntry.archive = this;
+		budgetEntry.path = key.path;
+		budgetEntry.altStreamType = key.altStreamType;
+		budgetEntry.contents = entry.contents.getContents();
+		budgetEntry.size = entry.contents.getSize();
+		cache._entries.push_front(budgetEntry);
+		cache._stats.usedBytes += budgetEntry.size;
+		entry.inBudget = true;
+		entry.budgetNode = cache._entries.begin();
+		cache.evict(cache._budget);
 	}
 
-	// It's possible that recreation failed in case of e.g. network
-	// share going offline.
-	if (entry->isFileMissing())
-		return nullptr;
+	// Only the budget and open streams keep big members alive
+	if (entry.contents.getSize() > _maxStronglyCachedSize)
+		entry.contents.makeWeak();
 
-	// Now we have a valid contents reference. Make stream for it.
-	Common::MemoryReadStream *memStream = new Common::MemoryReadStream(entry->getContents(), entry->getSize());
+	return true;
+}
 
-	// If the entry was just created and it's too big for strong caching,
-	// mark the copy in cache as weak
-	if (isNew && entry->getSize() > _maxStronglyCachedSize) {
-		entry->makeWeak();
+MemcachingCaseInsensitiveArchive::CacheEntry &MemcachingCaseInsensitiveArchive::storeContents(const CacheKey &key, const SharedArchiveContents &contents) const {
+	ArchiveContentsCache &cache = ArchiveContentsCache::instance();
+
+	CacheEntry &entry = _cache[key];
+	if (entry.inBudget) {
+		cache._stats.usedBytes -= entry.budgetNode->size;
+		cache._entries.erase(entry.budgetNode);
+		entry.inBudget = false;
 	}
 
-	return memStream;
+	entry.contents = contents;
+	if (contents.isFileMissing() || contents.getSize() <= _maxStronglyCachedSize)
+		return entry;
+
+	ArchiveContentsCache::Entry budgetEntry;
+	budgetEntry.archive = this;
+	budgetEntry.path = key.path;
+	budgetEntry.altStreamType = key.altStreamType;
+	budgetEntry.contents = contents.getContents();
+	budgetEntry.size = contents.getSize();
+	cache._entries.push_front(budgetEntry);
+	cache._stats.usedBytes += budgetEntry.size;
+	entry.inBudget = true;
+	entry.budgetNode = cache._entries.begin();
+
+	entry.contents.makeWeak();
+	return entry;
 }
 
 SharedArchiveContents MemcachingCaseInsensitiveArchive::readContentsForPathAltStream(const Path &translatedPath, AltStreamType altStreamType) const {
 	return SharedArchiveContents();
 }
 
+void MemcachingCaseInsensitiveArchive::enablePrefetch() {
+	if (!_readMutex)
+		_readMutex = new Mutex();
+	if (!_prefetchGroup)
+		_prefetchGroup = new WaitGroup();
+}
+
+void MemcachingCaseInsensitiveArchive::waitForPrefetch() const {
+	if (!_prefetchGroup)
+		return;
+
+	JobManager *jobs = g_system->getJobManager();
+	if (jobs)
+		jobs->wait(*_prefetchGroup);
+}
+
+void MemcachingCaseInsensitiveArchive::clearCache() {
+	waitForPrefetch();
+
+	// Nothing was ever cached without the cache instance
+	if (ArchiveContentsCache::hasInstance()) {
+		ArchiveContentsCache &cache = ArchiveContentsCache::instance();
+		StackLock lock(*cache._mutex);
+
+		ArchiveContentsCache::EntryList::iterator it = cache._entries.begin();
+		while (it != cache._entries.end()) {
+			if (it->archive == this) {
+				cache._stats.usedBytes -= it->size;
+				it = cache._entries.erase(it);
+			} else {
+				++it;
+			}
+		}
+
+		_cache.clear();
+	}
+
+	_prefetchOrderValid = false;
+	_prefetchOrder.clear();
+	_prefetchQueued.clear();
+	_prefetchIndex.clear();
+}
+
+void MemcachingCaseInsensitiveArchive::getPrefetchOrder(Array<Path> &paths) const {
+	ArchiveMemberList members;
+	listMembers(members);
+
+	for (ArchiveMemberList::const_iterator it = members.begin(); it != members.end(); ++it)
+		paths.push_back(translatePath((*it)->getPathInArchive()));
+}
+
+namespace {
+
+struct PrefetchJob {
+	const MemcachingCaseInsensitiveArchive *archive;
+	uint index;
+};
+
+} // End of anonymous namespace
+
+void MemcachingCaseInsensitiveArchive::schedulePrefetch(const Path &path) const {
+	if (!_prefetchGroup)
+		return;
+
+	ArchiveContentsCache &cache = ArchiveContentsCache::instance();
+	const uint count = cache.getPrefetchCount();
+	if (count == 0)
+		return;
+
+	// Extracting the members inline would only delay the caller
+	JobManager *jobs = g_system->getJobManager();
+	if (!jobs || jobs->getThreadCount() <= 1)
+		return;
+
+	if (!_prefetchOrderValid) {
+		getPrefetchOrder(_prefetchOrder);
+		_prefetchQueued.resize(_prefetchOrder.size());
+		for (uint i = 0; i < _prefetchOrder.size(); i++) {
+			_prefetchIndex[_prefetchOrder[i]] = i;
+			_prefetchQueued[i] = false;
+		}
+		_prefetchOrderValid = true;
+	}
+
+	uint index;
+	if (!_prefetchIndex.tryGetVal(path, index))
+		return;
+
+	StackLock lock(*cache._mutex);
+
+	const uint end = MIN<uint>(index + 1 + count, _prefetchOrder.size());
+	for (uint i = index + 1; i < end; i++) {
+		if (_prefetchQueued[i])
+			continue;
+
+		CacheKey key;
+		key.path = _prefetchOrder[i];
+		if (_cache.contains(key))
+			continue;
+
+		_prefetchQueued[i] = true;
+
+		PrefetchJob *job = new PrefetchJob();
+		job->archive = this;
+		job->index = i;
+		jobs->submit(&runPrefetchJob, job, _prefetchGroup);
+	}
+}
+
+void MemcachingCaseInsensitiveArchive::runPrefetchJob(void *data) {
+	PrefetchJob *job = (PrefetchJob *)data;
+	job->archive->prefetchMember(job->index);
+	delete job;
+}
+
+void MemcachingCaseInsensitiveArchive::prefetchMember(uint index) const {
+	// Runs on a worker thread. Common::String and SharedPtr are not thread
+	// safe, so paths and contents shared with the caller's thread may only
+	// be copied or released while holding the cache lock.
+	ArchiveContentsCache &cache = ArchiveContentsCache::instance();
+	const Path &path = _prefetchOrder[index];
+
+	SharedArchiveContents contents;
+	{
+		StackLock readLock(*_readMutex);
+		contents = readContentsForPath(path);
+	}
+
+	StackLock lock(*cache._mutex);
+	_prefetchQueued[index] = false;
+
+	if (contents._bypass) {
+		delete contents._bypass;
+		return;
+	}
+
+	CacheKey key;
+	key.path = path;
+
+	// Leave entries created meanwhile alone, the caller's thread may be
+	// using them. Eviction happens on the next regular read.
+	if (!contents.isFileMissing() && !_cache.contains(key)) {
+		storeContents(key, contents);
+		cache._stats.prefetches++;
+	}
+
+	contents = SharedArchiveContents();
+}
+
 MemcachingCaseInsensitiveArchive::CacheKey::CacheKey() : altStreamType(AltStreamType::Invalid) {
 }
 
@@ -254,6 +496,60 @@ uint MemcachingCaseInsensitiveArchive::CacheKey_Hash::operator()(const CacheKey
 	return static_cast<uint>(x.path.hashIgnoreCase() * 1000003u) ^ static_cast<uint>(x.altStreamType);
 };
 
+ArchiveContentsCache::ArchiveContentsCache() : _mutex(new Mutex()), _budget(32 * 1024 * 1024), _prefetchCount(0) {
+	resetStats();
+}
+
+ArchiveContentsCache::~ArchiveContentsCache() {
+	flush();
+	delete _mutex;
+}
+
+void ArchiveContentsCache::setBudget(uint32 bytes) {
+	StackLock lock(*_mutex);
+	_budget = bytes;
+	evict(_budget);
+}
+
+ArchiveContentsCache::Stats ArchiveContentsCache::getStats() const {
+	StackLock lock(*_mutex);
+	return _stats;
+}
+
+void ArchiveContentsCache::resetStats() {
+	StackLock lock(*_mutex);
+	const uint32 usedBytes = _stats.usedBytes;
+	memset(&_stats, 0, sizeof(_stats));
+	_stats.usedBytes = usedBytes;
+}
+
+void ArchiveContentsCache::flush() {
+	StackLock lock(*_mutex);
+	evict(0);
+}
+
+void ArchiveContentsCache::evict(uint32 budget) {
+	while (_stats.usedBytes > budget && !_entries.empty()) {
+		EntryList::iterator it = _entries.end();
+		--it;
+		removeEntry(it);
+		_stats.evictions++;
+	}
+}
+
+void ArchiveContentsCache::removeEntry(EntryList::iterator it) {
+	MemcachingCaseInsensitiveArchive::CacheKey key;
+	key.path = it->path;
+	key.altStreamType = it->altStreamType;
+
+	MemcachingCaseInsensitiveArchive::CacheMap::iterator cacheIt = it->archive->_cache.find(key);
+	if (cacheIt != it->archive->_cache.end())
+		cacheIt->_value.inBudget = false;
+
+	_stats.usedBytes -= it->size;
+	_entries.erase(it);
+}
+
 SearchSet::ArchiveNodeList::iterator SearchSet::find(const String &name) {
 	ArchiveNodeList::iterator it = _list.begin();
 	for (; it != _list.end(); ++it) {
@@ -284,6 +580,97 @@ void SearchSet::insert(const Node &node) {
 			break;
 	}
 	_list.insert(it, node);
+
+	if (dynamic_cast<SearchSet *>(node._arc))
+		_nestedSets++;
+
+	if (!_indexMutex)
+		return;
+
+	// The new archive is searched before all archives with a lower
+	// priority, so it may hide their files or provide missing ones.
+	StackLock lock(*_indexMutex);
+	if (!_index.empty()) {
+		Array<Path> stale;
+		for (PathIndex::const_iterator i = _index.begin(); i != _index.end(); ++i) {
+			if (i->_value == _list.end() || i->_value->_priority < node._priority)
+				stale.push_back(i->_key);
+		}
+		for (uint i = 0; i < stale.size(); i++)
+			_index.erase(stale[i]);
+	}
+}
+
+void SearchSet::removeFromIndex(ArchiveNodeList::const_iterator node) {
+	if (dynamic_cast<SearchSet *>(node->_arc))
+		_nestedSets--;
+
+	if (!_indexMutex)
+		return;
+
+	StackLock lock(*_indexMutex);
+	if (_index.empty())
+		return;
+
+	// Lookups which did not find the file in this archive are unaffected
+	Array<Path> stale;
+	for (PathIndex::const_iterator i = _index.begin(); i != _index.end(); ++i) {
+		if (i->_value == node)
+			stale.push_back(i->_key);
+	}
+	for (uint i = 0; i < stale.size(); i++)
+		_index.erase(stale[i]);
+}
+
+SearchSet::ArchiveNodeList::const_iterator SearchSet::findFile(const Path &path) const {
+	const bool indexed = isIndexed();
+	if (indexed) {
+		StackLock lock(*_indexMutex);
+		PathIndex::iterator entry = _index.find(path);
+		if (entry != _index.end()) {
+			// Files may have been deleted meanwhile, so check the hit
+			if (entry->_value == _list.end() || entry->_value->_arc->hasFile(path))
+				return entry->_value;
+			_index.erase(entry);
+		}
+	}
+
+	// The archives are asked without holding the lock, other threads may
+	// add the same result meanwhile
+	ArchiveNodeList::const_iterator it = _list.begin();
+	for (; it != _list.end(); ++it) {
+		if (it->_arc->hasFile(path))
+			break;
+	}
+
+	if (indexed) {
+		StackLock lock(*_indexMutex);
+		// Engines probing for lots of different names should not make the
+		// index grow without bounds
+		if (_index.size() >= 16384)
+			_index.clear();
+		// Copies of a path share its string, whose reference count is not
+		// atomic, so the index keeps a copy of its own
+		_index[path.unshare()] = it;
+	}
+
+	return it;
+}
+
+void SearchSet::setUseIndex(bool useIndex) {
+	if (useIndex && !_indexMutex)
+		_indexMutex = new Mutex();
+
+	_useIndex = useIndex;
+	invalidateIndex();
+}
+
+void SearchSet::invalidateIndex() {
+	if (!_indexMutex)
+		return;
+
+	StackLock lock(*_indexMutex);
+	_index.clear();
 }
 
 void SearchSet::add(const String &name, Archive *archive, int priority, bool autoFree) {
@@ -371,6 +758,7 @@ void SearchSet::addSubDirectoriesMatching(const FSNode &directory, String origPa
 void SearchSet::remove(const String &name) {
 	ArchiveNodeList::iterator it = find(name);
 	if (it != _list.end()) {
+		removeFromIndex(it);
 		if (it->_autoFree)
 			delete it->_arc;
 		_list.erase(it);
@@ -397,6 +785,8 @@ void SearchSet::clear() {
 	}
 
 	_list.clear();
+	_nestedSets = 0;
+	invalidateIndex();
 }
 
 void SearchSet::setPriority(const String &name, int priority) {
@@ -410,6 +800,7 @@ void SearchSet::setPriority(const String &name, int priority) {
 		return;
 
 	Node node(*it);
+	removeFromIndex(it);
 	_list.erase(it);
 	node._priority = priority;
 	insert(node);
@@ -419,13 +810,7 @@ bool SearchSet::hasFile(const Path &path) const {
 	if (path.empty())
 		return false;
 
-	ArchiveNodeList::const_iterator it = _list.begin();
-	for (; it != _list.end(); ++it) {
-		if (it->_arc->hasFile(path))
-			return true;
-	}
-
-	return false;
+	return findFile(path) != _list.end();
 }
 
 bool SearchSet::isPathDirectory(const Path &path) const {
@@ -489,17 +874,14 @@ const ArchiveMemberPtr SearchSet::getMember(const Path &path, Archive **containe
 	if (path.empty())
 		return ArchiveMemberPtr();
 
-	ArchiveNodeList::const_iterator it = _list.begin();
-	for (; it != _list.end(); ++it) {
-		if (it->_arc->hasFile(path)) {
-			if (container) {
-				*container = it->_arc;
-			}
-			return it->_arc->getMember(path);
-		}
-	}
+	ArchiveNodeList::const_iterator it = findFile(path);
+	if (it == _list.end())
+		return ArchiveMemberPtr();
 
-	return ArchiveMemberPtr();
+	if (container) {
+		*container = it->_arc;
+	}
+	return it->_arc->getMember(path);
 }
 
 const ArchiveMemberPtr SearchSet::getMember(const Path &path) const {
@@ -510,7 +892,9 @@ SeekableReadStream *SearchSet::createReadStreamForMember(const Path &path) const
 	if (path.empty())
 		return nullptr;
 
-	ArchiveNodeList::const_iterator it = _list.begin();
+	// With the index, archives before the first one having the file are
+	// skipped, and a miss is not searched for again
+	ArchiveNodeList::const_iterator it = isIndexed() ? findFile(path) : _list.begin();
 	for (; it != _list.end(); ++it) {
 		SeekableReadStream *stream = it->_arc->createReadStreamForMember(path);
 		if (stream)
@@ -554,6 +938,9 @@ SeekableReadStream *SearchSet::createReadStreamForMemberNext(const Path &path, c
 }
 
 SearchManager::SearchManager() {
+	// Engines look up the same files over and over
+	if (g_system)
+		setUseIndex(true);
 	clear(); // Force a reset
 }
 
@@ -575,5 +962,6 @@ void SearchManager::clear() {
 }
 
 DECLARE_SINGLETON(SearchManager);
+DECLARE_SINGLETON(ArchiveContentsCache);
 
 } // namespace Common
@@ -22,10 +22,12 @@
 #ifndef COMMON_ARCHIVE_H
 #define COMMON_ARCHIVE_H
 
+#include "common/array.h"
 #include "common/error.h"
 #include "common/hashmap.h"
 #include "common/hash-str.h"
 #include "common/list.h"
+#include "common/mutex.h"
 #include "common/path.h"
 #include "common/ptr.h"
 #include "common/singleton.h"
@@ -45,7 +47,9 @@ namespace Common {
 
 class ArchiveMember;
 class FSNode;
+class Mutex;
 class SeekableReadStream;
+class WaitGroup;
 
 enum class AltStreamType {
 	Invalid,
@@ -263,12 +267,82 @@ private:
 	friend class MemcachingCaseInsensitiveArchive;
 };
 
+/**
+ * Memory budget shared by all MemcachingCaseInsensitiveArchive instances.
+ *
+ * Extracted members bigger than the strong caching limit of their archive
+ * are kept in memory until the total size of these members exceeds the
+ * budget. The least recently used members are dropped first. A dropped
+ * member stays in memory while a stream still uses it.
+ *
+ * Archives which support it may also extract the members following an
+ * opened one on the worker threads of the job manager.
+ */
+class ArchiveContentsCache : public Singleton<ArchiveContentsCache> {
+public:
+	struct Stats {
+		uint32 hits;       ///< Members served from memory.
+		uint32 misses;     ///< Members which had to be extracted.
+		uint32 prefetches; ///< Members extracted ahead of time.
+		uint32 evictions;  ///< Members dropped to stay within the budget.
+		uint32 usedBytes;  ///< Total size of the members held by the cache.
+	};
+
+	~ArchiveContentsCache();
+
+	/** Set the maximum number of bytes to keep, dropping members if needed. */
+	void setBudget(uint32 bytes);
+	uint32 getBudget() const { return _budget; }
+
+	/** Set how many of the following members to extract when opening one. 0 disables prefetching. */
+	void setPrefetchCount(uint count) { _prefetchCount = count; }
+	uint getPrefetchCount() const { return _prefetchCount; }
+
+	Stats getStats() const;
+	void resetStats();
+
+	/** Drop all cached members. */
+	void flush();
+
+private:
+	friend class Singleton<SingletonBaseType>;
+	friend class MemcachingCaseInsensitiveArchive;
+
+	ArchiveContentsCache();
+
+	struct Entry {
+		const MemcachingCaseInsensitiveArchive *archive;
+		Path path;
+		AltStreamType altStreamType;
+		SharedPtr<byte> contents;
+		uint32 size;
+	};
+
+	typedef List<Entry> EntryList;
+
+	/** Drop the least recently used members until at most @p budget bytes are used. Must be called locked. */
+	void evict(uint32 budget);
+	/** Must be called locked. */
+	void removeEntry(EntryList::iterator it);
+
+	Mutex *_mutex;
+	EntryList _entries; ///< Most recently used first.
+	uint32 _budget;
+	uint _prefetchCount;
+	Stats _stats;
+};
+
 /**
  * An archive that caches the resulting contents.
+ *
+ * Members up to the given size stay in memory for the lifetime of the
+ * archive, bigger ones are kept within the budget of ArchiveContentsCache.
  */
 class MemcachingCaseInsensitiveArchive : public Archive {
 public:
-	MemcachingCaseInsensitiveArchive(uint32 maxStronglyCachedSize = 512) : _maxStronglyCachedSize(maxStronglyCachedSize) {}
+	MemcachingCaseInsensitiveArchive(uint32 maxStronglyCachedSize = 512);
+	~MemcachingCaseInsensitiveArchive();
+
 	SeekableReadStream *createReadStreamForMember(const Path &path) const;
 	SeekableReadStream *createReadStreamForMemberAltStream(const Path &path, Common::AltStreamType altStreamType) const;
 
@@ -279,7 +353,38 @@ public:
 	virtual SharedArchiveContents readContentsForPath(const Path &translatedPath) const = 0;
 	virtual SharedArchiveContents readContentsForPathAltStream(const Path &translatedPath, AltStreamType altStreamType) const;
 
+protected:
+	/**
+	 * Allow extracting members on worker threads ahead of time.
+	 *
+	 * readContentsForPath() may then be called from another thread, though
+	 * never concurrently with itself or readContentsForPathAltStream().
+	 * It must not use anything but the archive's own data. Subclasses must
+	 * call clearCache() or waitForPrefetch() before closing the underlying
+	 * stream.
+	 */
+	void enablePrefetch();
+
+	/** Wait for all members being extracted ahead of time. */
+	void waitForPrefetch() const;
+
+	/**
+	 * Forget all cached members and the prefetch order, for subclasses
+	 * which close or reopen their underlying stream. Waits for the members
+	 * being extracted ahead of time first.
+	 */
+	void clearCache();
+
+	/**
+	 * Return the translated paths of the members in the order they are
+	 * likely to be read, usually their order in the archive. The default
+	 * uses listMembers().
+	 */
+	virtual void getPrefetchOrder(Array<Path> &paths) const;
+
 private:
+	friend class ArchiveContentsCache;
+
 	struct CacheKey {
 		CacheKey();
 
@@ -295,10 +400,39 @@ private:
 		uint operator()(const CacheKey &x) const;
 	};
 
+	struct CacheEntry {
+		CacheEntry() : inBudget(false) {}
+
+		SharedArchiveContents contents;
+		bool inBudget; ///< True if ArchiveContentsCache holds a strong reference.
+		ArchiveContentsCache::EntryList::iterator budgetNode;
+	};
+
+	typedef HashMap<CacheKey, CacheEntry, CacheKey_Hash, CacheKey_EqualTo> CacheMap;
+
 	SeekableReadStream *createReadStreamForMemberImpl(const Path &path, bool isAltStream, Common::AltStreamType altStreamType) const;
 
-	mutable HashMap<CacheKey, SharedArchiveContents, CacheKey_Hash, CacheKey_EqualTo> _cache;
+	SharedArchiveContents readContents(const CacheKey &key) const;
+	/** Open a stream for a cached member. Returns false if it must be extracted. Must be called locked. */
+	bool openCachedMember(const CacheKey &key, SeekableReadStream *&stream) const;
+	/** Cache freshly extracted contents. Must be called locked. */
+	CacheEntry &storeContents(const CacheKey &key, const SharedArchiveContents &contents) const;
+
+	void schedulePrefetch(const Path &path) const;
+	static void runPrefetchJob(void *data);
+	void prefetchMember(uint index) const;
+
+	// All of these are guarded by the mutex of ArchiveContentsCache
+	mutable CacheMap _cache;
 	uint32 _maxStronglyCachedSize;
+
+	// Prefetching state, only allocated by enablePrefetch()
+	Mutex *_readMutex;
+	WaitGroup *_prefetchGroup;
+	mutable bool _prefetchOrderValid;
+	mutable Array<Path> _prefetchOrder;
+	mutable Array<bool> _prefetchQueued;
+	mutable HashMap<Path, uint, Path::IgnoreCase_Hash, Path::IgnoreCase_EqualTo> _prefetchIndex;
 };
 
 /**
@@ -329,9 +463,38 @@ class SearchSet : public Archive {
 
 	bool _ignoreClashes;
 
+	/**
+	 * Results of earlier lookups: the first archive which has a file, or
+	 * the end of the list if no archive has it. Entries are dropped when
+	 * archives are added or removed in a way which may change the result.
+	 *
+	 * Lookups are const and may run on several threads, so the index is
+	 * only accessed with _indexMutex held.
+	 */
+	typedef HashMap<Path, ArchiveNodeList::const_iterator, Path::Hash, Path::EqualTo> PathIndex;
+	mutable PathIndex _index;
+	bool _useIndex;
+	Mutex *_indexMutex;
+	/**
+	 * Member archives which are search sets themselves. Their content
+	 * changes without this set noticing, so the index is not used while
+	 * there are any.
+	 */
+	uint _nestedSets;
+
+	/**
+	 * Return the first archive which has the given file, or the end of the
+	 * list.
+	 */
+	ArchiveNodeList::const_iterator findFile(const Path &path) const;
+	/** Drop the lookups answered by the given archive. */
+	void removeFromIndex(ArchiveNodeList::const_iterator node);
+	/** Whether lookups go through the index. */
+	bool isIndexed() const { return _useIndex && _nestedSets == 0; }
+
 public:
-	SearchSet() : _ignoreClashes(false) { }
-	virtual ~SearchSet() { clear(); }
+	SearchSet() : _ignoreClashes(false), _useIndex(false), _indexMutex(nullptr), _nestedSets(0) { }
+	virtual ~SearchSet() { clear(); delete _indexMutex; }
 
 	/**
 	 * Add a new archive to the searchable set.
@@ -455,6 +618,21 @@ public:
 	 * in @ref FSDirectory documentation.
 	 */
 	void setIgnoreClashes(bool ignoreClashes) { _ignoreClashes = ignoreClashes; }
+
+	/**
+	 * Remember which archive contains a file, so that looking it up again
+	 * does not need to query every archive. This is off by default, except
+	 * for SearchMan.
+	 *
+	 * This assumes that the member archives do not gain files after they
+	 * have been queried. Call invalidateIndex() if they do. Files which an
+	 * archive does not report in hasFile() are not found either. The index
+	 * is not used while the set contains other search sets.
+	 */
+	void setUseIndex(bool useIndex);
+
+	/** Forget all remembered lookups. */
+	void invalidateIndex();
 };
 
 
@@ -0,0 +1,168 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef COMMON_ATOMIC_H
+#define COMMON_ATOMIC_H
+
+#include "common/scummsys.h"
+#include "common/noncopyable.h"
+
+#if !defined(__GNUC__)
+#include <atomic>
+#endif
+
+namespace Common {
+
+/**
+ * @defgroup common_atomic Atomic variables
+ * @ingroup common
+ *
+ * @brief API for sharing single values between threads without a mutex.
+ *
+ * Only use this for small integral values and pointers. Anything bigger
+ * should be protected by a Common::Mutex.
+ *
+ * @{
+ */
+
+/** Memory ordering of an atomic operation, see the C++11 memory model. */
+enum MemoryOrder {
+	kMemoryOrderRelaxed,
+	kMemoryOrderAcquire,
+	kMemoryOrderRelease,
+	kMemoryOrderSeqCst
+};
+
+#if defined(__GNUC__)
+
+namespace Internal {
+inline int toGccMemoryOrder(MemoryOrder order) {
+	switch (order) {
+	case kMemoryOrderRelaxed:
+		return __ATOMIC_RELAXED;
+	case kMemoryOrderAcquire:
+		return __ATOMIC_ACQUIRE;
+	case kMemoryOrderRelease:
+		return __ATOMIC_RELEASE;
+	default:
+		return __ATOMIC_SEQ_CST;
+	}
+}
+} // End of namespace Internal
+
+/**
+ * Integral value or pointer which can be read and written concurrently.
+ */
+template<class T>
+class Atomic : NonCopyable {
+public:
+	Atomic() : _value() {}
+	explicit Atomic(T value) : _value(value) {}
+
+	T load(MemoryOrder order = kMemoryOrderSeqCst) const {
+		return __atomic_load_n(&_value, Internal::toGccMemoryOrder(order));
+	}
+
+	void store(T value, MemoryOrder order = kMemoryOrderSeqCst) {
+		__atomic_store_n(&_value, value, Internal::toGccMemoryOrder(order));
+	}
+
+	/** Add @p value and return the previous value. */
+	T fetchAdd(T value, MemoryOrder order = kMemoryOrderSeqCst) {
+		return __atomic_fetch_add(&_value, value, Internal::toGccMemoryOrder(order));
+	}
+
+	/**
+	 * Store @p desired if the value is @p expected. Otherwise, load the
+	 * current value into @p expected.
+	 *
+	 * @return true if @p desired was stored.
+	 */
+	bool compareExchange(T &expected, T desired, MemoryOrder order = kMemoryOrderSeqCst) {
+		// A failed exchange only loads, which cannot have release semantics
+		const MemoryOrder failureOrder = (order == kMemoryOrderRelease) ? kMemoryOrderRelaxed : order;
+		return __atomic_compare_exchange_n(&_value, &expected, desired, false,
+			Internal::toGccMemoryOrder(order), Internal::toGccMemoryOrder(failureOrder));
+	}
+
+private:
+	T _value;
+};
+
+/** Order memory accesses around this point without touching a variable. */
+inline void atomicThreadFence(MemoryOrder order) {
+	__atomic_thread_fence(Internal::toGccMemoryOrder(order));
+}
+
+#else
+
+namespace Internal {
+inline std::memory_order toStdMemoryOrder(MemoryOrder order) {
+	switch (order) {
+	case kMemoryOrderRelaxed:
+		return std::memory_order_relaxed;
+	case kMemoryOrderAcquire:
+		return std::memory_order_acquire;
+	case kMemoryOrderRelease:
+		return std::memory_order_release;
+	default:
+		return std::memory_order_seq_cst;
+	}
+}
+} // End of namespace Internal
+
+template<class T>
+class Atomic : NonCopyable {
+public:
+	Atomic() : _value(T()) {}
+	explicit Atomic(T value) : _value(value) {}
+
+	T load(MemoryOrder order = kMemoryOrderSeqCst) const {
+		return _value.load(Internal::toStdMemoryOrder(order));
+	}
+
+	void store(T value, MemoryOrder order = kMemoryOrderSeqCst) {
+		_value.store(value, Internal::toStdMemoryOrder(order));
+	}
+
+	T fetchAdd(T value, MemoryOrder order = kMemoryOrderSeqCst) {
+		return _value.fetch_add(value, Internal::toStdMemoryOrder(order));
+	}
+
+	bool compareExchange(T &expected, T desired, MemoryOrder order = kMemoryOrderSeqCst) {
+		return _value.compare_exchange_strong(expected, desired, Internal::toStdMemoryOrder(order));
+	}
+
+private:
+	std::atomic<T> _value;
+};
+
+inline void atomicThreadFence(MemoryOrder order) {
+	std::atomic_thread_fence(Internal::toStdMemoryOrder(order));
+}
+
+#endif
+
+/** @} */
+
+} // End of namespace Common
+
+#endif
@@ -36,6 +36,7 @@ namespace Common {
  * @{
  */
 
+class JobManager;
 class SeekableReadStream;
 class WriteStream;
 
@@ -90,6 +91,25 @@ static inline bool inflateZlibHeaderless(byte *dst, uint dstLen, const byte *src
 	return inflateZlibHeaderless(dst, &dstLen, src, srcLen, dict, dictLen);
 }
 
+/**
+ * Same as inflateZlibHeaderless(), but also computes the CRC-32 of the
+ * decompressed data, as needed for ZIP archive members. The data is
+ * decompressed in chunks, and the checksum of each chunk is computed on
+ * the worker threads of the given job manager while the next chunk is
+ * being decompressed.
+ *
+ * @param dst       the buffer to store into.
+ * @param dstLen    a pointer to the size of the destination buffer. Upon exit,
+ *                  the number of bytes decompressed.
+ * @param src       the data to be decompressed.
+ * @param srcLen    the size of the compressed data.
+ * @param crc       a pointer where the checksum is stored.
+ * @param jobs      (optional) job manager to run the checksums on.
+ *
+ * @return true on success (Z_OK or Z_STREAM_END), false otherwise.
+ */
+bool inflateZlibHeaderlessCRC(byte *dst, uint *dstLen, const byte *src, uint srcLen, uint32 *crc, JobManager *jobs = nullptr);
+
 /**
  * Wrapper around zlib's inflate functions. This function will call the
  * modified inflate functions to uncompress data compressed for Clickteam
@@ -121,6 +141,10 @@ static inline bool inflateClickteam(byte *dst, uint  dstLen, const byte *src, ui
  * returned wrapped, unless there is no ZLIB support, then NULL is returned
  * and the old stream is destroyed.
  *
+ * Seeking backwards in the returned stream decompresses the data again,
+ * from the start or from the nearest seek point recorded after the first
+ * backward seek.
+ *
  * Certain GZip-formats don't supply an easily readable length, if you
  * still need the length carried along with the stream, and you know
  * the decompressed length at wrap-time, then it can be supplied as knownSize
@@ -40,6 +40,7 @@
 #include "common/ptr.h"
 #include "common/memstream.h"
 #include "common/compression/deflate.h"
+#include "common/crc.h"
 
 
 /* Compression methods (see algorithm.doc) */
@@ -1409,6 +1410,14 @@ bool inflateZlibHeaderless(byte *dst, uint *dstLen, const byte *src, uint srcLen
 	// In zlib version we use Z_SYNC_FLUSH so no error is raised if buffer is not completely consumed
 	return !gzio->err();
 }
+
+bool inflateZlibHeaderlessCRC(byte *dst, uint *dstLen, const byte *src, uint srcLen, uint32 *crc, JobManager *jobs) {
+	if (!crc || !inflateZlibHeaderless(dst, dstLen, src, srcLen))
+		return false;
+
+	*crc = CRC32().crcFast(dst, *dstLen);
+	return true;
+}
 #endif
 
 SeekableReadStream* wrapClickteamReadStream(Common::SeekableReadStream *parent, DisposeAfterUse::Flag disposeParent, uint64 uncompressed_size) {
@@ -57,6 +57,9 @@ public:
 	Common::Path translatePath(const Common::Path &path) const override;
 	char getPathSeparator() const override;
 
+protected:
+	void getPrefetchOrder(Common::Array<Common::Path> &paths) const override;
+
 private:
 	struct FileEntryFork {
 		FileEntryFork();
@@ -85,6 +88,9 @@ private:
 	typedef Common::HashMap<Common::Path, FileEntry, Common::Path::IgnoreCase_Hash, Common::Path::IgnoreCase_EqualTo> FileMap;
 	FileMap _map;
 
+	// Files with a data fork, in archive order
+	Common::Array<Common::Path> _order;
+
 	typedef Common::HashMap<Common::Path, Common::MacFinderInfoData, Common::Path::IgnoreCase_Hash, Common::Path::IgnoreCase_EqualTo> MetadataMap;
 	MetadataMap _metadataMap;
 
@@ -103,6 +109,7 @@ private:
 
 StuffItArchive::StuffItArchive() : Common::MemcachingCaseInsensitiveArchive(), _flattenTree(false) {
 	_stream = nullptr;
+	enablePrefetch();
 }
 
 StuffItArchive::~StuffItArchive() {
@@ -244,6 +251,8 @@ bool StuffItArchive::open(Common::SeekableReadStream *stream, bool flattenTree)
 		if (dataForkUncompressedSize != 0) {
 			// We have a data fork
 
+			_order.push_back(path);
+
 			FileEntryFork &entryFork = _map[path].dataFork;
 			entryFork.compression = dataForkCompression;
 			entryFork.uncompressedSize = dataForkUncompressedSize;
@@ -275,9 +284,13 @@ bool StuffItArchive::open(Common::SeekableReadStream *stream, bool flattenTree)
 }
 
 void StuffItArchive::close() {
+	// The cached members and the prefetch order belong to the old stream
+	clearCache();
+
 	delete _stream;
 	_stream = nullptr;
 	_map.clear();
+	_order.clear();
 }
 
 bool StuffItArchive::hasFile(const Common::Path &path) const {
@@ -373,6 +386,10 @@ char StuffItArchive::getPathSeparator() const {
 	return ':';
 }
 
+void StuffItArchive::getPrefetchOrder(Common::Array<Common::Path> &paths) const {
+	paths = _order;
+}
+
 void StuffItArchive::update14(uint16 first, uint16 last, byte *code, uint16 *freq) const {
 	uint16 i, j;
 
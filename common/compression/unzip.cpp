@@ -95,6 +95,7 @@ typedef Byte Bytef;
 #include "common/compression/deflate.h"
 #include "common/compression/unzip.h"
 #include "common/memstream.h"
+#include "common/system.h"
 
 #include "common/hashmap.h"
 #include "common/hash-str.h"
@@ -982,6 +983,8 @@ Common::SharedArchiveContents unzOpenCurrentFile (unzFile file
 	}
 
 	uint32 crc32_wait = s->cur_file_info.crc;
+	uint32 crc32_data = 0;
+	bool crc32_done = false;
 
 	byte *compressedBuffer = new byte[s->cur_file_info.compressed_size];
 	s->_stream->seek(s->cur_file_info_internal.offset_curfile + SIZEZIPLOCALHEADER + iSizeVar);
@@ -995,7 +998,18 @@ Common::SharedArchiveContents unzOpenCurrentFile (unzFile file
 	case Z_DEFLATED:
 		uncompressedBuffer = new byte[s->cur_file_info.uncompressed_size];
 		assert(s->cur_file_info.uncompressed_size == 0 || uncompressedBuffer != nullptr);
+#ifdef USE_ZLIB
+		if (s->cur_file_info.uncompressed_size != 0) {
+			// The checksum is computed on the worker threads, while the
+			// rest of the member is decompressed
+			uint uncompressedSize = s->cur_file_info.uncompressed_size;
+			Common::inflateZlibHeaderlessCRC(uncompressedBuffer, &uncompressedSize, compressedBuffer, s->cur_file_info.compressed_size,
+			                                 &crc32_data, g_system->getJobManager());
+			crc32_done = true;
+		}
+#else
 		Common::inflateZlibHeaderless(uncompressedBuffer, s->cur_file_info.uncompressed_size, compressedBuffer, s->cur_file_info.compressed_size);
+#endif
 		delete[] compressedBuffer;
 		compressedBuffer = nullptr;
 		break;
@@ -1004,11 +1018,13 @@ Common::SharedArchiveContents unzOpenCurrentFile (unzFile file
 		delete[] compressedBuffer;
 		return Common::SharedArchiveContents();
 	}
+	if (!crc32_done) {
 #ifndef USE_ZLIB
-	uint32 crc32_data = crc.crcFast(uncompressedBuffer, s->cur_file_info.uncompressed_size);
+		crc32_data = crc.crcFast(uncompressedBuffer, s->cur_file_info.uncompressed_size);
 #else
-	uint32 crc32_data = crc32(0, uncompressedBuffer, s->cur_file_info.uncompressed_size);
+		crc32_data = crc32(0, uncompressedBuffer, s->cur_file_info.uncompressed_size);
 #endif
+	}
 	if (crc32_data != crc32_wait) {
 		delete[] uncompressedBuffer;
 		warning("CRC32 mismatch: %08x, %08x", crc32_data, crc32_wait);
@@ -31,8 +31,15 @@
 #error Version 1.2.0.4 or newer of zlib is required for this code
 #endif
 
+// Seek points need inflateGetDictionary(), which was added in zlib 1.2.7.1
+#if ZLIB_VERNUM >= 0x1271
+#define ZLIB_SEEK_POINTS
+#endif
+
 #include "common/compression/deflate.h"
 
+#include "common/array.h"
+#include "common/jobs.h"
 #include "common/ptr.h"
 #include "common/util.h"
 #include "common/stream.h"
@@ -83,6 +90,82 @@ bool inflateZlibHeaderless(byte *dst, uint *dstLen, const byte *src, uint srcLen
 	return true;
 }
 
+namespace {
+
+enum {
+	/** Decompressed bytes per checksum job. */
+	kChecksumChunkSize = 1024 * 1024
+};
+
+struct ChecksumJob {
+	const byte *data;
+	uint32 size;
+	uLong crc;
+
+	static void run(void *data) {
+		ChecksumJob *job = (ChecksumJob *)data;
+		job->crc = crc32(0, job->data, job->size);
+	}
+};
+
+} // End of anonymous namespace
+
+bool inflateZlibHeaderlessCRC(byte *dst, uint *dstLen, const byte *src, uint srcLen, uint32 *crc, JobManager *jobs) {
+	if (!dst || !dstLen || !*dstLen || !src || !srcLen || !crc)
+		return false;
+
+	z_stream stream;
+	stream.next_in = const_cast<byte *>(src);
+	stream.avail_in = srcLen;
+	stream.zalloc = Z_NULL;
+	stream.zfree = Z_NULL;
+	stream.opaque = Z_NULL;
+
+	int err = inflateInit2(&stream, -MAX_WBITS);
+	if (err != Z_OK)
+		return false;
+
+	// Deflate data can only be decompressed in order, but the checksum of
+	// each decompressed chunk can be computed while the next one is
+	// decompressed
+	Array<ChecksumJob> chunks;
+	chunks.resize((*dstLen + kChecksumChunkSize - 1) / kChecksumChunkSize);
+	WaitGroup group;
+
+	uint done = 0, chunk = 0;
+	while (err == Z_OK && done < *dstLen) {
+		stream.next_out = dst + done;
+		stream.avail_out = MIN<uint>(kChecksumChunkSize, *dstLen - done);
+		while (err == Z_OK && stream.avail_out)
+			err = inflate(&stream, Z_SYNC_FLUSH);
+
+		const uint size = stream.next_out - (dst + done);
+		if (!size)
+			break;
+
+		ChecksumJob &job = chunks[chunk++];
+		job.data = dst + done;
+		job.size = size;
+		if (jobs)
+			jobs->submit(&ChecksumJob::run, &job, &group);
+		else
+			ChecksumJob::run(&job);
+		done += size;
+	}
+
+	inflateEnd(&stream);
+	if (jobs)
+		jobs->wait(group);
+
+	uLong result = crc32(0, Z_NULL, 0);
+	for (uint i = 0; i < chunk; i++)
+		result = crc32_combine(result, chunks[i].crc, chunks[i].size);
+
+	*crc = result;
+	*dstLen = done;
+	return err == Z_OK || err == Z_STREAM_END;
+}
+
 #ifndef RELEASE_BUILD
 static bool _shownBackwardSeekingWarning = false;
 #endif
@@ -91,11 +174,25 @@ static bool _shownBackwardSeekingWarning = false;
  * A simple wrapper class which can be used to wrap around an arbitrary
  * other SeekableReadStream and will then provide on-the-fly decompression support.
  * Assumes the compressed data to be in gzip format.
+ *
+ * Once the stream has been seeked backwards, seek points are recorded while
+ * decompressing. They hold the state of the decompressor at the end of a
+ * deflate block, so that later seeks only need to decompress the data from
+ * the nearest seek point on, instead of from the start of the stream.
  */
 class GZipReadStream : public SeekableReadStream {
 protected:
 	enum {
-		BUFSIZE = 16384		// 1 << MAX_WBITS
+		BUFSIZE = 16384,		// 1 << MAX_WBITS
+		WINDOWSIZE = 32768,		// 1 << MAX_WBITS
+		SEEKPOINT_INTERVAL = 512 * 1024	// Decompressed bytes between two seek points
+	};
+
+	struct SeekPoint {
+		uint32 outPos;		// Position in the decompressed data
+		uint64 inPos;		// Position of the next byte in the wrapped stream
+		int bits;			// Bits of the byte before inPos which are not used yet
+		Array<byte> window;	// The last bytes before outPos
 	};
 
 	byte	_buf[BUFSIZE];
@@ -108,6 +205,94 @@ protected:
 	uint32 _origSize;
 	bool _eos;
 
+	int _windowBits;
+	Array<byte> _dict;
+
+	bool _recordSeekPoints;
+	uint32 _nextSeekPoint;
+	Array<SeekPoint> _seekPoints;
+
+#ifdef ZLIB_SEEK_POINTS
+	void addSeekPoint(uint32 outPos) {
+		SeekPoint point;
+		point.outPos = outPos;
+		point.inPos = _wrapped->pos() - _stream.avail_in;
+		point.bits = _stream.data_type & 7;
+		point.window.resize(WINDOWSIZE);
+		uInt windowSize = WINDOWSIZE;
+		if (inflateGetDictionary(&_stream, point.window.data(), &windowSize) != Z_OK)
+			return;
+		point.window.resize(windowSize);
+
+		_seekPoints.push_back(point);
+		_nextSeekPoint = outPos + SEEKPOINT_INTERVAL;
+	}
+
+	/** Get the last seek point before @p pos, if any. */
+	const SeekPoint *findSeekPoint(uint32 pos) const {
+		int first = 0, last = (int)_seekPoints.size() - 1;
+		const SeekPoint *found = nullptr;
+		while (first <= last) {
+			const int mid = (first + last) / 2;
+			if (_seekPoints[mid].outPos <= pos) {
+				found = &_seekPoints[mid];
+				first = mid + 1;
+			} else {
+				last = mid - 1;
+			}
+		}
+		return found;
+	}
+
+	bool restoreSeekPoint(const SeekPoint &point) {
+		// The seek point is in the middle of the deflate data, so the
+		// wrapper is skipped from here on
+		_zlibErr = inflateReset2(&_stream, -MAX_WBITS);
+		if (_zlibErr != Z_OK)
+			return false;
+
+		_wrapped->seek(point.inPos - (point.bits ? 1 : 0), SEEK_SET);
+		if (point.bits) {
+			const byte partial = _wrapped->readByte();
+			_zlibErr = inflatePrime(&_stream, point.bits, partial >> (8 - point.bits));
+			if (_zlibErr != Z_OK)
+				return false;
+		}
+
+		_zlibErr = inflateSetDictionary(&_stream, const_cast<byte *>(point.window.data()), point.window.size());
+		if (_zlibErr != Z_OK)
+			return false;
+
+		_pos = point.outPos;
+		_stream.next_in = _buf;
+		_stream.avail_in = 0;
+		return true;
+	}
+#endif
+
+	bool restart() {
+		_pos = 0;
+		_wrapped->seek(_parentPos, SEEK_SET);
+#ifdef ZLIB_SEEK_POINTS
+		// Restoring a seek point changes the window bits
+		_zlibErr = inflateReset2(&_stream, _windowBits);
+#else
+		_zlibErr = inflateReset(&_stream);
+#endif
+		if (_zlibErr != Z_OK)
+			return false;
+
+		if (!_dict.empty()) {
+			_zlibErr = inflateSetDictionary(&_stream, _dict.data(), _dict.size());
+			if (_zlibErr != Z_OK)
+				return false;
+		}
+
+		_stream.next_in = _buf;
+		_stream.avail_in = 0;
+		return true;
+	}
+
 public:
 
 	GZipReadStream(SeekableReadStream *w, DisposeAfterUse::Flag disposeParent, uint32 knownSize) : _wrapped(w, disposeParent), _stream() {
@@ -131,13 +316,16 @@ public:
 		w->seek(_parentPos, SEEK_SET);
 		_pos = 0;
 		_eos = false;
+		_recordSeekPoints = false;
+		_nextSeekPoint = SEEKPOINT_INTERVAL;
 
 		// Adding 32 to windowBits indicates to zlib that it is supposed to
 		// automatically detect whether gzip or zlib headers are used for
 		// the compressed file. This feature was added in zlib 1.2.0.4,
 		// released 10 August 2003.
 		// Note: This is *crucial* for savegame compatibility, do *not* remove!
-		_zlibErr = inflateInit2(&_stream, MAX_WBITS + 32);
+		_windowBits = MAX_WBITS + 32;
+		_zlibErr = inflateInit2(&_stream, _windowBits);
 		if (_zlibErr != Z_OK)
 			return;
 
@@ -156,14 +344,20 @@ public:
 		_origSize = knownSize;
 		_pos = 0;
 		_eos = false;
+		_recordSeekPoints = false;
+		_nextSeekPoint = SEEKPOINT_INTERVAL;
 
-		_zlibErr = inflateInit2(&_stream, -MAX_WBITS);
+		_windowBits = -MAX_WBITS;
+		_zlibErr = inflateInit2(&_stream, _windowBits);
 		if (_zlibErr != Z_OK)
 			return;
 
-		// Set the dictionary, if provided
+		// Set the dictionary, if provided. It is kept for restarting the
+		// decompression when seeking backwards.
 		if (dict != nullptr && dictLen > 0) {
-			_zlibErr = inflateSetDictionary(&_stream, const_cast<byte *>(dict), dictLen);
+			_dict.resize(dictLen);
+			memcpy(_dict.data(), dict, dictLen);
+			_zlibErr = inflateSetDictionary(&_stream, _dict.data(), dictLen);
 			if (_zlibErr != Z_OK)
 				return;
 		}
@@ -194,6 +388,17 @@ public:
 				_stream.next_in = _buf;
 				_stream.avail_in = _wrapped->read(_buf, BUFSIZE);
 			}
+#ifdef ZLIB_SEEK_POINTS
+			// Stop at the end of the next deflate block when a seek point
+			// is due
+			const uint32 outPos = _pos + dataSize - _stream.avail_out;
+			if (_recordSeekPoints && outPos >= _nextSeekPoint) {
+				_zlibErr = inflate(&_stream, Z_BLOCK);
+				if (_zlibErr == Z_OK && (_stream.data_type & 128) && !(_stream.data_type & 64))
+					addSeekPoint(_pos + dataSize - _stream.avail_out);
+				continue;
+			}
+#endif
 			_zlibErr = inflate(&_stream, Z_NO_FLUSH);
 		}
 
@@ -235,9 +440,9 @@ public:
 		assert(newPos >= 0);
 
 		if ((uint32)newPos < _pos) {
-			// To search backward, we have to restart the whole decompression
-			// from the start of the file. A rather wasteful operation, best
-			// to avoid it. :/
+			// To search backward, we have to restart the decompression from
+			// the nearest seek point, or from the start of the file if there
+			// is none yet. Seek points are recorded from now on.
 
 #ifndef RELEASE_BUILD
 			if (!_shownBackwardSeekingWarning) {
@@ -249,21 +454,31 @@ public:
 			}
 #endif
 
-			_pos = 0;
-			_wrapped->seek(_parentPos, SEEK_SET);
-			_zlibErr = inflateReset(&_stream);
-			if (_zlibErr != Z_OK)
+#ifdef ZLIB_SEEK_POINTS
+			_recordSeekPoints = true;
+			const SeekPoint *point = findSeekPoint(newPos);
+			const bool restarted = point ? restoreSeekPoint(*point) : restart();
+#else
+			const bool restarted = restart();
+#endif
+			if (!restarted)
+				return false; // FIXME: STREAM REWRITE
+		}
+#ifdef ZLIB_SEEK_POINTS
+		else {
+			// Skip decompressing data which has been seen before
+			const SeekPoint *point = findSeekPoint(newPos);
+			if (point && point->outPos > _pos && !restoreSeekPoint(*point))
 				return false; // FIXME: STREAM REWRITE
-			_stream.next_in = _buf;
-			_stream.avail_in = 0;
 		}
+#endif
 
 		offset = newPos - _pos;
 
 		// Skip the given amount of data (very inefficient if one tries to skip
 		// huge amounts of data, but usually client code will only skip a few
 		// bytes, so this should be fine.
-		byte tmpBuf[1024];
+		byte tmpBuf[4096];
 		while (!err() && offset > 0) {
 			offset -= read(tmpBuf, MIN((int64)sizeof(tmpBuf), offset));
 		}
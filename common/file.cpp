@@ -23,6 +23,7 @@
 #include "common/debug.h"
 #include "common/file.h"
 #include "common/fs.h"
+#include "common/profiler.h"
 #include "common/textconsole.h"
 #include "common/system.h"
 #include "backends/fs/fs-factory.h"
@@ -42,6 +43,7 @@ bool File::open(const Path &filename) {
 }
 
 bool File::open(const Path &filename, Archive &archive) {
+	PROFILE_ZONE("File::open");
 	assert(!filename.empty());
 	assert(!_handle);
 
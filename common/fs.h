@@ -252,6 +252,15 @@ public:
 	 */
 	bool isWritable() const;
 
+	/**
+	 * Retrieve the size and the time of the last modification of the file
+	 * referred by this node, for validating data cached about it.
+	 *
+	 * @return True if both values are known, false otherwise. Not all
+	 *         backends support this.
+	 */
+	bool getFileStatus(int64 &size, int64 &modificationTime) const;
+
 	/**
 	 * Create a SeekableReadStream instance corresponding to the file
 	 * referred by this node. This assumes that the node actually refers
@@ -0,0 +1,234 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef COMMON_JOBS_H
+#define COMMON_JOBS_H
+
+#include "common/scummsys.h"
+#include "common/array.h"
+#include "common/noncopyable.h"
+#include "common/util.h"
+
+namespace Common {
+
+/**
+ * @defgroup common_jobs Jobs
+ * @ingroup common
+ *
+ * @brief API for running work on the backend's worker threads.
+ *
+ * The job manager is obtained through OSystem::getJobManager(). Backends
+ * with thread support provide a pool of worker threads, the others use
+ * the JobManager base class which runs every job immediately on the
+ * calling thread. Code using this API must therefore never rely on a job
+ * running concurrently with its submitter.
+ *
+ * Jobs may run on any thread. They must not touch the graphics, event or
+ * mixer managers of OSystem and must protect shared state themselves.
+ *
+ * @{
+ */
+
+class JobManager;
+
+/**
+ * Tracks a set of submitted jobs so that the submitter can wait for them.
+ *
+ * A wait group must outlive all jobs submitted with it.
+ */
+class WaitGroup : NonCopyable {
+	friend class JobManager;
+
+public:
+	WaitGroup() : _pending(0) {}
+
+private:
+	/** Number of jobs not yet finished. Guarded by the job manager. */
+	int _pending;
+};
+
+class JobManager : NonCopyable {
+public:
+	typedef void (*JobProc)(void *data); /*!< Type definition of a job. */
+
+	virtual ~JobManager() {}
+
+	/**
+	 * Return the number of threads which execute jobs, including the thread
+	 * waiting for them. This is 1 if jobs are run inline.
+	 */
+	virtual uint getThreadCount() const { return 1; }
+
+	/**
+	 * Return the index of the calling thread: from 1 to getThreadCount() - 1
+	 * for the threads of this job manager, 0 for every other thread.
+	 */
+	virtual uint getCurrentThread() const { return 0; }
+
+	/**
+	 * Queue a job for execution.
+	 *
+	 * @param proc   Callback.
+	 * @param data   Arbitrary pointer passed to the callback.
+	 * @param group  Optional wait group the job is added to.
+	 */
+	virtual void submit(JobProc proc, void *data, WaitGroup *group = nullptr) { proc(data); }
+
+	/**
+	 * Block until all jobs of the given group have finished. The calling
+	 * thread takes part in executing queued jobs while it waits.
+	 */
+	virtual void wait(WaitGroup &group) {}
+
+	/** Return true if all jobs of the given group have finished. */
+	virtual bool isDone(WaitGroup &group) { return true; }
+
+	/**
+	 * Split the range [0, count) into contiguous chunks of at least
+	 * @p minChunk items and call func(begin, end) for each of them, using
+	 * all available threads. Returns once every chunk has been processed.
+	 *
+	 * The split only depends on @p count, @p minChunk and the thread count,
+	 * so callers producing per-chunk results get a stable layout.
+	 */
+	template<class Func>
+	void parallelFor(uint count, const Func &func, uint minChunk = 1);
+
+protected:
+	/** Give subclasses access to the counter of a wait group. */
+	static int &pendingCount(WaitGroup &group) { return group._pending; }
+
+private:
+	template<class Func>
+	struct RangeJob {
+		const Func *func;
+		uint begin;
+		uint end;
+
+		static void run(void *data) {
+			RangeJob *job = (RangeJob *)data;
+			(*job->func)(job->begin, job->end);
+		}
+	};
+};
+
+template<class Func>
+void JobManager::parallelFor(uint count, const Func &func, uint minChunk) {
+	if (count == 0)
+		return;
+	if (minChunk == 0)
+		minChunk = 1;
+
+	uint chunks = MIN<uint>(getThreadCount(), (count + minChunk - 1) / minChunk);
+	if (chunks <= 1) {
+		func(0, count);
+		return;
+	}
+
+	Array<RangeJob<Func> > jobs;
+	jobs.resize(chunks);
+
+	uint begin = 0;
+	for (uint i = 0; i < chunks; i++) {
+		uint end = (uint)(((uint64)count * (i + 1)) / chunks);
+		jobs[i].func = &func;
+		jobs[i].begin = begin;
+		jobs[i].end = end;
+		begin = end;
+	}
+
+	// The calling thread handles the first chunk itself
+	WaitGroup group;
+	for (uint i = 1; i < chunks; i++)
+		submit(&RangeJob<Func>::run, &jobs[i], &group);
+
+	RangeJob<Func>::run(&jobs[0]);
+	wait(group);
+}
+
+/**
+ * Result of a single job running in the background.
+ *
+ * The callable is copied, so it may be a temporary lambda. The destructor
+ * waits for the job, so a future never outlives its work.
+ */
+template<class T>
+class Future : NonCopyable {
+public:
+	Future() : _manager(nullptr), _job(nullptr), _result() {}
+	~Future() { wait(); }
+
+	/** Start computing the result of func() using the given job manager. */
+	template<class Func>
+	void start(JobManager *manager, const Func &func) {
+		wait();
+		_manager = manager;
+		_job = new FuncJob<Func>(func, &_result);
+		_manager->submit(&runJob, _job, &_group);
+	}
+
+	/** Return true if no job is running. */
+	bool isReady() { return !_manager || _manager->isDone(_group); }
+
+	/** Wait for the job and return its result. */
+	T &get() {
+		wait();
+		return _result;
+	}
+
+	/** Wait for the job to finish. */
+	void wait() {
+		if (!_manager)
+			return;
+		_manager->wait(_group);
+		delete _job;
+		_job = nullptr;
+		_manager = nullptr;
+	}
+
+private:
+	struct Job {
+		virtual ~Job() {}
+		virtual void run() = 0;
+	};
+
+	template<class Func>
+	struct FuncJob : public Job {
+		FuncJob(const Func &func, T *result) : _func(func), _result(result) {}
+		void run() override { *_result = _func(); }
+
+		Func _func;
+		T *_result;
+	};
+
+	static void runJob(void *data) { ((Job *)data)->run(); }
+
+	JobManager *_manager;
+	Job *_job;
+	WaitGroup _group;
+	T _result;
+};
+
+/** @} */
+
+} // End of namespace Common
+
+#endif
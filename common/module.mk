@@ -55,5 +55,10 @@ MODULE_OBJS += \
 	updates.o
 endif
 
+ifdef ENABLE_PROFILER
+MODULE_OBJS += \
+	profiler.o
+endif
+
 # Include common rules
 include $(srcdir)/rules.mk
@@ -242,6 +242,17 @@ public:
 	/** Construct a copy of the given path. */
 	Path(const Path &path) : _str(path._str) { }
 
+	/**
+	 * Return a copy of the path which does not share its storage with this
+	 * one. Copies otherwise share a string whose reference count is
+	 * not atomic, so this is needed to keep a path given by another thread.
+	 */
+	Path unshare() const {
+		Path result;
+		result._str = String(_str.c_str(), _str.size());
+		return result;
+	}
+
 	/**
 	 * Construct a new path from the given NULL-terminated C string.
 	 *
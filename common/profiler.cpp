@@ -0,0 +1,225 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/profiler.h"
+
+#ifdef ENABLE_PROFILER
+
+#include "common/file.h"
+#include "common/jobs.h"
+
+namespace Common {
+
+DECLARE_SINGLETON(Profiler);
+
+bool Profiler::_enabled = false;
+
+/** Index of the calling thread plus one, 0 until getThread() assigns it. */
+static thread_local uint s_threadIndex = 0;
+
+Profiler::Profiler() : _tracing(false), _jobManager(nullptr), _nextThread(0), _droppedEvents(0), _frameStart(0), _startTime(0) {
+	registerZone("Frame");
+}
+
+void Profiler::setEnabled(bool enabled, bool trace) {
+	// Called from the main thread, which is thread 0 in the trace
+	s_threadIndex = 1;
+	if (!_jobManager)
+		_jobManager = g_system->getJobManager();
+
+	StackLock lock(_mutex);
+	if (enabled && !_enabled) {
+		_frameStart = g_system->getMicros();
+		if (!_startTime)
+			_startTime = _frameStart;
+	}
+	_enabled = enabled;
+	_tracing = enabled && trace;
+}
+
+void Profiler::reset() {
+	StackLock lock(_mutex);
+	for (uint i = 0; i < _zones.size(); i++) {
+		const char *name = _zones[i].name;
+		memset(&_zones[i], 0, sizeof(Zone));
+		_zones[i].name = name;
+	}
+	_events.clear();
+	_droppedEvents = 0;
+	_frameStart = _startTime = g_system->getMicros();
+}
+
+uint Profiler::registerZone(const char *name) {
+	StackLock lock(_mutex);
+	for (uint i = 0; i < _zones.size(); i++) {
+		if (!strcmp(_zones[i].name, name))
+			return i;
+	}
+
+	Zone zone;
+	memset(&zone, 0, sizeof(zone));
+	zone.name = name;
+	_zones.push_back(zone);
+	return _zones.size() - 1;
+}
+
+uint Profiler::getThread() {
+	// Trace events need to tell threads apart, to nest zones correctly. Job
+	// threads keep their index, other threads such as the one of the audio
+	// callback are numbered after them in the order they are first seen.
+	if (!s_threadIndex) {
+		uint thread = _jobManager->getCurrentThread();
+		if (!thread)
+			thread = _jobManager->getThreadCount() + _nextThread.fetchAdd(1);
+		s_threadIndex = thread + 1;
+	}
+	return s_threadIndex - 1;
+}
+
+uint Profiler::getBucket(uint32 micros) {
+	uint bucket = 0;
+	while (micros && bucket < kHistogramBuckets - 1) {
+		micros >>= 1;
+		bucket++;
+	}
+	return bucket;
+}
+
+void Profiler::addSample(uint zoneId, uint64 start, uint64 end) {
+	const uint32 duration = (uint32)MIN<uint64>(end - start, 0xFFFFFFFF);
+	const uint thread = _tracing ? getThread() : 0;
+
+	StackLock lock(_mutex);
+	Zone &zone = _zones[zoneId];
+	zone.calls++;
+	zone.totalMicros += duration;
+	zone.maxMicros = MAX(zone.maxMicros, duration);
+	zone.frameMicros += duration;
+
+	if (_tracing) {
+		if (_events.size() < kMaxTraceEvents) {
+			TraceEvent event;
+			event.zone = zoneId;
+			event.thread = thread;
+			event.duration = duration;
+			event.start = start;
+			_events.push_back(event);
+		} else {
+			_droppedEvents++;
+		}
+	}
+}
+
+void Profiler::endFrame() {
+	const uint64 now = g_system->getMicros();
+	const uint thread = _tracing ? getThread() : 0;
+
+	StackLock lock(_mutex);
+	Zone &frame = _zones[0];
+	frame.calls++;
+	frame.frameMicros = (uint32)MIN<uint64>(now - _frameStart, 0xFFFFFFFF);
+	frame.totalMicros += frame.frameMicros;
+	frame.maxMicros = MAX(frame.maxMicros, frame.frameMicros);
+	if (_tracing && _events.size() < kMaxTraceEvents) {
+		TraceEvent event;
+		event.zone = 0;
+		event.thread = thread;
+		event.duration = frame.frameMicros;
+		event.start = _frameStart;
+		_events.push_back(event);
+	}
+	_frameStart = now;
+
+	// Zones are only counted in the frames they were entered in
+	for (uint i = 0; i < _zones.size(); i++) {
+		Zone &zone = _zones[i];
+		if (i != 0 && !zone.frameMicros)
+			continue;
+		zone.frames++;
+		zone.histogram[getBucket(zone.frameMicros)]++;
+		zone.frameMicros = 0;
+	}
+}
+
+Array<Profiler::Zone> Profiler::getZones() {
+	StackLock lock(_mutex);
+	return _zones;
+}
+
+/** Estimate a percentile of the time per frame, from the histogram. */
+static uint32 getPercentile(const Profiler::Zone &zone, uint percent) {
+	const uint64 rank = ((uint64)zone.frames * percent + 99) / 100;
+	uint64 count = 0;
+	for (uint i = 0; i < Profiler::kHistogramBuckets; i++) {
+		count += zone.histogram[i];
+		if (count >= rank && count > 0)
+			return MIN(Profiler::getBucketLimit(i), zone.maxMicros);
+	}
+	return zone.maxMicros;
+}
+
+String Profiler::getStatistics() {
+	Array<Zone> zones = getZones();
+	String result = String::format("%-32s %8s %8s %10s %8s %8s %8s\n", "Zone", "Calls", "Frames", "Total ms", "p50 us", "p95 us", "Max us");
+	for (uint i = 0; i < zones.size(); i++) {
+		const Zone &zone = zones[i];
+		if (!zone.calls)
+			continue;
+		result += String::format("%-32s %8u %8u %10u %8u %8u %8u\n", zone.name, zone.calls, zone.frames,
+			(uint)(zone.totalMicros / 1000), getPercentile(zone, 50), getPercentile(zone, 95), zone.maxMicros);
+	}
+	return result;
+}
+
+bool Profiler::writeTrace(const Path &fileName) {
+	DumpFile file;
+	if (!file.open(fileName, true))
+		return false;
+
+	StackLock lock(_mutex);
+	file.writeString("{\n\"traceEvents\": [\n");
+	for (uint i = 0; i < _events.size(); i++) {
+		const TraceEvent &event = _events[i];
+		file.writeString(String::format("{\"name\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":%u,\"ts\":%llu,\"dur\":%u}%s\n",
+			_zones[event.zone].name, event.thread, (unsigned long long)(event.start - MIN(event.start, _startTime)),
+			event.duration, i + 1 < _events.size() ? "," : ""));
+	}
+	file.writeString("],\n\"displayTimeUnit\": \"ms\",\n");
+
+	// Chrome ignores unknown keys, the statistics are kept next to the events
+	file.writeString(String::format("\"droppedEvents\": %u,\n\"zones\": [\n", _droppedEvents));
+	for (uint i = 0; i < _zones.size(); i++) {
+		const Zone &zone = _zones[i];
+		file.writeString(String::format("{\"name\":\"%s\",\"calls\":%u,\"frames\":%u,\"total_us\":%llu,\"max_us\":%u,\"histogram\":[",
+			zone.name, zone.calls, zone.frames, (unsigned long long)zone.totalMicros, zone.maxMicros));
+		for (uint j = 0; j < kHistogramBuckets; j++)
+			file.writeString(String::format(j ? ",%u" : "%u", zone.histogram[j]));
+		file.writeString(i + 1 < _zones.size() ? "]},\n" : "]}\n");
+	}
+	file.writeString("]\n}\n");
+
+	file.finalize();
+	return !file.err();
+}
+
+} // End of namespace Common
+
+#endif // ENABLE_PROFILER
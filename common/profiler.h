@@ -0,0 +1,203 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef COMMON_PROFILER_H
+#define COMMON_PROFILER_H
+
+#include "common/scummsys.h"
+
+/**
+ * @defgroup common_profiler Profiler
+ * @ingroup common
+ *
+ * @brief  Timing zones for finding out where the time of a frame goes.
+ *
+ * A zone measures the time spent in the scope it is declared in:
+ *
+ * @code
+ * void MixerImpl::mixCallback(byte *samples, uint len) {
+ *     PROFILE_ZONE("Mixer::mixCallback");
+ *     ...
+ * }
+ * @endcode
+ *
+ * Zones are only compiled in when ScummVM is configured with
+ * --enable-profiler, and only measure anything once the profiler has been
+ * enabled, e.g. with the "profile" debugger command. Frames end with
+ * PROFILE_FRAME(), which is done by OSystem::updateScreen().
+ * @{
+ */
+
+#ifdef ENABLE_PROFILER
+
+#include "common/array.h"
+#include "common/atomic.h"
+#include "common/mutex.h"
+#include "common/path.h"
+#include "common/singleton.h"
+#include "common/str.h"
+#include "common/system.h"
+
+namespace Common {
+
+class JobManager;
+
+class Profiler : public Singleton<Profiler> {
+public:
+	enum {
+		/** Histogram buckets hold times up to 2^n - 1 microseconds. */
+		kHistogramBuckets = 25,
+		/** Events kept for the trace, later ones are dropped. */
+		kMaxTraceEvents = 1 << 20
+	};
+
+	struct Zone {
+		const char *name;
+		uint32 calls;
+		uint64 totalMicros;
+		uint32 maxMicros;
+		uint32 frameMicros; /*!< Time spent in the current frame */
+		uint32 frames;      /*!< Number of frames the zone was entered in */
+		uint32 histogram[kHistogramBuckets]; /*!< Time spent per frame */
+	};
+
+	/** Whether zones are measured. Checked without locking on every zone. */
+	static bool isEnabled() { return _enabled; }
+
+	/**
+	 * Start or stop measuring. Statistics are kept until reset() is called.
+	 *
+	 * @param trace  Also keep every zone entry, for writeTrace().
+	 */
+	void setEnabled(bool enabled, bool trace = false);
+	bool isTracing() const { return _tracing; }
+
+	/** Forget all statistics and trace events. */
+	void reset();
+
+	/** Get the id of the zone named @p name, adding it if needed. */
+	uint registerZone(const char *name);
+
+	/** Account a zone entry from @p start to @p end. */
+	void addSample(uint zone, uint64 start, uint64 end);
+
+	/** End the current frame and add the zone times to the histograms. */
+	void endFrame();
+
+	/** Get a copy of the statistics of every zone, the frames come first. */
+	Array<Zone> getZones();
+
+	/** Summary of the statistics, one line per zone. */
+	String getStatistics();
+
+	/**
+	 * Write the trace events in the Chrome trace event format, which can be
+	 * loaded in chrome://tracing or Perfetto. The zone statistics and
+	 * histograms are written as well.
+	 */
+	bool writeTrace(const Path &fileName);
+
+	/** Upper bound of a histogram bucket, in microseconds. */
+	static uint32 getBucketLimit(uint bucket) { return (1U << bucket) - 1; }
+	static uint getBucket(uint32 micros);
+
+private:
+	friend class Singleton<SingletonBaseType>;
+	Profiler();
+
+	struct TraceEvent {
+		uint16 zone;
+		uint16 thread;
+		uint32 duration;
+		uint64 start;
+	};
+
+	uint getThread();
+
+	static bool _enabled;
+	bool _tracing;
+	JobManager *_jobManager; /*!< Fetched on the main thread by setEnabled() */
+	Atomic<uint> _nextThread;
+	Mutex _mutex;
+	Array<Zone> _zones;
+	Array<TraceEvent> _events;
+	uint32 _droppedEvents;
+	uint64 _frameStart;
+	uint64 _startTime;
+};
+
+/** Measures the time until the end of the scope, see PROFILE_ZONE(). */
+class ProfileZone {
+public:
+	ProfileZone(Atomic<uint> &zone, const char *name) : _zone(zone), _name(name), _active(Profiler::isEnabled()), _start(0) {
+		if (_active)
+			_start = g_system->getMicros();
+	}
+
+	~ProfileZone() {
+		// Zones entered before the profiler was enabled are not counted
+		if (_active && Profiler::isEnabled()) {
+			Profiler &profiler = Profiler::instance();
+			// Zones may be entered from several threads. Registering a zone
+			// twice returns the same id, so a race only costs a lookup.
+			uint zone = _zone.load(kMemoryOrderRelaxed);
+			if (!zone) {
+				zone = profiler.registerZone(_name);
+				_zone.store(zone, kMemoryOrderRelaxed);
+			}
+			profiler.addSample(zone, _start, g_system->getMicros());
+		}
+	}
+
+private:
+	Atomic<uint> &_zone;
+	const char *_name;
+	bool _active;
+	uint64 _start;
+};
+
+} // End of namespace Common
+
+#define PROFILE_ZONE_CONCAT2(a, b) a##b
+#define PROFILE_ZONE_CONCAT(a, b) PROFILE_ZONE_CONCAT2(a, b)
+
+/** Measure the time spent in the rest of the enclosing scope. */
+#define PROFILE_ZONE(name) \
+	static Common::Atomic<uint> PROFILE_ZONE_CONCAT(profileZoneId, __LINE__); \
+	Common::ProfileZone PROFILE_ZONE_CONCAT(profileZone, __LINE__)(PROFILE_ZONE_CONCAT(profileZoneId, __LINE__), name)
+
+/** End the current frame. */
+#define PROFILE_FRAME() \
+	do { \
+		if (Common::Profiler::isEnabled()) \
+			Common::Profiler::instance().endFrame(); \
+	} while (false)
+
+#else
+
+#define PROFILE_ZONE(name) do {} while (false)
+#define PROFILE_FRAME() do {} while (false)
+
+#endif // ENABLE_PROFILER
+
+/** @} */
+
+#endif
@@ -24,6 +24,7 @@
 #include "common/system.h"
 #include "common/events.h"
 #include "common/fs.h"
+#include "common/jobs.h"
 #include "common/file.h"
 #include "common/savefile.h"
 #include "common/str.h"
@@ -45,6 +46,7 @@ OSystem::OSystem() {
 	_audiocdManager = nullptr;
 	_eventManager = nullptr;
 	_timerManager = nullptr;
+	_jobManager = nullptr;
 	_savefileManager = nullptr;
 #if defined(USE_TASKBAR)
 	_taskbarManager = nullptr;
@@ -71,6 +73,9 @@ OSystem::~OSystem() {
 	delete _timerManager;
 	_timerManager = nullptr;
 
+	delete _jobManager;
+	_jobManager = nullptr;
+
 #if defined(USE_TASKBAR)
 	delete _taskbarManager;
 	_taskbarManager = nullptr;
@@ -111,6 +116,10 @@ void OSystem::initBackend() {
 	if (!_savefileManager)
 		error("Backend failed to instantiate savefile manager");
 
+	// Created here, before any other thread may ask for it
+	if (!_jobManager)
+		_jobManager = new Common::JobManager();
+
 	// TODO: We currently don't check _fsFactory because not all ports
 	// set it.
 // 	if (!_fsFactory)
@@ -259,6 +268,16 @@ Common::TimerManager *OSystem::getTimerManager() {
 	return _timerManager;
 }
 
+Common::JobManager *OSystem::getJobManager() {
+	if (!_jobManager) {
+		// initBackend() sets it, so this is only reached while the main
+		// thread is the only one running
+		assert(!_backendInitialized);
+		_jobManager = new Common::JobManager();
+	}
+	return _jobManager;
+}
+
 Common::SaveFileManager *OSystem::getSavefileManager() {
 	return _savefileManager;
 }
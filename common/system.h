@@ -53,6 +53,7 @@ class Store;
 
 namespace Common {
 class EventManager;
+class JobManager;
 class MutexInternal;
 struct Rect;
 class SaveFileManager;
@@ -216,6 +217,17 @@ protected:
 	 */
 	Common::TimerManager *_timerManager;
 
+	/**
+	 * Backends with thread support should set _jobManager to a manager
+	 * running jobs on worker threads. If none has been set, initBackend()
+	 * creates a default instance which runs all jobs on the calling thread.
+	 * getJobManager() only creates one itself when called before
+	 * initBackend(), while no other thread is running.
+	 *
+	 * @note _jobManager is deleted by the OSystem destructor.
+	 */
+	Common::JobManager *_jobManager;
+
 	/**
 	 * No default value is provided for _savefileManager by OSystem.
 	 *
@@ -1505,6 +1517,16 @@ public:
 	 */
 	virtual uint32 getMillis(bool skipRecord = false) = 0;
 
+	/**
+	 * Get a monotonic time in microseconds, for measuring how long
+	 * something takes.
+	 *
+	 * Unlike getMillis(), this is never recorded or replayed by the event
+	 * recorder, so backends supporting it must override this. The default
+	 * implementation only has the precision of getMillis().
+	 */
+	virtual uint64 getMicros() { return (uint64)getMillis(true) * 1000; }
+
 	/** Delay/sleep for the specified amount of milliseconds. */
 	virtual void delayMillis(uint msecs) = 0;
 
@@ -1590,6 +1612,17 @@ public:
 	 */
 	virtual Common::MutexInternal *createMutex() = 0;
 
+	/**
+	 * Return the job manager singleton.
+	 *
+	 * Unlike the rest of this API, the job manager lets engines and other
+	 * subsystems run work on several threads. Backends without threads
+	 * run jobs on the calling thread.
+	 *
+	 * For more information, see @ref JobManager.
+	 */
+	virtual Common::JobManager *getJobManager();
+
 	/** @} */
 
 
@@ -24,10 +24,12 @@
 #include "common/debug.h"
 #include "common/util.h"
 #include "common/file.h"
+#include "common/jobs.h"
 #include "common/macresman.h"
 #include "common/md5.h"
 #include "common/config-manager.h"
 #include "common/punycode.h"
+#include "common/savefile.h"
 #include "common/system.h"
 #include "common/textconsole.h"
 #include "common/tokenizer.h"
@@ -413,6 +415,7 @@ Common::Error AdvancedMetaEngineDetection::createInstance(OSystem *syst, Engine
 
 	// Detection is done, no need to keep archives in memory anymore
 	ADCacheMan.clearArchives();
+	ADCacheMan.flushPersistentCache();
 
 	// If the GUI options were updated, we catch this here and update them in the users config
 	// file transparently.
@@ -482,19 +485,39 @@ void AdvancedMetaEngineDetection::composeFileHashMap(FileMap &allFiles, const Co
 	if (fslist.empty())
 		return;
 
+	// List the matching subdirectories up front, so that slow file systems
+	// can be queried concurrently. The results are merged in list order to
+	// keep the priority of clashing names.
+	Common::Array<const Common::FSNode *> subdirs;
+	if (depth > 1) {
+		for (Common::FSList::const_iterator file = fslist.begin(); file != fslist.end(); ++file) {
+			if (file->isDirectory() && _globsMap.contains(Common::punycode_encodefilename(file->getName())))
+				subdirs.push_back(&*file);
+		}
+	}
+
+	Common::Array<Common::FSList> subdirFiles;
+	Common::Array<bool> subdirListed;
+	subdirFiles.resize(subdirs.size());
+	subdirListed.resize(subdirs.size());
+
+	g_system->getJobManager()->parallelFor(subdirs.size(), [&](uint begin, uint end) {
+		for (uint i = begin; i < end; i++)
+			subdirListed[i] = subdirs[i]->getChildren(subdirFiles[i], Common::FSNode::kListAll);
+	});
+
+	uint subdir = 0;
 	for (Common::FSList::const_iterator file = fslist.begin(); file != fslist.end(); ++file) {
 		Common::String efname = Common::punycode_encodefilename(file->getName());
 		Common::Path tstr = ((_flags & kADFlagMatchFullPaths) ? parentName : Common::Path()).appendComponent(efname);
 
 		if (file->isDirectory()) {
-			if (!_globsMap.contains(efname))
-				continue;
-
-			Common::FSList files;
-			if (!file->getChildren(files, Common::FSNode::kListAll))
+			if (subdir >= subdirs.size() || subdirs[subdir] != &*file)
 				continue;
 
-			composeFileHashMap(allFiles, files, depth - 1, tstr);
+			if (subdirListed[subdir])
+				composeFileHashMap(allFiles, subdirFiles[subdir], depth - 1, tstr);
+			subdir++;
 			continue;
 		}
 
@@ -517,6 +540,148 @@ namespace Common {
 	DECLARE_SINGLETON(AdvancedDetectorCacheManager);
 }
 
+// The leading dot keeps the cache out of the cloud saves synchronization
+static const char *const kPersistentCacheFileName = ".detectioncache";
+static const uint32 kPersistentCacheVersion = 2;
+
+void AdvancedDetectorCacheManager::loadPersistentCache() {
+	_persistentLoaded = true;
+
+	Common::SaveFileManager *saveFileMan = g_system->getSavefileManager();
+	if (!saveFileMan)
+		return;
+
+	Common::ScopedPtr<Common::InSaveFile> in(saveFileMan->openRawFile(kPersistentCacheFileName));
+	if (!in)
+		return;
+
+	if (in->readUint32BE() != MKTAG('A', 'D', 'C', 'H') || in->readUint32LE() != kPersistentCacheVersion) {
+		debugC(2, kDebugGlobalDetection, "Ignoring outdated detection cache");
+		return;
+	}
+
+	uint32 count = in->readUint32LE();
+	for (uint32 i = 0; i < count; i++) {
+		uint32 keyLength = in->readUint32LE();
+		Common::String key = in->readString(0, keyLength);
+
+		PersistentEntry entry;
+		uint32 pathLength = in->readUint32LE();
+		entry.path = Common::Path::fromConfig(in->readString(0, pathLength));
+		entry.fileSize = in->readSint64LE();
+		entry.modificationTime = in->readSint64LE();
+		entry.props.size = in->readSint64LE();
+		entry.props.md5prop = (MD5Properties)in->readUint32LE();
+		uint32 md5Length = in->readUint32LE();
+		entry.props.md5 = in->readString(0, md5Length);
+
+		if (in->err() || in->eos()) {
+			warning("Detection cache is corrupted, discarding it");
+			persistentHashMap.clear();
+			return;
+		}
+
+		persistentHashMap.setVal(key, entry);
+	}
+
+	debugC(2, kDebugGlobalDetection, "Loaded %u entries from the detection cache", count);
+}
+
+bool AdvancedDetectorCacheManager::getPersistentProperties(const Common::String &key, int64 fileSize, int64 modificationTime, FileProperties &fileProps) {
+	if (!_persistentLoaded)
+		loadPersistentCache();
+
+	PersistentHashMap::const_iterator entry = persistentHashMap.find(key);
+	if (entry == persistentHashMap.end())
+		return false;
+
+	if (entry->_value.fileSize != fileSize || entry->_value.modificationTime != modificationTime)
+		return false;
+
+	fileProps = entry->_value.props;
+	return true;
+}
+
+void AdvancedDetectorCacheManager::setPersistentProperties(const Common::String &key, const Common::Path &path, int64 fileSize, int64 modificationTime, const FileProperties &fileProps) {
+	if (!_persistentLoaded)
+		loadPersistentCache();
+
+	PersistentEntry entry;
+	entry.path = path;
+	entry.fileSize = fileSize;
+	entry.modificationTime = modificationTime;
+	entry.props = fileProps;
+	persistentHashMap.setVal(key, entry);
+	_persistentDirty = true;
+}
+
+void AdvancedDetectorCacheManager::prunePersistentCache(const Common::Path &dir) {
+	if (!_persistentLoaded)
+		loadPersistentCache();
+
+	// Game files which were removed or moved would otherwise stay forever.
+	// Entries outside the scanned directory are kept, their drive may just
+	// not be mounted right now.
+	Common::Array<Common::String> staleKeys;
+	for (PersistentHashMap::const_iterator entry = persistentHashMap.begin(); entry != persistentHashMap.end(); ++entry) {
+		if (entry->_value.path.isRelativeTo(dir) && !Common::FSNode(entry->_value.path).exists())
+			staleKeys.push_back(entry->_key);
+	}
+
+	for (uint i = 0; i < staleKeys.size(); i++)
+		persistentHashMap.erase(staleKeys[i]);
+
+	if (!staleKeys.empty()) {
+		debugC(2, kDebugGlobalDetection, "Dropped %u stale entries from the detection cache", staleKeys.size());
+		_persistentDirty = true;
+	}
+}
+
+void AdvancedDetectorCacheManager::flushPersistentCache() {
+	if (!_persistentDirty || _batchDepth > 0)
+		return;
+
+	Common::SaveFileManager *saveFileMan = g_system->getSavefileManager();
+	if (!saveFileMan)
+		return;
+
+	Common::ScopedPtr<Common::OutSaveFile> out(saveFileMan->openForSaving(kPersistentCacheFileName, false));
+	if (!out) {
+		warning("Could not write the detection cache");
+		return;
+	}
+
+	out->writeUint32BE(MKTAG('A', 'D', 'C', 'H'));
+	out->writeUint32LE(kPersistentCacheVersion);
+	out->writeUint32LE(persistentHashMap.size());
+
+	for (PersistentHashMap::const_iterator entry = persistentHashMap.begin(); entry != persistentHashMap.end(); ++entry) {
+		out->writeUint32LE(entry->_key.size());
+		out->writeString(entry->_key);
+		const Common::String path = entry->_value.path.toConfig();
+		out->writeUint32LE(path.size());
+		out->writeString(path);
+		out->writeSint64LE(entry->_value.fileSize);
+		out->writeSint64LE(entry->_value.modificationTime);
+		out->writeSint64LE(entry->_value.props.size);
+		out->writeUint32LE(entry->_value.props.md5prop);
+		out->writeUint32LE(entry->_value.props.md5.size());
+		out->writeString(entry->_value.props.md5);
+	}
+
+	out->finalize();
+	if (out->err())
+		warning("Could not write the detection cache");
+
+	_persistentDirty = false;
+}
+
+void AdvancedDetectorCacheManager::endBatch() {
+	assert(_batchDepth > 0);
+	if (--_batchDepth == 0)
+		flushPersistentCache();
+}
+
 
 static MD5Properties gameFileToMD5Props(const ADGameFileDescription *fileEntry, uint32 gameFlags) {
 	MD5Properties ret = kMD5Head;
@@ -581,12 +746,52 @@ Common::String md5PropToGameFile(MD5Properties flags) {
 
 static bool getFilePropertiesIntern(uint md5Bytes, const AdvancedMetaEngine::FileMap &allFiles, MD5Properties md5prop, const Common::Path &fname, FileProperties &fileProps);
 
-bool AdvancedMetaEngineDetection::getFileProperties(const FileMap &allFiles, MD5Properties md5prop, const Common::Path &fname, FileProperties &fileProps) const {
+static Common::String getFileCacheKey(uint md5Bytes, MD5Properties md5prop, const Common::Path &fname) {
 	Common::String hashname = md5PropToCachePrefix(md5prop);
 		hashname += ':';
 		hashname += fname.toString('/');
 		hashname += ':';
-		hashname += Common::String::format("%d", _md5Bytes);
+		hashname += Common::String::format("%d", md5Bytes);
+	return hashname;
+}
+
+/**
+ * Compute the key of a file in the on-disk cache, along with the size and
+ * modification time validating the cached entry. Mac forks may be backed
+ * by several files on the host, so they are never stored on disk.
+ */
+static bool getPersistentCacheKey(uint md5Bytes, const AdvancedMetaEngine::FileMap &allFiles, MD5Properties md5prop, const Common::Path &fname, Common::String &key, Common::Path &hostPath, int64 &fileSize, int64 &modificationTime) {
+	if (md5prop & (kMD5MacResFork | kMD5MacDataFork))
+		return false;
+
+	Common::Path hostName = fname;
+	Common::String member;
+
+	if (md5prop & kMD5Archive) {
+		Common::StringTokenizer tok(fname.toString(), ":");
+		Common::String archiveType = tok.nextToken();
+		hostName = Common::Path(tok.nextToken());
+		member = archiveType + ':' + tok.nextToken();
+	}
+
+	AdvancedMetaEngine::FileMap::const_iterator file = allFiles.find(hostName);
+	if (file == allFiles.end())
+		return false;
+
+	if (!file->_value.getFileStatus(fileSize, modificationTime))
+		return false;
+
+	hostPath = file->_value.getPath();
+	key = getFileCacheKey(md5Bytes, md5prop, hostPath);
+	if (!member.empty()) {
+		key += ':';
+		key += member;
+	}
+	return true;
+}
+
+bool AdvancedMetaEngineDetection::getCachedFileProperties(const FileMap &allFiles, MD5Properties md5prop, const Common::Path &fname, FileProperties &fileProps) const {
+	Common::String hashname = getFileCacheKey(_md5Bytes, md5prop, fname);
 
 	if (ADCacheMan.containsMD5(hashname)) {
 		fileProps.md5 = ADCacheMan.getMD5(hashname);
@@ -594,13 +799,40 @@ bool AdvancedMetaEngineDetection::getFileProperties(const FileMap &allFiles, MD5
 		return true;
 	}
 
-	bool res = getFilePropertiesIntern(_md5Bytes, allFiles, md5prop, fname, fileProps);
-
-	if (res) {
+	Common::String key;
+	Common::Path hostPath;
+	int64 fileSize, modificationTime;
+	if (getPersistentCacheKey(_md5Bytes, allFiles, md5prop, fname, key, hostPath, fileSize, modificationTime) &&
+			ADCacheMan.getPersistentProperties(key, fileSize, modificationTime, fileProps)) {
 		ADCacheMan.setMD5(hashname, fileProps.md5);
 		ADCacheMan.setSize(hashname, fileProps.size);
+		return true;
 	}
 
+	return false;
+}
+
+void AdvancedMetaEngineDetection::cacheFileProperties(const FileMap &allFiles, MD5Properties md5prop, const Common::Path &fname, const FileProperties &fileProps) const {
+	Common::String hashname = getFileCacheKey(_md5Bytes, md5prop, fname);
+	ADCacheMan.setMD5(hashname, fileProps.md5);
+	ADCacheMan.setSize(hashname, fileProps.size);
+
+	Common::String key;
+	Common::Path hostPath;
+	int64 fileSize, modificationTime;
+	if (getPersistentCacheKey(_md5Bytes, allFiles, md5prop, fname, key, hostPath, fileSize, modificationTime))
+		ADCacheMan.setPersistentProperties(key, hostPath, fileSize, modificationTime, fileProps);
+}
+
+bool AdvancedMetaEngineDetection::getFileProperties(const FileMap &allFiles, MD5Properties md5prop, const Common::Path &fname, FileProperties &fileProps) const {
+	if (getCachedFileProperties(allFiles, md5prop, fname, fileProps))
+		return true;
+
+	bool res = getFilePropertiesIntern(_md5Bytes, allFiles, md5prop, fname, fileProps);
+
+	if (res)
+		cacheFileProperties(allFiles, md5prop, fname, fileProps);
+
 	return res;
 }
 
@@ -608,6 +840,17 @@ bool AdvancedMetaEngine::getFilePropertiesExtern(uint md5Bytes, const FileMap &a
 	return getFilePropertiesIntern(md5Bytes, allFiles, md5prop, fname, fileProps);
 }
 
+static void computeStreamProperties(uint md5Bytes, Common::SeekableReadStream &stream, MD5Properties md5prop, FileProperties &fileProps) {
+	if (md5prop & kMD5Tail) {
+		if (stream.size() > md5Bytes)
+			stream.seek(-(int64)md5Bytes, SEEK_END);
+	}
+
+	fileProps.size = stream.size();
+	fileProps.md5 = Common::computeStreamMD5AsString(stream, md5Bytes);
+	fileProps.md5prop = (MD5Properties) (md5prop & kMD5Tail);
+}
+
 static bool getFilePropertiesIntern(uint md5Bytes, const AdvancedMetaEngine::FileMap &allFiles, MD5Properties md5prop, const Common::Path &fname, FileProperties &fileProps) {
 	if (md5prop & (kMD5MacResFork | kMD5MacDataFork)) {
 		FileMapArchive fileMapArchive(allFiles);
@@ -700,14 +943,7 @@ static bool getFilePropertiesIntern(uint md5Bytes, const AdvancedMetaEngine::Fil
 			return false;
 	}
 
-	if (md5prop & kMD5Tail) {
-		if (testFile->size() > md5Bytes)
-			testFile->seek(-(int64)md5Bytes, SEEK_END);
-	}
-
-	fileProps.size = testFile->size();
-	fileProps.md5 = Common::computeStreamMD5AsString(*testFile.get(), md5Bytes);
-	fileProps.md5prop = (MD5Properties) (md5prop & kMD5Tail);
+	computeStreamProperties(md5Bytes, *testFile, md5prop, fileProps);
 	return true;
 }
 
@@ -775,6 +1011,20 @@ ADDetectedGames AdvancedMetaEngineDetection::detectGame(const Common::FSNode &pa
 
 	preprocessDescriptions();
 
+	// Plain files missing from the caches, grouped by the file they refer
+	// to. Each group is hashed by one job, so no FSNode is shared between
+	// threads.
+	struct PendingFile {
+		Common::String key;
+		MD5Properties md5prop;
+		Common::Path fname;
+		Common::FSNode node;
+		FileProperties props;
+		bool found;
+	};
+	Common::Array<Common::Array<PendingFile> > pendingGroups;
+	Common::HashMap<Common::String, uint> pendingGroupIndex;
+
 	// Check which files are included in some ADGameDescription *and* whether
 	// they are present. Compute MD5s and file sizes for the available files.
 	for (descPtr = _gameDescriptors; ((const ADGameDescription *)descPtr)->gameId != nullptr; descPtr += _descItemSize) {
@@ -790,14 +1040,71 @@ ADDetectedGames AdvancedMetaEngineDetection::detectGame(const Common::FSNode &pa
 			if (filesProps.contains(key))
 				continue;
 
-			FileProperties tmp;
-			if (getFileProperties(allFiles, md5prop, Common::Path(fname), tmp)) {
-				debugC(3, kDebugGlobalDetection, "> '%s': '%s' %ld", key.c_str(), tmp.md5.c_str(), long(tmp.size));
-			}
-
 			// Both positive and negative results are cached to avoid
 			// repeatedly checking for files.
+			FileProperties tmp;
 			filesProps[key] = tmp;
+
+			if (getCachedFileProperties(allFiles, md5prop, Common::Path(fname), tmp)) {
+				debugC(3, kDebugGlobalDetection, "> '%s': '%s' %ld (cached)", key.c_str(), tmp.md5.c_str(), long(tmp.size));
+				filesProps[key] = tmp;
+				continue;
+			}
+
+			// Mac forks and archive members are looked up through shared
+			// state, they are computed on this thread
+			if (md5prop & (kMD5MacResFork | kMD5MacDataFork | kMD5Archive)) {
+				if (getFileProperties(allFiles, md5prop, Common::Path(fname), tmp)) {
+					debugC(3, kDebugGlobalDetection, "> '%s': '%s' %ld", key.c_str(), tmp.md5.c_str(), long(tmp.size));
+					filesProps[key] = tmp;
+				}
+				continue;
+			}
+
+			FileMap::const_iterator file = allFiles.find(Common::Path(fname));
+			if (file == allFiles.end() || file->_value.isDirectory())
+				continue;
+
+			PendingFile pending;
+			pending.key = key;
+			pending.md5prop = md5prop;
+			pending.fname = Common::Path(fname);
+			pending.node = file->_value;
+			pending.found = false;
+
+			Common::String nodePath = file->_value.getPath().toString();
+			if (!pendingGroupIndex.contains(nodePath)) {
+				pendingGroupIndex[nodePath] = pendingGroups.size();
+				pendingGroups.push_back(Common::Array<PendingFile>());
+			}
+			pendingGroups[pendingGroupIndex[nodePath]].push_back(pending);
+		}
+	}
+
+	uint md5Bytes = _md5Bytes;
+	g_system->getJobManager()->parallelFor(pendingGroups.size(), [&](uint begin, uint end) {
+		for (uint i = begin; i < end; i++) {
+			for (uint j = 0; j < pendingGroups[i].size(); j++) {
+				PendingFile &pending = pendingGroups[i][j];
+				Common::ScopedPtr<Common::SeekableReadStream> stream(pending.node.createReadStream());
+				if (!stream)
+					continue;
+
+				computeStreamProperties(md5Bytes, *stream, pending.md5prop, pending.props);
+				pending.found = true;
+			}
+		}
+	});
+
+	for (uint i = 0; i < pendingGroups.size(); i++) {
+		for (uint j = 0; j < pendingGroups[i].size(); j++) {
+			const PendingFile &pending = pendingGroups[i][j];
+			if (!pending.found)
+				continue;
+
+			debugC(3, kDebugGlobalDetection, "> '%s': '%s' %ld", pending.key.c_str(), pending.props.md5.c_str(), long(pending.props.size));
+			cacheFileProperties(allFiles, pending.md5prop, pending.fname, pending.props);
+			filesProps[pending.key] = pending.props;
 		}
 	}
 
@@ -472,6 +472,12 @@ protected:
 	/** Get the properties (size and MD5) of this file. */
 	bool getFileProperties(const FileMap &allFiles, MD5Properties md5prop, const Common::Path &fname, FileProperties &fileProps) const;
 
+	/** Look up the properties of this file in the detection caches. */
+	bool getCachedFileProperties(const FileMap &allFiles, MD5Properties md5prop, const Common::Path &fname, FileProperties &fileProps) const;
+
+	/** Store the properties of this file in the detection caches. */
+	void cacheFileProperties(const FileMap &allFiles, MD5Properties md5prop, const Common::Path &fname, const FileProperties &fileProps) const;
+
 	/** Convert an AD game description into the shared game description format. */
 	virtual DetectedGame toDetectedGame(const ADDetectedGame &adGame, ADDetectedGameExtraInfo *extraInfo = nullptr) const;
 
@@ -612,7 +618,37 @@ public:
 		return archiveHashMap.getValOrDefault(node.getPath(), nullptr);
 	}
 
-	AdvancedDetectorCacheManager() {
+	/**
+	 * Look up file properties in the on-disk cache, which survives between
+	 * detection runs. An entry is only returned if the file still has the
+	 * size and modification time it had when the entry was stored.
+	 */
+	bool getPersistentProperties(const Common::String &key, int64 fileSize, int64 modificationTime, FileProperties &fileProps);
+
+	/** Record file properties of the file at @p path on the host in the on-disk cache. */
+	void setPersistentProperties(const Common::String &key, const Common::Path &path, int64 fileSize, int64 modificationTime, const FileProperties &fileProps);
+
+	/**
+	 * Write the on-disk cache if it changed. Does nothing while a batch is
+	 * running, the cache is then written by endBatch().
+	 */
+	void flushPersistentCache();
+
+	/**
+	 * Drop the entries of files below @p dir which no longer exist. Meant to
+	 * be called once a scan of the whole directory has finished, as this
+	 * checks every such file on the host.
+	 */
+	void prunePersistentCache(const Common::Path &dir);
+
+	/**
+	 * Delay writing the on-disk cache for callers running many detections
+	 * in a row, like the mass add dialog. Calls may be nested.
+	 */
+	void beginBatch() { _batchDepth++; }
+	void endBatch();
+
+	AdvancedDetectorCacheManager() : _batchDepth(0), _persistentLoaded(false), _persistentDirty(false) {
 		clear();
 	}
 
@@ -638,6 +674,23 @@ private:
 	FileHashMap md5HashMap;
 	SizeHashMap sizeHashMap;
 	ArchiveHashMap archiveHashMap;
+
+	struct PersistentEntry {
+		Common::Path path;  /*!< File on the host, the entry is dropped once it is gone */
+		int64 fileSize;
+		int64 modificationTime;
+		FileProperties props;
+	};
+
+	// Keys contain absolute paths, which may be case sensitive
+	typedef Common::HashMap<Common::String, PersistentEntry> PersistentHashMap;
+
+	void loadPersistentCache();
+
+	PersistentHashMap persistentHashMap;
+	int _batchDepth;
+	bool _persistentLoaded;
+	bool _persistentDirty;
 };
 
 /** Convenience shortcut for accessing the MD5CacheManager. */
@@ -112,6 +112,7 @@ public:
 bool BuriedMetaEngine::hasFeature(MetaEngineFeature f) const {
 	return
 		(f == kSupportsLoadingDuringStartup) ||
+		(f == kSavesSupportBackgroundLoading) ||
 		checkExtendedSaves(f);
 }
 
@@ -73,6 +73,7 @@ public:
 bool ChewyMetaEngine::hasFeature(MetaEngineFeature f) const {
 	return
 		(f == kSupportsLoadingDuringStartup) ||
+		(f == kSavesSupportBackgroundLoading) ||
 		checkExtendedSaves(f);
 }
 
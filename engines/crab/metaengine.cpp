@@ -71,7 +71,8 @@ Common::KeymapArray CrabMetaEngine::initKeymaps(const char *target) const {
 }
 
 bool CrabMetaEngine::hasFeature(MetaEngineFeature f) const {
-	return checkExtendedSaves(f);
+	return (f == kSavesSupportBackgroundLoading) ||
+		checkExtendedSaves(f);
 }
 
 int CrabMetaEngine::getMaximumSaveSlot() const {
@@ -31,6 +31,7 @@ public:
 	bool hasFeature(MetaEngineFeature f) const override {
 		return
 			(f == kSupportsLoadingDuringStartup) ||
+			(f == kSavesSupportBackgroundLoading) ||
 			checkExtendedSaves(f);
 	}
 
@@ -42,7 +42,8 @@ Common::Error Hpl1MetaEngine::createInstance(OSystem *syst, Engine **engine, con
 
 bool Hpl1MetaEngine::hasFeature(MetaEngineFeature f) const {
 	return checkExtendedSaves(f) ||
-		   (f == kSupportsLoadingDuringStartup);
+		   (f == kSupportsLoadingDuringStartup) ||
+		   (f == kSavesSupportBackgroundLoading);
 }
 
 void Hpl1MetaEngine::getSavegameThumbnail(Graphics::Surface &thumbnail) {
@@ -39,7 +39,8 @@ bool ImmortalMetaEngine::hasFeature(MetaEngineFeature f) const {
 	       (f == kSupportsDeleteSave) ||
 	       (f == kSavesSupportMetaInfo) ||
 	       (f == kSavesSupportThumbnail) ||
-	       (f == kSupportsLoadingDuringStartup);
+	       (f == kSupportsLoadingDuringStartup) ||
+	       (f == kSavesSupportBackgroundLoading);
 }
 
 #if PLUGIN_ENABLED_DYNAMIC(IMMORTAL)
@@ -490,7 +490,17 @@ public:
 		 * - kSavesSupportCreationDate
 		 * - kSavesSupportPlayTime
 		 */
-		kSavesUseExtendedFormat
+		kSavesUseExtendedFormat,
+
+		/**
+		 * The meta infos of saves are those read by the default
+		 * querySaveMetaInfos(), so the save/load choosers may decode them on
+		 * worker threads instead.
+		 *
+		 * This flag requires kSavesUseExtendedFormat. Engines overriding
+		 * querySaveMetaInfos() must not set it.
+		 */
+		kSavesSupportBackgroundLoading
 	};
 
 	/**
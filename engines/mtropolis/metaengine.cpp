@@ -144,7 +144,8 @@ public:
 };
 
 bool MTropolisMetaEngine::hasFeature(MetaEngineFeature f) const {
-	return checkExtendedSaves(f);
+	return (f == kSavesSupportBackgroundLoading) ||
+		checkExtendedSaves(f);
 }
 
 Common::Error MTropolisMetaEngine::createInstance(OSystem *syst, Engine **engine, const ADGameDescription *desc) const {
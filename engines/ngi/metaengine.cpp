@@ -68,7 +68,7 @@ public:
 };
 
 bool NGIMetaEngine::hasFeature(MetaEngineFeature f) const {
-	return checkExtendedSaves(f) || (f == kSupportsLoadingDuringStartup);
+	return checkExtendedSaves(f) || (f == kSupportsLoadingDuringStartup) || (f == kSavesSupportBackgroundLoading);
 }
 
 bool NGI::NGIEngine::hasFeature(EngineFeature f) const {
@@ -35,6 +35,7 @@ public:
 bool Saga2MetaEngine::hasFeature(MetaEngineFeature f) const {
 	return
 		(f == kSupportsLoadingDuringStartup) ||
+		(f == kSavesSupportBackgroundLoading) ||
 		checkExtendedSaves(f);
 }
 
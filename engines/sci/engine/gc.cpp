@@ -98,11 +98,9 @@ static void processWorkList(SegManager *segMan, WorklistManager &wm, const Commo
 	}
 }
 
-AddrSet *findAllActiveReferences(EngineState *s) {
+static void markActiveReferences(EngineState *s, WorklistManager &wm) {
 	assert(!s->_executionStack.empty());
 
-	WorklistManager wm;
-
 	// Initialize registers
 	wm.push(s->r_acc);
 	wm.push(s->r_prev);
@@ -174,11 +172,20 @@ AddrSet *findAllActiveReferences(EngineState *s) {
 
 	if (g_sci->_gfxPorts)
 		g_sci->_gfxPorts->processEngineHunkList(wm);
+}
 
+AddrSet *findAllActiveReferences(EngineState *s) {
+	WorklistManager wm;
+	markActiveReferences(s, wm);
 	return normalizeAddresses(s->_segMan, wm._map);
 }
 
-void run_gc(EngineState *s) {
+/**
+ * Finds the unreachable objects and adds them to `garbage`, apart from
+ * scripts. The objects are not freed yet, so that this can be spread over
+ * several kernel calls.
+ */
+static void findGarbage(EngineState *s, Common::Array<reg_t> &garbage) {
 	SegManager *segMan = s->_segMan;
 
 	// Some debug stuff
@@ -191,11 +198,26 @@ void run_gc(EngineState *s) {
 #endif
 
 	// Compute the set of all segments references currently in use.
-	AddrSet *activeRefs = findAllActiveReferences(s);
+	WorklistManager wm;
+	markActiveReferences(s, wm);
+
+	// The deallocatable objects are their own canonic address, so only the
+	// references which are not need to be normalised. These are mostly
+	// references to script objects, which all map to a handful of scripts.
+	const Common::Array<SegmentObj *> &heap = segMan->getSegments();
+	AddrSet canonicRefs;
+	for (AddrSet::const_iterator i = wm._map.begin(); i != wm._map.end(); ++i) {
+		const reg_t reg = i->_key;
+		SegmentObj *mobj = segMan->getSegmentObj(reg.getSegment());
+		if (mobj) {
+			const reg_t canonic = mobj->findCanonicAddress(segMan, reg);
+			if (canonic != reg)
+				canonicRefs.setVal(canonic, true);
+		}
+	}
 
 	// Iterate over all segments, and check for each whether it
 	// contains stuff that can be collected.
-	const Common::Array<SegmentObj *> &heap = segMan->getSegments();
 	for (uint seg = 1; seg < heap.size(); seg++) {
 		SegmentObj *mobj = heap[seg];
 
@@ -206,14 +228,24 @@ void run_gc(EngineState *s) {
 #endif
 
 			// Get a list of all deallocatable objects in this segment,
-			// then free any which are not referenced from somewhere.
+			// then note any which are not referenced from somewhere.
 			const Common::Array<reg_t> tmp = mobj->listAllDeallocatable(seg);
 			for (Common::Array<reg_t>::const_iterator it = tmp.begin(); it != tmp.end(); ++it) {
 				const reg_t addr = *it;
-				if (!activeRefs->contains(addr)) {
-					// Not found -> we can free it
-					mobj->freeAtAddress(segMan, addr);
-					debugC(kDebugLevelGC, "[GC] Deallocating %04x:%04x", PRINT_REG(addr));
+				if (!wm._map.contains(addr) && !canonicRefs.contains(addr)) {
+					// Not found -> we can free it. Scripts are freed right
+					// away, since a script which is loaded again and then
+					// unloaded would still be marked as deleted later on.
+					if (mobj->getType() == SEG_TYPE_SCRIPT) {
+						mobj->freeAtAddress(segMan, addr);
+						debugC(kDebugLevelGC, "[GC] Deallocating %04x:%04x", PRINT_REG(addr));
+					} else {
+						// Unreachable clones are still found by name until
+						// they are freed, so hide them from these lookups
+						if (mobj->getType() == SEG_TYPE_CLONES)
+							(*(CloneTable *)mobj)[addr.getOffset()].markAsGarbage();
+						garbage.push_back(addr);
+					}
 #ifdef GC_DEBUG_CODE
 					segcount[type]++;
 #endif
@@ -223,8 +255,6 @@ void run_gc(EngineState *s) {
 		}
 	}
 
-	delete activeRefs;
-
 #ifdef GC_DEBUG_CODE
 	// Output debug summary of garbage collection
 	debugC(kDebugLevelGC, "[GC] Summary:");
@@ -234,4 +264,39 @@ void run_gc(EngineState *s) {
 #endif
 }
 
+/**
+ * Frees up to `count` of the objects found by findGarbage().
+ */
+static void freeGarbage(SegManager *segMan, Common::Array<reg_t> &garbage, uint count) {
+	const Common::Array<SegmentObj *> &heap = segMan->getSegments();
+	while (count-- && !garbage.empty()) {
+		const reg_t addr = garbage.back();
+		garbage.pop_back();
+
+		// Unreachable objects stay unreachable, but their segment may be gone
+		// since, e.g. the locals of a freed script
+		SegmentObj *mobj = addr.getSegment() < heap.size() ? heap[addr.getSegment()] : nullptr;
+		if (mobj && mobj->isValidOffset(addr.getOffset())) {
+			mobj->freeAtAddress(segMan, addr);
+			debugC(kDebugLevelGC, "[GC] Deallocating %04x:%04x", PRINT_REG(addr));
+		}
+	}
+}
+
+void run_gc(EngineState *s) {
+	// Objects left over from the last step are found again
+	s->_gcGarbage.clear();
+	findGarbage(s, s->_gcGarbage);
+	freeGarbage(s->_segMan, s->_gcGarbage, s->_gcGarbage.size());
+}
+
+void run_gc_step(EngineState *s) {
+	if (s->_gcGarbage.empty()) {
+		s->gcCountDown = s->scriptGCInterval;
+		findGarbage(s, s->_gcGarbage);
+	}
+
+	freeGarbage(s->_segMan, s->_gcGarbage, GC_FREE_STEP);
+}
+
 } // End of namespace Sci
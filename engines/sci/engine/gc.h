@@ -49,11 +49,20 @@ typedef Common::HashMap<reg_t, bool, reg_t_Hash> AddrSet;
 AddrSet *findAllActiveReferences(EngineState *s);
 
 /**
- * Runs garbage collection on the current system state
+ * Runs garbage collection on the current system state, freeing all the
+ * unreachable objects at once
  * @param s The state in which we should gc
  */
 void run_gc(EngineState *s);
 
+/**
+ * Runs a step of garbage collection on the current system state. The first
+ * step finds the unreachable objects, this step and the following ones free
+ * GC_FREE_STEP of them each.
+ * @param s The state in which we should gc
+ */
+void run_gc_step(EngineState *s);
+
 struct WorklistManager {
 	Common::Array<reg_t> _worklist;
 	AddrSet _map;	// used for 2 contains() calls, inside push() and run_gc()
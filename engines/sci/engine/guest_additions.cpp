@@ -388,6 +388,7 @@ static void patchKSaveRestore(SegManager *segMan, reg_t methodAddress, byte id)
 	byte *patchPtr = const_cast<byte *>(script->getBuf(methodAddress.getOffset()));
 	memcpy(patchPtr, kSaveRestorePatch, sizeof(kSaveRestorePatch));
 	patchPtr[8] = id;
+	script->invalidateInstructions();
 }
 
 void GuestAdditions::patchGameSaveRestoreSCI16() const {
@@ -492,6 +493,7 @@ void GuestAdditions::patchGameSaveRestoreTorin(Script &script) const {
 		SWAP(patchPtr[1], patchPtr[2]);
 		SWAP(patchPtr[7], patchPtr[8]);
 	}
+	script.invalidateInstructions();
 }
 
 void GuestAdditions::patchGameSaveRestorePhant2(Script &script) const {
@@ -510,6 +512,7 @@ void GuestAdditions::patchGameSaveRestorePhant2(Script &script) const {
 
 		byte *scriptData = const_cast<byte *>(script.getBuf(obj.getFunction(methodIndex).getOffset()));
 		memcpy(scriptData, SRDialogPatch, sizeof(SRDialogPatch));
+		script.invalidateInstructions();
 		break;
 	}
 }
@@ -552,6 +555,7 @@ void GuestAdditions::patchSRDialogDoit(Script &script, const char *const objectN
 					}
 				}
 
+				script.invalidateInstructions();
 				return;
 			}
 		}
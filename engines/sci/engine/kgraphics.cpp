@@ -19,6 +19,7 @@
  *
  */
 
+#include "common/profiler.h"
 #include "common/system.h"
 #include "common/translation.h"
 
@@ -1219,6 +1220,7 @@ reg_t kNewWindow(EngineState *s, int argc, reg_t *argv) {
 }
 
 reg_t kAnimate(EngineState *s, int argc, reg_t *argv) {
+	PROFILE_ZONE("Sci::kAnimate");
 	reg_t castListReference = (argc > 0) ? argv[0] : NULL_REG;
 	bool cycle = (argc > 1) ? ((argv[1].toUint16()) ? true : false) : false;
 
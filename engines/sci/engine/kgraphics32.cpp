@@ -19,6 +19,7 @@
  *
  */
 
+#include "common/profiler.h"
 #include "common/system.h"
 #include "common/translation.h"
 
@@ -244,6 +245,7 @@ reg_t kGetHighPlanePri(EngineState *s, int argc, reg_t *argv) {
 }
 
 reg_t kFrameOut(EngineState *s, int argc, reg_t *argv) {
+	PROFILE_ZONE("Sci::kFrameOut");
 	bool showBits = argc > 0 ? argv[0].toUint16() : true;
 	g_sci->_gfxFrameout->kernelFrameOut(showBits);
 	s->_eventCounter = 0;
@@ -242,6 +242,12 @@ reg_t kMemorySegment(EngineState *s, int argc, reg_t *argv) {
 }
 
 reg_t kFlushResources(EngineState *s, int argc, reg_t *argv) {
+	// Read the resources of the new room while the garbage is collected.
+	// The argument of kPurge is an amount of memory, not a room number.
+	if (getSciVersion() >= SCI_VERSION_2)
+		g_sci->getResMan()->prefetchRoomResources(s->variables[VAR_GLOBAL][kGlobalVarNewRoomNo].toUint16());
+	else
+		g_sci->getResMan()->prefetchRoomResources(argv[0].toUint16());
 	run_gc(s);
 	debugC(kDebugLevelRoom, "Entering room number %d", argv[0].toUint16());
 	return s->r_acc;
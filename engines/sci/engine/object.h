@@ -72,6 +72,7 @@ public:
 		_name(NULL_REG),
 		_offset(getSciVersion() < SCI_VERSION_1_1 ? 0 : 5),
 		_isFreed(false),
+		_isGarbage(false),
 		_methodCount(0),
 	    _pos(NULL_REG)
 #ifdef ENABLE_SCI32
@@ -269,6 +270,9 @@ public:
 	void markAsFreed() { _isFreed = true; }
 	bool isFreed() const { return _isFreed; }
 
+	void markAsGarbage() { _isGarbage = true; }
+	bool isGarbage() const { return _isGarbage; }
+
 	uint getVarCount() const { return _variables.size(); }
 
 	void init(const Script &owner, reg_t obj_pos, bool initVariables = true);
@@ -361,6 +365,12 @@ private:
 	 */
 	bool _isFreed;
 
+	/**
+	 * Whether or not a clone object was found to be unreachable by the garbage
+	 * collector and waits to be freed by run_gc_step().
+	 */
+	bool _isGarbage;
+
 	/**
 	 * For SCI0 through SCI2.1, an extra index offset used when looking up
 	 * special object properties -species-, -super-, -info-, and name.
@@ -74,6 +74,18 @@ void Script::freeScript(const bool keepLocalsSegment) {
 	_offsetLookupObjectCount = 0;
 	_offsetLookupStringCount = 0;
 	_offsetLookupSaidCount = 0;
+
+	invalidateInstructions();
+}
+
+const ScriptInstruction &Script::decodeInstruction(uint32 offset) {
+	ScriptInstruction &instruction = _instructions.getOrCreateVal(offset);
+	instruction.size = readPMachineInstruction(getBuf(offset), instruction.extOpcode, instruction.opparams);
+	return instruction;
+}
+
+void Script::invalidateInstructions() {
+	_instructions.clear();
 }
 
 enum {
@@ -68,6 +68,13 @@ struct offsetLookupArrayEntry {
 
 typedef Common::Array<offsetLookupArrayEntry> offsetLookupArrayType;
 
+/** A PMachine instruction, as read by readPMachineInstruction(). */
+struct ScriptInstruction {
+	byte extOpcode;     /**< "extended" opcode */
+	uint16 size;        /**< Length of the instruction in bytes */
+	int16 opparams[4];
+};
+
 class Script : public SegmentObj {
 private:
 	int _nr; /**< Script number */
@@ -101,6 +108,16 @@ private:
 	uint16 _offsetLookupStringCount;
 	uint16 _offsetLookupSaidCount;
 
+	/**
+	 * Instructions decoded so far, by offset. Only a small part of the
+	 * buffer is code which actually runs, so this is not indexed by every
+	 * offset of the buffer.
+	 */
+	typedef Common::HashMap<uint32, ScriptInstruction> InstructionMap;
+	InstructionMap _instructions;
+
+	const ScriptInstruction &decodeInstruction(uint32 offset);
+
 public:
 	int getLocalsOffset() const { return _localsOffset; }
 	uint16 getLocalsCount() const { return _localsCount; }
@@ -126,6 +143,23 @@ public:
 	ObjMap &getObjectMap() { return _objects; }
 	const ObjMap &getObjectMap() const { return _objects; }
 
+	/**
+	 * Get the instruction at the given offset. Instructions are decoded
+	 * the first time they are executed, and kept until the script is freed
+	 * or invalidateInstructions() is called.
+	 *
+	 * The reference is only valid until the instructions are forgotten.
+	 */
+	const ScriptInstruction &getInstruction(uint32 offset) {
+		InstructionMap::const_iterator instruction = _instructions.find(offset);
+		if (instruction != _instructions.end())
+			return instruction->_value;
+		return decodeInstruction(offset);
+	}
+
+	/** Forget the decoded instructions, after the code has been patched. */
+	void invalidateInstructions();
+
 	// speed optimization: inline due to frequent calling
 	bool offsetIsObject(uint32 offset) const {
 		return _buf->getUint16SEAt(offset + SCRIPT_OBJECT_MAGIC_OFFSET) == SCRIPT_OBJECT_MAGIC_NUMBER;
@@ -314,7 +314,8 @@ Common::Array<reg_t> SegManager::findObjectsByName(const Common::String &name) {
 			// It's clone table, scan all objects in it
 			const CloneTable *ct = (const CloneTable *)mobj;
 			for (uint idx = 0; idx < ct->size(); ++idx) {
-				if (!ct->isValidEntry(idx))
+				// Skip the clones which wait to be freed by the garbage collector
+				if (!ct->isValidEntry(idx) || (*ct)[idx].isGarbage())
 					continue;
 
 				objpos.setOffset(idx);
@@ -381,7 +382,8 @@ Common::Array<reg_t> SegManager::findObjectsBySuperClass(const Common::String &s
 			// It's clone table, scan all objects in it
 			const CloneTable *ct = (const CloneTable *)mobj;
 			for (uint idx = 0; idx < ct->size(); ++idx) {
-				if (!ct->isValidEntry(idx))
+				// Skip the clones which wait to be freed by the garbage collector
+				if (!ct->isValidEntry(idx) || (*ct)[idx].isGarbage())
 					continue;
 
 				objpos.setOffset(idx);
@@ -188,6 +188,7 @@ struct EngineState : public Common::Serializable {
 	void shrinkStackToBase();
 
 	int gcCountDown; /**< Number of kernel calls until next gc */
+	Common::Array<reg_t> _gcGarbage; /**< Unreachable objects still to be freed by run_gc_step() */
 
 	MessageState *_msgState;
 
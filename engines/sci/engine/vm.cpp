@@ -565,6 +565,8 @@ void run_vm(EngineState *s) {
 
 	s->_executionStackPosChanged = true; // Force initialization
 
+	Console *con = g_sci->getSciDebugger();
+
 #ifdef ABORT_ON_INFINITE_LOOP
 	byte prevOpcode = 0xFF;
 #endif
@@ -601,16 +603,18 @@ void run_vm(EngineState *s) {
 			s->variables[VAR_PARAM] = s->xs->variables_argp;
 		}
 
-		g_sci->checkAddressBreakpoint(s->xs->addr.pc);
+		// Only go through the debugger when it has something to do
+		if (g_sci->_debugState.debugging || (g_sci->_debugState._activeBreakpointTypes & BREAK_ADDRESS) || con->isAttached()) {
+			g_sci->checkAddressBreakpoint(s->xs->addr.pc);
 
-		// Debug if this has been requested:
-		// TODO: re-implement sci_debug_flags
-		if (g_sci->_debugState.debugging /* sci_debug_flags*/) {
-			g_sci->scriptDebug();
-			g_sci->_debugState.breakpointWasHit = false;
+			// Debug if this has been requested:
+			// TODO: re-implement sci_debug_flags
+			if (g_sci->_debugState.debugging /* sci_debug_flags*/) {
+				g_sci->scriptDebug();
+				g_sci->_debugState.breakpointWasHit = false;
+			}
+			con->onFrame();
 		}
-		Console *con = g_sci->getSciDebugger();
-		con->onFrame();
 
 		if (s->xs->sp < s->xs->fp)
 			error("run_vm(): stack underflow, sp: %04x:%04x, fp: %04x:%04x",
@@ -620,9 +624,12 @@ void run_vm(EngineState *s) {
 			error("run_vm(): program counter gone astray, addr: %d, code buffer size: %d",
 			s->xs->addr.pc.getOffset(), scr->getBufSize());
 
-		// Get opcode
-		byte extOpcode;
-		s->xs->addr.pc.incOffset(readPMachineInstruction(scr->getBuf(s->xs->addr.pc.getOffset()), extOpcode, opparams));
+		// Get opcode. The instruction is copied, since the cached one can
+		// move when a kernel call runs more code of this script.
+		const ScriptInstruction &instruction = scr->getInstruction(s->xs->addr.pc.getOffset());
+		const byte extOpcode = instruction.extOpcode;
+		memcpy(opparams, instruction.opparams, sizeof(opparams));
+		s->xs->addr.pc.incOffset(instruction.size);
 		const byte opcode = extOpcode >> 1;
 		//debug("%s: %d, %d, %d, %d, acc = %04x:%04x, script %d, local script %d", opcodeNames[opcode], opparams[0], opparams[1], opparams[2], opparams[3], PRINT_REG(s->r_acc), scr->getScriptNumber(), local_script->getScriptNumber());
 
@@ -848,9 +855,8 @@ void run_vm(EngineState *s) {
 
 		case op_callk: { // 0x21 (33)
 			// Run the garbage collector, if needed
-			if (s->gcCountDown-- <= 0) {
-				s->gcCountDown = s->scriptGCInterval;
-				run_gc(s);
+			if (s->gcCountDown-- <= 0 || !s->_gcGarbage.empty()) {
+				run_gc_step(s);
 			}
 
 			// Call kernel function
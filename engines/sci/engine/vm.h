@@ -192,6 +192,11 @@ enum {
 	GC_INTERVAL = 0x8000
 };
 
+/** Number of unreachable objects freed per kernel call after a gc */
+enum {
+	GC_FREE_STEP = 32
+};
+
 enum SciOpcodes {
 	op_bnot     = 0x00,	// 000
 	op_add      = 0x01,	// 001
@@ -19,6 +19,7 @@
  *
  */
 
+#include "sci/console.h"
 #include "sci/resource/resource.h"
 #include "sci/engine/features.h"
 #include "sci/engine/seg_manager.h"
@@ -88,9 +89,18 @@ bool CelObj::_drawBlackLines = false;
 void CelObj::init() {
 	CelObj::deinit();
 	_drawBlackLines = false;
-	_nextCacheId = 1;
 	_scaler = new CelScaler();
-	_cache = new CelCache(100);
+
+	// SSCI kept the last 100 cels, whatever their size
+#if defined(__DS__) || defined(__3DS__) || defined(__PSP__) || defined(__DC__) || defined(__N64__)
+	uint32 cacheSize = 2 * 1024 * 1024; // 2MiB
+#else
+	uint32 cacheSize = 16 * 1024 * 1024; // 16MiB
+#endif
+	if (ConfMan.hasKey("cel_cache_size")) {
+		cacheSize = MAX(ConfMan.getInt("cel_cache_size"), 0) * 1024;
+	}
+	_cache = new CelCache(cacheSize);
 }
 
 void CelObj::deinit() {
@@ -686,45 +696,111 @@ void CelObj::submitPalette() const {
 #pragma mark -
 #pragma mark CelObj - Caching
 
-int CelObj::_nextCacheId = 1;
 CelCache *CelObj::_cache = nullptr;
 
-int CelObj::searchCache(const CelInfo32 &celInfo, int *const nextInsertIndex) const {
-	*nextInsertIndex = -1;
-	int oldestId = _nextCacheId + 1;
-	int oldestIndex = 0;
+const CelObj *CelObj::searchCache(const CelInfo32 &celInfo) const {
+	return _cache->find(celInfo);
+}
 
-	for (int i = 0, len = _cache->size(); i < len; ++i) {
-		CelCacheEntry &entry = (*_cache)[i];
+void CelObj::putCopyInCache() const {
+	_cache->insert(duplicate());
+}
 
-		if (entry.celObj == nullptr) {
-			if (*nextInsertIndex == -1) {
-				*nextInsertIndex = i;
-			}
-		} else if (entry.celObj->_info == celInfo) {
-			entry.id = ++_nextCacheId;
-			return i;
-		} else if (oldestId > entry.id) {
-			oldestId = entry.id;
-			oldestIndex = i;
-		}
+void CelObj::printCacheStatistics(Console *con) {
+	if (_cache == nullptr) {
+		con->debugPrintf("The cel cache is not in use\n");
+		return;
 	}
 
-	if (*nextInsertIndex == -1) {
-		*nextInsertIndex = oldestIndex;
+	const CelCache::Statistics &stats = _cache->getStatistics();
+	const uint32 lookups = stats.hits + stats.misses;
+	con->debugPrintf("Cels: %u, %u of %u KiB\n", _cache->getCount(), _cache->getSize() / 1024, _cache->getMaxSize() / 1024);
+	con->debugPrintf("Hits: %u, misses: %u, evictions: %u, hit rate: %u%%\n",
+		stats.hits, stats.misses, stats.evictions, lookups ? (uint)((uint64)stats.hits * 100 / lookups) : 0);
+}
+
+void CelObj::clearCache() {
+	if (_cache != nullptr) {
+		_cache->clear();
+		_cache->resetStatistics();
 	}
+}
 
-	return -1;
+CelCache::CelCache(const uint32 maxSize) :
+	_size(0),
+	_maxSize(maxSize) {
+	resetStatistics();
 }
 
-void CelObj::putCopyInCache(const int cacheIndex) const {
-	if (cacheIndex == -1) {
-		error("Invalid cache index");
+CelCache::~CelCache() {
+	clear();
+}
+
+const CelObj *CelCache::find(const CelInfo32 &celInfo) {
+	EntryMap::iterator it = _index.find(celInfo);
+	if (it == _index.end()) {
+		++_statistics.misses;
+		return nullptr;
 	}
 
-	CelCacheEntry &entry = (*_cache)[cacheIndex];
-	entry.celObj.reset(duplicate());
-	entry.id = ++_nextCacheId;
+	++_statistics.hits;
+	EntryList::iterator entry = it->_value;
+	if (entry != _entries.begin()) {
+		_entries.push_front(*entry);
+		_entries.erase(entry);
+		it->_value = _entries.begin();
+	}
+	return _entries.front().celObj;
+}
+
+void CelCache::insert(CelObj *celObj) {
+	EntryMap::iterator it = _index.find(celObj->_info);
+	if (it != _index.end()) {
+		_size -= it->_value->size;
+		delete it->_value->celObj;
+		_entries.erase(it->_value);
+	}
+
+	Entry entry;
+	entry.celObj = celObj;
+	entry.size = getEntrySize(*celObj);
+	_entries.push_front(entry);
+	_index[celObj->_info] = _entries.begin();
+	_size += entry.size;
+
+	// The new cel is kept even if it does not fit on its own, since the
+	// caller looks it up again right away on the next draw
+	evict(_maxSize > entry.size ? _maxSize : entry.size);
+}
+
+void CelCache::clear() {
+	for (EntryList::iterator it = _entries.begin(); it != _entries.end(); ++it) {
+		delete it->celObj;
+	}
+	_entries.clear();
+	_index.clear();
+	_size = 0;
+}
+
+void CelCache::resetStatistics() {
+	_statistics.hits = 0;
+	_statistics.misses = 0;
+	_statistics.evictions = 0;
+}
+
+uint32 CelCache::getEntrySize(const CelObj &celObj) {
+	return sizeof(CelObj) + celObj._width * celObj._height;
+}
+
+void CelCache::evict(const uint32 maxSize) {
+	while (_size > maxSize && !_entries.empty()) {
+		const Entry &entry = _entries.back();
+		_index.erase(entry.celObj->_info);
+		_size -= entry.size;
+		delete entry.celObj;
+		_entries.pop_back();
+		++_statistics.evictions;
+	}
 }
 
 #pragma mark -
@@ -971,16 +1047,13 @@ CelObjView::CelObjView(const GuiResourceId viewId, const int16 loopNo, const int
 	_compressionType = kCelCompressionInvalid;
 	_transparent = true;
 
-	int cacheInsertIndex;
-	const int cacheIndex = searchCache(_info, &cacheInsertIndex);
-	if (cacheIndex != -1) {
-		CelCacheEntry &entry = (*_cache)[cacheIndex];
-		const CelObjView *const cachedCelObj = dynamic_cast<CelObjView *>(entry.celObj.get());
+	const CelObj *const cachedEntry = searchCache(_info);
+	if (cachedEntry != nullptr) {
+		const CelObjView *const cachedCelObj = dynamic_cast<const CelObjView *>(cachedEntry);
 		if (cachedCelObj == nullptr) {
-			error("Expected a CelObjView in cache slot %d", cacheIndex);
+			error("Expected a CelObjView in the cel cache for %s", _info.toString().c_str());
 		}
 		*this = *cachedCelObj;
-		entry.id = ++_nextCacheId;
 		return;
 	}
 
@@ -1078,7 +1151,7 @@ CelObjView::CelObjView(const GuiResourceId viewId, const int16 loopNo, const int
 		_remap = analyzeForRemap();
 	}
 
-	putCopyInCache(cacheInsertIndex);
+	putCopyInCache();
 }
 
 bool CelObjView::analyzeUncompressedForRemap() const {
@@ -1179,16 +1252,13 @@ CelObjPic::CelObjPic(const GuiResourceId picId, const int16 celNo) {
 	_transparent = true;
 	_remap = false;
 
-	int cacheInsertIndex;
-	const int cacheIndex = searchCache(_info, &cacheInsertIndex);
-	if (cacheIndex != -1) {
-		CelCacheEntry &entry = (*_cache)[cacheIndex];
-		const CelObjPic *const cachedCelObj = dynamic_cast<CelObjPic *>(entry.celObj.get());
+	const CelObj *const cachedEntry = searchCache(_info);
+	if (cachedEntry != nullptr) {
+		const CelObjPic *const cachedCelObj = dynamic_cast<const CelObjPic *>(cachedEntry);
 		if (cachedCelObj == nullptr) {
-			error("Expected a CelObjPic in cache slot %d", cacheIndex);
+			error("Expected a CelObjPic in the cel cache for %s", _info.toString().c_str());
 		}
 		*this = *cachedCelObj;
-		entry.id = ++_nextCacheId;
 		return;
 	}
 
@@ -1252,7 +1322,7 @@ CelObjPic::CelObjPic(const GuiResourceId picId, const int16 celNo) {
 		}
 	}
 
-	putCopyInCache(cacheInsertIndex);
+	putCopyInCache();
 }
 
 bool CelObjPic::analyzeUncompressedForSkip() const {
@@ -22,6 +22,8 @@
 #ifndef SCI_GRAPHICS_CELOBJ32_H
 #define SCI_GRAPHICS_CELOBJ32_H
 
+#include "common/hashmap.h"
+#include "common/list.h"
 #include "common/rational.h"
 #include "common/rect.h"
 #include "sci/resource/resource.h"
@@ -105,7 +107,7 @@ struct CelInfo32 {
 
 	// This is the equivalence criteria used by CelObj::searchCache in at least
 	// SSCI SQ6. Notably, it does not check the color field.
-	inline bool operator==(const CelInfo32 &other) {
+	inline bool operator==(const CelInfo32 &other) const {
 		return (
 			type == other.type &&
 			resourceId == other.resourceId &&
@@ -115,7 +117,7 @@ struct CelInfo32 {
 		);
 	}
 
-	inline bool operator!=(const CelInfo32 &other) {
+	inline bool operator!=(const CelInfo32 &other) const {
 		return !(*this == other);
 	}
 
@@ -135,18 +137,91 @@ struct CelInfo32 {
 	}
 };
 
+struct CelInfo32Hash {
+	uint operator()(const CelInfo32 &info) const {
+		// Uses the same fields as CelInfo32::operator==
+		uint hash = info.type;
+		hash = hash * 31 + info.resourceId;
+		hash = hash * 31 + (uint16)info.loopNo;
+		hash = hash * 31 + (uint16)info.celNo;
+		hash = hash * 31 + info.bitmap.getSegment();
+		hash = hash * 31 + info.bitmap.getOffset();
+		return hash;
+	}
+};
+
 class CelObj;
-struct CelCacheEntry {
+class Console;
+
+/**
+ * A cache of cel objects, keyed on their CelInfo32. When the cached cels go
+ * over the byte budget, the least recently used ones are dropped.
+ */
+class CelCache {
+public:
+	struct Statistics {
+		uint32 hits;
+		uint32 misses;
+		uint32 evictions;
+	};
+
+	CelCache(uint32 maxSize);
+	~CelCache();
+
 	/**
-	 * A monotonically increasing cache ID used to identify the least recently
-	 * used item in the cache for replacement.
+	 * Finds the cached cel for the given CelInfo32 and marks it as the most
+	 * recently used one. Returns nullptr if it is not in the cache.
 	 */
-	int id;
-	Common::ScopedPtr<CelObj> celObj;
-	CelCacheEntry() : id(0) {}
-};
+	const CelObj *find(const CelInfo32 &celInfo);
 
-typedef Common::Array<CelCacheEntry> CelCache;
+	/**
+	 * Adds a cel to the cache, which takes ownership of it. A cel with the
+	 * same CelInfo32 is replaced.
+	 */
+	void insert(CelObj *celObj);
+
+	/**
+	 * Drops all the cached cels.
+	 */
+	void clear();
+
+	uint32 getMaxSize() const { return _maxSize; }
+	uint32 getSize() const { return _size; }
+	uint getCount() const { return _index.size(); }
+	const Statistics &getStatistics() const { return _statistics; }
+	void resetStatistics();
+
+private:
+	struct Entry {
+		CelObj *celObj;
+		uint32 size;
+	};
+
+	typedef Common::List<Entry> EntryList;
+	typedef Common::HashMap<CelInfo32, EntryList::iterator, CelInfo32Hash> EntryMap;
+
+	/**
+	 * The bytes accounted for a cached cel. CelObj does not hold the pixels
+	 * itself, but bigger cels are more expensive to set up again, since
+	 * their pixels are scanned for remap colors.
+	 */
+	static uint32 getEntrySize(const CelObj &celObj);
+
+	/**
+	 * Drops the least recently used cels until the cache fits in `maxSize`
+	 * bytes.
+	 */
+	void evict(uint32 maxSize);
+
+	/**
+	 * Cached cels, from the most to the least recently used one.
+	 */
+	EntryList _entries;
+	EntryMap _index;
+	uint32 _size;
+	uint32 _maxSize;
+	Statistics _statistics;
+};
 
 #pragma mark -
 #pragma mark CelScaler
@@ -450,12 +525,6 @@ private:
 #pragma mark -
 #pragma mark CelObj - Caching
 protected:
-	/**
-	 * A monotonically increasing cache ID used to identify the least recently
-	 * used item in the cache for replacement.
-	 */
-	static int _nextCacheId;
-
 	/**
 	 * A cache of cel objects used to avoid reinitialisation overhead for cels
 	 * with the same CelInfo32.
@@ -463,17 +532,27 @@ protected:
 	static CelCache *_cache;
 
 	/**
-	 * Searches the cel cache for a CelObj matching the provided CelInfo32. If
-	 * not found, -1 is returned. `nextInsertIndex` will receive the index of
-	 * the oldest item in the cache, which can be used to replace the oldest
-	 * item with a newer item.
+	 * Searches the cel cache for a CelObj matching the provided CelInfo32.
+	 * If not found, nullptr is returned.
+	 */
+	const CelObj *searchCache(const CelInfo32 &celInfo) const;
+
+	/**
+	 * Puts a copy of this CelObj into the cache.
+	 */
+	void putCopyInCache() const;
+
+public:
+	/**
+	 * Prints the size and the hit rate of the cel cache to the debugger
+	 * console.
 	 */
-	int searchCache(const CelInfo32 &celInfo, int *nextInsertIndex) const;
+	static void printCacheStatistics(Console *con);
 
 	/**
-	 * Puts a copy of this CelObj into the cache at the given cache index.
+	 * Drops all the cached cels and resets the statistics.
 	 */
-	void putCopyInCache(int index) const;
+	static void clearCache();
 };
 
 #pragma mark -
@@ -24,7 +24,9 @@
 #include "common/config-manager.h"
 #include "common/file.h"
 #include "common/fs.h"
+#include "common/jobs.h"
 #include "common/macresman.h"
+#include "common/system.h"
 #include "common/textconsole.h"
 #include "common/translation.h"
 #ifdef ENABLE_SCI32
@@ -419,7 +421,8 @@ void ResourceManager::disposeVolumeFileStream(Common::SeekableReadStream *fileSt
 }
 
 void ResourceManager::loadResource(Resource *res) {
-	res->_source->loadResource(this, res);
+	if (!loadPrefetchedResource(res))
+		res->_source->loadResource(this, res);
 	if (_patcher) {
 		_patcher->applyPatch(*res);
 	};
@@ -601,6 +604,18 @@ void ResourceSource::loadResource(ResourceManager *resMan, Resource *res) {
 	if (!fileStream)
 		return;
 
+	int error = decompressResource(resMan, res, fileStream);
+	if (error) {
+		warning("Error %d occurred while reading %s from resource file %s: %s",
+				error, res->_id.toString().c_str(), res->getResourceLocation().toString().c_str(),
+				s_errorDescriptions[error]);
+		res->unalloc();
+	}
+
+	resMan->disposeVolumeFileStream(fileStream, this);
+}
+
+int ResourceSource::decompressResource(ResourceManager *resMan, Resource *res, Common::SeekableReadStream *fileStream) const {
 	fileStream->seek(0, SEEK_SET);
 	ResourceType type = resMan->convertResType(fileStream->readByte());
 	ResVersion volVersion = resMan->getVolVersion();
@@ -615,15 +630,7 @@ void ResourceSource::loadResource(ResourceManager *resMan, Resource *res) {
 		volVersion = kResVersionSci11;
 	fileStream->seek(res->_fileOffset, SEEK_SET);
 
-	int error = res->decompress(volVersion, fileStream);
-	if (error) {
-		warning("Error %d occurred while reading %s from resource file %s: %s",
-				error, res->_id.toString().c_str(), res->getResourceLocation().toString().c_str(),
-				s_errorDescriptions[error]);
-		res->unalloc();
-	}
-
-	resMan->disposeVolumeFileStream(fileStream, this);
+	return res->decompress(volVersion, fileStream);
 }
 
 Resource *ResourceManager::testResource(const ResourceId &id) const {
@@ -1009,6 +1016,7 @@ void ResourceManager::init() {
 	_maxMemoryLRU = 256 * 1024; // 256KiB
 	_memoryLocked = 0;
 	_memoryLRU = 0;
+	_memoryLRUAudio = 0;
 	_LRU.clear();
 	_resMap.clear();
 	_audioMapSCI1 = nullptr;
@@ -1083,6 +1091,11 @@ void ResourceManager::init() {
 		_maxMemoryLRU = 4096 * 1024; // 4MiB
 	}
 
+	// Speech and sound effects are big and mostly played once, so together
+	// they may only take a quarter of the LRU instead of pushing out the
+	// graphics. The small SCI16 LRU still gets room for a few speech lines.
+	_maxMemoryLRUAudio = MAX(_maxMemoryLRU / 4, 128 * 1024);
+
 	switch (_viewType) {
 	case kViewEga:
 		debugC(1, kDebugLevelResMan, "resMan: Detected EGA graphic resources");
@@ -1109,6 +1122,8 @@ void ResourceManager::init() {
 }
 
 ResourceManager::~ResourceManager() {
+	clearPrefetchedResources();
+
 	// freeing resources
 	ResourceMap::iterator itr = _resMap.begin();
 	while (itr != _resMap.end()) {
@@ -1124,6 +1139,20 @@ ResourceManager::~ResourceManager() {
 	}
 }
 
+static bool isAudioResourceType(ResourceType type) {
+	switch (type) {
+	case kResourceTypeCdAudio:
+	case kResourceTypeAudio:
+	case kResourceTypeSync:
+	case kResourceTypeAudio36:
+	case kResourceTypeSync36:
+	case kResourceTypeRave:
+		return true;
+	default:
+		return false;
+	}
+}
+
 void ResourceManager::removeFromLRU(Resource *res) {
 	if (res->_status != kResStatusEnqueued) {
 		warning("resMan: trying to remove resource that isn't enqueued");
@@ -1131,6 +1160,8 @@ void ResourceManager::removeFromLRU(Resource *res) {
 	}
 	_LRU.remove(res);
 	_memoryLRU -= res->size();
+	if (isAudioResourceType(res->getType()))
+		_memoryLRUAudio -= res->size();
 	res->_status = kResStatusAllocated;
 }
 
@@ -1141,6 +1172,8 @@ void ResourceManager::addToLRU(Resource *res) {
 	}
 	_LRU.push_front(res);
 	_memoryLRU += res->size();
+	if (isAudioResourceType(res->getType()))
+		_memoryLRUAudio += res->size();
 #ifdef SCI_VERBOSE_RESMAN
 	debug("Adding %s (%d bytes) to lru control: %d bytes total",
 	      res->_id.toString().c_str(), res->size,
@@ -1150,6 +1183,25 @@ void ResourceManager::addToLRU(Resource *res) {
 }
 
 void ResourceManager::freeOldResources() {
+	// Free the oldest audio resources once they use more than their share.
+	// The most recent one is kept, as it has usually just been unlocked to
+	// be played.
+	if (_memoryLRUAudio > _maxMemoryLRUAudio) {
+		Common::List<Resource *>::iterator newest = _LRU.begin();
+		while (newest != _LRU.end() && !isAudioResourceType((*newest)->getType()))
+			++newest;
+
+		Common::List<Resource *>::iterator it = _LRU.reverse_begin();
+		while (it != newest && _memoryLRUAudio > _maxMemoryLRUAudio) {
+			Resource *res = *it;
+			--it;
+			if (isAudioResourceType(res->getType())) {
+				removeFromLRU(res);
+				res->unalloc();
+			}
+		}
+	}
+
 	while (_maxMemoryLRU < _memoryLRU) {
 		assert(!_LRU.empty());
 		Resource *goner = _LRU.back();
@@ -1232,6 +1284,110 @@ Resource *ResourceManager::findResource(ResourceId id, bool lock) {
 	}
 }
 
+struct ResourceManager::PrefetchedResource {
+	Resource *res;                     ///< Resource the data is for, only used by the main thread
+	ResourceSource *source;            ///< Source of the resource when it was prefetched
+	int32 fileOffset;                  ///< Offset of the resource when it was prefetched
+	Resource *data;                    ///< Copy of the resource the data is read into
+	Common::SeekableReadStream *file;  ///< Volume file, opened for the worker thread only
+	ResourceManager *resMan;
+	int error;
+	Common::WaitGroup group;
+};
+
+void ResourceManager::prefetchResourceJob(void *data) {
+	PrefetchedResource *prefetch = (PrefetchedResource *)data;
+	prefetch->error = prefetch->source->decompressResource(prefetch->resMan, prefetch->data, prefetch->file);
+}
+
+void ResourceManager::prefetchRoomResources(uint16 roomNumber) {
+	clearPrefetchedResources();
+
+	if (g_system->getJobManager()->getThreadCount() <= 1)
+		return;
+
+	static const ResourceType types[] = {
+		kResourceTypeScript, kResourceTypeHeap, kResourceTypePic, kResourceTypeView, kResourceTypePalette, kResourceTypeMessage
+	};
+
+	for (int i = 0; i < ARRAYSIZE(types); i++) {
+		Resource *res = testResource(ResourceId(types[i], roomNumber));
+		if (res)
+			prefetchResource(res);
+	}
+}
+
+void ResourceManager::prefetchResource(Resource *res) {
+	// Only resources in volume files are read on worker threads. Other
+	// sources read from files shared with the main thread, or need the
+	// resource manager to load.
+	ResourceSource *source = res->_source;
+	if (res->_status != kResStatusNoMalloc || source->getSourceType() != kSourceVolume || source->_resourceFile)
+		return;
+
+	Common::File *file = new Common::File();
+	if (!file->open(source->getLocationName())) {
+		delete file;
+		return;
+	}
+
+	PrefetchedResource *prefetch = new PrefetchedResource();
+	prefetch->res = res;
+	prefetch->source = source;
+	prefetch->fileOffset = res->_fileOffset;
+	prefetch->data = new Resource(this, res->_id);
+	prefetch->data->_fileOffset = res->_fileOffset;
+	prefetch->file = file;
+	prefetch->resMan = this;
+	prefetch->error = SCI_ERROR_NONE;
+	_prefetchedResources.push_back(prefetch);
+
+	debugC(kDebugLevelResMan, 2, "[resMan] Prefetching %s", res->_id.toString().c_str());
+	g_system->getJobManager()->submit(&prefetchResourceJob, prefetch, &prefetch->group);
+}
+
+bool ResourceManager::loadPrefetchedResource(Resource *res) {
+	for (uint i = 0; i < _prefetchedResources.size(); i++) {
+		PrefetchedResource *prefetch = _prefetchedResources[i];
+		if (prefetch->res != res)
+			continue;
+
+		_prefetchedResources.remove_at(i);
+		g_system->getJobManager()->wait(prefetch->group);
+
+		// Volumes may have been rescanned in the meantime, and errors are
+		// reported by loading the resource again
+		const bool loaded = prefetch->error == SCI_ERROR_NONE &&
+			prefetch->source == res->_source && prefetch->fileOffset == res->_fileOffset;
+		if (loaded) {
+			Resource *data = prefetch->data;
+			res->_id = data->_id;
+			res->_data = data->_data;
+			res->_size = data->_size;
+			res->_status = kResStatusAllocated;
+			data->_data = nullptr;
+		}
+
+		delete prefetch->data;
+		delete prefetch->file;
+		delete prefetch;
+		return loaded;
+	}
+
+	return false;
+}
+
+void ResourceManager::clearPrefetchedResources() {
+	for (uint i = 0; i < _prefetchedResources.size(); i++) {
+		PrefetchedResource *prefetch = _prefetchedResources[i];
+		g_system->getJobManager()->wait(prefetch->group);
+		delete prefetch->data;
+		delete prefetch->file;
+		delete prefetch;
+	}
+	_prefetchedResources.clear();
+}
+
 void ResourceManager::unlockResource(Resource *res) {
 	assert(res);
 
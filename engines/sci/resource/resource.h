@@ -22,6 +22,7 @@
 #ifndef SCI_RESOURCE_RESOURCE_H
 #define SCI_RESOURCE_RESOURCE_H
 
+#include "common/array.h"
 #include "common/str.h"
 #include "common/list.h"
 #include "common/hashmap.h"
@@ -374,6 +375,16 @@ public:
 	 */
 	Resource *findResource(ResourceId id, bool lock);
 
+	/**
+	 * Starts reading and decompressing the resources that a room is likely to
+	 * use on worker threads, so that they are ready when the room script
+	 * asks for them. Games usually give the script, heap, pic and main view
+	 * of a room the number of the room. Nothing is done when the job manager
+	 * has no worker threads.
+	 * @param roomNumber	The room the game is about to enter
+	 */
+	void prefetchRoomResources(uint16 roomNumber);
+
 	/**
 	 * Unlocks a previously locked resource.
 	 * @param res	The resource to free
@@ -500,6 +511,8 @@ protected:
 	SourcesList _sources;
 	int _memoryLocked;	///< Amount of resource bytes in locked memory
 	int _memoryLRU;		///< Amount of resource bytes under LRU control
+	int _memoryLRUAudio;	///< Amount of audio and sync resource bytes under LRU control
+	int _maxMemoryLRUAudio;	///< Share of _maxMemoryLRU the audio and sync resources may use
 	Common::List<Resource *> _LRU; ///< Last Resource Used list
 	ResourceMap _resMap;
 	Common::List<Common::File *> _volumeFiles; ///< list of opened volume files
@@ -562,6 +575,28 @@ protected:
 	void disposeVolumeFileStream(Common::SeekableReadStream *fileStream, ResourceSource *source);
 	void loadResource(Resource *res);
 	void freeOldResources();
+
+	struct PrefetchedResource;
+	Common::Array<PrefetchedResource *> _prefetchedResources; ///< Resources being read on worker threads
+	static void prefetchResourceJob(void *data);
+
+	/**
+	 * Starts reading and decompressing a resource on a worker thread.
+	 */
+	void prefetchResource(Resource *res);
+
+	/**
+	 * Takes the data of a resource read by prefetchResource(), waiting for
+	 * the worker thread if it is not done yet.
+	 * @return true if the resource was loaded
+	 */
+	bool loadPrefetchedResource(Resource *res);
+
+	/**
+	 * Waits for all prefetched resources and drops the ones not used yet.
+	 */
+	void clearPrefetchedResources();
+
 	bool validateResource(const ResourceId &resourceId, const Common::Path &sourceMapLocation, const Common::Path &sourceName, const uint32 offset, const uint32 size, const uint32 sourceSize) const;
 	Resource *addResource(ResourceId resId, ResourceSource *src, uint32 offset, uint32 size = 0, const Common::Path &sourceMapLocation = Common::Path("(no map location)"));
 	Resource *updateResource(ResourceId resId, ResourceSource *src, uint32 size, const Common::Path &sourceMapLocation = Common::Path("(no map location)"));
@@ -83,6 +83,13 @@ public:
 	 */
 	virtual void loadResource(ResourceManager *resMan, Resource *res);
 
+	/**
+	 * Read and decompress a resource from an open volume file. This does not
+	 * change the resource manager, so it may run on a worker thread.
+	 * @return An SCI_ERROR_* code
+	 */
+	int decompressResource(ResourceManager *resMan, Resource *res, Common::SeekableReadStream *fileStream) const;
+
 	// FIXME: This audio specific method is a hack. After all, why should a
 	// ResourceSource or a Resource (which uses this method) have audio
 	// specific methods? But for now we keep this, as it eases transition.
@@ -19,6 +19,7 @@
  *
  */
 
+#include "common/jobs.h"
 #include "common/system.h"
 #include "scumm/actor.h"
 #include "scumm/charset.h"
@@ -64,6 +65,9 @@ struct StripTable {
 
 static const byte bitMasks[9] = { 0x00, 0x01, 0x03, 0x07, 0x0F, 0x1F, 0x3F, 0x7F, 0xFF };
 
+// Number of strips decoded by each job when a bitmap is drawn on several threads
+static const uint kParallelStripChunk = 8;
+
 enum {
 	kNoDelay = 0,
 	// This should actually be 3 in all games using it;
@@ -212,8 +216,6 @@ Gdi::Gdi(ScummEngine *vm) : _vm(vm) {
 	_paletteMod = 0;
 	_roomPalette = vm->_roomPalette;
 	_transparentColor = 255;
-	_decomp_shr = 0;
-	_decomp_mask = 0;
 	_vertStripNextInc = 0;
 	_zbufferDisabled = false;
 	_objectMode = false;
@@ -272,6 +274,13 @@ GdiHE16bit::GdiHE16bit(ScummEngine *vm) : GdiHE(vm) {
 void Gdi::init() {
 	_numStrips = _vm->_screenWidth / 8;
 
+	// Amiga versions of V4+ games use the upper half of the room palette.
+	// This is only done for the 256 color codecs, see decompressBitmap().
+	if (_vm->_game.platform == Common::kPlatformAmiga && _vm->_game.version >= 4 && !(_vm->_game.features & GF_16COLOR))
+		_paletteMod = 16;
+	else
+		_paletteMod = 0;
+
 	// Increase the number of screen strips by one; needed for smooth scrolling
 	if (_vm->_game.version >= 7) {
 		// We now have mostly working smooth scrolling code in place for V7+ games
@@ -2068,7 +2077,6 @@ void Gdi::drawBitmap(const byte *ptr, VirtScreen *vs, int x, const int y, const
 	assert(ptr);
 	assert(height > 0);
 
-	byte *dstPtr;
 	const byte *smap_ptr;
 	const byte *zplane_list[9];
 	int numzbuf;
@@ -2121,6 +2129,32 @@ void Gdi::drawBitmap(const byte *ptr, VirtScreen *vs, int x, const int y, const
 		limit = numstrip;
 	if (limit > _numStrips - sx)
 		limit = _numStrips - sx;
+
+	// Decoding the strips is most of the work of drawing a room. From V6 on,
+	// none of the workarounds in drawStrip() apply and every strip only writes
+	// its own column, so the strips can be decoded on several threads. The
+	// masks are still decoded afterwards on this thread, since finding the
+	// mask buffer goes through the resource manager.
+	if (_vm->_game.version >= 6 && limit >= 2 * (int)kParallelStripChunk && g_system->getJobManager()->getThreadCount() > 1 &&
+		canDrawStripsInParallel(smap_ptr, stripnr, limit)) {
+		Common::Array<bool> transpStrips;
+		transpStrips.resize(limit);
+
+		for (int k = 0; k < limit; ++k) {
+			if (y < vs->tdirty[sx + k])
+				vs->tdirty[sx + k] = y;
+
+			if (y + height > vs->bdirty[sx + k])
+				vs->bdirty[sx + k] = y + height;
+		}
+
+		drawStripsInParallel(vs, x, y, width, height, stripnr, limit, smap_ptr, lightsOn, transpStrips.data());
+
+		for (int k = 0; k < limit; ++k)
+			decodeMask(x + k, y, width, height, stripnr + k, numzbuf, zplane_list, transpStrips[k], flag);
+		return;
+	}
+
 	for (int k = 0; k < limit; ++k, ++stripnr, ++sx, ++x) {
 		if (y < vs->tdirty[sx])
 			vs->tdirty[sx] = y;
@@ -2128,26 +2162,7 @@ void Gdi::drawBitmap(const byte *ptr, VirtScreen *vs, int x, const int y, const
 		if (y + height > vs->bdirty[sx])
 			vs->bdirty[sx] = y + height;
 
-		// In the case of a double buffered virtual screen, we draw to
-		// the backbuffer, otherwise to the primary surface memory.
-		if (vs->hasTwoBuffers)
-			dstPtr = vs->backBuf + y * vs->pitch + (x * 8 * vs->format.bytesPerPixel);
-		else
-			dstPtr = (byte *)vs->getBasePtr(x * 8, y);
-
-		transpStrip = drawStrip(dstPtr, vs, x, y, width, height, stripnr, smap_ptr);
-
-		// COMI and HE games only uses flag value
-		if (_vm->_game.version == 8 || _vm->_game.heversion >= 60)
-			transpStrip = true;
-
-		if (vs->hasTwoBuffers) {
-			byte *frontBuf = (byte *)vs->getBasePtr(x * 8, y);
-			if (lightsOn)
-				copy8Col(frontBuf, vs->pitch, dstPtr, height, vs->format.bytesPerPixel);
-			else
-				clear8Col(frontBuf, vs->pitch, height, vs->format.bytesPerPixel);
-		}
+		transpStrip = drawStripAndCopy(vs, x, y, width, height, stripnr, smap_ptr, lightsOn);
 
 		decodeMask(x, y, width, height, stripnr, numzbuf, zplane_list, transpStrip, flag);
 
@@ -2177,13 +2192,80 @@ void Gdi::drawBitmap(const byte *ptr, VirtScreen *vs, int x, const int y, const
 	}
 }
 
-bool Gdi::drawStrip(byte *dstPtr, VirtScreen *vs, int x, int y, const int width, const int height,
-					int stripnr, const byte *smap_ptr) {
+bool Gdi::drawStripAndCopy(VirtScreen *vs, int x, int y, const int width, const int height,
+					int stripnr, const byte *smap_ptr, bool lightsOn) {
+	byte *dstPtr;
+
+	// In the case of a double buffered virtual screen, we draw to
+	// the backbuffer, otherwise to the primary surface memory.
+	if (vs->hasTwoBuffers)
+		dstPtr = vs->backBuf + y * vs->pitch + (x * 8 * vs->format.bytesPerPixel);
+	else
+		dstPtr = (byte *)vs->getBasePtr(x * 8, y);
+
+	bool transpStrip = drawStrip(dstPtr, vs, x, y, width, height, stripnr, smap_ptr);
+
+	// COMI and HE games only uses flag value
+	if (_vm->_game.version == 8 || _vm->_game.heversion >= 60)
+		transpStrip = true;
+
+	if (vs->hasTwoBuffers) {
+		byte *frontBuf = (byte *)vs->getBasePtr(x * 8, y);
+		if (lightsOn)
+			copy8Col(frontBuf, vs->pitch, dstPtr, height, vs->format.bytesPerPixel);
+		else
+			clear8Col(frontBuf, vs->pitch, height, vs->format.bytesPerPixel);
+	}
+
+	return transpStrip;
+}
+
+/** Whether a codec is used by V6+ games and can be decoded on several threads. */
+static bool isParallelStripCodec(byte code) {
+	if (code == BMCOMP_RAW256 || code == BMCOMP_TPIX256 || code == BMCOMP_CUSTOM_RU_TR ||
+		code == BMCOMP_TRLE8BIT || code == BMCOMP_RLE8BIT)
+		return true;
+
+	switch (code - code % 10) {
+	case BMCOMP_ZIGZAG_V0:
+	case BMCOMP_ZIGZAG_H0:
+	case BMCOMP_ZIGZAG_VT0:
+	case BMCOMP_ZIGZAG_HT0:
+	case BMCOMP_MAJMIN_H0:
+	case BMCOMP_MAJMIN_HT0:
+	case BMCOMP_RMAJMIN_H0:
+	case BMCOMP_RMAJMIN_HT0:
+	case BMCOMP_NMAJMIN_H0:
+	case BMCOMP_NMAJMIN_HT0:
+		return code % 10 >= 4 && code % 10 <= 8;
+	default:
+		return false;
+	}
+}
+
+bool Gdi::canDrawStripsInParallel(const byte *smap_ptr, int stripnr, int numstrip) const {
+	for (int k = 0; k < numstrip; ++k) {
+		int smapLen;
+		if (!isParallelStripCodec(*getStripData(smap_ptr, stripnr + k, smapLen)))
+			return false;
+	}
+	return true;
+}
+
+void Gdi::drawStripsInParallel(VirtScreen *vs, int x, int y, const int width, const int height,
+					int stripnr, int numstrip, const byte *smap_ptr, bool lightsOn, bool *transpStrips) {
+	g_system->getJobManager()->parallelFor(numstrip, [&](uint begin, uint end) {
+		for (uint k = begin; k < end; ++k)
+			transpStrips[k] = drawStripAndCopy(vs, x + (int)k, y, width, height, stripnr + (int)k, smap_ptr, lightsOn);
+	}, kParallelStripChunk);
+}
+
+const byte *Gdi::getStripData(const byte *smap_ptr, int stripnr, int &smapLen) const {
 	// Do some input verification and make sure the strip/strip offset
 	// are actually valid. Normally, this should never be a problem,
 	// but if e.g. a savegame gets corrupted, we can easily get into
 	// trouble here. See also bug #1191.
-	int offset = -1, smapLen;
+	int offset = -1;
 	if (_vm->_game.features & GF_16COLOR) {
 		smapLen = READ_LE_UINT16(smap_ptr);
 		if (stripnr * 2 + 2 < smapLen) {
@@ -2206,6 +2288,14 @@ bool Gdi::drawStrip(byte *dstPtr, VirtScreen *vs, int x, int y, const int width,
 	}
 	assertRange(0, offset, smapLen-1, "screen strip");
 
+	return smap_ptr + offset;
+}
+
+bool Gdi::drawStrip(byte *dstPtr, VirtScreen *vs, int x, int y, const int width, const int height,
+					int stripnr, const byte *smap_ptr) {
+	int smapLen;
+	const byte *src = getStripData(smap_ptr, stripnr, smapLen);
+
 	// Indy4 Amiga always uses the room or verb palette map to match colors to
 	// the currently setup palette, thus we need to select it over here too.
 	// Done like the original interpreter.
@@ -2250,7 +2340,7 @@ bool Gdi::drawStrip(byte *dstPtr, VirtScreen *vs, int x, int y, const int width,
 			_vm->enhancementEnabled(kEnhVisualChanges)) {
 		_roomPalette[47] = 15;
 
-		byte result = decompressBitmap(dstPtr, vs->pitch, smap_ptr + offset, height);
+		byte result = decompressBitmap(dstPtr, vs->pitch, src, height);
 
 		_roomPalette[47] = 47;
 		return result;
@@ -2271,13 +2361,13 @@ bool Gdi::drawStrip(byte *dstPtr, VirtScreen *vs, int x, int y, const int width,
 			_vm->enhancementEnabled(kEnhVisualChanges)) {
 		_roomPalette[1] = 15;
 
-		byte result = decompressBitmap(dstPtr, vs->pitch, smap_ptr + offset, height);
+		byte result = decompressBitmap(dstPtr, vs->pitch, src, height);
 
 		_roomPalette[1] = 1;
 		return result;
 	}
 
-	return decompressBitmap(dstPtr, vs->pitch, smap_ptr + offset, height);
+	return decompressBitmap(dstPtr, vs->pitch, src, height);
 }
 
 bool GdiNES::drawStrip(byte *dstPtr, VirtScreen *vs, int x, int y, const int width, const int height,
@@ -2481,18 +2571,14 @@ void Gdi::drawBMAPBg(const byte *ptr, VirtScreen *vs) {
 	case BMCOMP_NMAJMIN_H6:
 	case BMCOMP_NMAJMIN_H7:
 	case BMCOMP_NMAJMIN_H8:
-		_decomp_shr = code - BMCOMP_NMAJMIN_H0; // Bits per pixel
-		_decomp_mask = bitMasks[_decomp_shr];
-		drawStripHE(dst, vs->pitch, bmap_ptr, vs->w, vs->h, false);
+		drawStripHE(dst, vs->pitch, bmap_ptr, vs->w, vs->h, code - BMCOMP_NMAJMIN_H0, false); // Bits per pixel
 		break;
 	case BMCOMP_NMAJMIN_HT4:
 	case BMCOMP_NMAJMIN_HT5:
 	case BMCOMP_NMAJMIN_HT6:
 	case BMCOMP_NMAJMIN_HT7:
 	case BMCOMP_NMAJMIN_HT8:
-		_decomp_shr = code - BMCOMP_NMAJMIN_HT0; // Bits per pixel
-		_decomp_mask = bitMasks[_decomp_shr];
-		drawStripHE(dst, vs->pitch, bmap_ptr, vs->w, vs->h, false);
+		drawStripHE(dst, vs->pitch, bmap_ptr, vs->w, vs->h, code - BMCOMP_NMAJMIN_HT0, false); // Bits per pixel
 		break;
 	case BMCOMP_SOLID_COLOR_FILL:
 		fill(dst, vs->pitch, *bmap_ptr, vs->w, vs->h, vs->format.bytesPerPixel);
@@ -2657,15 +2743,9 @@ bool Gdi::decompressBitmap(byte *dst, int dstPitch, const byte *src, int numLine
 		return false;
 	}
 
-	if ((_vm->_game.platform == Common::kPlatformAmiga) && (_vm->_game.version >= 4))
-		_paletteMod = 16;
-	else
-		_paletteMod = 0;
-
 	byte code = *src++;
 	bool transpStrip = false;
-	_decomp_shr = code % 10;
-	_decomp_mask = 0xFF >> (8 - _decomp_shr);
+	const byte shr = code % 10;
 
 	switch (code) {
 	case BMCOMP_RAW256:
@@ -2708,7 +2788,7 @@ bool Gdi::decompressBitmap(byte *dst, int dstPitch, const byte *src, int numLine
 	case BMCOMP_ZIGZAG_V6:
 	case BMCOMP_ZIGZAG_V7:
 	case BMCOMP_ZIGZAG_V8:
-		drawStripBasicV(dst, dstPitch, src, numLinesToProcess, false);
+		drawStripBasicV(dst, dstPitch, src, numLinesToProcess, shr, false);
 		break;
 
 	case BMCOMP_ZIGZAG_H4:
@@ -2716,7 +2796,7 @@ bool Gdi::decompressBitmap(byte *dst, int dstPitch, const byte *src, int numLine
 	case BMCOMP_ZIGZAG_H6:
 	case BMCOMP_ZIGZAG_H7:
 	case BMCOMP_ZIGZAG_H8:
-		drawStripBasicH(dst, dstPitch, src, numLinesToProcess, false);
+		drawStripBasicH(dst, dstPitch, src, numLinesToProcess, shr, false);
 		break;
 
 	case BMCOMP_ZIGZAG_VT4:
@@ -2725,7 +2805,7 @@ bool Gdi::decompressBitmap(byte *dst, int dstPitch, const byte *src, int numLine
 	case BMCOMP_ZIGZAG_VT7:
 	case BMCOMP_ZIGZAG_VT8:
 		transpStrip = true;
-		drawStripBasicV(dst, dstPitch, src, numLinesToProcess, true);
+		drawStripBasicV(dst, dstPitch, src, numLinesToProcess, shr, true);
 		break;
 
 	case BMCOMP_ZIGZAG_HT4:
@@ -2734,7 +2814,7 @@ bool Gdi::decompressBitmap(byte *dst, int dstPitch, const byte *src, int numLine
 	case BMCOMP_ZIGZAG_HT7:
 	case BMCOMP_ZIGZAG_HT8:
 		transpStrip = true;
-		drawStripBasicH(dst, dstPitch, src, numLinesToProcess, true);
+		drawStripBasicH(dst, dstPitch, src, numLinesToProcess, shr, true);
 		break;
 
 	case BMCOMP_MAJMIN_H4:
@@ -2747,7 +2827,7 @@ bool Gdi::decompressBitmap(byte *dst, int dstPitch, const byte *src, int numLine
 	case BMCOMP_RMAJMIN_H6:
 	case BMCOMP_RMAJMIN_H7:
 	case BMCOMP_RMAJMIN_H8:
-		drawStripComplex(dst, dstPitch, src, numLinesToProcess, false);
+		drawStripComplex(dst, dstPitch, src, numLinesToProcess, shr, false);
 		break;
 
 	case BMCOMP_MAJMIN_HT4:
@@ -2761,7 +2841,7 @@ bool Gdi::decompressBitmap(byte *dst, int dstPitch, const byte *src, int numLine
 	case BMCOMP_RMAJMIN_HT7:
 	case BMCOMP_RMAJMIN_HT8:
 		transpStrip = true;
-		drawStripComplex(dst, dstPitch, src, numLinesToProcess, true);
+		drawStripComplex(dst, dstPitch, src, numLinesToProcess, shr, true);
 		break;
 
 	case BMCOMP_NMAJMIN_H4:
@@ -2769,7 +2849,7 @@ bool Gdi::decompressBitmap(byte *dst, int dstPitch, const byte *src, int numLine
 	case BMCOMP_NMAJMIN_H6:
 	case BMCOMP_NMAJMIN_H7:
 	case BMCOMP_NMAJMIN_H8:
-		drawStripHE(dst, dstPitch, src, 8, numLinesToProcess, false);
+		drawStripHE(dst, dstPitch, src, 8, numLinesToProcess, shr, false);
 		break;
 
 	case BMCOMP_CUSTOM_RU_TR: // Triggered by Russian water
@@ -2779,7 +2859,7 @@ bool Gdi::decompressBitmap(byte *dst, int dstPitch, const byte *src, int numLine
 	case BMCOMP_NMAJMIN_HT7:
 	case BMCOMP_NMAJMIN_HT8:
 		transpStrip = true;
-		drawStripHE(dst, dstPitch, src, 8, numLinesToProcess, true);
+		drawStripHE(dst, dstPitch, src, 8, numLinesToProcess, shr, true);
 		break;
 
 	case BMCOMP_TPIX256:
@@ -3697,7 +3777,8 @@ void Gdi::drawStripEGA(byte *dst, int dstPitch, const byte *src, int height) con
 	} while (0)
 
 // NOTE: drawStripHE is actually very similar to drawStripComplex
-void Gdi::drawStripHE(byte *dst, int dstPitch, const byte *src, int width, int height, const bool transpCheck) const {
+void Gdi::drawStripHE(byte *dst, int dstPitch, const byte *src, int width, int height, byte shr, const bool transpCheck) const {
+	const byte mask = bitMasks[shr];
 	static const int delta_color[] = { -4, -3, -2, -1, 1, 2, 3, 4 };
 	uint32 dataBit, data;
 	byte color;
@@ -3730,10 +3811,10 @@ void Gdi::drawStripHE(byte *dst, int dstPitch, const byte *src, int width, int h
 				shift -= 3;
 				data >>= 3;
 			} else {
-				FILL_BITS(_decomp_shr);
-				color = data & _decomp_mask;
-				shift -= _decomp_shr;
-				data >>= _decomp_shr;
+				FILL_BITS(shr);
+				color = data & mask;
+				shift -= shr;
+				data >>= shr;
 			}
 		}
 	}
@@ -3788,11 +3869,11 @@ void Gdi::drawStrip3DO(byte *dst, int dstPitch, const byte *src, int height, con
 		}                           \
 	} while (0)
 
-void Gdi::drawStripComplex(byte *dst, int dstPitch, const byte *src, int height, const bool transpCheck) const {
+void Gdi::drawStripComplex(byte *dst, int dstPitch, const byte *src, int height, byte shr, const bool transpCheck) const {
 	byte color;
 	MajMinCodec majMin;
 
-	majMin.setupBitReader(_decomp_shr, src);
+	majMin.setupBitReader(shr, src);
 
 	byte lineBuffer[8];
 	memset(lineBuffer, 0, 8);
@@ -3809,7 +3890,8 @@ void Gdi::drawStripComplex(byte *dst, int dstPitch, const byte *src, int height,
 	}
 }
 
-void Gdi::drawStripBasicH(byte *dst, int dstPitch, const byte *src, int height, const bool transpCheck) const {
+void Gdi::drawStripBasicH(byte *dst, int dstPitch, const byte *src, int height, byte shr, const bool transpCheck) const {
+	const byte mask = bitMasks[shr];
 	byte color = *src++;
 	uint bits = *src++;
 	byte cl = 8;
@@ -3826,9 +3908,9 @@ void Gdi::drawStripBasicH(byte *dst, int dstPitch, const byte *src, int height,
 			if (!READ_BIT) {
 			} else if (!READ_BIT) {
 				FILL_BITS;
-				color = bits & _decomp_mask;
-				bits >>= _decomp_shr;
-				cl -= _decomp_shr;
+				color = bits & mask;
+				bits >>= shr;
+				cl -= shr;
 				inc = -1;
 			} else if (!READ_BIT) {
 				color += inc;
@@ -3841,7 +3923,8 @@ void Gdi::drawStripBasicH(byte *dst, int dstPitch, const byte *src, int height,
 	} while (--height);
 }
 
-void Gdi::drawStripBasicV(byte *dst, int dstPitch, const byte *src, int height, const bool transpCheck) const {
+void Gdi::drawStripBasicV(byte *dst, int dstPitch, const byte *src, int height, byte shr, const bool transpCheck) const {
+	const byte mask = bitMasks[shr];
 	byte color = *src++;
 	uint bits = *src++;
 	byte cl = 8;
@@ -3859,9 +3942,9 @@ void Gdi::drawStripBasicV(byte *dst, int dstPitch, const byte *src, int height,
 			if (!READ_BIT) {
 			} else if (!READ_BIT) {
 				FILL_BITS;
-				color = bits & _decomp_mask;
-				bits >>= _decomp_shr;
-				cl -= _decomp_shr;
+				color = bits & mask;
+				bits >>= shr;
+				cl -= shr;
 				inc = -1;
 			} else if (!READ_BIT) {
 				color += inc;
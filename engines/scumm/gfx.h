@@ -302,7 +302,6 @@ protected:
 	byte _paletteMod;
 	byte *_roomPalette;
 	byte _transparentColor;
-	byte _decomp_shr, _decomp_mask;
 	uint32 _vertStripNextInc;
 
 	bool _zbufferDisabled;
@@ -324,9 +323,9 @@ protected:
 
 	void drawStripEGA(byte *dst, int dstPitch, const byte *src, int height) const;
 
-	void drawStripComplex(byte *dst, int dstPitch, const byte *src, int height, const bool transpCheck) const;
-	void drawStripBasicH(byte *dst, int dstPitch, const byte *src, int height, const bool transpCheck) const;
-	void drawStripBasicV(byte *dst, int dstPitch, const byte *src, int height, const bool transpCheck) const;
+	void drawStripComplex(byte *dst, int dstPitch, const byte *src, int height, byte shr, const bool transpCheck) const;
+	void drawStripBasicH(byte *dst, int dstPitch, const byte *src, int height, byte shr, const bool transpCheck) const;
+	void drawStripBasicV(byte *dst, int dstPitch, const byte *src, int height, byte shr, const bool transpCheck) const;
 
 	void drawStripRaw(byte *dst, int dstPitch, const byte *src, int height, const bool transpCheck) const;
 	void unkDecode8(byte *dst, int dstPitch, const byte *src, int height) const;
@@ -335,7 +334,7 @@ protected:
 	void unkDecode11(byte *dst, int dstPitch, const byte *src, int height) const;
 	void drawStrip3DO(byte *dst, int dstPitch, const byte *src, int height, const bool transpCheck) const;
 
-	void drawStripHE(byte *dst, int dstPitch, const byte *src, int width, int height, const bool transpCheck) const;
+	void drawStripHE(byte *dst, int dstPitch, const byte *src, int width, int height, byte shr, const bool transpCheck) const;
 	virtual void writeRoomColor(byte *dst, byte color) const;
 
 	/* Mask decompressors */
@@ -349,6 +348,25 @@ protected:
 					int x, int y, const int width, const int height,
 					int stripnr, const byte *smap_ptr);
 
+	/** Find the data of a strip in a SMAP block, errors out if its offset is invalid. */
+	const byte *getStripData(const byte *smap_ptr, int stripnr, int &smapLen) const;
+
+	/** Draw a strip and copy it to the front buffer, returns whether it may be transparent. */
+	bool drawStripAndCopy(VirtScreen *vs, int x, int y, const int width, const int height,
+					int stripnr, const byte *smap_ptr, bool lightsOn);
+
+	/**
+	 * Check the strips of a bitmap before drawing them on several threads,
+	 * where errors cannot be reported. Errors out on invalid strip offsets,
+	 * and returns false if a strip uses a codec which is not known to be
+	 * safe to decode in parallel.
+	 */
+	bool canDrawStripsInParallel(const byte *smap_ptr, int stripnr, int numstrip) const;
+
+	/** Draw strips and copy them to the front buffer on the job manager threads. */
+	void drawStripsInParallel(VirtScreen *vs, int x, int y, const int width, const int height,
+					int stripnr, int numstrip, const byte *smap_ptr, bool lightsOn, bool *transpStrips);
+
 	virtual void decodeMask(int x, int y, const int width, const int height,
 	                int stripnr, int numzbuf, const byte *zplane_list[9],
 	                bool transpStrip, byte flag);
@@ -72,7 +72,8 @@ bool TetraedgeMetaEngine::hasFeature(MetaEngineFeature f) const {
 		(f == kSupportsDeleteSave) ||
 		(f == kSavesSupportMetaInfo) ||
 		(f == kSavesSupportThumbnail) ||
-		(f == kSupportsLoadingDuringStartup);
+		(f == kSupportsLoadingDuringStartup) ||
+		(f == kSavesSupportBackgroundLoading);
 }
 
 void TetraedgeMetaEngine::getSavegameThumbnail(Graphics::Surface &thumb) {
@@ -104,6 +104,7 @@ public:
 bool VCruiseMetaEngine::hasFeature(MetaEngineFeature f) const {
 	switch (f) {
 	case kSupportsLoadingDuringStartup:
+	case kSavesSupportBackgroundLoading:
 		return true;
 	default:
 		break;
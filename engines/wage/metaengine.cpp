@@ -54,7 +54,8 @@ public:
 
 bool WageMetaEngine::hasFeature(MetaEngineFeature f) const {
 	return checkExtendedSaves(f) ||
-		(f == kSupportsLoadingDuringStartup);
+		(f == kSupportsLoadingDuringStartup) ||
+		(f == kSavesSupportBackgroundLoading);
 }
 
 bool Wage::WageEngine::hasFeature(EngineFeature f) const {
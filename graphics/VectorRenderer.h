@@ -294,6 +294,15 @@ public:
 	 */
 	virtual void setGradientColors(uint8 r1, uint8 g1, uint8 b1, uint8 r2, uint8 g2, uint8 b2) = 0;
 
+	/**
+	 * Get the colors used by the steps which don't set their own, as pixel
+	 * values: foreground, background, bevel and the two gradient colors.
+	 */
+	virtual void getColors(uint32 colors[5]) const = 0;
+
+	/** Whether shadows are drawn, see disableShadows(). */
+	bool shadowsEnabled() const { return !_disableShadows; }
+
 	/**
 	 * Sets the active drawing surface. All drawing from this
 	 * point on will be done on that surface.
@@ -492,6 +501,12 @@ public:
 	 */
 	virtual void drawStep(const Common::Rect &area, const Common::Rect &clip, const DrawStep &step, uint32 extra = 0);
 
+	/**
+	 * Sets up the renderer like drawStep() does, without drawing anything.
+	 * Used when the result of the step is already known.
+	 */
+	void applyStepState(const Common::Rect &area, const Common::Rect &clip, const DrawStep &step, uint32 extra = 0);
+
 	/**
 	 * Copies the part of the current frame to the system overlay.
 	 *
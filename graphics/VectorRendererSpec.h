@@ -80,6 +80,13 @@ public:
 	void setFgColor(uint8 r, uint8 g, uint8 b) override { _fgColor = _format.RGBToColor(r, g, b); }
 	void setBgColor(uint8 r, uint8 g, uint8 b) override { _bgColor = _format.RGBToColor(r, g, b); }
 	void setBevelColor(uint8 r, uint8 g, uint8 b) override { _bevelColor = _format.RGBToColor(r, g, b); }
+	void getColors(uint32 colors[5]) const override {
+		colors[0] = _fgColor;
+		colors[1] = _bgColor;
+		colors[2] = _bevelColor;
+		colors[3] = _gradientStart;
+		colors[4] = _gradientEnd;
+	}
 	void setGradientColors(uint8 r1, uint8 g1, uint8 b1, uint8 r2, uint8 g2, uint8 b2) override;
 	void setClippingRect(const Common::Rect &clippingArea) override { _clippingArea = clippingArea; }
 
@@ -0,0 +1,154 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#include "graphics/blit/blit-convert.h"
+
+#include <immintrin.h>
+
+#ifdef __GNUC__
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+
+namespace Graphics {
+
+namespace {
+
+/** A channel of CrossBlitChannel, in shift counts and masks for AVX2. */
+struct ChannelAVX2 {
+	__m128i srcShift, up, srcBits, dstLoss, dstShift;
+	__m256i srcMask, fill;
+};
+
+/** Narrow 8 values of 16 bits kept in 32-bit lanes. */
+static FORCEINLINE __m128i packAVX2(__m256i values) {
+	// Sign extend, so that the signed saturation keeps the values
+	values = _mm256_srai_epi32(_mm256_slli_epi32(values, 16), 16);
+	return _mm_packs_epi32(_mm256_castsi256_si128(values), _mm256_extracti128_si256(values, 1));
+}
+
+/** Convert 8 pixels. */
+static FORCEINLINE void convertAVX2(byte *dst, const byte *src, const byte *mask, uint x,
+                                    const ChannelAVX2 *channels, const CrossBlitParams &params) {
+	__m256i color;
+	if (params.srcFmt.bytesPerPixel == 2)
+		color = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)(src + x * 2)));
+	else
+		color = _mm256_loadu_si256((const __m256i *)(src + x * 4));
+
+	__m256i result = _mm256_setzero_si256();
+	for (int i = 0; i < 4; i++) {
+		const ChannelAVX2 &channel = channels[i];
+		__m256i value = _mm256_sll_epi32(_mm256_and_si256(_mm256_srl_epi32(color, channel.srcShift), channel.srcMask), channel.up);
+		value = _mm256_or_si256(_mm256_or_si256(value, _mm256_srl_epi32(value, channel.srcBits)), channel.fill);
+		result = _mm256_or_si256(result, _mm256_sll_epi32(_mm256_srl_epi32(value, channel.dstLoss), channel.dstShift));
+	}
+
+	// Keep the destination pixels which are skipped
+	__m256i skip = _mm256_setzero_si256();
+	if (params.hasKey)
+		skip = _mm256_cmpeq_epi32(color, _mm256_set1_epi32(params.key));
+	if (mask) {
+		const __m256i maskValues = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(mask + x)));
+		skip = _mm256_or_si256(skip, _mm256_cmpeq_epi32(maskValues, _mm256_setzero_si256()));
+	}
+
+	if (params.dstFmt.bytesPerPixel == 2) {
+		__m128i narrow = packAVX2(result);
+		if (params.hasKey || mask) {
+			const __m128i narrowSkip = packAVX2(skip);
+			const __m128i old = _mm_loadu_si128((const __m128i *)(dst + x * 2));
+			narrow = _mm_or_si128(_mm_andnot_si128(narrowSkip, narrow), _mm_and_si128(narrowSkip, old));
+		}
+		_mm_storeu_si128((__m128i *)(dst + x * 2), narrow);
+	} else {
+		if (params.hasKey || mask) {
+			const __m256i old = _mm256_loadu_si256((const __m256i *)(dst + x * 4));
+			result = _mm256_blendv_epi8(result, old, skip);
+		}
+		_mm256_storeu_si256((__m256i *)(dst + x * 4), result);
+	}
+}
+
+/** Look up 8 palette indices. */
+static FORCEINLINE void mapAVX2(byte *dst, const byte *src, uint x, uint bytesPerPixel, const uint32 *map) {
+	const __m256i indices = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(src + x)));
+	const __m256i colors = _mm256_i32gather_epi32((const int *)map, indices, 4);
+	if (bytesPerPixel == 2)
+		_mm_storeu_si128((__m128i *)(dst + x * 2), packAVX2(colors));
+	else
+		_mm256_storeu_si256((__m256i *)(dst + x * 4), colors);
+}
+
+} // End of anonymous namespace
+
+static void convertRowAVX2(byte *dst, const byte *src, const byte *mask, uint w, bool backward, const CrossBlitParams &params) {
+	CrossBlitChannel channels[4];
+	getCrossBlitChannels(channels, params);
+
+	ChannelAVX2 vectorChannels[4];
+	for (int i = 0; i < 4; i++) {
+		vectorChannels[i].srcShift = _mm_cvtsi32_si128(channels[i].srcShift);
+		vectorChannels[i].up = _mm_cvtsi32_si128(channels[i].up);
+		vectorChannels[i].srcBits = _mm_cvtsi32_si128(channels[i].srcBits);
+		vectorChannels[i].dstLoss = _mm_cvtsi32_si128(channels[i].dstLoss);
+		vectorChannels[i].dstShift = _mm_cvtsi32_si128(channels[i].dstShift);
+		vectorChannels[i].srcMask = _mm256_set1_epi32(channels[i].srcMask);
+		vectorChannels[i].fill = _mm256_set1_epi32(channels[i].fill);
+	}
+
+	const uint vectorEnd = w & ~7;
+	if (backward) {
+		crossBlitPixels(dst, src, mask, vectorEnd, w, true, params);
+		for (uint x = vectorEnd; x > 0; x -= 8)
+			convertAVX2(dst, src, mask, x - 8, vectorChannels, params);
+	} else {
+		for (uint x = 0; x < vectorEnd; x += 8)
+			convertAVX2(dst, src, mask, x, vectorChannels, params);
+		crossBlitPixels(dst, src, mask, vectorEnd, w, false, params);
+	}
+}
+
+static void mapRowAVX2(byte *dst, const byte *src, uint w, uint bytesPerPixel, bool backward, const uint32 *map) {
+	const uint vectorEnd = w & ~7;
+	if (backward) {
+		crossBlitMapPixels(dst, src, vectorEnd, w, bytesPerPixel, true, map);
+		for (uint x = vectorEnd; x > 0; x -= 8)
+			mapAVX2(dst, src, x - 8, bytesPerPixel, map);
+	} else {
+		for (uint x = 0; x < vectorEnd; x += 8)
+			mapAVX2(dst, src, x, bytesPerPixel, map);
+		crossBlitMapPixels(dst, src, vectorEnd, w, bytesPerPixel, false, map);
+	}
+}
+
+const CrossBlitKernels g_crossBlitKernelsAVX2 = {
+	convertRowAVX2,
+	mapRowAVX2
+};
+
+} // End of namespace Graphics
+
+#ifdef __GNUC__
+#pragma GCC pop_options
+#endif
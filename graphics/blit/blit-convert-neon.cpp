@@ -0,0 +1,130 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#ifdef SCUMMVM_NEON
+
+#include "graphics/blit/blit-convert.h"
+
+#include <arm_neon.h>
+
+#ifdef __GNUC__
+#pragma GCC push_options
+
+#if !defined(__aarch64__)
+#pragma GCC target("fpu=neon")
+#endif // !defined(__aarch64__)
+
+#endif // __GNUC__
+
+namespace Graphics {
+
+namespace {
+
+/** A channel of CrossBlitChannel, in shift counts and masks for NEON. Right shifts are negative. */
+struct ChannelNEON {
+	int32x4_t srcShift, up, srcBits, dstLoss, dstShift;
+	uint32x4_t srcMask, fill;
+};
+
+/** Convert 4 pixels. */
+static FORCEINLINE void convertNEON(byte *dst, const byte *src, const byte *mask, uint x,
+                                    const ChannelNEON *channels, const CrossBlitParams &params) {
+	uint32x4_t color;
+	if (params.srcFmt.bytesPerPixel == 2)
+		color = vmovl_u16(vld1_u16((const uint16 *)(src + x * 2)));
+	else
+		color = vld1q_u32((const uint32 *)(src + x * 4));
+
+	uint32x4_t result = vdupq_n_u32(0);
+	for (int i = 0; i < 4; i++) {
+		const ChannelNEON &channel = channels[i];
+		uint32x4_t value = vshlq_u32(vandq_u32(vshlq_u32(color, channel.srcShift), channel.srcMask), channel.up);
+		value = vorrq_u32(vorrq_u32(value, vshlq_u32(value, channel.srcBits)), channel.fill);
+		result = vorrq_u32(result, vshlq_u32(vshlq_u32(value, channel.dstLoss), channel.dstShift));
+	}
+
+	// Keep the destination pixels which are skipped
+	uint32x4_t skip = vdupq_n_u32(0);
+	if (params.hasKey)
+		skip = vceqq_u32(color, vdupq_n_u32(params.key));
+	if (mask) {
+		uint32 maskBytes;
+		memcpy(&maskBytes, mask + x, sizeof(maskBytes));
+		const uint32x4_t maskValues = vmovl_u16(vget_low_u16(vmovl_u8(vreinterpret_u8_u32(vdup_n_u32(maskBytes)))));
+		skip = vorrq_u32(skip, vceqq_u32(maskValues, vdupq_n_u32(0)));
+	}
+
+	if (params.dstFmt.bytesPerPixel == 2) {
+		uint16x4_t narrow = vmovn_u32(result);
+		if (params.hasKey || mask)
+			narrow = vbsl_u16(vmovn_u32(skip), vld1_u16((const uint16 *)(dst + x * 2)), narrow);
+		vst1_u16((uint16 *)(dst + x * 2), narrow);
+	} else {
+		if (params.hasKey || mask)
+			result = vbslq_u32(skip, vld1q_u32((const uint32 *)(dst + x * 4)), result);
+		vst1q_u32((uint32 *)(dst + x * 4), result);
+	}
+}
+
+} // End of anonymous namespace
+
+static void convertRowNEON(byte *dst, const byte *src, const byte *mask, uint w, bool backward, const CrossBlitParams &params) {
+	CrossBlitChannel channels[4];
+	getCrossBlitChannels(channels, params);
+
+	ChannelNEON vectorChannels[4];
+	for (int i = 0; i < 4; i++) {
+		vectorChannels[i].srcShift = vdupq_n_s32(-channels[i].srcShift);
+		vectorChannels[i].up = vdupq_n_s32(channels[i].up);
+		vectorChannels[i].srcBits = vdupq_n_s32(-channels[i].srcBits);
+		vectorChannels[i].dstLoss = vdupq_n_s32(-channels[i].dstLoss);
+		vectorChannels[i].dstShift = vdupq_n_s32(channels[i].dstShift);
+		vectorChannels[i].srcMask = vdupq_n_u32(channels[i].srcMask);
+		vectorChannels[i].fill = vdupq_n_u32(channels[i].fill);
+	}
+
+	const uint vectorEnd = w & ~3;
+	if (backward) {
+		crossBlitPixels(dst, src, mask, vectorEnd, w, true, params);
+		for (uint x = vectorEnd; x > 0; x -= 4)
+			convertNEON(dst, src, mask, x - 4, vectorChannels, params);
+	} else {
+		for (uint x = 0; x < vectorEnd; x += 4)
+			convertNEON(dst, src, mask, x, vectorChannels, params);
+		crossBlitPixels(dst, src, mask, vectorEnd, w, false, params);
+	}
+}
+
+const CrossBlitKernels g_crossBlitKernelsNEON = {
+	convertRowNEON,
+	// Without gathers, the table lookups do not get faster
+	nullptr
+};
+
+} // End of namespace Graphics
+
+#ifdef __GNUC__
+#pragma GCC pop_options
+#endif
+
+#endif // SCUMMVM_NEON
@@ -0,0 +1,133 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#include "graphics/blit/blit-convert.h"
+
+#include <emmintrin.h>
+
+#ifdef __GNUC__
+#pragma GCC push_options
+
+#ifndef __x86_64__
+#pragma GCC target("sse2")
+#endif
+
+#endif
+
+namespace Graphics {
+
+namespace {
+
+/** A channel of CrossBlitChannel, in shift counts and masks for SSE2. */
+struct ChannelSSE2 {
+	__m128i srcShift, srcMask, up, srcBits, fill, dstLoss, dstShift;
+};
+
+/** Convert 4 pixels. */
+static FORCEINLINE void convertSSE2(byte *dst, const byte *src, const byte *mask, uint x,
+                                    const ChannelSSE2 *channels, const CrossBlitParams &params) {
+	const __m128i zero = _mm_setzero_si128();
+	__m128i color;
+	if (params.srcFmt.bytesPerPixel == 2)
+		color = _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i *)(src + x * 2)), zero);
+	else
+		color = _mm_loadu_si128((const __m128i *)(src + x * 4));
+
+	__m128i result = zero;
+	for (int i = 0; i < 4; i++) {
+		const ChannelSSE2 &channel = channels[i];
+		__m128i value = _mm_sll_epi32(_mm_and_si128(_mm_srl_epi32(color, channel.srcShift), channel.srcMask), channel.up);
+		value = _mm_or_si128(_mm_or_si128(value, _mm_srl_epi32(value, channel.srcBits)), channel.fill);
+		result = _mm_or_si128(result, _mm_sll_epi32(_mm_srl_epi32(value, channel.dstLoss), channel.dstShift));
+	}
+
+	// Keep the destination pixels which are skipped
+	__m128i skip = zero;
+	if (params.hasKey)
+		skip = _mm_cmpeq_epi32(color, _mm_set1_epi32(params.key));
+	if (mask) {
+		uint32 maskBytes;
+		memcpy(&maskBytes, mask + x, sizeof(maskBytes));
+		const __m128i maskValues = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(maskBytes), zero), zero);
+		skip = _mm_or_si128(skip, _mm_cmpeq_epi32(maskValues, zero));
+	}
+
+	if (params.dstFmt.bytesPerPixel == 2) {
+		// Sign extend, so that the signed saturation keeps the values
+		result = _mm_srai_epi32(_mm_slli_epi32(result, 16), 16);
+		result = _mm_packs_epi32(result, result);
+		if (params.hasKey || mask) {
+			skip = _mm_packs_epi32(skip, skip);
+			const __m128i old = _mm_loadl_epi64((const __m128i *)(dst + x * 2));
+			result = _mm_or_si128(_mm_andnot_si128(skip, result), _mm_and_si128(skip, old));
+		}
+		_mm_storel_epi64((__m128i *)(dst + x * 2), result);
+	} else {
+		if (params.hasKey || mask) {
+			const __m128i old = _mm_loadu_si128((const __m128i *)(dst + x * 4));
+			result = _mm_or_si128(_mm_andnot_si128(skip, result), _mm_and_si128(skip, old));
+		}
+		_mm_storeu_si128((__m128i *)(dst + x * 4), result);
+	}
+}
+
+} // End of anonymous namespace
+
+static void convertRowSSE2(byte *dst, const byte *src, const byte *mask, uint w, bool backward, const CrossBlitParams &params) {
+	CrossBlitChannel channels[4];
+	getCrossBlitChannels(channels, params);
+
+	ChannelSSE2 vectorChannels[4];
+	for (int i = 0; i < 4; i++) {
+		vectorChannels[i].srcShift = _mm_cvtsi32_si128(channels[i].srcShift);
+		vectorChannels[i].srcMask = _mm_set1_epi32(channels[i].srcMask);
+		vectorChannels[i].up = _mm_cvtsi32_si128(channels[i].up);
+		vectorChannels[i].srcBits = _mm_cvtsi32_si128(channels[i].srcBits);
+		vectorChannels[i].fill = _mm_set1_epi32(channels[i].fill);
+		vectorChannels[i].dstLoss = _mm_cvtsi32_si128(channels[i].dstLoss);
+		vectorChannels[i].dstShift = _mm_cvtsi32_si128(channels[i].dstShift);
+	}
+
+	const uint vectorEnd = w & ~3;
+	if (backward) {
+		crossBlitPixels(dst, src, mask, vectorEnd, w, true, params);
+		for (uint x = vectorEnd; x > 0; x -= 4)
+			convertSSE2(dst, src, mask, x - 4, vectorChannels, params);
+	} else {
+		for (uint x = 0; x < vectorEnd; x += 4)
+			convertSSE2(dst, src, mask, x, vectorChannels, params);
+		crossBlitPixels(dst, src, mask, vectorEnd, w, false, params);
+	}
+}
+
+const CrossBlitKernels g_crossBlitKernelsSSE2 = {
+	convertRowSSE2,
+	// Without gathers, the table lookups do not get faster
+	nullptr
+};
+
+} // End of namespace Graphics
+
+#ifdef __GNUC__
+#pragma GCC pop_options
+#endif
@@ -0,0 +1,164 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef GRAPHICS_BLIT_BLIT_CONVERT_H
+#define GRAPHICS_BLIT_BLIT_CONVERT_H
+
+#include "graphics/pixelformat.h"
+
+namespace Graphics {
+
+/** Conversion settings for the row converters, see CrossBlitKernels. */
+struct CrossBlitParams {
+	PixelFormat srcFmt, dstFmt;
+	bool hasKey;
+	uint32 key;
+};
+
+/**
+ * Row converters of crossBlit(), crossKeyBlit(), crossMaskBlit() and
+ * crossBlitMap(), used instead of the per pixel templates. The generic
+ * version lives in blit.cpp, vectorized versions in blit-convert-sse2.cpp,
+ * blit-convert-avx2.cpp and blit-convert-neon.cpp. All versions must produce
+ * the same pixels as PixelFormat::colorToARGB() and ARGBToColor().
+ */
+struct CrossBlitKernels {
+	/**
+	 * Convert a row of @p w pixels between two formats accepted by
+	 * canCrossBlitRow(). Pixels matching the key, or with a zero @p mask byte,
+	 * are left alone. The mask may be nullptr. With @p backward, the row is
+	 * converted from its end, so that it can grow in place.
+	 */
+	void (*convertRow)(byte *dst, const byte *src, const byte *mask, uint w, bool backward, const CrossBlitParams &params);
+
+	/**
+	 * Look up a row of @p w palette indices in @p map, for 2 or 4 bytes per
+	 * pixel. nullptr if the lookups are not vectorized.
+	 */
+	void (*mapRow)(byte *dst, const byte *src, uint w, uint bytesPerPixel, bool backward, const uint32 *map);
+};
+
+#ifdef SCUMMVM_NEON
+extern const CrossBlitKernels g_crossBlitKernelsNEON;
+#endif
+#ifdef SCUMMVM_SSE2
+extern const CrossBlitKernels g_crossBlitKernelsSSE2;
+#endif
+#ifdef SCUMMVM_AVX2
+extern const CrossBlitKernels g_crossBlitKernelsAVX2;
+#endif
+
+/** Return the generic converters, the reference for the vectorized ones. */
+const CrossBlitKernels &getGenericCrossBlitKernels();
+
+/**
+ * Return the converters used by crossBlit() and friends, detecting the
+ * fastest vectorized ones supported by the CPU on the first call. nullptr
+ * means the per pixel templates.
+ */
+const CrossBlitKernels *getCrossBlitKernels();
+
+/** Select the converters used by crossBlit() and friends, for testing. */
+void setCrossBlitKernels(const CrossBlitKernels *kernels);
+
+/**
+ * Whether the row converters handle the formats: 2 or 4 bytes per pixel,
+ * and channels of 4 to 8 bits, except for a missing alpha channel.
+ */
+inline bool canCrossBlitRow(const PixelFormat &srcFmt, const PixelFormat &dstFmt) {
+	if ((srcFmt.bytesPerPixel != 2 && srcFmt.bytesPerPixel != 4) ||
+	    (dstFmt.bytesPerPixel != 2 && dstFmt.bytesPerPixel != 4))
+		return false;
+
+	return srcFmt.rBits() >= 4 && srcFmt.gBits() >= 4 && srcFmt.bBits() >= 4 &&
+	       (srcFmt.aBits() == 0 || srcFmt.aBits() >= 4);
+}
+
+/**
+ * How the row converters move a channel: ((color >> srcShift) & srcMask)
+ * << up, repeated down by srcBits, ORed with fill, then reduced to the
+ * destination with (value >> dstLoss) << dstShift.
+ */
+struct CrossBlitChannel {
+	int srcShift;
+	uint32 srcMask;
+	int up;
+	int srcBits;
+	uint32 fill;
+	int dstLoss;
+	int dstShift;
+};
+
+/** Describe the alpha, red, green and blue channels of a conversion. */
+inline void getCrossBlitChannels(CrossBlitChannel channels[4], const CrossBlitParams &params) {
+	const PixelFormat &src = params.srcFmt, &dst = params.dstFmt;
+	const int srcBits[4] = { src.aBits(), src.rBits(), src.gBits(), src.bBits() };
+	const int srcShifts[4] = { src.aShift, src.rShift, src.gShift, src.bShift };
+	const int dstLosses[4] = { dst.aLoss, dst.rLoss, dst.gLoss, dst.bLoss };
+	const int dstShifts[4] = { dst.aShift, dst.rShift, dst.gShift, dst.bShift };
+
+	for (int i = 0; i < 4; i++) {
+		CrossBlitChannel &channel = channels[i];
+		channel.srcShift = srcShifts[i];
+		channel.srcMask = (1 << srcBits[i]) - 1;
+		channel.up = 8 - srcBits[i];
+		channel.srcBits = srcBits[i];
+		// A missing alpha channel is opaque, see PixelFormat::colorToARGB()
+		channel.fill = srcBits[i] ? 0 : 0xFF;
+		channel.dstLoss = dstLosses[i];
+		channel.dstShift = dstShifts[i];
+	}
+}
+
+/** Convert the pixels of a row from @p first to @p last, one at a time. */
+FORCEINLINE void crossBlitPixels(byte *dst, const byte *src, const byte *mask, uint first, uint last,
+                                 bool backward, const CrossBlitParams &params) {
+	for (uint i = first; i < last; i++) {
+		const uint x = backward ? last - 1 - (i - first) : i;
+		const uint32 color = params.srcFmt.bytesPerPixel == 2 ? ((const uint16 *)src)[x] : ((const uint32 *)src)[x];
+		if ((params.hasKey && color == params.key) || (mask && !mask[x]))
+			continue;
+
+		byte a, r, g, b;
+		params.srcFmt.colorToARGB(color, a, r, g, b);
+		const uint32 result = params.dstFmt.ARGBToColor(a, r, g, b);
+		if (params.dstFmt.bytesPerPixel == 2)
+			((uint16 *)dst)[x] = result;
+		else
+			((uint32 *)dst)[x] = result;
+	}
+}
+
+/** Look up the palette indices of a row from @p first to @p last, one at a time. */
+FORCEINLINE void crossBlitMapPixels(byte *dst, const byte *src, uint first, uint last, uint bytesPerPixel,
+                                    bool backward, const uint32 *map) {
+	for (uint i = first; i < last; i++) {
+		const uint x = backward ? last - 1 - (i - first) : i;
+		if (bytesPerPixel == 2)
+			((uint16 *)dst)[x] = map[src[x]];
+		else
+			((uint32 *)dst)[x] = map[src[x]];
+	}
+}
+
+} // End of namespace Graphics
+
+#endif
@@ -20,8 +20,10 @@
  */
 
 #include "graphics/blit.h"
+#include "graphics/blit/blit-convert.h"
 #include "graphics/pixelformat.h"
 #include "common/endian.h"
+#include "common/system.h"
 
 namespace Graphics {
 
@@ -265,6 +267,69 @@ inline void crossBlitLogic1BppSource(byte *dst, const byte *src, const byte *mas
 
 } // End of anonymous namespace
 
+static void convertRowGeneric(byte *dst, const byte *src, const byte *mask, uint w, bool backward, const CrossBlitParams &params) {
+	crossBlitPixels(dst, src, mask, 0, w, backward, params);
+}
+
+static void mapRowGeneric(byte *dst, const byte *src, uint w, uint bytesPerPixel, bool backward, const uint32 *map) {
+	crossBlitMapPixels(dst, src, 0, w, bytesPerPixel, backward, map);
+}
+
+static const CrossBlitKernels crossBlitKernelsGeneric = {
+	convertRowGeneric,
+	mapRowGeneric
+};
+
+const CrossBlitKernels &getGenericCrossBlitKernels() {
+	return crossBlitKernelsGeneric;
+}
+
+static const CrossBlitKernels *crossBlitKernels = nullptr;
+static bool crossBlitKernelsDetected = false;
+
+const CrossBlitKernels *getCrossBlitKernels() {
+	// If no kernels have been selected yet, detect and select
+	if (!crossBlitKernelsDetected) {
+		crossBlitKernelsDetected = true;
+#ifdef SCUMMVM_NEON
+		if (g_system->hasFeature(OSystem::kFeatureCpuNEON)) crossBlitKernels = &g_crossBlitKernelsNEON;
+#endif
+#ifdef SCUMMVM_SSE2
+		if (g_system->hasFeature(OSystem::kFeatureCpuSSE2)) crossBlitKernels = &g_crossBlitKernelsSSE2;
+#endif
+#ifdef SCUMMVM_AVX2
+		if (g_system->hasFeature(OSystem::kFeatureCpuAVX2)) crossBlitKernels = &g_crossBlitKernelsAVX2;
+#endif
+	}
+
+	return crossBlitKernels;
+}
+
+void setCrossBlitKernels(const CrossBlitKernels *kernels) {
+	crossBlitKernels = kernels;
+	crossBlitKernelsDetected = true;
+}
+
+/**
+ * Convert the rows with the row converters, if they handle the formats.
+ * Rows go in the same direction as in crossBlitLogic(), so that surfaces
+ * can still be converted in place.
+ */
+static bool crossBlitRows(byte *dst, const byte *src, const byte *mask,
+						  const uint dstPitch, const uint srcPitch, const uint maskPitch,
+						  const uint w, const uint h, const CrossBlitParams &params) {
+	const CrossBlitKernels *kernels = getCrossBlitKernels();
+	if (!kernels || !canCrossBlitRow(params.srcFmt, params.dstFmt))
+		return false;
+
+	const bool backward = params.dstFmt.bytesPerPixel > params.srcFmt.bytesPerPixel;
+	for (uint i = 0; i < h; ++i) {
+		const uint y = backward ? h - 1 - i : i;
+		kernels->convertRow(dst + y * dstPitch, src + y * srcPitch, mask ? mask + y * maskPitch : nullptr, w, backward, params);
+	}
+	return true;
+}
+
 // Function to blit a rect from one color format to another
 bool crossBlit(byte *dst, const byte *src,
 			   const uint dstPitch, const uint srcPitch,
@@ -281,6 +346,10 @@ bool crossBlit(byte *dst, const byte *src,
 		return true;
 	}
 
+	const CrossBlitParams params = { srcFmt, dstFmt, false, 0 };
+	if (crossBlitRows(dst, src, nullptr, dstPitch, srcPitch, 0, w, h, params))
+		return true;
+
 	// Faster, but larger, to provide optimized handling for each case.
 	const uint srcDelta = (srcPitch - w * srcFmt.bytesPerPixel);
 	const uint dstDelta = (dstPitch - w * dstFmt.bytesPerPixel);
@@ -353,6 +422,10 @@ bool crossKeyBlit(byte *dst, const byte *src,
 		return true;
 	}
 
+	const CrossBlitParams params = { srcFmt, dstFmt, true, key };
+	if (crossBlitRows(dst, src, nullptr, dstPitch, srcPitch, 0, w, h, params))
+		return true;
+
 	// Faster, but larger, to provide optimized handling for each case.
 	const uint srcDelta = (srcPitch - w * srcFmt.bytesPerPixel);
 	const uint dstDelta = (dstPitch - w * dstFmt.bytesPerPixel);
@@ -425,6 +498,10 @@ bool crossMaskBlit(byte *dst, const byte *src, const byte *mask,
 		return true;
 	}
 
+	const CrossBlitParams params = { srcFmt, dstFmt, false, 0 };
+	if (crossBlitRows(dst, src, mask, dstPitch, srcPitch, maskPitch, w, h, params))
+		return true;
+
 	// Faster, but larger, to provide optimized handling for each case.
 	const uint srcDelta  = (srcPitch  - w * srcFmt.bytesPerPixel);
 	const uint dstDelta  = (dstPitch  - w * dstFmt.bytesPerPixel);
@@ -448,6 +525,7 @@ bool crossMaskBlit(byte *dst, const byte *src, const byte *mask,
 			// color than per source color.
 			dst += h * dstPitch - dstDelta - dstFmt.bytesPerPixel;
 			src += h * srcPitch - srcDelta - srcFmt.bytesPerPixel;
+			mask += h * maskPitch - maskDelta - 1;
 			crossBlitLogic<uint16, 2, uint8, 3, true, false, true>(dst, src, mask, w, h, srcFmt, dstFmt, srcDelta, dstDelta, maskDelta, 0);
 		} else if (srcFmt.bytesPerPixel == 3) {
 			crossBlitLogic<uint8, 3, uint8, 3, false, false, true>(dst, src, mask, w, h, srcFmt, dstFmt, srcDelta, dstDelta, maskDelta, 0);
@@ -463,6 +541,7 @@ bool crossMaskBlit(byte *dst, const byte *src, const byte *mask,
 			// color than per source color.
 			dst += h * dstPitch - dstDelta - dstFmt.bytesPerPixel;
 			src += h * srcPitch - srcDelta - srcFmt.bytesPerPixel;
+			mask += h * maskPitch - maskDelta - 1;
 			crossBlitLogic<uint16, 2, uint32, 4, true, false, true>(dst, src, mask, w, h, srcFmt, dstFmt, srcDelta, dstDelta, maskDelta, 0);
 		} else if (srcFmt.bytesPerPixel == 3) {
 			// We need to blit the surface from bottom right to top left here.
@@ -472,6 +551,7 @@ bool crossMaskBlit(byte *dst, const byte *src, const byte *mask,
 			// color than per source color.
 			dst += h * dstPitch - dstDelta - dstFmt.bytesPerPixel;
 			src += h * srcPitch - srcDelta - srcFmt.bytesPerPixel;
+			mask += h * maskPitch - maskDelta - 1;
 			crossBlitLogic<uint8, 3, uint32, 4, true, false, true>(dst, src, mask, w, h, srcFmt, dstFmt, srcDelta, dstDelta, maskDelta, 0);
 		} else {
 			crossBlitLogic<uint32, 4, uint32, 4, false, false, true>(dst, src, mask, w, h, srcFmt, dstFmt, srcDelta, dstDelta, maskDelta, 0);
@@ -491,6 +571,14 @@ bool crossBlitMap(byte *dst, const byte *src,
 	if (!bytesPerPixel)
 		return false;
 
+	// Look up the rows from the bottom, like below
+	const CrossBlitKernels *kernels = getCrossBlitKernels();
+	if (kernels && kernels->mapRow && (bytesPerPixel == 2 || bytesPerPixel == 4)) {
+		for (uint y = h; y-- > 0;)
+			kernels->mapRow(dst + y * dstPitch, src + y * srcPitch, w, bytesPerPixel, true, map);
+		return true;
+	}
+
 	// Faster, but larger, to provide optimized handling for each case.
 	const uint srcDelta = (srcPitch - w);
 	const uint dstDelta = (dstPitch - w * bytesPerPixel);
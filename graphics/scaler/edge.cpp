@@ -305,75 +305,46 @@ uint16 convertTo16Bit(const typename ColorMask::PixelType p) {
 }
 
 
-template<typename ColorMask>
-int16 *EdgeScaler::chooseGreyscale(typename ColorMask::PixelType *pixels) {
-	int i, j;
-	int32 scores[3];
-
-	for (i = 0; i < 3; i++) {
-		int16 *diff_ptr;
-		int16 *bptr;
-		typename ColorMask::PixelType *pptr;
-		int16 *grey_ptr;
-		int16 center;
-		int32 sum_diffs;
-
-		sum_diffs = 0;
-
-		grey_ptr = _greyscaleTable[i];
-
-		/* fill the 9 pixel window with greyscale values */
-		bptr = _bplanes[i];
-		pptr = pixels;
-		for (j = 9; j; --j)
-			*bptr++ = grey_ptr[convertTo16Bit<ColorMask>(*pptr++)];
-		bptr = _bplanes[i];
-
-		center = grey_ptr[convertTo16Bit<ColorMask>(pixels[4])];
-		diff_ptr = _greyscaleDiffs[i];
+void edgeGreyDiffsGeneric(const int16 *windows, int16 *diffs, int32 *scores, uint count) {
+	for (uint i = 0; i < count; i++, windows += 9, diffs += 8) {
+		const int16 center = windows[4];
+		int32 sum_diffs = 0;
 
 		/* calculate the delta from center pixel */
-		diff_ptr[0] = bptr[0] - center;
-		diff_ptr[1] = bptr[1] - center;
-		diff_ptr[2] = bptr[2] - center;
-		diff_ptr[3] = bptr[3] - center;
-		diff_ptr[4] = bptr[5] - center;
-		diff_ptr[5] = bptr[6] - center;
-		diff_ptr[6] = bptr[7] - center;
-		diff_ptr[7] = bptr[8] - center;
+		diffs[0] = windows[0] - center;
+		diffs[1] = windows[1] - center;
+		diffs[2] = windows[2] - center;
+		diffs[3] = windows[3] - center;
+		diffs[4] = windows[5] - center;
+		diffs[5] = windows[6] - center;
+		diffs[6] = windows[7] - center;
+		diffs[7] = windows[8] - center;
 
 		/* calculate sum of squares distance */
-		for (j = 8; j; --j) {
-			sum_diffs += *diff_ptr * *diff_ptr;
-			++diff_ptr;
-		}
+		for (int j = 0; j < 8; j++)
+			sum_diffs += diffs[j] * diffs[j];
 
 		scores[i] = sum_diffs;
 	}
+}
 
-	/* choose greyscale with highest score, ties decided in GRB order */
-
-	if (scores[1] >= scores[0] && scores[1] >= scores[2]) {
-		if (!scores[1]) return NULL;
-
-		_chosenGreyscale = _greyscaleTable[1];
-		_bptr = _bplanes[1];
-		return _greyscaleDiffs[1];
-	}
-
-	if (scores[0] >= scores[1] && scores[0] >= scores[2]) {
-		if (!scores[0]) return NULL;
+int16 *EdgeScaler::chooseGreyscale(int window) {
+	const int32 *scores = &_rowScores[window];
+	int i;
 
-		_chosenGreyscale = _greyscaleTable[0];
-		_bptr = _bplanes[0];
-		return _greyscaleDiffs[0];
-	}
+	/* choose greyscale with highest score, ties decided in GRB order */
+	if (scores[1] >= scores[0] && scores[1] >= scores[2])
+		i = 1;
+	else if (scores[0] >= scores[1] && scores[0] >= scores[2])
+		i = 0;
+	else
+		i = 2;
 
-	if (!scores[2]) return NULL;
+	if (!scores[i]) return NULL;
 
-	_chosenGreyscale = _greyscaleTable[2];
-	_bptr = _bplanes[2];
-	return _greyscaleDiffs[2];
+	_chosenGreyscale = _greyscaleTable[i];
+	_bptr = &_rowWindows[(window + i) * 9];
+	return &_rowDiffs[(window + i) * 8];
 }
 
 
@@ -3307,6 +3278,70 @@ void drawUnchangedGrid2x(byte *dptr, int dstPitch,
 }
 
 
+/* Fill the 3x3 grid around a pixel */
+template<typename Pixel>
+static inline void fillGrid(const Pixel *sptr16, int srcPitch, Pixel *pixels) {
+	const Pixel *sptr2, *addr3;
+
+	sptr2 = ((const Pixel *)((const uint8 *) sptr16 - srcPitch)) - 1;
+	addr3 = ((const Pixel *)((const uint8 *) sptr16 + srcPitch)) + 1;
+
+	memcpy(pixels, sptr2, 3 * sizeof(Pixel));
+	memcpy(pixels + 3, sptr16 - 1, 3 * sizeof(Pixel));
+	memcpy(pixels + 6, addr3 - 2, 3 * sizeof(Pixel));
+}
+
+
+template<typename ColorMask>
+void EdgeScaler::scoreGreyscaleRow(const uint8 *src, int w, int y, int h,
+								   int srcPitch,
+								   bool haveOldSrc,
+								   const uint8 *oldSrc, int oldPitch) {
+	typedef typename ColorMask::PixelType Pixel;
+
+	const Pixel *sptr16 = (const Pixel *) src;
+	const Pixel *oldSptr = (const Pixel *) oldSrc;
+	int x, i, j;
+	int count = 0;
+
+	_rowFirstWindow.resize(w);
+	_rowWindows.resize(w * 3 * 9);
+	_rowDiffs.resize(w * 3 * 8);
+	_rowScores.resize(w * 3);
+
+	for (x = 0; x < w; x++, sptr16++, oldSptr++) {
+		Pixel pixels[9];
+
+		fillGrid<Pixel>(sptr16, srcPitch, pixels);
+
+		if (haveOldSrc) {
+			/* skip interior unchanged 3x3 blocks */
+			if (*sptr16 == *oldSptr &&
+#if DEBUG_DRAW_REFRESH_BORDERS
+					x > 0 && x < w - 1 && y > 0 && y < h - 1 &&
+#endif
+					checkUnchangedPixels<Pixel>(oldSptr, pixels, oldPitch / sizeof(Pixel))) {
+				_rowFirstWindow[x] = -1;
+				continue;
+			}
+		}
+
+		/* fill the 9 pixel windows with greyscale values */
+		_rowFirstWindow[x] = count;
+		for (i = 0; i < 3; i++, count++) {
+			const int16 *grey_ptr = _greyscaleTable[i];
+			int16 *bptr = &_rowWindows[count * 9];
+
+			for (j = 0; j < 9; j++)
+				bptr[j] = grey_ptr[convertTo16Bit<ColorMask>(pixels[j])];
+		}
+	}
+
+	if (count)
+		_greyDiffs(&_rowWindows[0], &_rowDiffs[0], &_rowScores[0], count);
+}
+
+
 template<typename ColorMask>
 void EdgeScaler::antiAliasPass3x(const uint8 *src, uint8 *dst,
 								 int w, int h,
@@ -3320,7 +3355,6 @@ void EdgeScaler::antiAliasPass3x(const uint8 *src, uint8 *dst,
 	const uint8 *sptr8 = src;
 	uint8 *dptr8 = dst + dstPitch + sizeof(Pixel);
 	const Pixel *sptr16;
-	const Pixel *oldSptr;
 	const Pixel *oldDptr;
 	Pixel *dptr16;
 	int16 *bplane;
@@ -3332,41 +3366,29 @@ void EdgeScaler::antiAliasPass3x(const uint8 *src, uint8 *dst,
 	int bufferPitch3 = bufferPitch * 3;
 
 	for (y = 0; y < h; y++, sptr8 += srcPitch, dptr8 += dstPitch3, oldSrc += oldPitch, buffer += bufferPitch3) {
+		scoreGreyscaleRow<ColorMask>(sptr8, w, y, h, srcPitch, haveOldSrc, oldSrc, oldPitch);
+
 		for (x = 0,
 		        sptr16 = (const Pixel *) sptr8,
-		        oldSptr = (const Pixel *) oldSrc,
 		        oldDptr = (const Pixel *) buffer,
 		        dptr16 = (Pixel *) dptr8;
-		        x < w; x++, sptr16++, dptr16 += 3, oldDptr += 3, oldSptr++) {
-			const Pixel *sptr2, *addr3;
+		        x < w; x++, sptr16++, dptr16 += 3, oldDptr += 3) {
 			Pixel pixels[9];
 			char edge_type;
 
-			sptr2 = ((const Pixel *)((const uint8 *) sptr16 - srcPitch)) - 1;
-			addr3 = ((const Pixel *)((const uint8 *) sptr16 + srcPitch)) + 1;
-
-			/* fill the 3x3 grid */
-			memcpy(pixels, sptr2, 3 * sizeof(Pixel));
-			memcpy(pixels + 3, sptr16 - 1, 3 * sizeof(Pixel));
-			memcpy(pixels + 6, addr3 - 2, 3 * sizeof(Pixel));
-
-			if (haveOldSrc) {
-				/* skip interior unchanged 3x3 blocks */
-				if (*sptr16 == *oldSptr &&
-#if DEBUG_DRAW_REFRESH_BORDERS
-						x > 0 && x < w - 1 && y > 0 && y < h - 1 &&
-#endif
-						checkUnchangedPixels(oldSptr, pixels, oldPitch / sizeof(Pixel))) {
-					drawUnchangedGrid3x<Pixel>((byte *)dptr16, dstPitch, (const byte *)oldDptr, bufferPitch);
+			/* skip interior unchanged 3x3 blocks */
+			if (_rowFirstWindow[x] < 0) {
+				drawUnchangedGrid3x<Pixel>((byte *)dptr16, dstPitch, (const byte *)oldDptr, bufferPitch);
 
 #if DEBUG_REFRESH_RANDOM_XOR
-					*(dptr16 + 1) = 0;
+				*(dptr16 + 1) = 0;
 #endif
-					continue;
-				}
+				continue;
 			}
 
-			diffs = chooseGreyscale<ColorMask>(pixels);
+			fillGrid<Pixel>(sptr16, srcPitch, pixels);
+
+			diffs = chooseGreyscale(_rowFirstWindow[x]);
 
 			/* block of solid color */
 			if (!diffs) {
@@ -3405,7 +3427,6 @@ void EdgeScaler::antiAliasPass2x(const uint8 *src, uint8 *dst,
 	const uint8 *sptr8 = src;
 	uint8 *dptr8 = dst;
 	const Pixel *sptr16;
-	const Pixel *oldSptr;
 	const Pixel *oldDptr;
 	Pixel *dptr16;
 	int16 *bplane;
@@ -3417,41 +3438,29 @@ void EdgeScaler::antiAliasPass2x(const uint8 *src, uint8 *dst,
 	int bufferPitch2 = bufferPitch * 2;
 
 	for (y = 0; y < h; y++, sptr8 += srcPitch, dptr8 += dstPitch2, oldSrc += oldSrcPitch, buffer += bufferPitch2) {
+		scoreGreyscaleRow<ColorMask>(sptr8, w, y, h, srcPitch, haveOldSrc, oldSrc, oldSrcPitch);
+
 		for (x = 0,
 		        sptr16 = (const Pixel *) sptr8,
 		        dptr16 = (Pixel *) dptr8,
-				oldSptr = (const Pixel *) oldSrc,
 				oldDptr = (const Pixel *) buffer;
-		        x < w; x++, sptr16++, dptr16 += 2, oldDptr += 2, oldSptr++) {
-			const Pixel *sptr2, *addr3;
+		        x < w; x++, sptr16++, dptr16 += 2, oldDptr += 2) {
 			Pixel pixels[9];
 			char edge_type;
 
-			sptr2 = ((const Pixel *)((const uint8 *) sptr16 - srcPitch)) - 1;
-			addr3 = ((const Pixel *)((const uint8 *) sptr16 + srcPitch)) + 1;
-
-			/* fill the 3x3 grid */
-			memcpy(pixels, sptr2, 3 * sizeof(Pixel));
-			memcpy(pixels + 3, sptr16 - 1, 3 * sizeof(Pixel));
-			memcpy(pixels + 6, addr3 - 2, 3 * sizeof(Pixel));
-
-			if (haveOldSrc) {
-				/* skip interior unchanged 3x3 blocks */
-				if (*sptr16 == *oldSptr &&
-#if DEBUG_DRAW_REFRESH_BORDERS
-						x > 0 && x < w - 1 && y > 0 && y < h - 1 &&
-#endif
-						checkUnchangedPixels<Pixel>(oldSptr, pixels, oldSrcPitch / sizeof(Pixel))) {
-					drawUnchangedGrid2x<Pixel>((byte *)dptr16, dstPitch, (const byte *)oldDptr, bufferPitch);
+			/* skip interior unchanged 3x3 blocks */
+			if (_rowFirstWindow[x] < 0) {
+				drawUnchangedGrid2x<Pixel>((byte *)dptr16, dstPitch, (const byte *)oldDptr, bufferPitch);
 
 #if DEBUG_REFRESH_RANDOM_XOR
-					*(dptr16 + 1) = 0;
+				*(dptr16 + 1) = 0;
 #endif
-					continue;
-				}
+				continue;
 			}
 
-			diffs = chooseGreyscale<ColorMask>(pixels);
+			fillGrid<Pixel>(sptr16, srcPitch, pixels);
+
+			diffs = chooseGreyscale(_rowFirstWindow[x]);
 
 			/* block of solid color */
 			if (!diffs) {
@@ -3533,6 +3542,14 @@ void EdgeScaler::initTables(const uint8 *srcPtr, uint32 srcPitch,
 EdgeScaler::EdgeScaler(const Graphics::PixelFormat &format) : SourceScaler(format) {
 	_factor = 2;
 
+	_greyDiffs = edgeGreyDiffsGeneric;
+#ifdef SCUMMVM_NEON
+	if (g_system->hasFeature(OSystem::kFeatureCpuNEON)) _greyDiffs = edgeGreyDiffsNEON;
+#endif
+#ifdef SCUMMVM_SSE2
+	if (g_system->hasFeature(OSystem::kFeatureCpuSSE2)) _greyDiffs = edgeGreyDiffsSSE2;
+#endif
+
 	initTables(0, 0, 0, 0);
 }
 
@@ -21,8 +21,29 @@
 #ifndef GRAPHICS_SCALER_EDGE_H
 #define GRAPHICS_SCALER_EDGE_H
 
+#include "common/array.h"
 #include "graphics/scalerplugin.h"
 
+/**
+ * Score @p count 3x3 windows of 9 greyscale values each, for
+ * EdgeScaler::chooseGreyscale(): store the differences of the 8 neighbours
+ * from the center value in @p diffs, 8 per window, and the sum of their
+ * squares in @p scores. The generic version lives in edge.cpp, vectorized
+ * versions in edge_sse2.cpp and edge_neon.cpp. All versions must return the
+ * same values.
+ */
+typedef void (*EdgeGreyDiffsFunc)(const int16 *windows, int16 *diffs, int32 *scores, uint count);
+
+/** The generic version, the reference for the vectorized ones. */
+void edgeGreyDiffsGeneric(const int16 *windows, int16 *diffs, int32 *scores, uint count);
+
+#ifdef SCUMMVM_NEON
+void edgeGreyDiffsNEON(const int16 *windows, int16 *diffs, int32 *scores, uint count);
+#endif
+#ifdef SCUMMVM_SSE2
+void edgeGreyDiffsSSE2(const int16 *windows, int16 *diffs, int32 *scores, uint count);
+#endif
+
 class EdgeScaler : public SourceScaler {
 public:
 
@@ -37,11 +58,25 @@ protected:
 						   const uint8 *oldSrcPtr, uint32 oldSrcPitch,
 						   int width, int height, const uint8 *buffer, uint32 bufferPitch) override;
 
+	EdgeGreyDiffsFunc _greyDiffs;          ///< fastest version supported by the CPU
+
 private:
 
 	/**
-	 * Choose greyscale bitplane to use, return diff array.  Exit early and
-	 * return NULL for a block of solid color (all diffs zero).
+	 * Fill the greyscale windows of all pixels of a row which changed, in
+	 * the three greyscale bitplanes, and score them with a single call of
+	 * _greyDiffs.
+	 */
+	template<typename ColorMask>
+	void scoreGreyscaleRow(const uint8 *src, int w, int y, int h,
+		int srcPitch,
+		bool haveOldSrc,
+		const uint8 *oldSrc, int oldPitch);
+
+	/**
+	 * Choose greyscale bitplane to use among the windows scored by
+	 * scoreGreyscaleRow(), starting at @p window, return diff array.  Exit
+	 * early and return NULL for a block of solid color (all diffs zero).
 	 *
 	 * No matter how you do it, mapping 3 bitplanes into a single greyscale
 	 * bitplane will always result in colors which are very different mapping to
@@ -63,8 +98,7 @@ private:
 	 * speed, and is still a lot faster than edge detecting over all three RGB
 	 * bitplanes.  The increase in image quality is well worth the speed hit.
 	 */
-	template<typename ColorMask>
-	int16 *chooseGreyscale(typename ColorMask::PixelType *pixels);
+	int16 *chooseGreyscale(int window);
 
 	/**
 	 * Calculate the distance between pixels in RGB space.  Greyscale isn't
@@ -165,8 +199,10 @@ private:
 	int16 *_chosenGreyscale;               ///< pointer to chosen greyscale table
 	int16 *_bptr;                          ///< too awkward to pass variables
 	int8 _simSum;                          ///< sum of similarity matrix
-	int16 _greyscaleDiffs[3][8];
-	int16 _bplanes[3][9];
+	Common::Array<int> _rowFirstWindow;    ///< first window of each pixel of the row, -1 if unchanged
+	Common::Array<int16> _rowWindows;      ///< greyscale windows of the row, 3 per pixel
+	Common::Array<int16> _rowDiffs;        ///< greyscale differences of the windows
+	Common::Array<int32> _rowScores;       ///< greyscale scores of the windows
 };
 
 
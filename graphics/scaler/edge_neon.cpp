@@ -0,0 +1,56 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#ifdef SCUMMVM_NEON
+
+#include "graphics/scaler/edge.h"
+
+#include <arm_neon.h>
+
+#ifdef __GNUC__
+#pragma GCC push_options
+
+#if !defined(__aarch64__)
+#pragma GCC target("fpu=neon")
+#endif // !defined(__aarch64__)
+
+#endif // __GNUC__
+
+void edgeGreyDiffsNEON(const int16 *windows, int16 *diffs, int32 *scores, uint count) {
+	for (uint i = 0; i < count; i++, windows += 9, diffs += 8) {
+		// All 8 neighbours at once, skipping the center
+		int16x8_t deltas = vsubq_s16(vcombine_s16(vld1_s16(windows), vld1_s16(windows + 5)), vdupq_n_s16(windows[4]));
+		vst1q_s16(diffs, deltas);
+
+		int32x4_t squares = vmull_s16(vget_low_s16(deltas), vget_low_s16(deltas));
+		squares = vmlal_s16(squares, vget_high_s16(deltas), vget_high_s16(deltas));
+		int32x2_t sums = vadd_s32(vget_low_s32(squares), vget_high_s32(squares));
+		scores[i] = vget_lane_s32(vpadd_s32(sums, sums), 0);
+	}
+}
+
+#ifdef __GNUC__
+#pragma GCC pop_options
+#endif
+
+#endif // SCUMMVM_NEON
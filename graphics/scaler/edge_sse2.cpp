@@ -0,0 +1,54 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#include "graphics/scaler/edge.h"
+
+#include <emmintrin.h>
+
+#ifdef __GNUC__
+#pragma GCC push_options
+
+#ifndef __x86_64__
+#pragma GCC target("sse2")
+#endif
+
+#endif
+
+void edgeGreyDiffsSSE2(const int16 *windows, int16 *diffs, int32 *scores, uint count) {
+	for (uint i = 0; i < count; i++, windows += 9, diffs += 8) {
+		// All 8 neighbours at once, skipping the center
+		__m128i neighbours = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i *)windows),
+		                                        _mm_loadl_epi64((const __m128i *)(windows + 5)));
+		__m128i deltas = _mm_sub_epi16(neighbours, _mm_set1_epi16(windows[4]));
+		_mm_storeu_si128((__m128i *)diffs, deltas);
+
+		__m128i squares = _mm_madd_epi16(deltas, deltas);
+		squares = _mm_add_epi32(squares, _mm_shuffle_epi32(squares, _MM_SHUFFLE(1, 0, 3, 2)));
+		squares = _mm_add_epi32(squares, _mm_shuffle_epi32(squares, _MM_SHUFFLE(2, 3, 0, 1)));
+		scores[i] = _mm_cvtsi128_si32(squares);
+	}
+}
+
+#ifdef __GNUC__
+#pragma GCC pop_options
+#endif
@@ -18,6 +18,8 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include "common/array.h"
+#include "common/system.h"
 #include "graphics/scaler/hq.h"
 #include "graphics/scaler.h"
 #include "graphics/scaler/intern.h"
@@ -193,13 +195,132 @@ static inline uint32 ConvertYUV(uint32 x, const uint32 *RGBtoYUV) {
 	return RGBtoYUV[r | g | b];
 }
 
+uint32 convertHQYUV(uint32 pixel, int rShift, int gShift, int bShift) {
+	// Expand the channels like the 565 format of the RGBtoYUV table does
+	const int r5 = (pixel >> (rShift + 3)) & 0x1F;
+	const int g6 = (pixel >> (gShift + 2)) & 0x3F;
+	const int b5 = (pixel >> (bShift + 3)) & 0x1F;
+	const int r = (r5 << 3) | (r5 >> 2);
+	const int g = (g6 << 2) | (g6 >> 4);
+	const int b = (b5 << 3) | (b5 >> 2);
+
+	const int Y = (r + g + b) >> 2;
+	const int u = 128 + ((r - b) >> 2);
+	const int v = 128 + ((-r + 2 * g - b) >> 3);
+	return (Y << 16) | (u << 8) | v;
+}
+
+uint8 findHQPattern(const uint32 *yuvAbove, const uint32 *yuv, const uint32 *yuvBelow) {
+	const int yuv5 = yuv[1];
+	uint8 pattern = 0;
+	if (diffYUV(yuv5, yuvAbove[0])) pattern |= 0x0001;
+	if (diffYUV(yuv5, yuvAbove[1])) pattern |= 0x0002;
+	if (diffYUV(yuv5, yuvAbove[2])) pattern |= 0x0004;
+	if (diffYUV(yuv5, yuv[0])) pattern |= 0x0008;
+	if (diffYUV(yuv5, yuv[2])) pattern |= 0x0010;
+	if (diffYUV(yuv5, yuvBelow[0])) pattern |= 0x0020;
+	if (diffYUV(yuv5, yuvBelow[1])) pattern |= 0x0040;
+	if (diffYUV(yuv5, yuvBelow[2])) pattern |= 0x0080;
+	return pattern;
+}
+
+static void convertYUVGeneric(const uint32 *src, uint32 *yuv, int count, int rShift, int gShift, int bShift) {
+	for (int i = 0; i < count; i++)
+		yuv[i] = convertHQYUV(src[i], rShift, gShift, bShift);
+}
+
+static void findPatternsGeneric(const uint32 *yuvAbove, const uint32 *yuv, const uint32 *yuvBelow, uint8 *patterns, int width) {
+	for (int i = 0; i < width; i++)
+		patterns[i] = findHQPattern(yuvAbove + i, yuv + i, yuvBelow + i);
+}
+
+static const HQKernels hqKernelsGeneric = {
+	convertYUVGeneric,
+	findPatternsGeneric
+};
+
+const HQKernels &getGenericHQKernels() {
+	return hqKernelsGeneric;
+}
+
+const HQKernels *getHQKernels() {
+	static const HQKernels *kernels = nullptr;
+	static bool detected = false;
+
+	// If no kernels have been selected yet, detect and select
+	if (!detected) {
+		detected = true;
+#ifdef SCUMMVM_NEON
+		if (g_system->hasFeature(OSystem::kFeatureCpuNEON)) kernels = &g_hqKernelsNEON;
+#endif
+#ifdef SCUMMVM_SSE2
+		if (g_system->hasFeature(OSystem::kFeatureCpuSSE2)) kernels = &g_hqKernelsSSE2;
+#endif
+#ifdef SCUMMVM_AVX2
+		if (g_system->hasFeature(OSystem::kFeatureCpuAVX2)) kernels = &g_hqKernelsAVX2;
+#endif
+	}
+
+	return kernels;
+}
+
+/**
+ * Find the patterns of the pixels of 32bpp pictures a row at a time, with the
+ * vectorized kernels. The YUV values of a row are reused for the next two.
+ */
+class HQPatternRows {
+public:
+	HQPatternRows(const HQKernels *kernels, int width, int rShift, int gShift, int bShift) :
+		_kernels(kernels), _width(width), _rShift(rShift), _gShift(gShift), _bShift(bShift), _started(false),
+		_yuvAbove(nullptr), _yuvRow(nullptr), _yuvBelow(nullptr) {
+		if (!_kernels)
+			return;
+
+		_yuv.resize(3 * (width + 2));
+		_patterns.resize(width);
+		_yuvAbove = &_yuv[0];
+		_yuvRow = &_yuv[width + 2];
+		_yuvBelow = &_yuv[2 * (width + 2)];
+	}
+
+	bool isActive() const { return _kernels != nullptr; }
+
+	/** Find the patterns of the row starting at @p p, and move to the next row. */
+	const uint8 *find(const void *p, uint32 srcPitch) {
+		const uint32 *row = (const uint32 *)p - 1;
+		const uint32 nextlineSrc = srcPitch / sizeof(uint32);
+		if (!_started) {
+			_kernels->convertYUV(row - nextlineSrc, _yuvAbove, _width + 2, _rShift, _gShift, _bShift);
+			_kernels->convertYUV(row, _yuvRow, _width + 2, _rShift, _gShift, _bShift);
+			_started = true;
+		}
+		_kernels->convertYUV(row + nextlineSrc, _yuvBelow, _width + 2, _rShift, _gShift, _bShift);
+		_kernels->findPatterns(_yuvAbove, _yuvRow, _yuvBelow, &_patterns[0], _width);
+
+		uint32 *oldAbove = _yuvAbove;
+		_yuvAbove = _yuvRow;
+		_yuvRow = _yuvBelow;
+		_yuvBelow = oldAbove;
+		return &_patterns[0];
+	}
+
+private:
+	const HQKernels *_kernels;
+	int _width;
+	int _rShift, _gShift, _bShift;
+	bool _started;
+	Common::Array<uint32> _yuv;
+	Common::Array<uint8> _patterns;
+	uint32 *_yuvAbove, *_yuvRow, *_yuvBelow;
+};
+
 /*
  * The HQ2x high quality 2x graphics filter.
  * Original author Maxim Stepin (https://web.archive.org/web/20090204033742/http://www.hiend3d.com/hq2x.html).
  * Adapted for ScummVM to 16 bit output and optimized by Max Horn.
  */
 template<typename ColorMask>
-static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height, const uint32 *RGBtoYUV) {
+static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height, const uint32 *RGBtoYUV, const HQKernels *kernels = nullptr) {
 	typedef typename ColorMask::PixelType Pixel;
 
 	int w1, w2, w3, w4, w5, w6, w7, w8, w9;
@@ -221,7 +342,13 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 	//	 | w7 | w8 | w9 |
 	//	 +----+----+----+
 
+	// Only 32bpp pictures have vectorized kernels
+	HQPatternRows patternRows(sizeof(Pixel) == 4 ? kernels : nullptr, width,
+	                          ColorMask::kRedShift, ColorMask::kGreenShift, ColorMask::kBlueShift);
+
 	while (height--) {
+		const uint8 *patterns = patternRows.isActive() ? patternRows.find(p, srcPitch) : nullptr;
+
 		w1 = *(p - 1 - nextlineSrc);
 		w4 = *(p - 1);
 		w7 = *(p - 1 + nextlineSrc);
@@ -239,15 +366,19 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			w9 = *(p + nextlineSrc);
 
 			int pattern = 0;
-			const int yuv5 = YUV(5);
-			if (w5 != w1 && diffYUV(yuv5, YUV(1))) pattern |= 0x0001;
-			if (w5 != w2 && diffYUV(yuv5, YUV(2))) pattern |= 0x0002;
-			if (w5 != w3 && diffYUV(yuv5, YUV(3))) pattern |= 0x0004;
-			if (w5 != w4 && diffYUV(yuv5, YUV(4))) pattern |= 0x0008;
-			if (w5 != w6 && diffYUV(yuv5, YUV(6))) pattern |= 0x0010;
-			if (w5 != w7 && diffYUV(yuv5, YUV(7))) pattern |= 0x0020;
-			if (w5 != w8 && diffYUV(yuv5, YUV(8))) pattern |= 0x0040;
-			if (w5 != w9 && diffYUV(yuv5, YUV(9))) pattern |= 0x0080;
+			if (patterns) {
+				pattern = *patterns++;
+			} else {
+				const int yuv5 = YUV(5);
+				if (w5 != w1 && diffYUV(yuv5, YUV(1))) pattern |= 0x0001;
+				if (w5 != w2 && diffYUV(yuv5, YUV(2))) pattern |= 0x0002;
+				if (w5 != w3 && diffYUV(yuv5, YUV(3))) pattern |= 0x0004;
+				if (w5 != w4 && diffYUV(yuv5, YUV(4))) pattern |= 0x0008;
+				if (w5 != w6 && diffYUV(yuv5, YUV(6))) pattern |= 0x0010;
+				if (w5 != w7 && diffYUV(yuv5, YUV(7))) pattern |= 0x0020;
+				if (w5 != w8 && diffYUV(yuv5, YUV(8))) pattern |= 0x0040;
+				if (w5 != w9 && diffYUV(yuv5, YUV(9))) pattern |= 0x0080;
+			}
 
 			switch (pattern) {
 			case 0:
@@ -2116,7 +2247,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
  * Adapted for ScummVM to 16 bit output and optimized by Max Horn.
  */
 template<typename ColorMask>
-static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height, const uint32 *RGBtoYUV) {
+static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height, const uint32 *RGBtoYUV, const HQKernels *kernels = nullptr) {
 	typedef typename ColorMask::PixelType Pixel;
 
 	int  w1, w2, w3, w4, w5, w6, w7, w8, w9;
@@ -2139,7 +2270,13 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 	//	 | w7 | w8 | w9 |
 	//	 +----+----+----+
 
+	// Only 32bpp pictures have vectorized kernels
+	HQPatternRows patternRows(sizeof(Pixel) == 4 ? kernels : nullptr, width,
+	                          ColorMask::kRedShift, ColorMask::kGreenShift, ColorMask::kBlueShift);
+
 	while (height--) {
+		const uint8 *patterns = patternRows.isActive() ? patternRows.find(p, srcPitch) : nullptr;
+
 		w1 = *(p - 1 - nextlineSrc);
 		w4 = *(p - 1);
 		w7 = *(p - 1 + nextlineSrc);
@@ -2157,15 +2294,19 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			w9 = *(p + nextlineSrc);
 
 			int pattern = 0;
-			const int yuv5 = YUV(5);
-			if (w5 != w1 && diffYUV(yuv5, YUV(1))) pattern |= 0x0001;
-			if (w5 != w2 && diffYUV(yuv5, YUV(2))) pattern |= 0x0002;
-			if (w5 != w3 && diffYUV(yuv5, YUV(3))) pattern |= 0x0004;
-			if (w5 != w4 && diffYUV(yuv5, YUV(4))) pattern |= 0x0008;
-			if (w5 != w6 && diffYUV(yuv5, YUV(6))) pattern |= 0x0010;
-			if (w5 != w7 && diffYUV(yuv5, YUV(7))) pattern |= 0x0020;
-			if (w5 != w8 && diffYUV(yuv5, YUV(8))) pattern |= 0x0040;
-			if (w5 != w9 && diffYUV(yuv5, YUV(9))) pattern |= 0x0080;
+			if (patterns) {
+				pattern = *patterns++;
+			} else {
+				const int yuv5 = YUV(5);
+				if (w5 != w1 && diffYUV(yuv5, YUV(1))) pattern |= 0x0001;
+				if (w5 != w2 && diffYUV(yuv5, YUV(2))) pattern |= 0x0002;
+				if (w5 != w3 && diffYUV(yuv5, YUV(3))) pattern |= 0x0004;
+				if (w5 != w4 && diffYUV(yuv5, YUV(4))) pattern |= 0x0008;
+				if (w5 != w6 && diffYUV(yuv5, YUV(6))) pattern |= 0x0010;
+				if (w5 != w7 && diffYUV(yuv5, YUV(7))) pattern |= 0x0020;
+				if (w5 != w8 && diffYUV(yuv5, YUV(8))) pattern |= 0x0040;
+				if (w5 != w9 && diffYUV(yuv5, YUV(9))) pattern |= 0x0080;
+			}
 
 			switch (pattern) {
 			case 0:
@@ -4953,6 +5094,7 @@ HQScaler::HQScaler(const Graphics::PixelFormat &format) : Scaler(format),
 #endif
 	_RGBtoYUV(nullptr) {
 	_factor = 2;
+	_kernels = getHQKernels();
 
 	if (format.bytesPerPixel == 2) {
 		initLUT(format);
@@ -5007,15 +5149,15 @@ void HQScaler::HQ2x32(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint3
 	if (_format.aLoss == 0) {
 		if (_format.aShift == 0) {
 			HQ2x_implementation<Graphics::ColorMasks<-8888> >(srcPtr, srcPitch, dstPtr,
-					dstPitch, width, height, _RGBtoYUV);
+					dstPitch, width, height, _RGBtoYUV, _kernels);
 		} else {
 			HQ2x_implementation<Graphics::ColorMasks<8888> >(srcPtr, srcPitch, dstPtr,
-					dstPitch, width, height, _RGBtoYUV);
+					dstPitch, width, height, _RGBtoYUV, _kernels);
 		}
 	} else {
 		assert((_format.rMax() | _format.gMax() | _format.bMax()) <= 0xffffff);
 		HQ2x_implementation<Graphics::ColorMasks<888> >(srcPtr, srcPitch, dstPtr,
-				dstPitch, width, height, _RGBtoYUV);
+				dstPitch, width, height, _RGBtoYUV, _kernels);
 	}
 }
 
@@ -5023,15 +5165,15 @@ void HQScaler::HQ3x32(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint3
 	if (_format.aLoss == 0) {
 		if (_format.aShift == 0) {
 			HQ3x_implementation<Graphics::ColorMasks<-8888> >(srcPtr, srcPitch, dstPtr,
-					dstPitch, width, height, _RGBtoYUV);
+					dstPitch, width, height, _RGBtoYUV, _kernels);
 		} else {
 			HQ3x_implementation<Graphics::ColorMasks<8888> >(srcPtr, srcPitch, dstPtr,
-					dstPitch, width, height, _RGBtoYUV);
+					dstPitch, width, height, _RGBtoYUV, _kernels);
 		}
 	} else {
 		assert((_format.rMax() | _format.gMax() | _format.bMax()) <= 0xffffff);
 		HQ3x_implementation<Graphics::ColorMasks<888> >(srcPtr, srcPitch, dstPtr,
-				dstPitch, width, height, _RGBtoYUV);
+				dstPitch, width, height, _RGBtoYUV, _kernels);
 	}
 }
 
@@ -27,6 +27,52 @@
 struct hqx_parameters;
 #endif
 
+/**
+ * Inner loops of the HQ scalers for 32bpp pixels, with 8 bit channels at the
+ * given shifts. The generic versions live in hq.cpp, vectorized versions in
+ * hq_sse2.cpp, hq_avx2.cpp and hq_neon.cpp. All versions must produce the
+ * same values as the YUV lookups and the diffYUV() tests of HQ2x and HQ3x.
+ */
+struct HQKernels {
+	/**
+	 * Convert @p count pixels to the YUV values the RGBtoYUV table holds for
+	 * their 565 equivalents.
+	 */
+	void (*convertYUV)(const uint32 *src, uint32 *yuv, int count, int rShift, int gShift, int bShift);
+
+	/**
+	 * Find the patterns of @p width pixels. Bit n of a pattern is set when
+	 * the n-th neighbour of the pixel, skipping the pixel itself, has a
+	 * noticeably different color. The YUV rows start with the value of the
+	 * pixel left of the first one.
+	 */
+	void (*findPatterns)(const uint32 *yuvAbove, const uint32 *yuv, const uint32 *yuvBelow, uint8 *patterns, int width);
+};
+
+#ifdef SCUMMVM_NEON
+extern const HQKernels g_hqKernelsNEON;
+#endif
+#ifdef SCUMMVM_SSE2
+extern const HQKernels g_hqKernelsSSE2;
+#endif
+#ifdef SCUMMVM_AVX2
+extern const HQKernels g_hqKernelsAVX2;
+#endif
+
+/** Return the generic kernels, the reference for the vectorized ones. */
+const HQKernels &getGenericHQKernels();
+
+/**
+ * Return the fastest vectorized kernels supported by the CPU, or nullptr if
+ * there are none. The generic kernels are not worth using over the lookups
+ * of the scalers themselves.
+ */
+const HQKernels *getHQKernels();
+
+/** Single pixel versions of the kernels, for the remaining pixels of a row. */
+uint32 convertHQYUV(uint32 pixel, int rShift, int gShift, int bShift);
+uint8 findHQPattern(const uint32 *yuvAbove, const uint32 *yuv, const uint32 *yuvBelow);
+
 class HQScaler : public Scaler {
 public:
 	HQScaler(const Graphics::PixelFormat &format);
@@ -36,6 +82,7 @@ public:
 protected:
 	virtual void scaleIntern(const uint8 *srcPtr, uint32 srcPitch,
 							uint8 *dstPtr, uint32 dstPitch, int width, int height, int x, int y) override;
+	bool canScaleInBands() const override { return true; }
 
 	void initLUT(Graphics::PixelFormat format);
 	inline void HQ2x16(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height);
@@ -44,6 +91,7 @@ protected:
 	inline void HQ3x32(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height);
 
 	uint32 *_RGBtoYUV;
+	const HQKernels *_kernels;
 #ifdef USE_NASM
 	hqx_parameters *_hqx_params;
 #endif
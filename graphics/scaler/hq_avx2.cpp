@@ -0,0 +1,107 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#include "graphics/scaler/hq.h"
+
+#include <immintrin.h>
+
+#ifdef __GNUC__
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+
+/** YUV values of 8 pixels, see convertHQYUV(). */
+static FORCEINLINE __m256i yuvAVX2(__m256i pixels, __m128i rShift, __m128i gShift, __m128i bShift) {
+	const __m256i mask5 = _mm256_set1_epi32(0xF8);
+	const __m256i mask6 = _mm256_set1_epi32(0xFC);
+
+	// Keep the top bits of each channel, and repeat them below
+	__m256i r = _mm256_and_si256(_mm256_srl_epi32(pixels, rShift), mask5);
+	__m256i g = _mm256_and_si256(_mm256_srl_epi32(pixels, gShift), mask6);
+	__m256i b = _mm256_and_si256(_mm256_srl_epi32(pixels, bShift), mask5);
+	r = _mm256_or_si256(r, _mm256_srli_epi32(r, 5));
+	g = _mm256_or_si256(g, _mm256_srli_epi32(g, 6));
+	b = _mm256_or_si256(b, _mm256_srli_epi32(b, 5));
+
+	const __m256i offset = _mm256_set1_epi32(128);
+	__m256i y = _mm256_srli_epi32(_mm256_add_epi32(_mm256_add_epi32(r, g), b), 2);
+	__m256i u = _mm256_add_epi32(_mm256_srai_epi32(_mm256_sub_epi32(r, b), 2), offset);
+	__m256i v = _mm256_add_epi32(_mm256_srai_epi32(_mm256_sub_epi32(_mm256_add_epi32(g, g), _mm256_add_epi32(r, b)), 3), offset);
+	return _mm256_or_si256(_mm256_or_si256(_mm256_slli_epi32(y, 16), _mm256_slli_epi32(u, 8)), v);
+}
+
+static void convertYUVAVX2(const uint32 *src, uint32 *yuv, int count, int rShift, int gShift, int bShift) {
+	const __m128i rCount = _mm_cvtsi32_si128(rShift);
+	const __m128i gCount = _mm_cvtsi32_si128(gShift);
+	const __m128i bCount = _mm_cvtsi32_si128(bShift);
+
+	int i = 0;
+	for (; i + 8 <= count; i += 8) {
+		__m256i pixels = _mm256_loadu_si256((const __m256i *)(src + i));
+		_mm256_storeu_si256((__m256i *)(yuv + i), yuvAVX2(pixels, rCount, gCount, bCount));
+	}
+	for (; i < count; i++)
+		yuv[i] = convertHQYUV(src[i], rShift, gShift, bShift);
+}
+
+/**
+ * Lanes of the neighbours with a noticeably different color get @p bit, see
+ * diffYUV(). The Y, U and V values are bytes, so their distances are too.
+ */
+static FORCEINLINE __m256i differAVX2(__m256i center, const uint32 *neighbours, int bit) {
+	const __m256i limits = _mm256_set1_epi32(0x00300706);
+	__m256i other = _mm256_loadu_si256((const __m256i *)neighbours);
+	__m256i dist = _mm256_or_si256(_mm256_subs_epu8(center, other), _mm256_subs_epu8(other, center));
+	__m256i same = _mm256_cmpeq_epi32(_mm256_subs_epu8(dist, limits), _mm256_setzero_si256());
+	return _mm256_andnot_si256(same, _mm256_set1_epi32(bit));
+}
+
+static void findPatternsAVX2(const uint32 *yuvAbove, const uint32 *yuv, const uint32 *yuvBelow, uint8 *patterns, int width) {
+	int i = 0;
+	for (; i + 8 <= width; i += 8) {
+		__m256i center = _mm256_loadu_si256((const __m256i *)(yuv + i + 1));
+		__m256i pattern = differAVX2(center, yuvAbove + i, 0x01);
+		pattern = _mm256_or_si256(pattern, differAVX2(center, yuvAbove + i + 1, 0x02));
+		pattern = _mm256_or_si256(pattern, differAVX2(center, yuvAbove + i + 2, 0x04));
+		pattern = _mm256_or_si256(pattern, differAVX2(center, yuv + i, 0x08));
+		pattern = _mm256_or_si256(pattern, differAVX2(center, yuv + i + 2, 0x10));
+		pattern = _mm256_or_si256(pattern, differAVX2(center, yuvBelow + i, 0x20));
+		pattern = _mm256_or_si256(pattern, differAVX2(center, yuvBelow + i + 1, 0x40));
+		pattern = _mm256_or_si256(pattern, differAVX2(center, yuvBelow + i + 2, 0x80));
+
+		// Packing works within 128 bit lanes, so pack the halves instead
+		__m128i words = _mm_packs_epi32(_mm256_castsi256_si128(pattern), _mm256_extracti128_si256(pattern, 1));
+		_mm_storel_epi64((__m128i *)(patterns + i), _mm_packus_epi16(words, words));
+	}
+	for (; i < width; i++)
+		patterns[i] = findHQPattern(yuvAbove + i, yuv + i, yuvBelow + i);
+}
+
+const HQKernels g_hqKernelsAVX2 = {
+	convertYUVAVX2,
+	findPatternsAVX2
+};
+
+#ifdef __GNUC__
+#pragma GCC pop_options
+#endif
@@ -0,0 +1,118 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#ifdef SCUMMVM_NEON
+
+#include "graphics/scaler/hq.h"
+
+#include <arm_neon.h>
+
+#ifdef __GNUC__
+#pragma GCC push_options
+
+#if !defined(__aarch64__)
+#pragma GCC target("fpu=neon")
+#endif // !defined(__aarch64__)
+
+#endif // __GNUC__
+
+/** YUV values of 4 pixels, see convertHQYUV(). */
+static FORCEINLINE uint32x4_t yuvNEON(uint32x4_t pixels, int32x4_t rShift, int32x4_t gShift, int32x4_t bShift) {
+	const uint32x4_t mask5 = vdupq_n_u32(0xF8);
+	const uint32x4_t mask6 = vdupq_n_u32(0xFC);
+
+	// Keep the top bits of each channel, and repeat them below
+	uint32x4_t r = vandq_u32(vshlq_u32(pixels, rShift), mask5);
+	uint32x4_t g = vandq_u32(vshlq_u32(pixels, gShift), mask6);
+	uint32x4_t b = vandq_u32(vshlq_u32(pixels, bShift), mask5);
+	int32x4_t rs = vreinterpretq_s32_u32(vorrq_u32(r, vshrq_n_u32(r, 5)));
+	int32x4_t gs = vreinterpretq_s32_u32(vorrq_u32(g, vshrq_n_u32(g, 6)));
+	int32x4_t bs = vreinterpretq_s32_u32(vorrq_u32(b, vshrq_n_u32(b, 5)));
+
+	const int32x4_t offset = vdupq_n_s32(128);
+	int32x4_t y = vshrq_n_s32(vaddq_s32(vaddq_s32(rs, gs), bs), 2);
+	int32x4_t u = vaddq_s32(vshrq_n_s32(vsubq_s32(rs, bs), 2), offset);
+	int32x4_t v = vaddq_s32(vshrq_n_s32(vsubq_s32(vaddq_s32(gs, gs), vaddq_s32(rs, bs)), 3), offset);
+	int32x4_t yuv = vorrq_s32(vorrq_s32(vshlq_n_s32(y, 16), vshlq_n_s32(u, 8)), v);
+	return vreinterpretq_u32_s32(yuv);
+}
+
+static void convertYUVNEON(const uint32 *src, uint32 *yuv, int count, int rShift, int gShift, int bShift) {
+	// NEON shifts right with negative counts
+	const int32x4_t rCount = vdupq_n_s32(-rShift);
+	const int32x4_t gCount = vdupq_n_s32(-gShift);
+	const int32x4_t bCount = vdupq_n_s32(-bShift);
+
+	int i = 0;
+	for (; i + 4 <= count; i += 4)
+		vst1q_u32(yuv + i, yuvNEON(vld1q_u32(src + i), rCount, gCount, bCount));
+	for (; i < count; i++)
+		yuv[i] = convertHQYUV(src[i], rShift, gShift, bShift);
+}
+
+/**
+ * Lanes of the neighbours with a noticeably different color get @p bit, see
+ * diffYUV(). The Y, U and V values are bytes, so their distances are too.
+ */
+static FORCEINLINE uint32x4_t differNEON(uint8x16_t center, const uint32 *neighbours, uint32 bit) {
+	const uint8x16_t limits = vreinterpretq_u8_u32(vdupq_n_u32(0x00300706));
+	uint8x16_t other = vreinterpretq_u8_u32(vld1q_u32(neighbours));
+	uint32x4_t over = vreinterpretq_u32_u8(vqsubq_u8(vabdq_u8(center, other), limits));
+	return vandq_u32(vtstq_u32(over, over), vdupq_n_u32(bit));
+}
+
+/** Patterns of 4 pixels, as 16 bit lanes. */
+static FORCEINLINE uint16x4_t patternsNEON(const uint32 *yuvAbove, const uint32 *yuv, const uint32 *yuvBelow) {
+	uint8x16_t center = vreinterpretq_u8_u32(vld1q_u32(yuv + 1));
+	uint32x4_t pattern = differNEON(center, yuvAbove, 0x01);
+	pattern = vorrq_u32(pattern, differNEON(center, yuvAbove + 1, 0x02));
+	pattern = vorrq_u32(pattern, differNEON(center, yuvAbove + 2, 0x04));
+	pattern = vorrq_u32(pattern, differNEON(center, yuv, 0x08));
+	pattern = vorrq_u32(pattern, differNEON(center, yuv + 2, 0x10));
+	pattern = vorrq_u32(pattern, differNEON(center, yuvBelow, 0x20));
+	pattern = vorrq_u32(pattern, differNEON(center, yuvBelow + 1, 0x40));
+	pattern = vorrq_u32(pattern, differNEON(center, yuvBelow + 2, 0x80));
+	return vmovn_u32(pattern);
+}
+
+static void findPatternsNEON(const uint32 *yuvAbove, const uint32 *yuv, const uint32 *yuvBelow, uint8 *patterns, int width) {
+	int i = 0;
+	for (; i + 8 <= width; i += 8) {
+		uint16x4_t lo = patternsNEON(yuvAbove + i, yuv + i, yuvBelow + i);
+		uint16x4_t hi = patternsNEON(yuvAbove + i + 4, yuv + i + 4, yuvBelow + i + 4);
+		vst1_u8(patterns + i, vmovn_u16(vcombine_u16(lo, hi)));
+	}
+	for (; i < width; i++)
+		patterns[i] = findHQPattern(yuvAbove + i, yuv + i, yuvBelow + i);
+}
+
+const HQKernels g_hqKernelsNEON = {
+	convertYUVNEON,
+	findPatternsNEON
+};
+
+#ifdef __GNUC__
+#pragma GCC pop_options
+#endif
+
+#endif // SCUMMVM_NEON
@@ -0,0 +1,116 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#include "graphics/scaler/hq.h"
+
+#include <emmintrin.h>
+
+#ifdef __GNUC__
+#pragma GCC push_options
+
+#ifndef __x86_64__
+#pragma GCC target("sse2")
+#endif
+
+#endif
+
+/** YUV values of 4 pixels, see convertHQYUV(). */
+static FORCEINLINE __m128i yuvSSE2(__m128i pixels, __m128i rShift, __m128i gShift, __m128i bShift) {
+	const __m128i mask5 = _mm_set1_epi32(0xF8);
+	const __m128i mask6 = _mm_set1_epi32(0xFC);
+
+	// Keep the top bits of each channel, and repeat them below
+	__m128i r = _mm_and_si128(_mm_srl_epi32(pixels, rShift), mask5);
+	__m128i g = _mm_and_si128(_mm_srl_epi32(pixels, gShift), mask6);
+	__m128i b = _mm_and_si128(_mm_srl_epi32(pixels, bShift), mask5);
+	r = _mm_or_si128(r, _mm_srli_epi32(r, 5));
+	g = _mm_or_si128(g, _mm_srli_epi32(g, 6));
+	b = _mm_or_si128(b, _mm_srli_epi32(b, 5));
+
+	const __m128i offset = _mm_set1_epi32(128);
+	__m128i y = _mm_srli_epi32(_mm_add_epi32(_mm_add_epi32(r, g), b), 2);
+	__m128i u = _mm_add_epi32(_mm_srai_epi32(_mm_sub_epi32(r, b), 2), offset);
+	__m128i v = _mm_add_epi32(_mm_srai_epi32(_mm_sub_epi32(_mm_add_epi32(g, g), _mm_add_epi32(r, b)), 3), offset);
+	return _mm_or_si128(_mm_or_si128(_mm_slli_epi32(y, 16), _mm_slli_epi32(u, 8)), v);
+}
+
+static void convertYUVSSE2(const uint32 *src, uint32 *yuv, int count, int rShift, int gShift, int bShift) {
+	const __m128i rCount = _mm_cvtsi32_si128(rShift);
+	const __m128i gCount = _mm_cvtsi32_si128(gShift);
+	const __m128i bCount = _mm_cvtsi32_si128(bShift);
+
+	int i = 0;
+	for (; i + 4 <= count; i += 4) {
+		__m128i pixels = _mm_loadu_si128((const __m128i *)(src + i));
+		_mm_storeu_si128((__m128i *)(yuv + i), yuvSSE2(pixels, rCount, gCount, bCount));
+	}
+	for (; i < count; i++)
+		yuv[i] = convertHQYUV(src[i], rShift, gShift, bShift);
+}
+
+/**
+ * Lanes of the neighbours with a noticeably different color get @p bit, see
+ * diffYUV(). The Y, U and V values are bytes, so their distances are too.
+ */
+static FORCEINLINE __m128i differSSE2(__m128i center, const uint32 *neighbours, int bit) {
+	const __m128i limits = _mm_set1_epi32(0x00300706);
+	__m128i other = _mm_loadu_si128((const __m128i *)neighbours);
+	__m128i dist = _mm_or_si128(_mm_subs_epu8(center, other), _mm_subs_epu8(other, center));
+	__m128i same = _mm_cmpeq_epi32(_mm_subs_epu8(dist, limits), _mm_setzero_si128());
+	return _mm_andnot_si128(same, _mm_set1_epi32(bit));
+}
+
+/** Patterns of 4 pixels, as 32 bit lanes. */
+static FORCEINLINE __m128i patternsSSE2(const uint32 *yuvAbove, const uint32 *yuv, const uint32 *yuvBelow) {
+	__m128i center = _mm_loadu_si128((const __m128i *)(yuv + 1));
+	__m128i pattern = differSSE2(center, yuvAbove, 0x01);
+	pattern = _mm_or_si128(pattern, differSSE2(center, yuvAbove + 1, 0x02));
+	pattern = _mm_or_si128(pattern, differSSE2(center, yuvAbove + 2, 0x04));
+	pattern = _mm_or_si128(pattern, differSSE2(center, yuv, 0x08));
+	pattern = _mm_or_si128(pattern, differSSE2(center, yuv + 2, 0x10));
+	pattern = _mm_or_si128(pattern, differSSE2(center, yuvBelow, 0x20));
+	pattern = _mm_or_si128(pattern, differSSE2(center, yuvBelow + 1, 0x40));
+	pattern = _mm_or_si128(pattern, differSSE2(center, yuvBelow + 2, 0x80));
+	return pattern;
+}
+
+static void findPatternsSSE2(const uint32 *yuvAbove, const uint32 *yuv, const uint32 *yuvBelow, uint8 *patterns, int width) {
+	int i = 0;
+	for (; i + 8 <= width; i += 8) {
+		__m128i lo = patternsSSE2(yuvAbove + i, yuv + i, yuvBelow + i);
+		__m128i hi = patternsSSE2(yuvAbove + i + 4, yuv + i + 4, yuvBelow + i + 4);
+		__m128i words = _mm_packs_epi32(lo, hi);
+		_mm_storel_epi64((__m128i *)(patterns + i), _mm_packus_epi16(words, words));
+	}
+	for (; i < width; i++)
+		patterns[i] = findHQPattern(yuvAbove + i, yuv + i, yuvBelow + i);
+}
+
+const HQKernels g_hqKernelsSSE2 = {
+	convertYUVSSE2,
+	findPatternsSSE2
+};
+
+#ifdef __GNUC__
+#pragma GCC pop_options
+#endif
@@ -20,6 +20,9 @@
 
 #include "graphics/scalerplugin.h"
 
+#include "common/jobs.h"
+#include "common/system.h"
+
 namespace {
 /**
  * Trivial 'scaler' - in fact it doesn't do any scaling but just copies the
@@ -40,10 +43,16 @@ void Normal1x(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPit
 		dstPtr += dstPitch;
 	}
 }
+
+// Small rects are not worth a job
+enum {
+	kMinRowsPerJob = 16
+};
 } // End of anonymous namespace
 
 void Scaler::scale(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr,
-	                           uint32 dstPitch, int width, int height, int x, int y) {
+	                           uint32 dstPitch, int width, int height, int x, int y,
+	                           Common::JobManager *jobs) {
 	if (_factor == 1) {
 		if (_format.bytesPerPixel == 1) {
 			Normal1x<uint8>(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
@@ -52,6 +61,17 @@ void Scaler::scale(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr,
 		} else {
 			Normal1x<uint32>(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
 		}
+	} else if (canScaleInBands() && height >= 2 * kMinRowsPerJob) {
+		if (!jobs)
+			jobs = g_system->getJobManager();
+
+		// Each band reads the rows around it from the shared source, so
+		// the result is the same as scaling the rect at once
+		jobs->parallelFor(height, [&](uint first, uint last) {
+			scaleIntern(srcPtr + first * srcPitch, srcPitch,
+			            dstPtr + first * _factor * dstPitch, dstPitch,
+			            width, last - first, x, y + first);
+		}, kMinRowsPerJob);
 	} else {
 		scaleIntern(srcPtr, srcPitch, dstPtr, dstPitch, width, height, x, y);
 	}
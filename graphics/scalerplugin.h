@@ -25,6 +25,10 @@
 #include "graphics/pixelformat.h"
 #include "graphics/surface.h"
 
+namespace Common {
+class JobManager;
+}
+
 class Scaler {
 public:
 	Scaler(const Graphics::PixelFormat &format) : _format(format) {}
@@ -41,9 +45,12 @@ public:
 	 * @param height   The height of the source rect to scale.
 	 * @param x        The x position of the source rect.
 	 * @param y        The y position of the source rect.
+	 * @param jobs     Job manager used to scale bands of rows in parallel,
+	 *                 or nullptr to use the one of g_system.
 	 */
 	void scale(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr,
-	           uint32 dstPitch, int width, int height, int x, int y);
+	           uint32 dstPitch, int width, int height, int x, int y,
+	           Common::JobManager *jobs = nullptr);
 
 	/**
 	 * Increase the factor of scaling.
@@ -101,6 +108,14 @@ protected:
 	virtual void scaleIntern(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr,
 	                         uint32 dstPitch, int width, int height, int x, int y) = 0;
 
+	/**
+	 * Whether scaleIntern() may be called for several bands of rows of the
+	 * same rect at once, from different threads. Scalers which only read the
+	 * source (including the rows of its border) and write their own rows of
+	 * the destination should return true.
+	 */
+	virtual bool canScaleInBands() const { return false; }
+
 	uint _factor;
 	Graphics::PixelFormat _format;
 };
@@ -353,11 +353,13 @@ void GLContext::init(int screenW, int screenH, Graphics::PixelFormat pixelFormat
 	_drawCallAllocator[1].initialize(drawCallMemorySize);
 	_debugRectsEnabled = false;
 	_profilingEnabled = false;
+	_isRasterizerBand = false;
 
-	TinyGL::Internal::tglBlitResetScissorRect();
+	TinyGL::Internal::tglBlitResetScissorRect(this);
 }
 
 void GLContext::deinit() {
+	disposeRasterizerBands();
 	disposeDrawCallLists();
 	disposeResources();
 
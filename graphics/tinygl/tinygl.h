@@ -27,6 +27,10 @@
 #include "graphics/tinygl/gl.h"
 #include "graphics/tinygl/zblit_public.h"
 
+namespace Common {
+class JobManager;
+}
+
 namespace TinyGL {
 
 typedef void *ContextHandle;
@@ -38,7 +42,12 @@ void destroyContext();
 void destroyContext(ContextHandle *handle);
 void setContext(ContextHandle *handle);
 void presentBuffer();
-void presentBuffer(Common::List<Common::Rect> &dirtyAreas);
+/**
+ * Render the draw calls of the current frame. The frame buffer is split in
+ * horizontal bands rendered by the threads of @p jobs, or of the job manager
+ * of OSystem if it is nullptr.
+ */
+void presentBuffer(Common::List<Common::Rect> &dirtyAreas, Common::JobManager *jobs = nullptr);
 void getSurfaceRef(Graphics::Surface &surface);
 Graphics::Surface *copyFromFrameBuffer(const Graphics::PixelFormat &dstFormat);
 
@@ -33,6 +33,7 @@
 
 #include "graphics/tinygl/zbuffer.h"
 #include "graphics/tinygl/zgl.h"
+#include "graphics/tinygl/zspan.h"
 
 namespace TinyGL {
 
@@ -56,15 +57,31 @@ FrameBuffer::FrameBuffer(int width, int height, const Graphics::PixelFormat &for
 	_currentTexture = nullptr;
 
 	_enableScissor = false;
+	_ownsBuffers = true;
+	_spanKernels = getSpanKernels();
 }
 
 FrameBuffer::~FrameBuffer() {
+	if (!_ownsBuffers)
+		return;
 	gl_free(_pbuf);
 	gl_free(_zbuf);
 	if (_sbuf)
 		gl_free(_sbuf);
 }
 
+FrameBuffer *FrameBuffer::createSharedView() const {
+	FrameBuffer *view = new FrameBuffer(*this);
+	view->_ownsBuffers = false;
+	return view;
+}
+
+void FrameBuffer::updateSharedView(const FrameBuffer &source) {
+	assert(!_ownsBuffers);
+	*this = source;
+	_ownsBuffers = false;
+}
+
 Buffer *FrameBuffer::genOffscreenBuffer() {
 	Buffer *buf = (Buffer *)gl_malloc(sizeof(Buffer));
 	buf->pbuf = (byte *)gl_zalloc(_pbufHeight * _pbufPitch);
@@ -75,6 +75,9 @@ static const int DRAW_DEPTH_ONLY = 0;
 static const int DRAW_FLAT = 1;
 static const int DRAW_SMOOTH = 2;
 
+struct SpanKernels;
+struct SpanState;
+
 struct Buffer {
 	byte *pbuf;
 	uint *zbuf;
@@ -106,6 +109,18 @@ struct FrameBuffer {
 	FrameBuffer(int width, int height, const Graphics::PixelFormat &format, bool enableStencilBuffer);
 	~FrameBuffer();
 
+	/**
+	 * Creates a frame buffer drawing into the same pixel, depth and stencil
+	 * buffers as this one, starting with a copy of its rasterization state.
+	 */
+	FrameBuffer *createSharedView() const;
+
+	/**
+	 * Makes a view created by createSharedView() draw into the current
+	 * buffers of @p source again, with a copy of its rasterization state.
+	 */
+	void updateSharedView(const FrameBuffer &source);
+
 	Graphics::PixelFormat getPixelFormat() {
 		return _pbufFormat;
 	}
@@ -134,6 +149,15 @@ struct FrameBuffer {
 		return _zbuf;
 	}
 
+	/**
+	 * Select the span kernels of the triangle rasterizer, or nullptr for its
+	 * per-pixel loops. Frame buffers start with the fastest vectorized
+	 * kernels supported by the CPU.
+	 */
+	void setSpanKernels(const SpanKernels *kernels) {
+		_spanKernels = kernels;
+	}
+
 	Graphics::Surface *copyFromFrameBuffer(const Graphics::PixelFormat &dstFormat) {
 		Graphics::Surface tmp;
 		tmp.init(_pbufWidth, _pbufHeight, _pbufPitch, _pbuf, _pbufFormat);
@@ -372,6 +396,10 @@ private:
 	template <bool kDepthWrite, bool kEnableScissor, bool kStencilEnabled, bool kDepthTestEnabled>
 	void putPixelDepth(uint *pz, byte *ps, int _a, int x, int y, uint &z, int &dzdx);
 
+	void putSpanTexture(int fbOffset, const TexelBuffer *texture, uint *pz, int count, const SpanState &spanState,
+	                    uint &z, int &s, int &t, uint &r, uint &g, uint &b, uint &a,
+	                    int dzdx, int dsdx, int dtdx, int drdx, int dgdx, int dbdx, uint dadx);
+
 
 	template <bool kEnableAlphaTest>
 	FORCEINLINE void writePixel(int pixel, int value) {
@@ -741,6 +769,7 @@ private:
 	void drawLine(const ZBufferPoint *p1, const ZBufferPoint *p2);
 
 	Buffer _offscreenBuffer;
+	bool _ownsBuffers;
 	byte *_pbuf;
 	int _pbufWidth;
 	int _pbufHeight;
@@ -751,6 +780,9 @@ private:
 	uint *_zbuf;
 	byte *_sbuf;
 
+	// Vectorized rasterizer loops, or nullptr when the CPU has none
+	const SpanKernels *_spanKernels;
+
 	bool _enableStencil;
 	int _textureSize;
 	int _textureSizeMask;
@@ -22,9 +22,12 @@
 #include "graphics/tinygl/zdirtyrect.h"
 #include "graphics/tinygl/zgl.h"
 #include "graphics/tinygl/gl.h"
+#include "graphics/tinygl/tinygl.h"
 
 #include "common/debug.h"
+#include "common/jobs.h"
 #include "common/math.h"
+#include "common/system.h"
 
 namespace TinyGL {
 
@@ -113,7 +116,7 @@ static inline void _appendDirtyRectangle(const DrawCall &call, Common::List<Dirt
 		rectangles.push_back(DirtyRectangle(dirty_region, r, g, b));
 }
 
-void GLContext::presentBufferDirtyRects(Common::List<Common::Rect> &dirtyAreas) {
+void GLContext::presentBufferDirtyRects(Common::List<Common::Rect> &dirtyAreas, Common::JobManager *jobs) {
 	typedef Common::List<DrawCall *>::const_iterator DrawCallIterator;
 	typedef Common::List<DirtyRectangle>::iterator RectangleIterator;
 
@@ -188,17 +191,21 @@ void GLContext::presentBufferDirtyRects(Common::List<Common::Rect> &dirtyAreas)
 	}
 
 	if (!rectangles.empty()) {
+		Common::Array<Common::Rect> clipRectangles;
 		for (RectangleIterator itRect = rectangles.begin(); itRect != rectangles.end(); ++itRect) {
 			dirtyAreas.push_back((*itRect).rectangle);
+			clipRectangles.push_back((*itRect).rectangle);
 		}
 
 		// Execute draw calls.
-		for (DrawCallIterator it = _drawCallsQueue.begin(); it != _drawCallsQueue.end(); ++it) {
-			Common::Rect drawCallRegion = (*it)->getDirtyRegion();
-			for (RectangleIterator itRect = rectangles.begin(); itRect != rectangles.end(); ++itRect) {
-				Common::Rect dirtyRegion = (*itRect).rectangle;
-				if (dirtyRegion.intersects(drawCallRegion)) {
-					(*it)->execute(dirtyRegion, true);
+		if (!presentBufferInBands(clipRectangles, jobs)) {
+			for (DrawCallIterator it = _drawCallsQueue.begin(); it != _drawCallsQueue.end(); ++it) {
+				Common::Rect drawCallRegion = (*it)->getDirtyRegion();
+				for (RectangleIterator itRect = rectangles.begin(); itRect != rectangles.end(); ++itRect) {
+					Common::Rect dirtyRegion = (*itRect).rectangle;
+					if (dirtyRegion.intersects(drawCallRegion)) {
+						(*it)->execute(this, dirtyRegion, true);
+					}
 				}
 			}
 		}
@@ -235,13 +242,19 @@ void GLContext::presentBufferDirtyRects(Common::List<Common::Rect> &dirtyAreas)
 	_drawCallAllocator[_currentAllocatorIndex].reset();
 }
 
-void GLContext::presentBufferSimple(Common::List<Common::Rect> &dirtyAreas) {
+void GLContext::presentBufferSimple(Common::List<Common::Rect> &dirtyAreas, Common::JobManager *jobs) {
 	typedef Common::List<DrawCall *>::const_iterator DrawCallIterator;
 
-	dirtyAreas.push_back(Common::Rect(fb->getPixelBufferWidth(), fb->getPixelBufferHeight()));
+	Common::Rect frameRect(fb->getPixelBufferWidth(), fb->getPixelBufferHeight());
+	dirtyAreas.push_back(frameRect);
+
+	if (!presentBufferInBands(Common::Array<Common::Rect>(1, frameRect), jobs)) {
+		for (DrawCallIterator it = _drawCallsQueue.begin(); it != _drawCallsQueue.end(); ++it) {
+			(*it)->execute(this, true);
+		}
+	}
 
 	for (DrawCallIterator it = _drawCallsQueue.begin(); it != _drawCallsQueue.end(); ++it) {
-		(*it)->execute(true);
 		delete *it;
 	}
 
@@ -252,12 +265,114 @@ void GLContext::presentBufferSimple(Common::List<Common::Rect> &dirtyAreas) {
 	_drawCallAllocator[_currentAllocatorIndex].reset();
 }
 
-void presentBuffer(Common::List<Common::Rect> &dirtyAreas) {
+// Bands thinner than this are not worth the per band overhead
+static const int kMinRasterizerBandHeight = 32;
+
+// Replays the draw calls touching the given clip rectangles, restricted to one band of rows
+static void replayDrawCallsInBand(GLContext *band, const Common::Rect &bandRect,
+                                  Common::List<DrawCall *>::const_iterator begin, Common::List<DrawCall *>::const_iterator end,
+                                  const Common::Array<Common::Rect> &clipRectangles, bool checkDirtyRegions) {
+	for (Common::List<DrawCall *>::const_iterator it = begin; it != end; ++it) {
+		Common::Rect drawCallRegion = (*it)->getDirtyRegion();
+		for (uint i = 0; i < clipRectangles.size(); i++) {
+			Common::Rect clipRect = clipRectangles[i].findIntersectingRect(bandRect);
+			if (clipRect.isEmpty())
+				continue;
+			if (checkDirtyRegions && !clipRectangles[i].intersects(drawCallRegion))
+				continue;
+			(*it)->execute(band, clipRect, true);
+		}
+	}
+}
+
+bool GLContext::presentBufferInBands(const Common::Array<Common::Rect> &clipRectangles, Common::JobManager *jobs) {
+	typedef Common::List<DrawCall *>::const_iterator DrawCallIterator;
+
+	if (!jobs) {
+		if (!g_system)
+			return false;
+		jobs = g_system->getJobManager();
+	}
+	int width = fb->getPixelBufferWidth();
+	int height = fb->getPixelBufferHeight();
+	uint bandCount = MIN<uint>(jobs->getThreadCount(), height / kMinRasterizerBandHeight);
+	if (bandCount <= 1)
+		return false;
+
+	// Every band gets its own context and frame buffer state, sharing the
+	// pixel, depth and stencil buffers. As bands never overlap, each row of
+	// those buffers is only ever written by one thread.
+	if (_rasterizerBands.size() != bandCount || _rasterizerBandRects.back() != Common::Rect(0, height * (bandCount - 1) / bandCount, width, height)) {
+		disposeRasterizerBands();
+		for (uint i = 0; i < bandCount; i++) {
+			GLContext *band = new GLContext();
+			band->fb = fb->createSharedView();
+			band->_isRasterizerBand = true;
+			_rasterizerBands.push_back(band);
+			_rasterizerBandRects.push_back(Common::Rect(0, height * i / bandCount, width, height * (i + 1) / bandCount));
+		}
+	}
+
+	const Common::Array<GLContext *> &bands = _rasterizerBands;
+	const Common::Array<Common::Rect> &bandRects = _rasterizerBandRects;
+	for (uint i = 0; i < bandCount; i++) {
+		GLContext *band = bands[i];
+		band->fb->updateSharedView(*fb);
+		band->renderRect = renderRect;
+		band->_scissorRect = renderRect;
+		band->_textureSize = _textureSize;
+		band->current_cull_face = current_cull_face;
+		band->vertex_n = vertex_n;
+		band->_profilingEnabled = _profilingEnabled;
+		RasterizationDrawCall::copyState(band, this);
+	}
+
+	DrawCallIterator it = _drawCallsQueue.begin();
+	DrawCallIterator end = _drawCallsQueue.end();
+	while (it != end) {
+		DrawCallIterator runEnd = it;
+		while (runEnd != end && (*runEnd)->canRenderInBands())
+			++runEnd;
+
+		if (runEnd != it) {
+			jobs->parallelFor(bandCount, [&](uint first, uint last) {
+				for (uint i = first; i < last; i++)
+					replayDrawCallsInBand(bands[i], bandRects[i], it, runEnd, clipRectangles, _enableDirtyRectangles);
+			});
+			it = runEnd;
+		} else {
+			// Calls which may draw outside of their clip rectangle are replayed on
+			// the whole frame buffer once the bands have caught up.
+			Common::Rect drawCallRegion = (*it)->getDirtyRegion();
+			for (uint i = 0; i < clipRectangles.size(); i++) {
+				if (!_enableDirtyRectangles) {
+					(*it)->execute(this, true);
+				} else if (clipRectangles[i].intersects(drawCallRegion)) {
+					(*it)->execute(this, clipRectangles[i], true);
+				}
+			}
+			++it;
+		}
+	}
+
+	return true;
+}
+
+void GLContext::disposeRasterizerBands() {
+	for (uint i = 0; i < _rasterizerBands.size(); i++) {
+		delete _rasterizerBands[i]->fb;
+		delete _rasterizerBands[i];
+	}
+	_rasterizerBands.clear();
+	_rasterizerBandRects.clear();
+}
+
+void presentBuffer(Common::List<Common::Rect> &dirtyAreas, Common::JobManager *jobs) {
 	GLContext *c = gl_get_context();
 	if (c->_enableDirtyRectangles) {
-		c->presentBufferDirtyRects(dirtyAreas);
+		c->presentBufferDirtyRects(dirtyAreas, jobs);
 	} else {
-		c->presentBufferSimple(dirtyAreas);
+		c->presentBufferSimple(dirtyAreas, jobs);
 	}
 }
 
@@ -294,7 +409,7 @@ RasterizationDrawCall::RasterizationDrawCall() : DrawCall(DrawCall_Rasterization
 	_drawTriangleFront = c->draw_triangle_front;
 	_drawTriangleBack = c->draw_triangle_back;
 	memcpy(_vertex, c->vertex, sizeof(GLVertex) * _vertexCount);
-	_state = captureState();
+	_state = captureState(c);
 	if (c->_enableDirtyRectangles) {
 		computeDirtyRegion();
 	}
@@ -333,19 +448,24 @@ void RasterizationDrawCall::computeDirtyRegion() {
 	}
 }
 
-void RasterizationDrawCall::execute(bool restoreState) const {
-	GLContext *c = gl_get_context();
-
+void RasterizationDrawCall::execute(GLContext *c, bool restoreState) const {
 	RasterizationDrawCall::RasterizationState backupState;
 	if (restoreState) {
-		backupState = captureState();
+		backupState = captureState(c);
 	}
-	applyState(_state);
+	applyState(c, _state);
 
 	GLVertex *prevVertex = c->vertex;
 	int prevVertexCount = c->vertex_cnt;
 
 	c->vertex = _vertex;
+	if (c->_isRasterizerBand && _vertexCount > 0) {
+		// Edge flags and texture coordinates are written while rasterizing,
+		// so every band works on its own copy of the vertices.
+		c->_bandVertices.resize(_vertexCount);
+		memcpy(c->_bandVertices.data(), _vertex, sizeof(GLVertex) * _vertexCount);
+		c->vertex = c->_bandVertices.data();
+	}
 	c->vertex_cnt = _vertexCount;
 	c->draw_triangle_front = (gl_draw_triangle_func)_drawTriangleFront;
 	c->draw_triangle_back = (gl_draw_triangle_func)_drawTriangleBack;
@@ -429,13 +549,22 @@ void RasterizationDrawCall::execute(bool restoreState) const {
 	c->vertex_cnt = prevVertexCount;
 
 	if (restoreState) {
-		applyState(backupState);
+		applyState(c, backupState);
 	}
 }
 
-RasterizationDrawCall::RasterizationState RasterizationDrawCall::captureState() const {
+bool RasterizationDrawCall::canRenderInBands() const {
+	// Selection writes hits to a buffer shared by all bands
+	return _drawTriangleFront != &GLContext::gl_draw_triangle_select &&
+	       _drawTriangleBack != &GLContext::gl_draw_triangle_select;
+}
+
+void RasterizationDrawCall::copyState(GLContext *dst, GLContext *src) {
+	applyState(dst, captureState(src));
+}
+
+RasterizationDrawCall::RasterizationState RasterizationDrawCall::captureState(GLContext *c) {
 	RasterizationState state;
-	GLContext *c = gl_get_context();
 	state.enableBlending = c->blending_enabled;
 	state.sfactor = c->source_blending_factor;
 	state.dfactor = c->destination_blending_factor;
@@ -484,8 +613,7 @@ RasterizationDrawCall::RasterizationState RasterizationDrawCall::captureState()
 	return state;
 }
 
-void RasterizationDrawCall::applyState(const RasterizationDrawCall::RasterizationState &state) const {
-	GLContext *c = gl_get_context();
+void RasterizationDrawCall::applyState(GLContext *c, const RasterizationDrawCall::RasterizationState &state) {
 	c->fb->enableBlending(state.enableBlending);
 	c->fb->setBlendingFactors(state.sfactor, state.dfactor);
 	c->fb->enableAlphaTest(state.alphaTestEnabled);
@@ -546,10 +674,9 @@ void RasterizationDrawCall::applyState(const RasterizationDrawCall::Rasterizatio
 	memcpy(c->viewport.trans._v, state.viewportTranslation, sizeof(c->viewport.trans._v));
 }
 
-void RasterizationDrawCall::execute(const Common::Rect &clippingRectangle, bool restoreState) const {
-	TinyGL::GLContext *c = gl_get_context();
+void RasterizationDrawCall::execute(GLContext *c, const Common::Rect &clippingRectangle, bool restoreState) const {
 	c->fb->setScissorRectangle(clippingRectangle);
-	execute(restoreState);
+	execute(c, restoreState);
 	c->fb->resetScissorRectangle();
 }
 
@@ -571,7 +698,7 @@ bool RasterizationDrawCall::operator==(const RasterizationDrawCall &other) const
 
 BlittingDrawCall::BlittingDrawCall(BlitImage *image, const BlitTransform &transform, BlittingMode blittingMode) : DrawCall(DrawCall_Blitting), _transform(transform), _mode(blittingMode), _image(image) {
 	tglIncBlitImageRef(image);
-	_blitState = captureState();
+	_blitState = captureState(gl_get_context());
 	_imageVersion = tglGetBlitImageVersion(image);
 	if (gl_get_context()->_enableDirtyRectangles) {
 		computeDirtyRegion();
@@ -582,40 +709,48 @@ BlittingDrawCall::~BlittingDrawCall() {
 	tglDeleteBlitImage(_image);
 }
 
-void BlittingDrawCall::execute(bool restoreState) const {
+void BlittingDrawCall::execute(GLContext *c, bool restoreState) const {
 	BlittingState backupState;
 	if (restoreState) {
-		backupState = captureState();
+		backupState = captureState(c);
 	}
-	applyState(_blitState);
+	applyState(c, _blitState);
 
 	switch (_mode) {
 	case BlittingDrawCall::BlitMode_Regular:
-		Internal::tglBlit(_image, _transform);
+		Internal::tglBlit(c, _image, _transform);
 		break;
 	case BlittingDrawCall::BlitMode_Fast:
-		Internal::tglBlitFast(_image, _transform._destinationRectangle.left, _transform._destinationRectangle.top);
+		Internal::tglBlitFast(c, _image, _transform._destinationRectangle.left, _transform._destinationRectangle.top);
 		break;
 	case BlittingDrawCall::BlitMode_ZBuffer:
-		Internal::tglBlitZBuffer(_image, _transform._destinationRectangle.left, _transform._destinationRectangle.top);
+		Internal::tglBlitZBuffer(c, _image, _transform._destinationRectangle.left, _transform._destinationRectangle.top);
 		break;
 	default:
 		break;
 	}
 	if (restoreState) {
-		applyState(backupState);
+		applyState(c, backupState);
 	}
 }
 
-void BlittingDrawCall::execute(const Common::Rect &clippingRectangle, bool restoreState) const {
-	Internal::tglBlitSetScissorRect(clippingRectangle);
-	execute(restoreState);
-	Internal::tglBlitResetScissorRect();
+void BlittingDrawCall::execute(GLContext *c, const Common::Rect &clippingRectangle, bool restoreState) const {
+	Internal::tglBlitSetScissorRect(c, clippingRectangle);
+	execute(c, restoreState);
+	Internal::tglBlitResetScissorRect(c);
 }
 
-BlittingDrawCall::BlittingState BlittingDrawCall::captureState() const {
+bool BlittingDrawCall::canRenderInBands() const {
+	// Scaled and rotated blits sample the source relative to the clipped
+	// destination and may write past it, flipped ones mirror the clipping.
+	if (_mode != BlitMode_Regular)
+		return true;
+	return _transform._destinationRectangle.width() == 0 && _transform._destinationRectangle.height() == 0 &&
+	       _transform._rotation == 0 && !_transform._flipHorizontally && !_transform._flipVertically;
+}
+
+BlittingDrawCall::BlittingState BlittingDrawCall::captureState(GLContext *c) {
 	BlittingState state;
-	TinyGL::GLContext *c = gl_get_context();
 	state.enableBlending = c->blending_enabled;
 	state.sfactor = c->source_blending_factor;
 	state.dfactor = c->destination_blending_factor;
@@ -626,8 +761,7 @@ BlittingDrawCall::BlittingState BlittingDrawCall::captureState() const {
 	return state;
 }
 
-void BlittingDrawCall::applyState(const BlittingState &state) const {
-	TinyGL::GLContext *c = gl_get_context();
+void BlittingDrawCall::applyState(GLContext *c, const BlittingState &state) {
 	c->fb->enableBlending(state.enableBlending);
 	c->fb->setBlendingFactors(state.sfactor, state.dfactor);
 	c->fb->enableAlphaTest(state.alphaTest);
@@ -689,19 +823,15 @@ ClearBufferDrawCall::ClearBufferDrawCall(bool clearZBuffer, int zValue,
 	: _clearZBuffer(clearZBuffer), _clearColorBuffer(clearColorBuffer), _zValue(zValue),
 	  _rValue(rValue), _gValue(gValue), _bValue(bValue), _clearStencilBuffer(clearStencilBuffer),
 	  _stencilValue(stencilValue), DrawCall(DrawCall_Clear) {
-	TinyGL::GLContext *c = gl_get_context();
-	if (c->_enableDirtyRectangles) {
-		_dirtyRegion = c->renderRect;
-	}
+	// Always set, the clipped execute() relies on it
+	_dirtyRegion = gl_get_context()->renderRect;
 }
 
-void ClearBufferDrawCall::execute(bool restoreState) const {
-	TinyGL::GLContext *c = gl_get_context();
+void ClearBufferDrawCall::execute(GLContext *c, bool restoreState) const {
 	c->fb->clear(_clearZBuffer, _zValue, _clearColorBuffer, _rValue, _gValue, _bValue, _clearStencilBuffer, _stencilValue);
 }
 
-void ClearBufferDrawCall::execute(const Common::Rect &clippingRectangle, bool restoreState) const {
-	TinyGL::GLContext *c = gl_get_context();
+void ClearBufferDrawCall::execute(GLContext *c, const Common::Rect &clippingRectangle, bool restoreState) const {
 	Common::Rect clearRect = clippingRectangle.findIntersectingRect(getDirtyRegion());
 	c->fb->clearRegion(clearRect.left, clearRect.top, clearRect.width(), clearRect.height(),
 	                   _clearZBuffer, _zValue, _clearColorBuffer, _rValue, _gValue, _bValue,
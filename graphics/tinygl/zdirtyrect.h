@@ -53,8 +53,11 @@ public:
 	bool operator!=(const DrawCall &other) const {
 		return !(*this == other);
 	}
-	virtual void execute(bool restoreState) const = 0;
-	virtual void execute(const Common::Rect &clippingRectangle, bool restoreState) const = 0;
+	virtual void execute(GLContext *c, bool restoreState) const = 0;
+	virtual void execute(GLContext *c, const Common::Rect &clippingRectangle, bool restoreState) const = 0;
+	// Returns true if the clipped execute() never writes outside of the clipping rectangle,
+	// which allows replaying the call on several horizontal bands of the frame buffer at once.
+	virtual bool canRenderInBands() const { return true; }
 	DrawCallType getType() const { return _type; }
 	virtual const Common::Rect getDirtyRegion() const { return _dirtyRegion; }
 protected:
@@ -68,8 +71,8 @@ public:
 	ClearBufferDrawCall(bool clearZBuffer, int zValue, bool clearColorBuffer, int rValue, int gValue, int bValue, bool clearStencilBuffer, int stencilValue);
 	virtual ~ClearBufferDrawCall() { }
 	bool operator==(const ClearBufferDrawCall &other) const;
-	virtual void execute(bool restoreState) const;
-	virtual void execute(const Common::Rect &clippingRectangle, bool restoreState) const;
+	virtual void execute(GLContext *c, bool restoreState) const;
+	virtual void execute(GLContext *c, const Common::Rect &clippingRectangle, bool restoreState) const;
 
 	void *operator new(size_t size) {
 		return Internal::allocateFrame(size);
@@ -87,8 +90,12 @@ public:
 	RasterizationDrawCall();
 	virtual ~RasterizationDrawCall() { }
 	bool operator==(const RasterizationDrawCall &other) const;
-	virtual void execute(bool restoreState) const;
-	virtual void execute(const Common::Rect &clippingRectangle, bool restoreState) const;
+	virtual void execute(GLContext *c, bool restoreState) const;
+	virtual void execute(GLContext *c, const Common::Rect &clippingRectangle, bool restoreState) const;
+	virtual bool canRenderInBands() const;
+
+	// Copies the rasterization state of one context to another.
+	static void copyState(GLContext *dst, GLContext *src);
 
 	void *operator new(size_t size) {
 		return Internal::allocateFrame(size);
@@ -150,8 +157,8 @@ private:
 
 	RasterizationState _state;
 
-	RasterizationState captureState() const;
-	void applyState(const RasterizationState &state) const;
+	static RasterizationState captureState(GLContext *c);
+	static void applyState(GLContext *c, const RasterizationState &state);
 };
 
 // Encapsulate a blit call: it might execute either a color buffer or z buffer blit.
@@ -166,8 +173,9 @@ public:
 	BlittingDrawCall(BlitImage *image, const BlitTransform &transform, BlittingMode blittingMode);
 	virtual ~BlittingDrawCall();
 	bool operator==(const BlittingDrawCall &other) const;
-	virtual void execute(bool restoreState) const;
-	virtual void execute(const Common::Rect &clippingRectangle, bool restoreState) const;
+	virtual void execute(GLContext *c, bool restoreState) const;
+	virtual void execute(GLContext *c, const Common::Rect &clippingRectangle, bool restoreState) const;
+	virtual bool canRenderInBands() const;
 
 	BlittingMode getBlittingMode() const { return _mode; }
 
@@ -202,8 +210,8 @@ private:
 		}
 	};
 
-	BlittingState captureState() const;
-	void applyState(const BlittingState &state) const;
+	static BlittingState captureState(GLContext *c);
+	static void applyState(GLContext *c, const BlittingState &state);
 
 	BlittingState _blitState;
 };
@@ -43,6 +43,10 @@
 #include "graphics/tinygl/zdirtyrect.h"
 #include "graphics/tinygl/texelbuffer.h"
 
+namespace Common {
+class JobManager;
+}
+
 namespace TinyGL {
 
 enum {
@@ -463,6 +467,15 @@ struct GLContext {
 	bool _debugRectsEnabled;
 	bool _profilingEnabled;
 
+	// Set on the contexts replaying draw calls for one band of the frame buffer
+	bool _isRasterizerBand;
+	Common::Array<GLVertex> _bandVertices;
+
+	// Contexts of the bands, kept from one frame to the next as long as the
+	// band layout stays the same
+	Common::Array<GLContext *> _rasterizerBands;
+	Common::Array<Common::Rect> _rasterizerBandRects;
+
 	void gl_vertex_transform(GLVertex *v);
 	void gl_calc_fog_factor(GLVertex *v);
 
@@ -517,8 +530,10 @@ public:
 	void disposeResources();
 	void disposeDrawCallLists();
 
-	void presentBufferDirtyRects(Common::List<Common::Rect> &dirtyAreas);
-	void presentBufferSimple(Common::List<Common::Rect> &dirtyAreas);
+	void presentBufferDirtyRects(Common::List<Common::Rect> &dirtyAreas, Common::JobManager *jobs = nullptr);
+	void presentBufferSimple(Common::List<Common::Rect> &dirtyAreas, Common::JobManager *jobs = nullptr);
+	bool presentBufferInBands(const Common::Array<Common::Rect> &clipRectangles, Common::JobManager *jobs);
+	void disposeRasterizerBands();
 
 	void debugDrawRectangle(Common::Rect rect, int r, int g, int b);
 
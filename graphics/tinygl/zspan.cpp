@@ -0,0 +1,80 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/system.h"
+#include "graphics/tinygl/zspan.h"
+
+namespace TinyGL {
+
+static void shadeGeneric(uint32 *pixels, uint *zbuf, int count, const SpanInterpolants &span, const SpanState &state) {
+	for (int i = 0; i < count; i++)
+		spanShadePixel(pixels, zbuf, i, span, state);
+}
+
+static uint depthTestGeneric(const uint *zbuf, int count, const SpanInterpolants &span, const SpanState &state) {
+	uint mask = 0;
+	for (int i = 0; i < count; i++) {
+		if (spanDepthTest(span.z + i * span.dzdx, zbuf[i], state))
+			mask |= 1 << i;
+	}
+	return mask;
+}
+
+static void textureGeneric(uint32 *pixels, uint *zbuf, int count, uint mask, const uint32 *texels,
+                           const SpanInterpolants &span, const SpanState &state, bool modulate) {
+	for (int i = 0; i < count; i++) {
+		if (mask & (1 << i))
+			spanTexturePixel(pixels, zbuf, i, texels[i], span, state, modulate);
+	}
+}
+
+static const SpanKernels spanKernelsGeneric = {
+	shadeGeneric,
+	depthTestGeneric,
+	textureGeneric
+};
+
+const SpanKernels &getGenericSpanKernels() {
+	return spanKernelsGeneric;
+}
+
+const SpanKernels *getSpanKernels() {
+	static const SpanKernels *kernels = nullptr;
+	static bool detected = false;
+
+	// If no kernels have been selected yet, detect and select
+	if (!detected) {
+		detected = true;
+#ifdef SCUMMVM_NEON
+		if (g_system->hasFeature(OSystem::kFeatureCpuNEON)) kernels = &g_spanKernelsNEON;
+#endif
+#ifdef SCUMMVM_SSE2
+		if (g_system->hasFeature(OSystem::kFeatureCpuSSE2)) kernels = &g_spanKernelsSSE2;
+#endif
+#ifdef SCUMMVM_AVX2
+		if (g_system->hasFeature(OSystem::kFeatureCpuAVX2)) kernels = &g_spanKernelsAVX2;
+#endif
+	}
+
+	return kernels;
+}
+
+} // end of namespace TinyGL
@@ -0,0 +1,162 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef GRAPHICS_TINYGL_ZSPAN_H
+#define GRAPHICS_TINYGL_ZSPAN_H
+
+#include "common/scummsys.h"
+#include "graphics/pixelformat.h"
+#include "graphics/tinygl/zbuffer.h"
+
+namespace TinyGL {
+
+/**
+ * Values interpolated along a span, for its first pixel. All of them are
+ * stepped with unsigned wrap-around arithmetic like FrameBuffer::fillTriangle
+ * does; colors are in ZB_POINT_*_BITS fixed point.
+ */
+struct SpanInterpolants {
+	uint z, r, g, b, a;
+	uint dzdx, drdx, dgdx, dbdx, dadx;
+};
+
+/** Frame buffer state used by the span kernels. */
+struct SpanState {
+	Graphics::PixelFormat format;
+	bool depthTest;
+	bool depthWrite;
+	int depthFunc;
+};
+
+/**
+ * Inner loops of the triangle rasterizer for 32bpp frame buffers without
+ * fog, alpha test, blending, stencil or scissor clipping. The generic
+ * versions live in zspan.cpp, vectorized versions in zspan_sse2.cpp,
+ * zspan_avx2.cpp and zspan_neon.cpp. All versions must produce the same
+ * pixels and depth values as FrameBuffer::putPixelNoTexture() and
+ * FrameBuffer::putPixelTexture().
+ */
+struct SpanKernels {
+	/** Depth test and draw @p count Gouraud (or flat) shaded pixels. */
+	void (*shade)(uint32 *pixels, uint *zbuf, int count, const SpanInterpolants &span, const SpanState &state);
+
+	/**
+	 * Depth test up to 8 pixels without writing anything. Bit i of the result
+	 * is set when pixel i passes.
+	 */
+	uint (*depthTest)(const uint *zbuf, int count, const SpanInterpolants &span, const SpanState &state);
+
+	/**
+	 * Draw the pixels set in @p mask out of up to 8 pixels, using the texels
+	 * sampled for them in 0xAARRGGBB form. When @p modulate is true, texels
+	 * are multiplied by the interpolated colors.
+	 */
+	void (*texture)(uint32 *pixels, uint *zbuf, int count, uint mask, const uint32 *texels,
+	                const SpanInterpolants &span, const SpanState &state, bool modulate);
+};
+
+#ifdef SCUMMVM_NEON
+extern const SpanKernels g_spanKernelsNEON;
+#endif
+#ifdef SCUMMVM_SSE2
+extern const SpanKernels g_spanKernelsSSE2;
+#endif
+#ifdef SCUMMVM_AVX2
+extern const SpanKernels g_spanKernelsAVX2;
+#endif
+
+/** Return the generic kernels, the reference for the vectorized ones. */
+const SpanKernels &getGenericSpanKernels();
+
+/**
+ * Return the fastest vectorized kernels supported by the CPU, or nullptr if
+ * there are none. The templated loops of the rasterizer beat the generic
+ * kernels, so they are not worth using there.
+ */
+const SpanKernels *getSpanKernels();
+
+/** Depth test of a single pixel, see FrameBuffer::compareDepth(). */
+FORCEINLINE bool spanDepthTest(uint zSrc, uint zDst, const SpanState &state) {
+	if (!state.depthTest)
+		return true;
+
+	switch (state.depthFunc) {
+	case TGL_LESS:
+		return zDst < zSrc;
+	case TGL_EQUAL:
+		return zDst == zSrc;
+	case TGL_LEQUAL:
+		return zDst <= zSrc;
+	case TGL_GREATER:
+		return zDst > zSrc;
+	case TGL_NOTEQUAL:
+		return zDst != zSrc;
+	case TGL_GEQUAL:
+		return zDst >= zSrc;
+	case TGL_ALWAYS:
+		return true;
+	default:
+		return false;
+	}
+}
+
+/**
+ * Store the depth of a pixel. The rasterizer passes it through a float, so
+ * precision is lost the same way here.
+ */
+FORCEINLINE void spanWriteDepth(uint *zbuf, uint z, const SpanState &state) {
+	if (state.depthWrite)
+		*zbuf = (uint)(float)z;
+}
+
+/** Draw pixel @p i of a span with the generic code. */
+FORCEINLINE void spanShadePixel(uint32 *pixels, uint *zbuf, int i, const SpanInterpolants &span, const SpanState &state) {
+	uint z = span.z + i * span.dzdx;
+	if (!spanDepthTest(z, zbuf[i], state))
+		return;
+
+	spanWriteDepth(zbuf + i, z, state);
+	pixels[i] = state.format.ARGBToColor((span.a + i * span.dadx) >> (ZB_POINT_ALPHA_BITS - 8),
+	                                     (span.r + i * span.drdx) >> (ZB_POINT_RED_BITS - 8),
+	                                     (span.g + i * span.dgdx) >> (ZB_POINT_GREEN_BITS - 8),
+	                                     (span.b + i * span.dbdx) >> (ZB_POINT_BLUE_BITS - 8));
+}
+
+/** Draw textured pixel @p i of a span with the generic code. */
+FORCEINLINE void spanTexturePixel(uint32 *pixels, uint *zbuf, int i, uint32 texel,
+                                  const SpanInterpolants &span, const SpanState &state, bool modulate) {
+	uint8 c_a = texel >> 24;
+	uint8 c_r = texel >> 16;
+	uint8 c_g = texel >> 8;
+	uint8 c_b = texel;
+	if (modulate) {
+		c_a = (c_a * ((span.a + i * span.dadx) >> (ZB_POINT_ALPHA_BITS - 8))) >> (ZB_POINT_ALPHA_BITS - 8);
+		c_r = (c_r * ((span.r + i * span.drdx) >> (ZB_POINT_RED_BITS - 8))) >> (ZB_POINT_RED_BITS - 8);
+		c_g = (c_g * ((span.g + i * span.dgdx) >> (ZB_POINT_GREEN_BITS - 8))) >> (ZB_POINT_GREEN_BITS - 8);
+		c_b = (c_b * ((span.b + i * span.dbdx) >> (ZB_POINT_BLUE_BITS - 8))) >> (ZB_POINT_BLUE_BITS - 8);
+	}
+	spanWriteDepth(zbuf + i, span.z + i * span.dzdx, state);
+	pixels[i] = state.format.ARGBToColor(c_a, c_r, c_g, c_b);
+}
+
+} // end of namespace TinyGL
+
+#endif
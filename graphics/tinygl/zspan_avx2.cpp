@@ -0,0 +1,212 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#include "graphics/tinygl/zspan.h"
+
+#include <immintrin.h>
+
+#ifdef __GNUC__
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+
+namespace TinyGL {
+
+/** Value of 8 consecutive pixels, starting with @p start. */
+static FORCEINLINE __m256i stepsAVX2(uint start, uint delta) {
+	return _mm256_add_epi32(_mm256_set1_epi32(start),
+	                        _mm256_mullo_epi32(_mm256_set1_epi32(delta), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7)));
+}
+
+/** Lanes of pixels passing the depth test are all ones, see spanDepthTest(). */
+static FORCEINLINE __m256i depthMaskAVX2(__m256i zSrc, __m256i zDst, const SpanState &state) {
+	const __m256i ones = _mm256_set1_epi32(-1);
+	if (!state.depthTest)
+		return ones;
+
+	// AVX2 only has signed comparisons
+	const __m256i sign = _mm256_set1_epi32((int)0x80000000);
+	__m256i src = _mm256_xor_si256(zSrc, sign);
+	__m256i dst = _mm256_xor_si256(zDst, sign);
+	switch (state.depthFunc) {
+	case TGL_LESS:
+		return _mm256_cmpgt_epi32(src, dst);
+	case TGL_EQUAL:
+		return _mm256_cmpeq_epi32(dst, src);
+	case TGL_LEQUAL:
+		return _mm256_xor_si256(_mm256_cmpgt_epi32(dst, src), ones);
+	case TGL_GREATER:
+		return _mm256_cmpgt_epi32(dst, src);
+	case TGL_NOTEQUAL:
+		return _mm256_xor_si256(_mm256_cmpeq_epi32(dst, src), ones);
+	case TGL_GEQUAL:
+		return _mm256_xor_si256(_mm256_cmpgt_epi32(src, dst), ones);
+	case TGL_ALWAYS:
+		return ones;
+	default:
+		return _mm256_setzero_si256();
+	}
+}
+
+/** Round depth values through a float like spanWriteDepth() does. */
+static FORCEINLINE __m256i roundDepthAVX2(__m256i z) {
+	// Unsigned to float, rounded once: the high half times 65536 is exact
+	__m256 hi = _mm256_cvtepi32_ps(_mm256_srli_epi32(z, 16));
+	__m256 lo = _mm256_cvtepi32_ps(_mm256_and_si256(z, _mm256_set1_epi32(0xFFFF)));
+	__m256 f = _mm256_add_ps(_mm256_mul_ps(hi, _mm256_set1_ps(65536.0f)), lo);
+
+	// Float to unsigned, truncated; values from 2^31 on are converted minus 2^31
+	__m256 big = _mm256_cmp_ps(f, _mm256_set1_ps(2147483648.0f), _CMP_GE_OQ);
+	f = _mm256_sub_ps(f, _mm256_and_ps(big, _mm256_set1_ps(2147483648.0f)));
+	return _mm256_xor_si256(_mm256_cvttps_epi32(f), _mm256_slli_epi32(_mm256_castps_si256(big), 31));
+}
+
+/** Shift counts of PixelFormat::ARGBToColor(). */
+struct PackAVX2 {
+	__m128i aLoss, rLoss, gLoss, bLoss;
+	__m128i aShift, rShift, gShift, bShift;
+
+	PackAVX2(const Graphics::PixelFormat &format) :
+		aLoss(_mm_cvtsi32_si128(format.aLoss)), rLoss(_mm_cvtsi32_si128(format.rLoss)),
+		gLoss(_mm_cvtsi32_si128(format.gLoss)), bLoss(_mm_cvtsi32_si128(format.bLoss)),
+		aShift(_mm_cvtsi32_si128(format.aShift)), rShift(_mm_cvtsi32_si128(format.rShift)),
+		gShift(_mm_cvtsi32_si128(format.gShift)), bShift(_mm_cvtsi32_si128(format.bShift)) {}
+
+	/** Pack 8-bit channels held in 32-bit lanes. */
+	FORCEINLINE __m256i operator()(__m256i a, __m256i r, __m256i g, __m256i b) const {
+		__m256i color = _mm256_sll_epi32(_mm256_srl_epi32(a, aLoss), aShift);
+		color = _mm256_or_si256(color, _mm256_sll_epi32(_mm256_srl_epi32(r, rLoss), rShift));
+		color = _mm256_or_si256(color, _mm256_sll_epi32(_mm256_srl_epi32(g, gLoss), gShift));
+		return _mm256_or_si256(color, _mm256_sll_epi32(_mm256_srl_epi32(b, bLoss), bShift));
+	}
+};
+
+/** Integer part of interpolated colors, as 8-bit channels. */
+static FORCEINLINE __m256i channelAVX2(__m256i c) {
+	return _mm256_and_si256(_mm256_srli_epi32(c, ZB_POINT_RED_BITS - 8), _mm256_set1_epi32(0xFF));
+}
+
+/** Multiply 8-bit texel channels by interpolated colors. */
+static FORCEINLINE __m256i modulateAVX2(__m256i texel, __m256i c) {
+	// Only the low 16 bits of the product are kept, so a 16-bit multiply is enough
+	__m256i l = _mm256_and_si256(_mm256_srli_epi32(c, ZB_POINT_RED_BITS - 8), _mm256_set1_epi32(0xFFFF));
+	return _mm256_and_si256(_mm256_srli_epi32(_mm256_mullo_epi16(texel, l), ZB_POINT_RED_BITS - 8), _mm256_set1_epi32(0xFF));
+}
+
+static void shadeAVX2(uint32 *pixels, uint *zbuf, int count, const SpanInterpolants &span, const SpanState &state) {
+	const PackAVX2 pack(state.format);
+	__m256i z = stepsAVX2(span.z, span.dzdx);
+	__m256i r = stepsAVX2(span.r, span.drdx);
+	__m256i g = stepsAVX2(span.g, span.dgdx);
+	__m256i b = stepsAVX2(span.b, span.dbdx);
+	__m256i a = stepsAVX2(span.a, span.dadx);
+	const __m256i dz = _mm256_set1_epi32(8 * span.dzdx);
+	const __m256i dr = _mm256_set1_epi32(8 * span.drdx);
+	const __m256i dg = _mm256_set1_epi32(8 * span.dgdx);
+	const __m256i db = _mm256_set1_epi32(8 * span.dbdx);
+	const __m256i da = _mm256_set1_epi32(8 * span.dadx);
+
+	int i = 0;
+	for (; i + 8 <= count; i += 8) {
+		__m256i zDst = _mm256_loadu_si256((const __m256i *)(zbuf + i));
+		__m256i mask = depthMaskAVX2(z, zDst, state);
+		if (_mm256_movemask_epi8(mask)) {
+			if (state.depthWrite)
+				_mm256_storeu_si256((__m256i *)(zbuf + i), _mm256_blendv_epi8(zDst, roundDepthAVX2(z), mask));
+			__m256i color = pack(channelAVX2(a), channelAVX2(r), channelAVX2(g), channelAVX2(b));
+			__m256i dst = _mm256_loadu_si256((const __m256i *)(pixels + i));
+			_mm256_storeu_si256((__m256i *)(pixels + i), _mm256_blendv_epi8(dst, color, mask));
+		}
+		z = _mm256_add_epi32(z, dz);
+		r = _mm256_add_epi32(r, dr);
+		g = _mm256_add_epi32(g, dg);
+		b = _mm256_add_epi32(b, db);
+		a = _mm256_add_epi32(a, da);
+	}
+
+	for (; i < count; i++)
+		spanShadePixel(pixels, zbuf, i, span, state);
+}
+
+static uint depthTestAVX2(const uint *zbuf, int count, const SpanInterpolants &span, const SpanState &state) {
+	if (count == 8) {
+		__m256i zDst = _mm256_loadu_si256((const __m256i *)zbuf);
+		__m256i pass = depthMaskAVX2(stepsAVX2(span.z, span.dzdx), zDst, state);
+		return _mm256_movemask_ps(_mm256_castsi256_ps(pass));
+	}
+
+	uint mask = 0;
+	for (int i = 0; i < count; i++) {
+		if (spanDepthTest(span.z + i * span.dzdx, zbuf[i], state))
+			mask |= 1 << i;
+	}
+	return mask;
+}
+
+static void textureAVX2(uint32 *pixels, uint *zbuf, int count, uint mask, const uint32 *texels,
+                        const SpanInterpolants &span, const SpanState &state, bool modulate) {
+	if (count != 8) {
+		for (int i = 0; i < count; i++) {
+			if (mask & (1 << i))
+				spanTexturePixel(pixels, zbuf, i, texels[i], span, state, modulate);
+		}
+		return;
+	}
+
+	const PackAVX2 pack(state.format);
+	const __m256i bits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+	const __m256i channelMask = _mm256_set1_epi32(0xFF);
+	__m256i laneMask = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(mask), bits), bits);
+
+	if (state.depthWrite) {
+		__m256i zDst = _mm256_loadu_si256((const __m256i *)zbuf);
+		__m256i z = roundDepthAVX2(stepsAVX2(span.z, span.dzdx));
+		_mm256_storeu_si256((__m256i *)zbuf, _mm256_blendv_epi8(zDst, z, laneMask));
+	}
+
+	__m256i texel = _mm256_loadu_si256((const __m256i *)texels);
+	__m256i a = _mm256_srli_epi32(texel, 24);
+	__m256i r = _mm256_and_si256(_mm256_srli_epi32(texel, 16), channelMask);
+	__m256i g = _mm256_and_si256(_mm256_srli_epi32(texel, 8), channelMask);
+	__m256i b = _mm256_and_si256(texel, channelMask);
+	if (modulate) {
+		a = modulateAVX2(a, stepsAVX2(span.a, span.dadx));
+		r = modulateAVX2(r, stepsAVX2(span.r, span.drdx));
+		g = modulateAVX2(g, stepsAVX2(span.g, span.dgdx));
+		b = modulateAVX2(b, stepsAVX2(span.b, span.dbdx));
+	}
+	__m256i dst = _mm256_loadu_si256((const __m256i *)pixels);
+	_mm256_storeu_si256((__m256i *)pixels, _mm256_blendv_epi8(dst, pack(a, r, g, b), laneMask));
+}
+
+const SpanKernels g_spanKernelsAVX2 = {
+	shadeAVX2,
+	depthTestAVX2,
+	textureAVX2
+};
+
+} // end of namespace TinyGL
+
+#ifdef __GNUC__
+#pragma GCC pop_options
+#endif
@@ -0,0 +1,217 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#ifdef SCUMMVM_NEON
+
+#include "graphics/tinygl/zspan.h"
+
+#include <arm_neon.h>
+
+#ifdef __GNUC__
+#pragma GCC push_options
+
+#if !defined(__aarch64__)
+#pragma GCC target("fpu=neon")
+#endif // !defined(__aarch64__)
+
+#endif // __GNUC__
+
+namespace TinyGL {
+
+/** Value of 4 consecutive pixels, starting with @p start. */
+static FORCEINLINE uint32x4_t stepsNEON(uint start, uint delta) {
+	const uint32 index[4] = { 0, 1, 2, 3 };
+	return vmlaq_n_u32(vdupq_n_u32(start), vld1q_u32(index), delta);
+}
+
+static FORCEINLINE bool anyNEON(uint32x4_t mask) {
+	uint32x2_t half = vorr_u32(vget_low_u32(mask), vget_high_u32(mask));
+	return vget_lane_u32(vpmax_u32(half, half), 0) != 0;
+}
+
+/** Lanes of pixels passing the depth test are all ones, see spanDepthTest(). */
+static FORCEINLINE uint32x4_t depthMaskNEON(uint32x4_t zSrc, uint32x4_t zDst, const SpanState &state) {
+	if (!state.depthTest)
+		return vdupq_n_u32(0xFFFFFFFF);
+
+	switch (state.depthFunc) {
+	case TGL_LESS:
+		return vcltq_u32(zDst, zSrc);
+	case TGL_EQUAL:
+		return vceqq_u32(zDst, zSrc);
+	case TGL_LEQUAL:
+		return vcleq_u32(zDst, zSrc);
+	case TGL_GREATER:
+		return vcgtq_u32(zDst, zSrc);
+	case TGL_NOTEQUAL:
+		return vmvnq_u32(vceqq_u32(zDst, zSrc));
+	case TGL_GEQUAL:
+		return vcgeq_u32(zDst, zSrc);
+	case TGL_ALWAYS:
+		return vdupq_n_u32(0xFFFFFFFF);
+	default:
+		return vdupq_n_u32(0);
+	}
+}
+
+/** Round depth values through a float like spanWriteDepth() does. */
+static FORCEINLINE uint32x4_t roundDepthNEON(uint32x4_t z) {
+	return vcvtq_u32_f32(vcvtq_f32_u32(z));
+}
+
+/** Shift counts of PixelFormat::ARGBToColor(), right shifts being negative. */
+struct PackNEON {
+	int32x4_t aLoss, rLoss, gLoss, bLoss;
+	int32x4_t aShift, rShift, gShift, bShift;
+
+	PackNEON(const Graphics::PixelFormat &format) :
+		aLoss(vdupq_n_s32(-format.aLoss)), rLoss(vdupq_n_s32(-format.rLoss)),
+		gLoss(vdupq_n_s32(-format.gLoss)), bLoss(vdupq_n_s32(-format.bLoss)),
+		aShift(vdupq_n_s32(format.aShift)), rShift(vdupq_n_s32(format.rShift)),
+		gShift(vdupq_n_s32(format.gShift)), bShift(vdupq_n_s32(format.bShift)) {}
+
+	/** Pack 8-bit channels held in 32-bit lanes. */
+	FORCEINLINE uint32x4_t operator()(uint32x4_t a, uint32x4_t r, uint32x4_t g, uint32x4_t b) const {
+		uint32x4_t color = vshlq_u32(vshlq_u32(a, aLoss), aShift);
+		color = vorrq_u32(color, vshlq_u32(vshlq_u32(r, rLoss), rShift));
+		color = vorrq_u32(color, vshlq_u32(vshlq_u32(g, gLoss), gShift));
+		return vorrq_u32(color, vshlq_u32(vshlq_u32(b, bLoss), bShift));
+	}
+};
+
+/** Integer part of interpolated colors, as 8-bit channels. */
+static FORCEINLINE uint32x4_t channelNEON(uint32x4_t c) {
+	return vandq_u32(vshrq_n_u32(c, ZB_POINT_RED_BITS - 8), vdupq_n_u32(0xFF));
+}
+
+/** Multiply 8-bit texel channels by interpolated colors. */
+static FORCEINLINE uint32x4_t modulateNEON(uint32x4_t texel, uint32x4_t c) {
+	uint32x4_t l = vandq_u32(vshrq_n_u32(c, ZB_POINT_RED_BITS - 8), vdupq_n_u32(0xFFFF));
+	return vandq_u32(vshrq_n_u32(vmulq_u32(texel, l), ZB_POINT_RED_BITS - 8), vdupq_n_u32(0xFF));
+}
+
+static void shadeNEON(uint32 *pixels, uint *zbuf, int count, const SpanInterpolants &span, const SpanState &state) {
+	const PackNEON pack(state.format);
+	uint32x4_t z = stepsNEON(span.z, span.dzdx);
+	uint32x4_t r = stepsNEON(span.r, span.drdx);
+	uint32x4_t g = stepsNEON(span.g, span.dgdx);
+	uint32x4_t b = stepsNEON(span.b, span.dbdx);
+	uint32x4_t a = stepsNEON(span.a, span.dadx);
+	const uint32x4_t dz = vdupq_n_u32(4 * span.dzdx);
+	const uint32x4_t dr = vdupq_n_u32(4 * span.drdx);
+	const uint32x4_t dg = vdupq_n_u32(4 * span.dgdx);
+	const uint32x4_t db = vdupq_n_u32(4 * span.dbdx);
+	const uint32x4_t da = vdupq_n_u32(4 * span.dadx);
+
+	int i = 0;
+	for (; i + 4 <= count; i += 4) {
+		uint32x4_t zDst = vld1q_u32(zbuf + i);
+		uint32x4_t mask = depthMaskNEON(z, zDst, state);
+		if (anyNEON(mask)) {
+			if (state.depthWrite)
+				vst1q_u32(zbuf + i, vbslq_u32(mask, roundDepthNEON(z), zDst));
+			uint32x4_t color = pack(channelNEON(a), channelNEON(r), channelNEON(g), channelNEON(b));
+			vst1q_u32(pixels + i, vbslq_u32(mask, color, vld1q_u32(pixels + i)));
+		}
+		z = vaddq_u32(z, dz);
+		r = vaddq_u32(r, dr);
+		g = vaddq_u32(g, dg);
+		b = vaddq_u32(b, db);
+		a = vaddq_u32(a, da);
+	}
+
+	for (; i < count; i++)
+		spanShadePixel(pixels, zbuf, i, span, state);
+}
+
+static uint depthTestNEON(const uint *zbuf, int count, const SpanInterpolants &span, const SpanState &state) {
+	const uint32 bitValues[4] = { 1, 2, 4, 8 };
+	const uint32x4_t bits = vld1q_u32(bitValues);
+
+	uint mask = 0;
+	int i = 0;
+	for (; i + 4 <= count; i += 4) {
+		uint32x4_t pass = depthMaskNEON(stepsNEON(span.z + i * span.dzdx, span.dzdx), vld1q_u32(zbuf + i), state);
+		uint32x4_t set = vandq_u32(pass, bits);
+		uint32x2_t sum = vadd_u32(vget_low_u32(set), vget_high_u32(set));
+		mask |= vget_lane_u32(vpadd_u32(sum, sum), 0) << i;
+	}
+
+	for (; i < count; i++) {
+		if (spanDepthTest(span.z + i * span.dzdx, zbuf[i], state))
+			mask |= 1 << i;
+	}
+	return mask;
+}
+
+static void textureNEON(uint32 *pixels, uint *zbuf, int count, uint mask, const uint32 *texels,
+                        const SpanInterpolants &span, const SpanState &state, bool modulate) {
+	const PackNEON pack(state.format);
+	const uint32 bitValues[4] = { 1, 2, 4, 8 };
+	const uint32x4_t bits = vld1q_u32(bitValues);
+	const uint32x4_t channelMask = vdupq_n_u32(0xFF);
+
+	int i = 0;
+	for (; i + 4 <= count; i += 4) {
+		if (!((mask >> i) & 0xF))
+			continue;
+
+		uint32x4_t laneMask = vtstq_u32(vdupq_n_u32(mask >> i), bits);
+		if (state.depthWrite) {
+			uint32x4_t z = roundDepthNEON(stepsNEON(span.z + i * span.dzdx, span.dzdx));
+			vst1q_u32(zbuf + i, vbslq_u32(laneMask, z, vld1q_u32(zbuf + i)));
+		}
+
+		uint32x4_t texel = vld1q_u32(texels + i);
+		uint32x4_t a = vshrq_n_u32(texel, 24);
+		uint32x4_t r = vandq_u32(vshrq_n_u32(texel, 16), channelMask);
+		uint32x4_t g = vandq_u32(vshrq_n_u32(texel, 8), channelMask);
+		uint32x4_t b = vandq_u32(texel, channelMask);
+		if (modulate) {
+			a = modulateNEON(a, stepsNEON(span.a + i * span.dadx, span.dadx));
+			r = modulateNEON(r, stepsNEON(span.r + i * span.drdx, span.drdx));
+			g = modulateNEON(g, stepsNEON(span.g + i * span.dgdx, span.dgdx));
+			b = modulateNEON(b, stepsNEON(span.b + i * span.dbdx, span.dbdx));
+		}
+		vst1q_u32(pixels + i, vbslq_u32(laneMask, pack(a, r, g, b), vld1q_u32(pixels + i)));
+	}
+
+	for (; i < count; i++) {
+		if (mask & (1 << i))
+			spanTexturePixel(pixels, zbuf, i, texels[i], span, state, modulate);
+	}
+}
+
+const SpanKernels g_spanKernelsNEON = {
+	shadeNEON,
+	depthTestNEON,
+	textureNEON
+};
+
+} // end of namespace TinyGL
+
+#ifdef __GNUC__
+#pragma GCC pop_options
+#endif
+
+#endif // SCUMMVM_NEON
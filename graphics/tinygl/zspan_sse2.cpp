@@ -0,0 +1,223 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#include "graphics/tinygl/zspan.h"
+
+#include <emmintrin.h>
+
+#ifdef __GNUC__
+#pragma GCC push_options
+
+#ifndef __x86_64__
+#pragma GCC target("sse2")
+#endif
+
+#endif
+
+namespace TinyGL {
+
+/** Value of 4 consecutive pixels, starting with @p start. */
+static FORCEINLINE __m128i stepsSSE2(uint start, uint delta) {
+	return _mm_setr_epi32(start, start + delta, start + 2 * delta, start + 3 * delta);
+}
+
+static FORCEINLINE __m128i blendSSE2(__m128i mask, __m128i src, __m128i dst) {
+	return _mm_or_si128(_mm_and_si128(mask, src), _mm_andnot_si128(mask, dst));
+}
+
+/** Lanes of pixels passing the depth test are all ones, see spanDepthTest(). */
+static FORCEINLINE __m128i depthMaskSSE2(__m128i zSrc, __m128i zDst, const SpanState &state) {
+	const __m128i ones = _mm_set1_epi32(-1);
+	if (!state.depthTest)
+		return ones;
+
+	// SSE2 only has signed comparisons
+	const __m128i sign = _mm_set1_epi32((int)0x80000000);
+	__m128i src = _mm_xor_si128(zSrc, sign);
+	__m128i dst = _mm_xor_si128(zDst, sign);
+	switch (state.depthFunc) {
+	case TGL_LESS:
+		return _mm_cmpgt_epi32(src, dst);
+	case TGL_EQUAL:
+		return _mm_cmpeq_epi32(dst, src);
+	case TGL_LEQUAL:
+		return _mm_xor_si128(_mm_cmpgt_epi32(dst, src), ones);
+	case TGL_GREATER:
+		return _mm_cmpgt_epi32(dst, src);
+	case TGL_NOTEQUAL:
+		return _mm_xor_si128(_mm_cmpeq_epi32(dst, src), ones);
+	case TGL_GEQUAL:
+		return _mm_xor_si128(_mm_cmpgt_epi32(src, dst), ones);
+	case TGL_ALWAYS:
+		return ones;
+	default:
+		return _mm_setzero_si128();
+	}
+}
+
+/** Round depth values through a float like spanWriteDepth() does. */
+static FORCEINLINE __m128i roundDepthSSE2(__m128i z) {
+	// Unsigned to float, rounded once: the high half times 65536 is exact
+	__m128 hi = _mm_cvtepi32_ps(_mm_srli_epi32(z, 16));
+	__m128 lo = _mm_cvtepi32_ps(_mm_and_si128(z, _mm_set1_epi32(0xFFFF)));
+	__m128 f = _mm_add_ps(_mm_mul_ps(hi, _mm_set1_ps(65536.0f)), lo);
+
+	// Float to unsigned, truncated; values from 2^31 on are converted minus 2^31
+	__m128 big = _mm_cmpge_ps(f, _mm_set1_ps(2147483648.0f));
+	f = _mm_sub_ps(f, _mm_and_ps(big, _mm_set1_ps(2147483648.0f)));
+	return _mm_xor_si128(_mm_cvttps_epi32(f), _mm_slli_epi32(_mm_castps_si128(big), 31));
+}
+
+/** Shift counts of PixelFormat::ARGBToColor(). */
+struct PackSSE2 {
+	__m128i aLoss, rLoss, gLoss, bLoss;
+	__m128i aShift, rShift, gShift, bShift;
+
+	PackSSE2(const Graphics::PixelFormat &format) :
+		aLoss(_mm_cvtsi32_si128(format.aLoss)), rLoss(_mm_cvtsi32_si128(format.rLoss)),
+		gLoss(_mm_cvtsi32_si128(format.gLoss)), bLoss(_mm_cvtsi32_si128(format.bLoss)),
+		aShift(_mm_cvtsi32_si128(format.aShift)), rShift(_mm_cvtsi32_si128(format.rShift)),
+		gShift(_mm_cvtsi32_si128(format.gShift)), bShift(_mm_cvtsi32_si128(format.bShift)) {}
+
+	/** Pack 8-bit channels held in 32-bit lanes. */
+	FORCEINLINE __m128i operator()(__m128i a, __m128i r, __m128i g, __m128i b) const {
+		__m128i color = _mm_sll_epi32(_mm_srl_epi32(a, aLoss), aShift);
+		color = _mm_or_si128(color, _mm_sll_epi32(_mm_srl_epi32(r, rLoss), rShift));
+		color = _mm_or_si128(color, _mm_sll_epi32(_mm_srl_epi32(g, gLoss), gShift));
+		return _mm_or_si128(color, _mm_sll_epi32(_mm_srl_epi32(b, bLoss), bShift));
+	}
+};
+
+/** Integer part of interpolated colors, as 8-bit channels. */
+static FORCEINLINE __m128i channelSSE2(__m128i c) {
+	return _mm_and_si128(_mm_srli_epi32(c, ZB_POINT_RED_BITS - 8), _mm_set1_epi32(0xFF));
+}
+
+/** Multiply 8-bit texel channels by interpolated colors. */
+static FORCEINLINE __m128i modulateSSE2(__m128i texel, __m128i c) {
+	// Only the low 16 bits of the product are kept, so a 16-bit multiply is enough
+	__m128i l = _mm_and_si128(_mm_srli_epi32(c, ZB_POINT_RED_BITS - 8), _mm_set1_epi32(0xFFFF));
+	return _mm_and_si128(_mm_srli_epi32(_mm_mullo_epi16(texel, l), ZB_POINT_RED_BITS - 8), _mm_set1_epi32(0xFF));
+}
+
+static void shadeSSE2(uint32 *pixels, uint *zbuf, int count, const SpanInterpolants &span, const SpanState &state) {
+	const PackSSE2 pack(state.format);
+	__m128i z = stepsSSE2(span.z, span.dzdx);
+	__m128i r = stepsSSE2(span.r, span.drdx);
+	__m128i g = stepsSSE2(span.g, span.dgdx);
+	__m128i b = stepsSSE2(span.b, span.dbdx);
+	__m128i a = stepsSSE2(span.a, span.dadx);
+	const __m128i dz = _mm_set1_epi32(4 * span.dzdx);
+	const __m128i dr = _mm_set1_epi32(4 * span.drdx);
+	const __m128i dg = _mm_set1_epi32(4 * span.dgdx);
+	const __m128i db = _mm_set1_epi32(4 * span.dbdx);
+	const __m128i da = _mm_set1_epi32(4 * span.dadx);
+
+	int i = 0;
+	for (; i + 4 <= count; i += 4) {
+		__m128i zDst = _mm_loadu_si128((const __m128i *)(zbuf + i));
+		__m128i mask = depthMaskSSE2(z, zDst, state);
+		if (_mm_movemask_epi8(mask)) {
+			if (state.depthWrite)
+				_mm_storeu_si128((__m128i *)(zbuf + i), blendSSE2(mask, roundDepthSSE2(z), zDst));
+			__m128i color = pack(channelSSE2(a), channelSSE2(r), channelSSE2(g), channelSSE2(b));
+			__m128i dst = _mm_loadu_si128((const __m128i *)(pixels + i));
+			_mm_storeu_si128((__m128i *)(pixels + i), blendSSE2(mask, color, dst));
+		}
+		z = _mm_add_epi32(z, dz);
+		r = _mm_add_epi32(r, dr);
+		g = _mm_add_epi32(g, dg);
+		b = _mm_add_epi32(b, db);
+		a = _mm_add_epi32(a, da);
+	}
+
+	for (; i < count; i++)
+		spanShadePixel(pixels, zbuf, i, span, state);
+}
+
+static uint depthTestSSE2(const uint *zbuf, int count, const SpanInterpolants &span, const SpanState &state) {
+	uint mask = 0;
+	int i = 0;
+	for (; i + 4 <= count; i += 4) {
+		__m128i zDst = _mm_loadu_si128((const __m128i *)(zbuf + i));
+		__m128i pass = depthMaskSSE2(stepsSSE2(span.z + i * span.dzdx, span.dzdx), zDst, state);
+		mask |= _mm_movemask_ps(_mm_castsi128_ps(pass)) << i;
+	}
+
+	for (; i < count; i++) {
+		if (spanDepthTest(span.z + i * span.dzdx, zbuf[i], state))
+			mask |= 1 << i;
+	}
+	return mask;
+}
+
+static void textureSSE2(uint32 *pixels, uint *zbuf, int count, uint mask, const uint32 *texels,
+                        const SpanInterpolants &span, const SpanState &state, bool modulate) {
+	const PackSSE2 pack(state.format);
+	const __m128i bits = _mm_setr_epi32(1, 2, 4, 8);
+	const __m128i channelMask = _mm_set1_epi32(0xFF);
+
+	int i = 0;
+	for (; i + 4 <= count; i += 4) {
+		if (!((mask >> i) & 0xF))
+			continue;
+
+		__m128i laneMask = _mm_cmpeq_epi32(_mm_and_si128(_mm_set1_epi32(mask >> i), bits), bits);
+		if (state.depthWrite) {
+			__m128i zDst = _mm_loadu_si128((const __m128i *)(zbuf + i));
+			__m128i z = roundDepthSSE2(stepsSSE2(span.z + i * span.dzdx, span.dzdx));
+			_mm_storeu_si128((__m128i *)(zbuf + i), blendSSE2(laneMask, z, zDst));
+		}
+
+		__m128i texel = _mm_loadu_si128((const __m128i *)(texels + i));
+		__m128i a = _mm_srli_epi32(texel, 24);
+		__m128i r = _mm_and_si128(_mm_srli_epi32(texel, 16), channelMask);
+		__m128i g = _mm_and_si128(_mm_srli_epi32(texel, 8), channelMask);
+		__m128i b = _mm_and_si128(texel, channelMask);
+		if (modulate) {
+			a = modulateSSE2(a, stepsSSE2(span.a + i * span.dadx, span.dadx));
+			r = modulateSSE2(r, stepsSSE2(span.r + i * span.drdx, span.drdx));
+			g = modulateSSE2(g, stepsSSE2(span.g + i * span.dgdx, span.dgdx));
+			b = modulateSSE2(b, stepsSSE2(span.b + i * span.dbdx, span.dbdx));
+		}
+		__m128i dst = _mm_loadu_si128((const __m128i *)(pixels + i));
+		_mm_storeu_si128((__m128i *)(pixels + i), blendSSE2(laneMask, pack(a, r, g, b), dst));
+	}
+
+	for (; i < count; i++) {
+		if (mask & (1 << i))
+			spanTexturePixel(pixels, zbuf, i, texels[i], span, state, modulate);
+	}
+}
+
+const SpanKernels g_spanKernelsSSE2 = {
+	shadeSSE2,
+	depthTestSSE2,
+	textureSSE2
+};
+
+} // end of namespace TinyGL
+
+#ifdef __GNUC__
+#pragma GCC pop_options
+#endif
@@ -29,6 +29,7 @@
 #include "graphics/tinygl/texelbuffer.h"
 #include "graphics/tinygl/zbuffer.h"
 #include "graphics/tinygl/zgl.h"
+#include "graphics/tinygl/zspan.h"
 
 namespace TinyGL {
 
@@ -157,6 +158,33 @@ void FrameBuffer::putPixelDepth(uint *pz, byte *ps, int _a, int x, int y, uint &
 	z += dzdx;
 }
 
+void FrameBuffer::putSpanTexture(int fbOffset, const TexelBuffer *texture, uint *pz, int count, const SpanState &spanState,
+                                 uint &z, int &s, int &t, uint &r, uint &g, uint &b, uint &a,
+                                 int dzdx, int dsdx, int dtdx, int drdx, int dgdx, int dbdx, uint dadx) {
+	SpanInterpolants span = { z, r, g, b, a, (uint)dzdx, (uint)drdx, (uint)dgdx, (uint)dbdx, dadx };
+	uint mask = _spanKernels->depthTest(pz, count, span, spanState);
+
+	// Only sample the texels which are going to be drawn
+	uint32 texels[NB_INTERP] = {};
+	for (int _a = 0; _a < count; _a++) {
+		if (mask & (1 << _a)) {
+			uint8 c_a, c_r, c_g, c_b;
+			texture->getARGBAt(_wrapS, _wrapT, s + _a * dsdx, t + _a * dtdx, c_a, c_r, c_g, c_b);
+			texels[_a] = (c_a << 24) | (c_r << 16) | (c_g << 8) | c_b;
+		}
+	}
+	if (mask)
+		_spanKernels->texture((uint32 *)_pbuf + fbOffset, pz, count, mask, texels, span, spanState, true);
+
+	z += count * dzdx;
+	s += count * dsdx;
+	t += count * dtdx;
+	r += count * drdx;
+	g += count * dgdx;
+	b += count * dbdx;
+	a += count * dadx;
+}
+
 template <bool kInterpRGB, bool kInterpZ, bool kInterpST, bool kInterpSTZ, bool kSmoothMode,
           bool kDepthWrite, bool kFogMode, bool kAlphaTestEnabled, bool kEnableScissor,
           bool kBlendingEnabled, bool kStencilEnabled, bool kDepthTestEnabled>
@@ -296,6 +324,17 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 		dtzdy = (fdx1 * d2 - fdx2 * d1);
 	}
 
+	// The vectorized span kernels handle opaque 32bpp pixels without stencil
+	const bool kSpanKernels = kInterpRGB && kInterpZ && !kFogMode && !kAlphaTestEnabled && !kBlendingEnabled && !kStencilEnabled;
+	const bool useSpanKernels = kSpanKernels && _spanKernels && _pbufBpp == 4;
+	SpanState spanState;
+	if (useSpanKernels) {
+		spanState.format = _pbufFormat;
+		spanState.depthTest = kDepthTestEnabled;
+		spanState.depthWrite = kDepthWrite;
+		spanState.depthFunc = _depthFunc;
+	}
+
 	int polyOffset = 0;
 	if (kInterpZ && kInterpRGB && (_offsetStates & TGL_OFFSET_FILL)) {
 		int m = MAX(ABS(dzdx), ABS(dzdy));
@@ -423,8 +462,15 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 
 		// we draw all the scan line of the part
 		while (nb_lines > 0) {
+			if (kEnableScissor && y >= _clipRectangle.bottom)
+				return;
 			int x = x1;
-			if (!kInterpRGB) {
+			// Kernels do not clip, so spans crossing the scissor rectangle take the slow path
+			bool spanInKernels = useSpanKernels &&
+			                     (!kEnableScissor || (x1 >= _clipRectangle.left && (x2 >> 16) < _clipRectangle.right));
+			if (kEnableScissor && y < _clipRectangle.top) {
+				// above the scissor rectangle, only the edges have to be stepped
+			} else if (!kInterpRGB) {
 				int n;
 				uint *pz;
 				byte *ps = nullptr;
@@ -483,6 +529,11 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 				if (kStencilEnabled) {
 					ps = ps1 + x1;
 				}
+				if (spanInKernels) {
+					SpanInterpolants span = { z, r, g, b, a, (uint)dzdx, (uint)drdx, (uint)dgdx, (uint)dbdx, (uint)dadx };
+					_spanKernels->shade((uint32 *)_pbuf + pp, pz, n + 1, span, spanState);
+					n = -1;
+				}
 				while (n >= 3) {
 					putPixelNoTexture<kDepthWrite, kSmoothMode, kFogMode, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled, kStencilEnabled, kDepthTestEnabled>
 					                 (pp, pz, ps, 0, x, y, z, r, g, b, a, dzdx, drdx, dgdx, dbdx, dadx, fog, fog_r, fog_g, fog_b, dfdx);
@@ -557,9 +608,13 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 						fz += fndzdx;
 						zinv = (float)(1.0 / fz);
 					}
-					for (int _a = 0; _a < NB_INTERP; _a++) {
-						putPixelTexture<kDepthWrite, kInterpRGB, kSmoothMode, kFogMode, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled, kStencilEnabled, kDepthTestEnabled>
-						               (pp, texture, _wrapS, _wrapT, pz, ps, _a, x, y, z, t, s, r, g, b, a, dzdx, dsdx, dtdx, drdx, dgdx, dbdx, dadx, fog, fog_r, fog_g, fog_b, dfdx);
+					if (spanInKernels) {
+						putSpanTexture(pp, texture, pz, NB_INTERP, spanState, z, s, t, r, g, b, a, dzdx, dsdx, dtdx, drdx, dgdx, dbdx, dadx);
+					} else {
+						for (int _a = 0; _a < NB_INTERP; _a++) {
+							putPixelTexture<kDepthWrite, kInterpRGB, kSmoothMode, kFogMode, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled, kStencilEnabled, kDepthTestEnabled>
+							               (pp, texture, _wrapS, _wrapT, pz, ps, _a, x, y, z, t, s, r, g, b, a, dzdx, dsdx, dtdx, drdx, dgdx, dbdx, dadx, fog, fog_r, fog_g, fog_b, dfdx);
+						}
 					}
 					pp += NB_INTERP;
 					if (kInterpZ) {
@@ -584,6 +639,10 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 					dtdx = (int)((dtzdx - tt * fdzdx) * zinv);
 				}
 
+				if (spanInKernels && n >= 0) {
+					putSpanTexture(pp, texture, pz, n + 1, spanState, z, s, t, r, g, b, a, dzdx, dsdx, dtdx, drdx, dgdx, dbdx, dadx);
+					n = -1;
+				}
 				while (n >= 0) {
 					putPixelTexture<kDepthWrite, kInterpRGB, kSmoothMode, kFogMode, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled, kStencilEnabled, kDepthTestEnabled>
 					               (pp, texture, _wrapS, _wrapT, pz, ps, 0, x, y, z, t, s, r, g, b, a, dzdx, dsdx, dtdx, drdx, dgdx, dbdx, dadx, fog, fog_r, fog_g, fog_b, dfdx);
@@ -82,8 +82,11 @@
 // BASIS, AND BROWN UNIVERSITY HAS NO OBLIGATION TO PROVIDE MAINTENANCE,
 // SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 
+#include "common/jobs.h"
+#include "common/system.h"
 #include "graphics/surface.h"
 #include "graphics/yuv_to_rgb.h"
+#include "graphics/yuv_to_rgb_intern.h"
 
 namespace Common {
 DECLARE_SINGLETON(Graphics::YUVToRGBManager);
@@ -168,6 +171,8 @@ YUVToRGBLookup::YUVToRGBLookup(Graphics::PixelFormat format, YUVToRGBManager::Lu
 YUVToRGBManager::YUVToRGBManager() {
 	_lookup = 0;
 	_alphaMode = false;
+	_kernels = nullptr;
+	_kernelsDetected = false;
 
 	int16 *Cr_r_tab = &_colorTab[0 * 256];
 	int16 *Cr_g_tab = &_colorTab[1 * 256];
@@ -202,6 +207,86 @@ const YUVToRGBLookup *YUVToRGBManager::getLookup(Graphics::PixelFormat format, Y
 	return _lookup;
 }
 
+static void convertRowGeneric(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, const byte *aSrc,
+                              int width, bool halfChroma, const YUVToRGBParams &params) {
+	yuvToRGBRowTail(dst, ySrc, uSrc, vSrc, aSrc, 0, width, halfChroma, params);
+}
+
+static const YUVToRGBKernels yuvToRGBKernelsGeneric = {
+	convertRowGeneric
+};
+
+const YUVToRGBKernels &getGenericYUVToRGBKernels() {
+	return yuvToRGBKernelsGeneric;
+}
+
+const YUVToRGBKernels *getYUVToRGBKernels() {
+	const YUVToRGBKernels *kernels = nullptr;
+#ifdef SCUMMVM_NEON
+	if (g_system->hasFeature(OSystem::kFeatureCpuNEON)) kernels = &g_yuvToRGBKernelsNEON;
+#endif
+#ifdef SCUMMVM_SSE2
+	if (g_system->hasFeature(OSystem::kFeatureCpuSSE2)) kernels = &g_yuvToRGBKernelsSSE2;
+#endif
+#ifdef SCUMMVM_AVX2
+	if (g_system->hasFeature(OSystem::kFeatureCpuAVX2)) kernels = &g_yuvToRGBKernelsAVX2;
+#endif
+	return kernels;
+}
+
+void YUVToRGBManager::setKernels(const YUVToRGBKernels *kernels) {
+	_kernels = kernels;
+	_kernelsDetected = true;
+}
+
+const YUVToRGBKernels *YUVToRGBManager::getKernels() {
+	// If no kernels have been selected yet, detect and select
+	if (!_kernelsDetected)
+		setKernels(getYUVToRGBKernels());
+
+	return _kernels;
+}
+
+void YUVToRGBManager::getParams(YUVToRGBParams &params, const Graphics::PixelFormat &format, LuminanceScale scale, bool alphaMode) const {
+	params.itu = scale == kScaleITU;
+
+	// The products with these truncate to the values of _colorTab
+	params.crToR = (float)(0.419 / 0.299);
+	params.crToG = (float)-(0.299 / 0.419);
+	params.cbToG = (float)-(0.114 / 0.331);
+	params.cbToB = (float)(0.587 / 0.331);
+	params.colorTab = _colorTab;
+
+	params.bytesPerPixel = format.bytesPerPixel;
+	params.rLoss = format.rLoss;
+	params.gLoss = format.gLoss;
+	params.bLoss = format.bLoss;
+	params.aLoss = format.aLoss;
+	params.rShift = format.rShift;
+	params.gShift = format.gShift;
+	params.bShift = format.bShift;
+	params.aShift = format.aShift;
+	params.alpha = alphaMode ? 0 : format.ARGBToColor(255, 0, 0, 0);
+}
+
+/**
+ * Call func(first, last) on ranges of the given number of rows, spread
+ * over the threads of the job manager. Rows are converted independently,
+ * so the result is the same as when converting all of them at once.
+ */
+template<class Func>
+static void convertRows(Common::JobManager *jobs, int rowCount, int minRows, const Func &func) {
+	if (!jobs)
+		jobs = g_system->getJobManager();
+
+	jobs->parallelFor(MAX(rowCount, 0), func, MAX(minRows, 1));
+}
+
+// Small pictures are not worth a job
+enum {
+	kMinRowsPerJob = 32
+};
+
 #define PUT_PIXEL(s, d) \
 	L = &rgbToPix[(s)]; \
 	*((PixelInt *)(d)) = (L[cr_r] | L[crb_g] | L[cb_b])
@@ -237,7 +322,7 @@ void convertYUV444ToRGB(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup
 	}
 }
 
-void YUVToRGBManager::convert444(Graphics::Surface *dst, YUVToRGBManager::LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
+void YUVToRGBManager::convert444(Graphics::Surface *dst, YUVToRGBManager::LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch, Common::JobManager *jobs) {
 	// Sanity checks
 	assert(dst && dst->getPixels());
 	assert(dst->format.bytesPerPixel == 2 || dst->format.bytesPerPixel == 4);
@@ -245,11 +330,33 @@ void YUVToRGBManager::convert444(Graphics::Surface *dst, YUVToRGBManager::Lumina
 
 	const YUVToRGBLookup *lookup = getLookup(dst->format, scale);
 
-	// Use a templated function to avoid an if check on every pixel
-	if (dst->format.bytesPerPixel == 2)
-		convertYUV444ToRGB<uint16>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
-	else
-		convertYUV444ToRGB<uint32>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+	byte *dstPtr = (byte *)dst->getPixels();
+	int dstPitch = dst->pitch;
+	bool is16Bit = dst->format.bytesPerPixel == 2;
+	int16 *colorTab = _colorTab;
+
+	if (const YUVToRGBKernels *kernels = getKernels()) {
+		YUVToRGBParams params;
+		getParams(params, dst->format, scale, false);
+		convertRows(jobs, yHeight, kMinRowsPerJob, [=, &params](uint first, uint last) {
+			for (uint h = first; h < last; h++)
+				kernels->convertRow(dstPtr + h * dstPitch, ySrc + h * yPitch, uSrc + h * uvPitch, vSrc + h * uvPitch, nullptr, yWidth, false, params);
+		});
+		return;
+	}
+
+	convertRows(jobs, yHeight, kMinRowsPerJob, [=](uint first, uint last) {
+		byte *rowDst = dstPtr + first * dstPitch;
+		const byte *rowY = ySrc + first * yPitch;
+		const byte *rowU = uSrc + first * uvPitch;
+		const byte *rowV = vSrc + first * uvPitch;
+
+		// Use a templated function to avoid an if check on every pixel
+		if (is16Bit)
+			convertYUV444ToRGB<uint16>(rowDst, dstPitch, lookup, colorTab, rowY, rowU, rowV, yWidth, last - first, yPitch, uvPitch);
+		else
+			convertYUV444ToRGB<uint32>(rowDst, dstPitch, lookup, colorTab, rowY, rowU, rowV, yWidth, last - first, yPitch, uvPitch);
+	});
 }
 
 template<typename PixelInt>
@@ -288,7 +395,7 @@ void convertYUV422ToRGB(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup
 	}
 }
 
-void YUVToRGBManager::convert422(Graphics::Surface *dst, YUVToRGBManager::LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
+void YUVToRGBManager::convert422(Graphics::Surface *dst, YUVToRGBManager::LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch, Common::JobManager *jobs) {
 	// Sanity checks
 	assert(dst && dst->getPixels());
 	assert(dst->format.bytesPerPixel == 2 || dst->format.bytesPerPixel == 4);
@@ -297,11 +404,33 @@ void YUVToRGBManager::convert422(Graphics::Surface *dst, YUVToRGBManager::Lumina
 
 	const YUVToRGBLookup *lookup = getLookup(dst->format, scale);
 
-	// Use a templated function to avoid an if check on every pixel
-	if (dst->format.bytesPerPixel == 2)
-		convertYUV422ToRGB<uint16>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
-	else
-		convertYUV422ToRGB<uint32>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+	byte *dstPtr = (byte *)dst->getPixels();
+	int dstPitch = dst->pitch;
+	bool is16Bit = dst->format.bytesPerPixel == 2;
+	int16 *colorTab = _colorTab;
+
+	if (const YUVToRGBKernels *kernels = getKernels()) {
+		YUVToRGBParams params;
+		getParams(params, dst->format, scale, false);
+		convertRows(jobs, yHeight, kMinRowsPerJob, [=, &params](uint first, uint last) {
+			for (uint h = first; h < last; h++)
+				kernels->convertRow(dstPtr + h * dstPitch, ySrc + h * yPitch, uSrc + h * uvPitch, vSrc + h * uvPitch, nullptr, yWidth, true, params);
+		});
+		return;
+	}
+
+	convertRows(jobs, yHeight, kMinRowsPerJob, [=](uint first, uint last) {
+		byte *rowDst = dstPtr + first * dstPitch;
+		const byte *rowY = ySrc + first * yPitch;
+		const byte *rowU = uSrc + first * uvPitch;
+		const byte *rowV = vSrc + first * uvPitch;
+
+		// Use a templated function to avoid an if check on every pixel
+		if (is16Bit)
+			convertYUV422ToRGB<uint16>(rowDst, dstPitch, lookup, colorTab, rowY, rowU, rowV, yWidth, last - first, yPitch, uvPitch);
+		else
+			convertYUV422ToRGB<uint32>(rowDst, dstPitch, lookup, colorTab, rowY, rowU, rowV, yWidth, last - first, yPitch, uvPitch);
+	});
 }
 
 template<typename PixelInt>
@@ -343,7 +472,7 @@ void convertYUV420ToRGB(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup
 	}
 }
 
-void YUVToRGBManager::convert420(Graphics::Surface *dst, YUVToRGBManager::LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
+void YUVToRGBManager::convert420(Graphics::Surface *dst, YUVToRGBManager::LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch, Common::JobManager *jobs) {
 	// Sanity checks
 	assert(dst && dst->getPixels());
 	assert(dst->format.bytesPerPixel == 2 || dst->format.bytesPerPixel == 4);
@@ -353,11 +482,34 @@ void YUVToRGBManager::convert420(Graphics::Surface *dst, YUVToRGBManager::Lumina
 
 	const YUVToRGBLookup *lookup = getLookup(dst->format, scale);
 
-	// Use a templated function to avoid an if check on every pixel
-	if (dst->format.bytesPerPixel == 2)
-		convertYUV420ToRGB<uint16>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
-	else
-		convertYUV420ToRGB<uint32>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+	byte *dstPtr = (byte *)dst->getPixels();
+	int dstPitch = dst->pitch;
+	bool is16Bit = dst->format.bytesPerPixel == 2;
+	int16 *colorTab = _colorTab;
+
+	// Rows are converted in pairs sharing a chroma row
+	if (const YUVToRGBKernels *kernels = getKernels()) {
+		YUVToRGBParams params;
+		getParams(params, dst->format, scale, false);
+		convertRows(jobs, yHeight / 2, kMinRowsPerJob / 2, [=, &params](uint first, uint last) {
+			for (uint h = first * 2; h < last * 2; h++)
+				kernels->convertRow(dstPtr + h * dstPitch, ySrc + h * yPitch, uSrc + (h / 2) * uvPitch, vSrc + (h / 2) * uvPitch, nullptr, yWidth, true, params);
+		});
+		return;
+	}
+
+	convertRows(jobs, yHeight / 2, kMinRowsPerJob / 2, [=](uint first, uint last) {
+		byte *rowDst = dstPtr + first * 2 * dstPitch;
+		const byte *rowY = ySrc + first * 2 * yPitch;
+		const byte *rowU = uSrc + first * uvPitch;
+		const byte *rowV = vSrc + first * uvPitch;
+
+		// Use a templated function to avoid an if check on every pixel
+		if (is16Bit)
+			convertYUV420ToRGB<uint16>(rowDst, dstPitch, lookup, colorTab, rowY, rowU, rowV, yWidth, (last - first) * 2, yPitch, uvPitch);
+		else
+			convertYUV420ToRGB<uint32>(rowDst, dstPitch, lookup, colorTab, rowY, rowU, rowV, yWidth, (last - first) * 2, yPitch, uvPitch);
+	});
 }
 
 #define PUT_PIXELA(s, a, d) \
@@ -407,7 +559,7 @@ void convertYUVA420ToRGBA(byte *dstPtr, int dstPitch, const YUVToRGBLookup *look
 	}
 }
 
-void YUVToRGBManager::convert420Alpha(Graphics::Surface *dst, YUVToRGBManager::LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, const byte *aSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
+void YUVToRGBManager::convert420Alpha(Graphics::Surface *dst, YUVToRGBManager::LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, const byte *aSrc, int yWidth, int yHeight, int yPitch, int uvPitch, Common::JobManager *jobs) {
 	// Sanity checks
 	assert(dst && dst->getPixels());
 	assert(dst->format.bytesPerPixel == 2 || dst->format.bytesPerPixel == 4);
@@ -417,11 +569,35 @@ void YUVToRGBManager::convert420Alpha(Graphics::Surface *dst, YUVToRGBManager::L
 
 	const YUVToRGBLookup *lookup = getLookup(dst->format, scale, true);
 
-	// Use a templated function to avoid an if check on every pixel
-	if (dst->format.bytesPerPixel == 2)
-		convertYUVA420ToRGBA<uint16>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, aSrc, yWidth, yHeight, yPitch, uvPitch);
-	else
-		convertYUVA420ToRGBA<uint32>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, aSrc, yWidth, yHeight, yPitch, uvPitch);
+	byte *dstPtr = (byte *)dst->getPixels();
+	int dstPitch = dst->pitch;
+	bool is16Bit = dst->format.bytesPerPixel == 2;
+	int16 *colorTab = _colorTab;
+
+	// Rows are converted in pairs sharing a chroma row
+	if (const YUVToRGBKernels *kernels = getKernels()) {
+		YUVToRGBParams params;
+		getParams(params, dst->format, scale, true);
+		convertRows(jobs, yHeight / 2, kMinRowsPerJob / 2, [=, &params](uint first, uint last) {
+			for (uint h = first * 2; h < last * 2; h++)
+				kernels->convertRow(dstPtr + h * dstPitch, ySrc + h * yPitch, uSrc + (h / 2) * uvPitch, vSrc + (h / 2) * uvPitch, aSrc + h * yPitch, yWidth, true, params);
+		});
+		return;
+	}
+
+	convertRows(jobs, yHeight / 2, kMinRowsPerJob / 2, [=](uint first, uint last) {
+		byte *rowDst = dstPtr + first * 2 * dstPitch;
+		const byte *rowY = ySrc + first * 2 * yPitch;
+		const byte *rowA = aSrc + first * 2 * yPitch;
+		const byte *rowU = uSrc + first * uvPitch;
+		const byte *rowV = vSrc + first * uvPitch;
+
+		// Use a templated function to avoid an if check on every pixel
+		if (is16Bit)
+			convertYUVA420ToRGBA<uint16>(rowDst, dstPitch, lookup, colorTab, rowY, rowU, rowV, rowA, yWidth, (last - first) * 2, yPitch, uvPitch);
+		else
+			convertYUVA420ToRGBA<uint32>(rowDst, dstPitch, lookup, colorTab, rowY, rowU, rowV, rowA, yWidth, (last - first) * 2, yPitch, uvPitch);
+	});
 }
 
 #define READ_QUAD(ptr, prefix) \
@@ -492,7 +668,7 @@ void convertYUV410ToRGB(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup
 #undef DO_INTERPOLATION
 #undef DO_YUV410_PIXEL
 
-void YUVToRGBManager::convert410(Graphics::Surface *dst, YUVToRGBManager::LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
+void YUVToRGBManager::convert410(Graphics::Surface *dst, YUVToRGBManager::LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch, Common::JobManager *jobs) {
 	// Sanity checks
 	assert(dst && dst->getPixels());
 	assert(dst->format.bytesPerPixel == 2 || dst->format.bytesPerPixel == 4);
@@ -502,11 +678,24 @@ void YUVToRGBManager::convert410(Graphics::Surface *dst, YUVToRGBManager::Lumina
 
 	const YUVToRGBLookup *lookup = getLookup(dst->format, scale);
 
-	// Use a templated function to avoid an if check on every pixel
-	if (dst->format.bytesPerPixel == 2)
-		convertYUV410ToRGB<uint16>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
-	else
-		convertYUV410ToRGB<uint32>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+	byte *dstPtr = (byte *)dst->getPixels();
+	int dstPitch = dst->pitch;
+	bool is16Bit = dst->format.bytesPerPixel == 2;
+	int16 *colorTab = _colorTab;
+
+	// Rows are converted in groups of four sharing a chroma row
+	convertRows(jobs, yHeight / 4, kMinRowsPerJob / 4, [=](uint first, uint last) {
+		byte *rowDst = dstPtr + first * 4 * dstPitch;
+		const byte *rowY = ySrc + first * 4 * yPitch;
+		const byte *rowU = uSrc + first * uvPitch;
+		const byte *rowV = vSrc + first * uvPitch;
+
+		// Use a templated function to avoid an if check on every pixel
+		if (is16Bit)
+			convertYUV410ToRGB<uint16>(rowDst, dstPitch, lookup, colorTab, rowY, rowU, rowV, yWidth, (last - first) * 4, yPitch, uvPitch);
+		else
+			convertYUV410ToRGB<uint32>(rowDst, dstPitch, lookup, colorTab, rowY, rowU, rowV, yWidth, (last - first) * 4, yPitch, uvPitch);
+	});
 }
 
 } // End of namespace Graphics
@@ -41,9 +41,15 @@
 #include "common/singleton.h"
 #include "graphics/surface.h"
 
+namespace Common {
+class JobManager;
+}
+
 namespace Graphics {
 
 class YUVToRGBLookup;
+struct YUVToRGBKernels;
+struct YUVToRGBParams;
 
 class YUVToRGBManager : public Common::Singleton<YUVToRGBManager> {
 public:
@@ -65,8 +71,9 @@ public:
 	 * @param yHeight the height of the y surface
 	 * @param yPitch  the pitch of the y surface
 	 * @param uvPitch the pitch of the u and v surfaces
+	 * @param jobs    the job manager converting rows in parallel, by default the one of OSystem
 	 */
-	void convert444(Graphics::Surface *dst, LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch);
+	void convert444(Graphics::Surface *dst, LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch, Common::JobManager *jobs = nullptr);
 
 	/**
 	 * Convert a YUV422 image to an RGB surface
@@ -80,8 +87,9 @@ public:
 	 * @param yHeight the height of the y surface
 	 * @param yPitch  the pitch of the y surface
 	 * @param uvPitch the pitch of the u and v surfaces
+	 * @param jobs    the job manager converting rows in parallel, by default the one of OSystem
 	 */
-	void convert422(Graphics::Surface *dst, LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch);
+	void convert422(Graphics::Surface *dst, LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch, Common::JobManager *jobs = nullptr);
 
 	/**
 	 * Convert a YUV420 image to an RGB surface
@@ -95,8 +103,9 @@ public:
 	 * @param yHeight the height of the y surface (must be divisible by 2)
 	 * @param yPitch  the pitch of the y surface
 	 * @param uvPitch the pitch of the u and v surfaces
+	 * @param jobs    the job manager converting rows in parallel, by default the one of OSystem
 	 */
-	void convert420(Graphics::Surface *dst, LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch);
+	void convert420(Graphics::Surface *dst, LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch, Common::JobManager *jobs = nullptr);
 
 	/**
 	 * Convert a YUV420 image with Alpha component to an ARGB surface
@@ -111,8 +120,9 @@ public:
 	 * @param yHeight the height of the y surface (must be divisible by 2)
 	 * @param yPitch  the pitch of the y surface
 	 * @param uvPitch the pitch of the u and v surfaces
+	 * @param jobs    the job manager converting rows in parallel, by default the one of OSystem
 	 */
-	void convert420Alpha(Graphics::Surface *dst, LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, const byte *aSrc, int yWidth, int yHeight, int yPitch, int uvPitch);
+	void convert420Alpha(Graphics::Surface *dst, LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, const byte *aSrc, int yWidth, int yHeight, int yPitch, int uvPitch, Common::JobManager *jobs = nullptr);
 
 	/**
 	 * Convert a YUV410 image to an RGB surface
@@ -132,8 +142,16 @@ public:
 	 * @param yHeight the height of the y surface (must be divisible by 4)
 	 * @param yPitch  the pitch of the y surface
 	 * @param uvPitch the pitch of the u and v surfaces
+	 * @param jobs    the job manager converting rows in parallel, by default the one of OSystem
+	 */
+	void convert410(Graphics::Surface *dst, LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch, Common::JobManager *jobs = nullptr);
+
+	/**
+	 * Set the row converters used instead of the lookup tables, or nullptr to
+	 * always use the tables. By default, the fastest vectorized converters
+	 * the CPU supports are used. YUV410 is always converted with the tables.
 	 */
-	void convert410(Graphics::Surface *dst, LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch);
+	void setKernels(const YUVToRGBKernels *kernels);
 
 private:
 	friend class Common::Singleton<SingletonBaseType>;
@@ -141,10 +159,14 @@ private:
 	~YUVToRGBManager();
 
 	const YUVToRGBLookup *getLookup(Graphics::PixelFormat format, LuminanceScale scale, bool alphaMode = false);
+	const YUVToRGBKernels *getKernels();
+	void getParams(YUVToRGBParams &params, const Graphics::PixelFormat &format, LuminanceScale scale, bool alphaMode) const;
 
 	YUVToRGBLookup *_lookup;
 	int16 _colorTab[4 * 256]; // 2048 bytes
 	bool _alphaMode;
+	const YUVToRGBKernels *_kernels;
+	bool _kernelsDetected;
 };
  /** @} */
 } // End of namespace Graphics
@@ -0,0 +1,135 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#include "graphics/yuv_to_rgb_intern.h"
+
+#include <immintrin.h>
+
+#ifdef __GNUC__
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+
+namespace Graphics {
+
+/** Products of 16 centered chroma values with a factor, truncated like the color table. */
+static FORCEINLINE __m256i chromaAVX2(__m256i centered, __m256 factor) {
+	__m256i lo = _mm256_cvtepi16_epi32(_mm256_castsi256_si128(centered));
+	__m256i hi = _mm256_cvtepi16_epi32(_mm256_extracti128_si256(centered, 1));
+	lo = _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_cvtepi32_ps(lo), factor));
+	hi = _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_cvtepi32_ps(hi), factor));
+
+	// Packing works within the 128-bit lanes, put the quarters back in order
+	return _mm256_permute4x64_epi64(_mm256_packs_epi32(lo, hi), 0xD8);
+}
+
+/** Stretch 16 luminance values plus chroma offsets, see yuvToRGBChannel(). */
+static FORCEINLINE __m256i channelAVX2(__m256i value, bool itu) {
+	if (!itu)
+		return _mm256_min_epi16(_mm256_max_epi16(value, _mm256_setzero_si256()), _mm256_set1_epi16(255));
+
+	value = _mm256_sub_epi16(_mm256_min_epi16(_mm256_max_epi16(value, _mm256_set1_epi16(16)), _mm256_set1_epi16(235)), _mm256_set1_epi16(16));
+	return _mm256_add_epi16(value, _mm256_mulhi_epu16(value, _mm256_set1_epi16(10774)));
+}
+
+static FORCEINLINE __m256i loadChromaAVX2(const byte *src, bool halfChroma) {
+	__m128i c;
+	if (halfChroma) {
+		c = _mm_loadl_epi64((const __m128i *)src);
+		c = _mm_unpacklo_epi8(c, c);
+	} else {
+		c = _mm_loadu_si128((const __m128i *)src);
+	}
+	return _mm256_sub_epi16(_mm256_cvtepu8_epi16(c), _mm256_set1_epi16(128));
+}
+
+static FORCEINLINE __m256i packAVX2(__m256i r, __m256i g, __m256i b, __m128i rLoss, __m128i rShift,
+                                    __m128i gLoss, __m128i gShift, __m128i bLoss, __m128i bShift) {
+	__m256i color = _mm256_or_si256(_mm256_sll_epi32(_mm256_srl_epi32(r, rLoss), rShift),
+	                                _mm256_sll_epi32(_mm256_srl_epi32(g, gLoss), gShift));
+	return _mm256_or_si256(color, _mm256_sll_epi32(_mm256_srl_epi32(b, bLoss), bShift));
+}
+
+static void convertRowAVX2(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, const byte *aSrc,
+                           int width, bool halfChroma, const YUVToRGBParams &params) {
+	const __m256 crToR = _mm256_set1_ps(params.crToR);
+	const __m256 crToG = _mm256_set1_ps(params.crToG);
+	const __m256 cbToG = _mm256_set1_ps(params.cbToG);
+	const __m256 cbToB = _mm256_set1_ps(params.cbToB);
+	const __m128i rLoss = _mm_cvtsi32_si128(params.rLoss), rShift = _mm_cvtsi32_si128(params.rShift);
+	const __m128i gLoss = _mm_cvtsi32_si128(params.gLoss), gShift = _mm_cvtsi32_si128(params.gShift);
+	const __m128i bLoss = _mm_cvtsi32_si128(params.bLoss), bShift = _mm_cvtsi32_si128(params.bShift);
+	const __m128i aLoss = _mm_cvtsi32_si128(params.aLoss), aShift = _mm_cvtsi32_si128(params.aShift);
+
+	int i = 0;
+	for (; i + 16 <= width; i += 16) {
+		const int c = halfChroma ? i >> 1 : i;
+		const __m256i y = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(ySrc + i)));
+		const __m256i cb = loadChromaAVX2(uSrc + c, halfChroma);
+		const __m256i cr = loadChromaAVX2(vSrc + c, halfChroma);
+
+		const __m256i gOffset = _mm256_add_epi16(chromaAVX2(cr, crToG), chromaAVX2(cb, cbToG));
+		const __m256i r = channelAVX2(_mm256_add_epi16(y, chromaAVX2(cr, crToR)), params.itu);
+		const __m256i g = channelAVX2(_mm256_add_epi16(y, gOffset), params.itu);
+		const __m256i b = channelAVX2(_mm256_add_epi16(y, chromaAVX2(cb, cbToB)), params.itu);
+		const __m256i a = aSrc ? _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(aSrc + i))) : _mm256_setzero_si256();
+
+		if (params.bytesPerPixel == 2) {
+			__m256i color = _mm256_or_si256(_mm256_sll_epi16(_mm256_srl_epi16(r, rLoss), rShift),
+			                                _mm256_sll_epi16(_mm256_srl_epi16(g, gLoss), gShift));
+			color = _mm256_or_si256(color, _mm256_sll_epi16(_mm256_srl_epi16(b, bLoss), bShift));
+			if (aSrc)
+				color = _mm256_or_si256(color, _mm256_sll_epi16(_mm256_srl_epi16(a, aLoss), aShift));
+			else
+				color = _mm256_or_si256(color, _mm256_set1_epi16((int16)params.alpha));
+			_mm256_storeu_si256((__m256i *)(dst + i * 2), color);
+		} else {
+			const __m256i alpha = _mm256_set1_epi32(params.alpha);
+			for (int half = 0; half < 2; half++) {
+				const __m256i r32 = _mm256_cvtepu16_epi32(half ? _mm256_extracti128_si256(r, 1) : _mm256_castsi256_si128(r));
+				const __m256i g32 = _mm256_cvtepu16_epi32(half ? _mm256_extracti128_si256(g, 1) : _mm256_castsi256_si128(g));
+				const __m256i b32 = _mm256_cvtepu16_epi32(half ? _mm256_extracti128_si256(b, 1) : _mm256_castsi256_si128(b));
+				__m256i color = packAVX2(r32, g32, b32, rLoss, rShift, gLoss, gShift, bLoss, bShift);
+				if (aSrc) {
+					const __m256i a32 = _mm256_cvtepu16_epi32(half ? _mm256_extracti128_si256(a, 1) : _mm256_castsi256_si128(a));
+					color = _mm256_or_si256(color, _mm256_sll_epi32(_mm256_srl_epi32(a32, aLoss), aShift));
+				} else {
+					color = _mm256_or_si256(color, alpha);
+				}
+				_mm256_storeu_si256((__m256i *)(dst + (i + half * 8) * 4), color);
+			}
+		}
+	}
+
+	yuvToRGBRowTail(dst, ySrc, uSrc, vSrc, aSrc, i, width, halfChroma, params);
+}
+
+const YUVToRGBKernels g_yuvToRGBKernelsAVX2 = {
+	convertRowAVX2
+};
+
+} // End of namespace Graphics
+
+#ifdef __GNUC__
+#pragma GCC pop_options
+#endif
@@ -0,0 +1,125 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef GRAPHICS_YUV_TO_RGB_INTERN_H
+#define GRAPHICS_YUV_TO_RGB_INTERN_H
+
+#include "common/scummsys.h"
+#include "common/util.h"
+
+namespace Graphics {
+
+/** Conversion settings for the row converters, see YUVToRGBKernels. */
+struct YUVToRGBParams {
+	/** Luminance values range from [16, 235] and are stretched to [0, 255]. */
+	bool itu;
+
+	/**
+	 * Factors of the centered chroma values. Their products with the values
+	 * truncate to the offsets in the color table of the manager.
+	 */
+	float crToR, crToG, cbToG, cbToB;
+
+	/** The color table of the manager, for the generic converter. */
+	const int16 *colorTab;
+
+	/** Layout of the destination pixels. */
+	int bytesPerPixel;
+	int rLoss, gLoss, bLoss, aLoss;
+	int rShift, gShift, bShift, aShift;
+
+	/** Alpha bits of the pixels converted without an alpha row. */
+	uint32 alpha;
+};
+
+/**
+ * Row converters of YUVToRGBManager, used instead of its lookup tables. The
+ * generic version lives in yuv_to_rgb.cpp, vectorized versions in
+ * yuv_to_rgb_sse2.cpp, yuv_to_rgb_avx2.cpp and yuv_to_rgb_neon.cpp. All
+ * versions must produce the same pixels as the lookup tables.
+ */
+struct YUVToRGBKernels {
+	/**
+	 * Convert a row of @p width pixels. With @p halfChroma, each chroma value
+	 * covers two pixels like in YUV422 and YUV420, otherwise one. The alpha
+	 * row @p aSrc may be nullptr.
+	 */
+	void (*convertRow)(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, const byte *aSrc,
+	                   int width, bool halfChroma, const YUVToRGBParams &params);
+};
+
+#ifdef SCUMMVM_NEON
+extern const YUVToRGBKernels g_yuvToRGBKernelsNEON;
+#endif
+#ifdef SCUMMVM_SSE2
+extern const YUVToRGBKernels g_yuvToRGBKernelsSSE2;
+#endif
+#ifdef SCUMMVM_AVX2
+extern const YUVToRGBKernels g_yuvToRGBKernelsAVX2;
+#endif
+
+/** Return the generic converter, the reference for the vectorized ones. */
+const YUVToRGBKernels &getGenericYUVToRGBKernels();
+
+/**
+ * Return the fastest vectorized converters supported by the CPU, or nullptr
+ * if there are none. The generic converter is slower than the lookup tables.
+ */
+const YUVToRGBKernels *getYUVToRGBKernels();
+
+/** Stretch a luminance value plus chroma offset to [0, 255] like the lookup tables. */
+FORCEINLINE int yuvToRGBChannel(int value, const YUVToRGBParams &params) {
+	if (!params.itu)
+		return CLIP(value, 0, 255);
+
+	// Same as value * 255 / 219, without a division
+	value = CLIP(value, 16, 235) - 16;
+	return value + ((value * 10774) >> 16);
+}
+
+/** Convert a single pixel, without its alpha bits. */
+FORCEINLINE uint32 yuvToRGBPixel(int y, int u, int v, const YUVToRGBParams &params) {
+	const int16 *colorTab = params.colorTab;
+	const int r = yuvToRGBChannel(y + colorTab[v] - 256, params);
+	const int g = yuvToRGBChannel(y + colorTab[256 + v] + colorTab[512 + u] - 768 - 256, params);
+	const int b = yuvToRGBChannel(y + colorTab[768 + u] - 2 * 768 - 256, params);
+	return ((r >> params.rLoss) << params.rShift) |
+	       ((g >> params.gLoss) << params.gShift) |
+	       ((b >> params.bLoss) << params.bShift);
+}
+
+/** Convert the pixels of a row from @p first on, one at a time. */
+FORCEINLINE void yuvToRGBRowTail(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, const byte *aSrc,
+                                 int first, int width, bool halfChroma, const YUVToRGBParams &params) {
+	for (int i = first; i < width; i++) {
+		const int c = halfChroma ? i >> 1 : i;
+		uint32 color = yuvToRGBPixel(ySrc[i], uSrc[c], vSrc[c], params);
+		color |= aSrc ? (uint32)(aSrc[i] >> params.aLoss) << params.aShift : params.alpha;
+		if (params.bytesPerPixel == 2)
+			((uint16 *)dst)[i] = color;
+		else
+			((uint32 *)dst)[i] = color;
+	}
+}
+
+} // End of namespace Graphics
+
+#endif
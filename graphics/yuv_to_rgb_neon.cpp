@@ -0,0 +1,134 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#ifdef SCUMMVM_NEON
+
+#include "graphics/yuv_to_rgb_intern.h"
+
+#include <arm_neon.h>
+
+#ifdef __GNUC__
+#pragma GCC push_options
+
+#if !defined(__aarch64__)
+#pragma GCC target("fpu=neon")
+#endif // !defined(__aarch64__)
+
+#endif // __GNUC__
+
+namespace Graphics {
+
+/** Products of 8 centered chroma values with a factor, truncated like the color table. */
+static FORCEINLINE int16x8_t chromaNEON(int16x8_t centered, float factor) {
+	const int32x4_t lo = vcvtq_s32_f32(vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(centered))), factor));
+	const int32x4_t hi = vcvtq_s32_f32(vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(centered))), factor));
+	return vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi));
+}
+
+/** Stretch 8 luminance values plus chroma offsets, see yuvToRGBChannel(). */
+static FORCEINLINE uint16x8_t channelNEON(int16x8_t value, bool itu) {
+	if (!itu)
+		return vreinterpretq_u16_s16(vminq_s16(vmaxq_s16(value, vdupq_n_s16(0)), vdupq_n_s16(255)));
+
+	value = vsubq_s16(vminq_s16(vmaxq_s16(value, vdupq_n_s16(16)), vdupq_n_s16(235)), vdupq_n_s16(16));
+
+	// The doubling multiply gives (value * 10774) >> 16
+	return vreinterpretq_u16_s16(vaddq_s16(value, vqdmulhq_n_s16(value, 5387)));
+}
+
+static FORCEINLINE int16x8_t loadChromaNEON(const byte *src, bool halfChroma) {
+	uint8x8_t c;
+	if (halfChroma) {
+		uint32 values;
+		memcpy(&values, src, sizeof(values));
+		c = vreinterpret_u8_u32(vdup_n_u32(values));
+		c = vzip_u8(c, c).val[0];
+	} else {
+		c = vld1_u8(src);
+	}
+	return vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(c)), vdupq_n_s16(128));
+}
+
+static FORCEINLINE uint32x4_t packNEON(uint16x4_t r, uint16x4_t g, uint16x4_t b, int rLoss, int rShift,
+                                       int gLoss, int gShift, int bLoss, int bShift) {
+	uint32x4_t color = vshlq_u32(vshlq_u32(vmovl_u16(r), vdupq_n_s32(-rLoss)), vdupq_n_s32(rShift));
+	color = vorrq_u32(color, vshlq_u32(vshlq_u32(vmovl_u16(g), vdupq_n_s32(-gLoss)), vdupq_n_s32(gShift)));
+	return vorrq_u32(color, vshlq_u32(vshlq_u32(vmovl_u16(b), vdupq_n_s32(-bLoss)), vdupq_n_s32(bShift)));
+}
+
+static void convertRowNEON(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, const byte *aSrc,
+                           int width, bool halfChroma, const YUVToRGBParams &params) {
+	int i = 0;
+	for (; i + 8 <= width; i += 8) {
+		const int c = halfChroma ? i >> 1 : i;
+		const int16x8_t y = vreinterpretq_s16_u16(vmovl_u8(vld1_u8(ySrc + i)));
+		const int16x8_t cb = loadChromaNEON(uSrc + c, halfChroma);
+		const int16x8_t cr = loadChromaNEON(vSrc + c, halfChroma);
+
+		const int16x8_t gOffset = vaddq_s16(chromaNEON(cr, params.crToG), chromaNEON(cb, params.cbToG));
+		const uint16x8_t r = channelNEON(vaddq_s16(y, chromaNEON(cr, params.crToR)), params.itu);
+		const uint16x8_t g = channelNEON(vaddq_s16(y, gOffset), params.itu);
+		const uint16x8_t b = channelNEON(vaddq_s16(y, chromaNEON(cb, params.cbToB)), params.itu);
+		const uint16x8_t a = aSrc ? vmovl_u8(vld1_u8(aSrc + i)) : vdupq_n_u16(0);
+
+		if (params.bytesPerPixel == 2) {
+			uint16x8_t color = vshlq_u16(vshlq_u16(r, vdupq_n_s16(-params.rLoss)), vdupq_n_s16(params.rShift));
+			color = vorrq_u16(color, vshlq_u16(vshlq_u16(g, vdupq_n_s16(-params.gLoss)), vdupq_n_s16(params.gShift)));
+			color = vorrq_u16(color, vshlq_u16(vshlq_u16(b, vdupq_n_s16(-params.bLoss)), vdupq_n_s16(params.bShift)));
+			if (aSrc)
+				color = vorrq_u16(color, vshlq_u16(vshlq_u16(a, vdupq_n_s16(-params.aLoss)), vdupq_n_s16(params.aShift)));
+			else
+				color = vorrq_u16(color, vdupq_n_u16(params.alpha));
+			vst1q_u16((uint16 *)(dst + i * 2), color);
+		} else {
+			uint32x4_t lo = packNEON(vget_low_u16(r), vget_low_u16(g), vget_low_u16(b),
+			                         params.rLoss, params.rShift, params.gLoss, params.gShift, params.bLoss, params.bShift);
+			uint32x4_t hi = packNEON(vget_high_u16(r), vget_high_u16(g), vget_high_u16(b),
+			                         params.rLoss, params.rShift, params.gLoss, params.gShift, params.bLoss, params.bShift);
+			if (aSrc) {
+				const int32x4_t aLoss = vdupq_n_s32(-params.aLoss), aShift = vdupq_n_s32(params.aShift);
+				lo = vorrq_u32(lo, vshlq_u32(vshlq_u32(vmovl_u16(vget_low_u16(a)), aLoss), aShift));
+				hi = vorrq_u32(hi, vshlq_u32(vshlq_u32(vmovl_u16(vget_high_u16(a)), aLoss), aShift));
+			} else {
+				lo = vorrq_u32(lo, vdupq_n_u32(params.alpha));
+				hi = vorrq_u32(hi, vdupq_n_u32(params.alpha));
+			}
+			vst1q_u32((uint32 *)(dst + i * 4), lo);
+			vst1q_u32((uint32 *)(dst + i * 4 + 16), hi);
+		}
+	}
+
+	yuvToRGBRowTail(dst, ySrc, uSrc, vSrc, aSrc, i, width, halfChroma, params);
+}
+
+const YUVToRGBKernels g_yuvToRGBKernelsNEON = {
+	convertRowNEON
+};
+
+} // End of namespace Graphics
+
+#ifdef __GNUC__
+#pragma GCC pop_options
+#endif
+
+#endif // SCUMMVM_NEON
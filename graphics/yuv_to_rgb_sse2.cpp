@@ -0,0 +1,135 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#include "graphics/yuv_to_rgb_intern.h"
+
+#include <emmintrin.h>
+
+#ifdef __GNUC__
+#pragma GCC push_options
+
+#ifndef __x86_64__
+#pragma GCC target("sse2")
+#endif
+
+#endif
+
+namespace Graphics {
+
+/** Products of 8 centered chroma values with a factor, truncated like the color table. */
+static FORCEINLINE __m128i chromaSSE2(__m128i centered, __m128 factor) {
+	__m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(centered, centered), 16);
+	__m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(centered, centered), 16);
+	lo = _mm_cvttps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(lo), factor));
+	hi = _mm_cvttps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(hi), factor));
+	return _mm_packs_epi32(lo, hi);
+}
+
+/** Stretch 8 luminance values plus chroma offsets, see yuvToRGBChannel(). */
+static FORCEINLINE __m128i channelSSE2(__m128i value, bool itu) {
+	if (!itu)
+		return _mm_min_epi16(_mm_max_epi16(value, _mm_setzero_si128()), _mm_set1_epi16(255));
+
+	value = _mm_sub_epi16(_mm_min_epi16(_mm_max_epi16(value, _mm_set1_epi16(16)), _mm_set1_epi16(235)), _mm_set1_epi16(16));
+	return _mm_add_epi16(value, _mm_mulhi_epu16(value, _mm_set1_epi16(10774)));
+}
+
+static FORCEINLINE __m128i loadChromaSSE2(const byte *src, bool halfChroma) {
+	__m128i c;
+	if (halfChroma) {
+		uint32 values;
+		memcpy(&values, src, sizeof(values));
+		c = _mm_cvtsi32_si128(values);
+		c = _mm_unpacklo_epi8(c, c);
+	} else {
+		c = _mm_loadl_epi64((const __m128i *)src);
+	}
+	return _mm_sub_epi16(_mm_unpacklo_epi8(c, _mm_setzero_si128()), _mm_set1_epi16(128));
+}
+
+static void convertRowSSE2(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, const byte *aSrc,
+                           int width, bool halfChroma, const YUVToRGBParams &params) {
+	const __m128 crToR = _mm_set1_ps(params.crToR);
+	const __m128 crToG = _mm_set1_ps(params.crToG);
+	const __m128 cbToG = _mm_set1_ps(params.cbToG);
+	const __m128 cbToB = _mm_set1_ps(params.cbToB);
+	const __m128i rLoss = _mm_cvtsi32_si128(params.rLoss), rShift = _mm_cvtsi32_si128(params.rShift);
+	const __m128i gLoss = _mm_cvtsi32_si128(params.gLoss), gShift = _mm_cvtsi32_si128(params.gShift);
+	const __m128i bLoss = _mm_cvtsi32_si128(params.bLoss), bShift = _mm_cvtsi32_si128(params.bShift);
+	const __m128i aLoss = _mm_cvtsi32_si128(params.aLoss), aShift = _mm_cvtsi32_si128(params.aShift);
+	const __m128i zero = _mm_setzero_si128();
+
+	int i = 0;
+	for (; i + 8 <= width; i += 8) {
+		const int c = halfChroma ? i >> 1 : i;
+		const __m128i y = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(ySrc + i)), zero);
+		const __m128i cb = loadChromaSSE2(uSrc + c, halfChroma);
+		const __m128i cr = loadChromaSSE2(vSrc + c, halfChroma);
+
+		const __m128i gOffset = _mm_add_epi16(chromaSSE2(cr, crToG), chromaSSE2(cb, cbToG));
+		const __m128i r = channelSSE2(_mm_add_epi16(y, chromaSSE2(cr, crToR)), params.itu);
+		const __m128i g = channelSSE2(_mm_add_epi16(y, gOffset), params.itu);
+		const __m128i b = channelSSE2(_mm_add_epi16(y, chromaSSE2(cb, cbToB)), params.itu);
+		const __m128i a = aSrc ? _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(aSrc + i)), zero) : zero;
+
+		if (params.bytesPerPixel == 2) {
+			__m128i color = _mm_or_si128(_mm_sll_epi16(_mm_srl_epi16(r, rLoss), rShift),
+			                             _mm_sll_epi16(_mm_srl_epi16(g, gLoss), gShift));
+			color = _mm_or_si128(color, _mm_sll_epi16(_mm_srl_epi16(b, bLoss), bShift));
+			if (aSrc)
+				color = _mm_or_si128(color, _mm_sll_epi16(_mm_srl_epi16(a, aLoss), aShift));
+			else
+				color = _mm_or_si128(color, _mm_set1_epi16((int16)params.alpha));
+			_mm_storeu_si128((__m128i *)(dst + i * 2), color);
+		} else {
+			const __m128i alpha = _mm_set1_epi32(params.alpha);
+			for (int half = 0; half < 2; half++) {
+				const __m128i r32 = half ? _mm_unpackhi_epi16(r, zero) : _mm_unpacklo_epi16(r, zero);
+				const __m128i g32 = half ? _mm_unpackhi_epi16(g, zero) : _mm_unpacklo_epi16(g, zero);
+				const __m128i b32 = half ? _mm_unpackhi_epi16(b, zero) : _mm_unpacklo_epi16(b, zero);
+				__m128i color = _mm_or_si128(_mm_sll_epi32(_mm_srl_epi32(r32, rLoss), rShift),
+				                             _mm_sll_epi32(_mm_srl_epi32(g32, gLoss), gShift));
+				color = _mm_or_si128(color, _mm_sll_epi32(_mm_srl_epi32(b32, bLoss), bShift));
+				if (aSrc) {
+					const __m128i a32 = half ? _mm_unpackhi_epi16(a, zero) : _mm_unpacklo_epi16(a, zero);
+					color = _mm_or_si128(color, _mm_sll_epi32(_mm_srl_epi32(a32, aLoss), aShift));
+				} else {
+					color = _mm_or_si128(color, alpha);
+				}
+				_mm_storeu_si128((__m128i *)(dst + (i + half * 4) * 4), color);
+			}
+		}
+	}
+
+	yuvToRGBRowTail(dst, ySrc, uSrc, vSrc, aSrc, i, width, halfChroma, params);
+}
+
+const YUVToRGBKernels g_yuvToRGBKernelsSSE2 = {
+	convertRowSSE2
+};
+
+} // End of namespace Graphics
+
+#ifdef __GNUC__
+#pragma GCC pop_options
+#endif
@@ -29,9 +29,12 @@ DECLARE_SINGLETON(GUI::EventRecorder);
 }
 
 #include "common/debug-channels.h"
+#ifdef SDL_BACKEND
 #include "backends/timer/sdl/sdl-timer.h"
+#endif
 #include "backends/mixer/mixer.h"
 #include "common/config-manager.h"
+#include "common/file.h"
 #include "common/md5.h"
 #include "gui/gui-manager.h"
 #include "gui/widget.h"
@@ -78,6 +81,11 @@ EventRecorder::EventRecorder() {
 	_screenshotPeriod = 0;
 	_playbackFile = nullptr;
 	_recordFile = nullptr;
+	_benchmark = false;
+	_benchmarkStart = 0;
+	_frameStart = 0;
+	_blitStart = 0;
+	_hashStart = 0;
 }
 
 EventRecorder::~EventRecorder() {
@@ -88,6 +96,7 @@ void EventRecorder::deinit() {
 	if (!_initialized) {
 		return;
 	}
+	finishBenchmark();
 	setFileHeader();
 	_needRedraw = false;
 	_initialized = false;
@@ -559,7 +568,11 @@ void EventRecorder::registerTimerManager(DefaultTimerManager *timerManager) {
 void EventRecorder::switchTimerManagers() {
 	delete _timerManager;
 	if (_recordMode == kPassthrough) {
+#ifdef SDL_BACKEND
 		_timerManager = new SdlTimerManager();
+#else
+		_timerManager = new DefaultTimerManager();
+#endif
 	} else {
 		_timerManager = new DefaultTimerManager();
 	}
@@ -571,7 +584,10 @@ void EventRecorder::updateSubsystems() {
 	}
 	RecordMode oldRecordMode = _recordMode;
 	_recordMode = kPassthrough;
+	const uint64 start = _benchmark ? g_system->getMicros() : 0;
 	_fakeMixerManager->update();
+	if (_benchmark)
+		_frame.mixerMicros += g_system->getMicros() - start;
 	_recordMode = oldRecordMode;
 }
 
@@ -662,6 +678,7 @@ void EventRecorder::takeScreenshot() {
 }
 
 bool EventRecorder::grabScreenAndComputeMD5(Graphics::Surface &screen, uint8 md5[16]) {
+	_hashStart = g_system->getMicros();
 	if (!createScreenShot(screen)) {
 		warning("Can't save screenshot");
 		return false;
@@ -699,6 +716,11 @@ Common::SaveFileManager *EventRecorder::getSaveManager(Common::SaveFileManager *
 }
 
 void EventRecorder::preDrawOverlayGui() {
+	if (_benchmark) {
+		// The control panel is not drawn, only the game screen is timed
+		beginBlit();
+		return;
+	}
 	if ((_initialized) || (_needRedraw)) {
 		RecordMode oldMode = _recordMode;
 		_recordMode = kPassthrough;
@@ -716,6 +738,12 @@ void EventRecorder::preDrawOverlayGui() {
 }
 
 void EventRecorder::postDrawOverlayGui() {
+	if (_benchmark) {
+		endBlit();
+		if (_initialized)
+			finishBenchmarkFrame();
+		return;
+	}
 	if ((_initialized) || (_needRedraw)) {
 		RecordMode oldMode = _recordMode;
 		_recordMode = kPassthrough;
@@ -756,10 +784,12 @@ void EventRecorder::setFileHeader() {
 	_recordFile->getHeader().name = _name;
 }
 
+#ifdef SDL_BACKEND
 SDL_Surface *EventRecorder::getSurface(int width, int height) {
 	// Create a RGB565 surface of the requested dimensions.
 	return SDL_CreateRGBSurface(SDL_SWSURFACE, width, height, 16, 0xF800, 0x07E0, 0x001F, 0x0000);
 }
+#endif
 
 bool EventRecorder::switchMode() {
 	const Plugin *plugin = EngineMan.findPlugin(ConfMan.get("engineid"));
@@ -808,6 +838,101 @@ bool EventRecorder::checkForContinueGame() {
 	return result;
 }
 
+void EventRecorder::processScreenHash(bool match) {
+	if (!_benchmark) {
+		return;
+	}
+	_frame.hashMicros += g_system->getMicros() - _hashStart;
+	_frame.hash = (_frame.hash != 0 && match) ? 1 : 0;
+}
+
+void EventRecorder::startBenchmark(const Common::String &reportFileName) {
+	assert(_recordMode == kRecorderPlayback);
+	_benchmark = true;
+	_benchmarkFileName = reportFileName;
+	_benchmarkFrames.clear();
+	_fastPlayback = true;
+	memset(&_frame, 0, sizeof(_frame));
+	_frame.hash = -1;
+	_benchmarkStart = _frameStart = g_system->getMicros();
+}
+
+void EventRecorder::finishBenchmark() {
+	if (!_benchmark) {
+		return;
+	}
+	_benchmark = false;
+	writeBenchmarkReport();
+	_benchmarkFrames.clear();
+}
+
+void EventRecorder::finishBenchmarkFrame() {
+	const uint64 now = g_system->getMicros();
+	// Everything which is not blitting, mixing or checking the screen is
+	// spent in the engine
+	const uint64 total = now - _frameStart;
+	const uint64 measured = _frame.blitMicros + _frame.mixerMicros + _frame.hashMicros;
+	_frame.engineMicros = total > measured ? total - measured : 0;
+	_frame.time = _fakeTimer;
+	_benchmarkFrames.push_back(_frame);
+
+	memset(&_frame, 0, sizeof(_frame));
+	_frame.hash = -1;
+	_frameStart = now;
+}
+
+static Common::String quoteJSON(const Common::String &str) {
+	Common::String result = "\"";
+	for (uint i = 0; i < str.size(); i++) {
+		if (str[i] == '"' || str[i] == '\\')
+			result += '\\';
+		result += str[i];
+	}
+	return result + "\"";
+}
+
+void EventRecorder::writeBenchmarkReport() {
+	Common::DumpFile report;
+	if (!report.open(Common::Path::fromConfig(_benchmarkFileName))) {
+		warning("Can't write the benchmark report to %s", _benchmarkFileName.c_str());
+		return;
+	}
+
+	uint64 engineMicros = 0, blitMicros = 0, mixerMicros = 0, hashMicros = 0;
+	uint hashChecks = 0, hashMismatches = 0;
+	report.writeString("{\n\t\"frames\": [\n");
+	for (uint i = 0; i < _benchmarkFrames.size(); i++) {
+		const BenchmarkFrame &frame = _benchmarkFrames[i];
+		const char *hash = frame.hash < 0 ? "null" : (frame.hash ? "\"match\"" : "\"mismatch\"");
+		report.writeString(Common::String::format("\t\t{ \"frame\": %u, \"time\": %u, \"engine_us\": %u, \"blit_us\": %u, \"mixer_us\": %u, \"hash_us\": %u, \"hash\": %s }%s\n",
+			i, frame.time, frame.engineMicros, frame.blitMicros, frame.mixerMicros, frame.hashMicros, hash,
+			i + 1 < _benchmarkFrames.size() ? "," : ""));
+
+		engineMicros += frame.engineMicros;
+		blitMicros += frame.blitMicros;
+		mixerMicros += frame.mixerMicros;
+		hashMicros += frame.hashMicros;
+		if (frame.hash >= 0)
+			hashChecks++;
+		if (frame.hash == 0)
+			hashMismatches++;
+	}
+	report.writeString("\t],\n");
+
+	const Common::String recordFileName = _playbackFile ? _playbackFile->getHeader().fileName : Common::String();
+	report.writeString(Common::String::format("\t\"summary\": {\n\t\t\"record\": %s,\n\t\t\"frames\": %u,\n",
+		quoteJSON(recordFileName).c_str(), _benchmarkFrames.size()));
+	report.writeString(Common::String::format("\t\t\"wall_us\": %llu,\n\t\t\"engine_us\": %llu,\n\t\t\"blit_us\": %llu,\n\t\t\"mixer_us\": %llu,\n\t\t\"hash_us\": %llu,\n",
+		(unsigned long long)(g_system->getMicros() - _benchmarkStart), (unsigned long long)engineMicros,
+		(unsigned long long)blitMicros, (unsigned long long)mixerMicros, (unsigned long long)hashMicros));
+	report.writeString(Common::String::format("\t\t\"hash_checks\": %u,\n\t\t\"hash_mismatches\": %u\n\t}\n}\n",
+		hashChecks, hashMismatches));
+
+	report.finalize();
+	report.close();
+	debug("Benchmark report written to %s: %u frames, %u screen hash mismatches", _benchmarkFileName.c_str(), _benchmarkFrames.size(), hashMismatches);
+}
+
 void EventRecorder::deleteTemporarySave() {
 	if (_temporarySlot == -1) return;
 	const Plugin *plugin = EngineMan.findPlugin(ConfMan.get("engineid"));
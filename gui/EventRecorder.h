@@ -38,7 +38,11 @@
 #include "backends/mixer/mixer.h"
 #include "common/hashmap.h"
 #include "common/hash-str.h"
+#ifdef SDL_BACKEND
 #include "backends/timer/sdl/sdl-timer.h"
+#else
+#include "backends/timer/default/default-timer.h"
+#endif
 #include "common/config-manager.h"
 #include "common/recorderfile.h"
 #include "backends/saves/recorder/recorder-saves.h"
@@ -87,6 +91,31 @@ public:
 	void processGameDescription(const ADGameDescription *desc);
 	bool processAutosave();
 	Common::SeekableReadStream *processSaveStream(const Common::String & fileName);
+	void processScreenHash(bool match);
+
+	/**
+	 * Replay as fast as possible and measure how long every frame takes.
+	 *
+	 * Must be called after the playback has been initialized. The report is
+	 * written to @p reportFileName as JSON when the playback ends.
+	 */
+	void startBenchmark(const Common::String &reportFileName);
+
+	/** Write the benchmark report, if a benchmark is running. */
+	void finishBenchmark();
+
+	/**
+	 * Time passing the game screen to the backend, from copyRectToScreen()
+	 * or lockScreen() until the matching unlockScreen(), for the benchmark.
+	 */
+	void beginBlit() {
+		if (_benchmark)
+			_blitStart = g_system->getMicros();
+	}
+	void endBlit() {
+		if (_benchmark)
+			_frame.blitMicros += g_system->getMicros() - _blitStart;
+	}
 
 	/** Hooks for intercepting into GUI processing, so required events could be shoot
 	 *  or filtered out */
@@ -177,7 +206,9 @@ public:
 	Common::String generateRecordFileName(const Common::String &target);
 
 	Common::SaveFileManager *getSaveManager(Common::SaveFileManager *realSaveManager);
+#ifdef SDL_BACKEND
 	SDL_Surface *getSurface(int width, int height);
+#endif
 	void RegisterEventSource();
 
 	/** Retrieve game screenshot and compute its checksum for comparison */
@@ -249,6 +280,28 @@ private:
 	bool _fastPlayback;
 	bool _needRedraw;
 	bool _processingMillis;
+
+	/** Timings of a replayed frame, in microseconds. */
+	struct BenchmarkFrame {
+		uint32 time;
+		uint32 engineMicros;
+		uint32 blitMicros;
+		uint32 mixerMicros;
+		uint32 hashMicros;
+		int hash; /**< -1 if not checked, 0 on mismatch, 1 on match */
+	};
+
+	void finishBenchmarkFrame();
+	void writeBenchmarkReport();
+
+	bool _benchmark;
+	Common::String _benchmarkFileName;
+	Common::Array<BenchmarkFrame> _benchmarkFrames;
+	uint64 _benchmarkStart;
+	uint64 _frameStart;
+	uint64 _blitStart;
+	uint64 _hashStart;
+	BenchmarkFrame _frame;
 };
 
 } // End of namespace GUI
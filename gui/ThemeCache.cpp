@@ -0,0 +1,163 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "gui/ThemeCache.h"
+
+#include "common/endian.h"
+#include "graphics/managed_surface.h"
+
+namespace GUI {
+
+bool ThemeCache::Key::operator==(const Key &other) const {
+	return type == other.type && dynamic == other.dynamic && width == other.width && height == other.height &&
+	       !memcmp(colors, other.colors, sizeof(colors)) && shadows == other.shadows &&
+	       backgroundHash == other.backgroundHash;
+}
+
+uint ThemeCache::KeyHash::operator()(const Key &key) const {
+	uint hash = key.backgroundHash;
+	hash = hash * 31 + key.type;
+	hash = hash * 31 + key.dynamic;
+	hash = hash * 31 + ((key.width << 16) | (uint16)key.height);
+	for (int i = 0; i < 5; i++)
+		hash = hash * 31 + key.colors[i];
+	return hash;
+}
+
+ThemeCache::ThemeCache(uint32 maxSize) : _maxSize(maxSize), _size(0), _hasBackground(false) {
+}
+
+ThemeCache::~ThemeCache() {
+	clear();
+}
+
+void ThemeCache::clear() {
+	for (EntryList::iterator i = _entries.begin(); i != _entries.end(); ++i) {
+		i->background.free();
+		i->raster.free();
+	}
+	_entries.clear();
+	_index.clear(true);
+	_size = 0;
+
+	_background.free();
+	_hasBackground = false;
+}
+
+uint32 ThemeCache::hashPixels(const Graphics::ManagedSurface *surface, const Common::Rect &rect) {
+	// FNV-1a, a word at a time
+	const uint rowSize = rect.width() * surface->format.bytesPerPixel;
+	uint32 hash = 2166136261U;
+	for (int y = rect.top; y < rect.bottom; y++) {
+		const byte *row = (const byte *)surface->getBasePtr(rect.left, y);
+		uint x = 0;
+		for (; x + 4 <= rowSize; x += 4)
+			hash = (hash ^ READ_UINT32(row + x)) * 16777619;
+		for (; x < rowSize; x++)
+			hash = (hash ^ row[x]) * 16777619;
+	}
+	return hash;
+}
+
+bool ThemeCache::equalPixels(const Graphics::Surface &pixels, const Graphics::ManagedSurface *surface, const Common::Rect &rect) {
+	const uint rowSize = rect.width() * surface->format.bytesPerPixel;
+	for (int y = 0; y < rect.height(); y++) {
+		if (memcmp(pixels.getBasePtr(0, y), surface->getBasePtr(rect.left, rect.top + y), rowSize))
+			return false;
+	}
+	return true;
+}
+
+void ThemeCache::copyPixels(Graphics::Surface &pixels, const Graphics::ManagedSurface *surface, const Common::Rect &rect) {
+	if (pixels.w != rect.width() || pixels.h != rect.height() || pixels.format != surface->format) {
+		pixels.free();
+		pixels.create(rect.width(), rect.height(), surface->format);
+	}
+	pixels.copyRectToSurface(surface->getBasePtr(rect.left, rect.top), surface->pitch, 0, 0, rect.width(), rect.height());
+}
+
+bool ThemeCache::restore(Key &key, Graphics::ManagedSurface *surface, const Common::Rect &rect) {
+	_hasBackground = false;
+
+	// Small widgets are drawn faster than they are looked up, and rasters
+	// which would push out most of the others are not worth it
+	const uint32 size = rect.width() * rect.height() * surface->format.bytesPerPixel * 2;
+	if (rect.width() * rect.height() < kMinPixels || size > _maxSize / 4)
+		return false;
+
+	key.backgroundHash = hashPixels(surface, rect);
+	EntryMap::iterator i = _index.find(key);
+	if (i != _index.end() && equalPixels(i->_value->background, surface, rect)) {
+		EntryList::iterator entry = i->_value;
+		surface->copyRectToSurface(entry->raster, rect.left, rect.top, Common::Rect(rect.width(), rect.height()));
+
+		if (entry != _entries.begin()) {
+			_entries.push_front(*entry);
+			_entries.erase(entry);
+			i->_value = _entries.begin();
+		}
+		return true;
+	}
+
+	copyPixels(_background, surface, rect);
+	_hasBackground = true;
+	return false;
+}
+
+void ThemeCache::store(const Key &key, const Graphics::ManagedSurface *surface, const Common::Rect &rect) {
+	if (!_hasBackground || _background.w != rect.width() || _background.h != rect.height())
+		return;
+	_hasBackground = false;
+
+	// Same hash on another background, keep the latest one
+	EntryMap::iterator i = _index.find(key);
+	if (i != _index.end()) {
+		_entries.push_front(*i->_value);
+		_entries.erase(i->_value);
+		i->_value = _entries.begin();
+	} else {
+		Entry entry;
+		entry.key = key;
+		entry.size = rect.width() * rect.height() * surface->format.bytesPerPixel * 2;
+		evict(_maxSize > entry.size ? _maxSize - entry.size : 0);
+		_entries.push_front(entry);
+		_index[key] = _entries.begin();
+		_size += entry.size;
+	}
+
+	// The background buffer of the entry is reused for the next miss
+	Entry &entry = _entries.front();
+	SWAP(entry.background, _background);
+	copyPixels(entry.raster, surface, rect);
+}
+
+void ThemeCache::evict(uint32 maxSize) {
+	while (_size > maxSize && !_entries.empty()) {
+		Entry &entry = _entries.back();
+		_index.erase(entry.key);
+		_size -= entry.size;
+		entry.background.free();
+		entry.raster.free();
+		_entries.pop_back();
+	}
+}
+
+} // End of namespace GUI
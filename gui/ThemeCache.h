@@ -0,0 +1,123 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef GUI_THEME_CACHE_H
+#define GUI_THEME_CACHE_H
+
+#include "common/scummsys.h"
+#include "common/hashmap.h"
+#include "common/list.h"
+#include "common/rect.h"
+#include "graphics/surface.h"
+
+namespace Graphics {
+class ManagedSurface;
+}
+
+namespace GUI {
+
+/**
+ * Keeps the pixels of widgets drawn by the ThemeEngine, so that widgets
+ * which are drawn again with the same size and state onto the same
+ * background are copied instead of going through the vector renderer.
+ *
+ * The background under a widget is part of the lookup, since the drawing
+ * steps blend with it. Rasters are dropped least recently used first when
+ * the cache is full. Widgets with fewer than kMinPixels pixels are cheaper
+ * to draw than to look up, and are never kept.
+ */
+class ThemeCache {
+public:
+	/** What the pixels of a widget depend on, besides its background. */
+	struct Key {
+		int type;          /*!< DrawData of the widget */
+		uint32 dynamic;    /*!< Dynamic data passed to the drawing steps */
+		int16 width, height;
+		uint32 colors[5];  /*!< Renderer colors, see VectorRenderer::getColors() */
+		bool shadows;
+		uint32 backgroundHash;
+
+		bool operator==(const Key &other) const;
+	};
+
+	enum {
+		/** Bytes kept for all rasters and their backgrounds. */
+		kDefaultMaxSize = 8 * 1024 * 1024,
+		/** Smallest widget area worth caching, in pixels. */
+		kMinPixels = 32 * 32
+	};
+
+	ThemeCache(uint32 maxSize = kDefaultMaxSize);
+	~ThemeCache();
+
+	/** Forget all rasters, e.g. when the theme or the screen changes. */
+	void clear();
+
+	/**
+	 * Look for a widget drawn with @p key onto the pixels found in @p rect of
+	 * @p surface. If there is one, copy it there and return true. Otherwise
+	 * keep the background, for a store() once the widget is drawn.
+	 */
+	bool restore(Key &key, Graphics::ManagedSurface *surface, const Common::Rect &rect);
+
+	/** Keep the widget just drawn in @p rect, after restore() failed. */
+	void store(const Key &key, const Graphics::ManagedSurface *surface, const Common::Rect &rect);
+
+	uint32 getSize() const { return _size; }
+	uint32 getMaxSize() const { return _maxSize; }
+	uint getCount() const { return _index.size(); }
+
+private:
+	struct KeyHash {
+		uint operator()(const Key &key) const;
+	};
+
+	struct Entry {
+		Key key;
+		Graphics::Surface background;
+		Graphics::Surface raster;
+		uint32 size;
+	};
+
+	typedef Common::List<Entry> EntryList;
+	typedef Common::HashMap<Key, EntryList::iterator, KeyHash> EntryMap;
+
+	static uint32 hashPixels(const Graphics::ManagedSurface *surface, const Common::Rect &rect);
+	static bool equalPixels(const Graphics::Surface &pixels, const Graphics::ManagedSurface *surface, const Common::Rect &rect);
+	static void copyPixels(Graphics::Surface &pixels, const Graphics::ManagedSurface *surface, const Common::Rect &rect);
+
+	/** Drop the least recently used rasters until the cache fits in `maxSize` bytes. */
+	void evict(uint32 maxSize);
+
+	/** Rasters from the most to the least recently used one. */
+	EntryList _entries;
+	EntryMap _index;
+	uint32 _maxSize;
+	uint32 _size;
+
+	/** Background of the last restore() which failed. */
+	Graphics::Surface _background;
+	bool _hasBackground;
+};
+
+} // End of namespace GUI
+
+#endif
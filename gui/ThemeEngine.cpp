@@ -83,6 +83,9 @@ struct WidgetDrawData {
 	uint16 _backgroundOffset;
 	uint16 _shadowOffset;
 
+	/** Whether the pixels of the widget may be kept in the theme cache, see ThemeCache */
+	bool _cacheable;
+
 	DrawLayer _layer;
 
 
@@ -458,6 +461,9 @@ void ThemeEngine::setGraphicsMode(GraphicsMode mode) {
 	_vectorRenderer = Graphics::createRenderer(mode);
 	_vectorRenderer->setSurface(&_screen);
 
+	// The widgets may look different with the new renderer
+	_widgetCache.clear();
+
 	// Since we reinitialized our screen surfaces we know nothing has been
 	// drawn so far. Sometimes we still end up with dirty screen bits in the
 	// list. Clearing it avoids invalid overlay writes when the backend
@@ -478,6 +484,24 @@ void WidgetDrawData::calcBackgroundOffset() {
 
 	_backgroundOffset = maxBevel;
 	_shadowOffset = maxShadow;
+
+	// Filling the whole surface reaches past the widget, and plain filled
+	// rectangles are drawn faster than they are looked up
+	bool flatFill = true;
+	_cacheable = true;
+	for (Common::List<Graphics::DrawStep>::const_iterator step = _steps.begin();
+	        step != _steps.end(); ++step) {
+		if (step->drawingCall == &Graphics::VectorRenderer::drawCallback_FILLSURFACE)
+			_cacheable = false;
+
+		if (step->drawingCall != &Graphics::VectorRenderer::drawCallback_VOID &&
+		        (step->drawingCall != &Graphics::VectorRenderer::drawCallback_SQUARE ||
+		         step->fillMode == Graphics::VectorRenderer::kFillGradient || step->shadow || step->stroke))
+			flatFill = false;
+	}
+
+	if (flatFill)
+		_cacheable = false;
 }
 
 void ThemeEngine::restoreBackground(Common::Rect r) {
@@ -741,6 +765,7 @@ bool ThemeEngine::addDrawData(const Common::String &data, bool cached) {
 	_widgets[id] = new WidgetDrawData;
 	_widgets[id]->_layer = kDrawDataDefaults[id].layer;
 	_widgets[id]->_textDataId = kTextDataNone;
+	_widgets[id]->_cacheable = false;
 
 	return true;
 }
@@ -751,6 +776,7 @@ bool ThemeEngine::addDrawData(const Common::String &data, bool cached) {
  *********************************************************/
 void ThemeEngine::loadTheme(const Common::String &themeId) {
 	unloadTheme();
+	_widgetCache.clear();
 
 	debug(6, "Loading theme %s", themeId.c_str());
 
@@ -927,6 +953,10 @@ void ThemeEngine::drawDD(DrawData type, const Common::Rect &r, uint32 dynamic, b
 		extendedRect.bottom += drawData->_shadowOffset - drawData->_backgroundOffset;
 	}
 
+	// Only widgets which are drawn whole can be taken from the cache
+	const bool cacheable = drawData->_cacheable && area == r && !_clip.isEmpty() && _clip.contains(extendedRect) &&
+	                       Common::Rect(_screen.w, _screen.h).contains(extendedRect);
+
 	if (!_clip.isEmpty()) {
 		extendedRect.clip(_clip);
 	}
@@ -940,11 +970,36 @@ void ThemeEngine::drawDD(DrawData type, const Common::Rect &r, uint32 dynamic, b
 		restoreBackground(extendedRect);
 
 	if (drawData->_layer == _layerToDraw) {
+		// The steps blend with what is below the widget, which is part of the
+		// lookup along with everything else they depend on
+		ThemeCache::Key key;
+		if (cacheable) {
+			key.type = type;
+			key.dynamic = dynamic;
+			key.width = area.width();
+			key.height = area.height();
+			_vectorRenderer->getColors(key.colors);
+			key.shadows = _vectorRenderer->shadowsEnabled();
+
+			if (_widgetCache.restore(key, _vectorRenderer->getActiveSurface(), extendedRect)) {
+				// Later drawing may rely on the colors set by the steps
+				Common::List<Graphics::DrawStep>::const_iterator step;
+				for (step = drawData->_steps.begin(); step != drawData->_steps.end(); ++step)
+					_vectorRenderer->applyStepState(area, _clip, *step, dynamic);
+
+				addDirtyRect(extendedRect);
+				return;
+			}
+		}
+
 		Common::List<Graphics::DrawStep>::const_iterator step;
 		for (step = drawData->_steps.begin(); step != drawData->_steps.end(); ++step) {
 			_vectorRenderer->drawStep(area, _clip, *step, dynamic);
 		}
 
+		if (cacheable)
+			_widgetCache.store(key, _vectorRenderer->getActiveSurface(), extendedRect);
+
 		addDirtyRect(extendedRect);
 	}
 }
@@ -35,6 +35,7 @@
 #include "graphics/font.h"
 #include "graphics/pixelformat.h"
 
+#include "gui/ThemeCache.h"
 
 #define SCUMMVM_THEME_VERSION_STR "SCUMMVM_STX0.9.15"
 
@@ -806,6 +807,9 @@ protected:
 	/** List of all the dirty screens that must be blitted to the overlay. */
 	Common::List<Common::Rect> _dirtyScreen;
 
+	/** Pixels of the widgets drawn before, see drawDD(). */
+	ThemeCache _widgetCache;
+
 	bool _initOk;  ///< Class and renderer properly initialized
 	bool _themeOk; ///< Theme data successfully loaded.
 	bool _enabled; ///< Whether the Theme is currently shown on the overlay
@@ -25,6 +25,7 @@
 #include "common/file.h"
 #include "common/debug.h"
 #include "common/debug-channels.h"
+#include "common/profiler.h"
 #include "common/system.h"
 
 #ifndef DISABLE_MD5
@@ -81,6 +82,9 @@ Debugger::Debugger() {
 	registerCmd("debugflag_list",		WRAP_METHOD(Debugger, cmdDebugFlagsList));
 	registerCmd("debugflag_enable",	WRAP_METHOD(Debugger, cmdDebugFlagEnable));
 	registerCmd("debugflag_disable",	WRAP_METHOD(Debugger, cmdDebugFlagDisable));
+#ifdef ENABLE_PROFILER
+	registerCmd("profile",			WRAP_METHOD(Debugger, cmdProfile));
+#endif
 }
 
 Debugger::~Debugger() {
@@ -857,6 +861,35 @@ bool Debugger::cmdDebugFlagDisable(int argc, const char **argv) {
 	return true;
 }
 
+#ifdef ENABLE_PROFILER
+bool Debugger::cmdProfile(int argc, const char **argv) {
+	Common::Profiler &profiler = Common::Profiler::instance();
+	if (argc >= 2 && !strcmp(argv[1], "on")) {
+		bool trace = argc >= 3 && !strcmp(argv[2], "trace");
+		profiler.setEnabled(true, trace);
+		debugPrintf("Profiling enabled%s\n", trace ? ", with trace" : "");
+	} else if (argc >= 2 && !strcmp(argv[1], "off")) {
+		profiler.setEnabled(false);
+		debugPrintf("Profiling disabled\n");
+	} else if (argc >= 2 && !strcmp(argv[1], "reset")) {
+		profiler.reset();
+		debugPrintf("Profiling statistics cleared\n");
+	} else if (argc >= 2 && !strcmp(argv[1], "stats")) {
+		debugPrintf("%s", profiler.getStatistics().c_str());
+	} else if (argc >= 3 && !strcmp(argv[1], "dump")) {
+		if (profiler.writeTrace(Common::Path(argv[2], Common::Path::kNativeSeparator)))
+			debugPrintf("Profile written to '%s'\n", argv[2]);
+		else
+			debugPrintf("Failed to write the profile to '%s'\n", argv[2]);
+	} else {
+		debugPrintf("Profiling is currently %s\n", Common::Profiler::isEnabled() ? "enabled" : "disabled");
+		debugPrintf("Usage: %s on [trace] | off | reset | stats | dump <file>\n", argv[0]);
+		debugPrintf("The dump uses the Chrome trace event format\n");
+	}
+	return true;
+}
+#endif
+
 // Console handler
 #ifndef USE_TEXT_CONSOLE_FOR_DEBUGGER
 bool Debugger::debuggerInputCallback(GUI::ConsoleDialog *console, const char *input, void *refCon) {
@@ -58,6 +58,7 @@ enum {
 
 MassAddDialog::MassAddDialog(const Common::FSNode &startDir)
 	: Dialog("MassAdd"),
+	_startDir(startDir.getPath()),
 	_dirsScanned(0),
 	_oldGamesCount(0),
 	_dirTotal(0),
@@ -107,6 +108,13 @@ MassAddDialog::MassAddDialog(const Common::FSNode &startDir)
 			_pathToTargets[path].push_back(iter->_key);
 		}
 	}
+
+	// Write the detection cache once, when the dialog is closed
+	ADCacheMan.beginBatch();
+}
+
+MassAddDialog::~MassAddDialog() {
+	ADCacheMan.endBatch();
 }
 
 struct GameTargetLess {
@@ -250,6 +258,10 @@ void MassAddDialog::handleTickle() {
 	Common::U32String buf;
 
 	if (_scanStack.empty()) {
+		// Every file below the start directory has been seen, cache entries
+		// of other files there are stale
+		ADCacheMan.prunePersistentCache(_startDir);
+
 		// Enable the OK button
 		_okButton->setEnabled(true);
 
@@ -36,6 +36,7 @@ class StaticTextWidget;
 class MassAddDialog : public Dialog {
 public:
 	MassAddDialog(const Common::FSNode &startDir);
+	~MassAddDialog() override;
 
 	//void open();
 	void handleCommand(CommandSender *sender, uint32 cmd, uint32 data) override;
@@ -49,6 +50,7 @@ public:
 
 private:
 	Common::Stack<Common::FSNode>  _scanStack;
+	Common::Path _startDir;
 	DetectedGames _games;
 
 	/**
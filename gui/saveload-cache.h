@@ -0,0 +1,204 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef GUI_SAVELOAD_CACHE_H
+#define GUI_SAVELOAD_CACHE_H
+
+#include "common/scummsys.h"
+#include "common/hash-str.h"
+#include "common/hashmap.h"
+#include "common/list.h"
+#include "common/stream.h"
+#include "common/str.h"
+
+namespace GUI {
+
+/**
+ * Compute the stamp of a save file. SaveFileManager does not provide
+ * modification times, so the stamp is a hash of the size and of both ends
+ * of the file, which is where the headers of the save formats live.
+ *
+ * @return the stamp, which is never 0.
+ */
+inline uint32 computeSaveStamp(Common::SeekableReadStream &file) {
+	enum {
+		kStampBytes = 256
+	};
+
+	byte data[kStampBytes * 2];
+	const int64 size = file.size();
+	file.seek(0);
+	uint32 length = file.read(data, MIN<int64>(size, kStampBytes));
+	if (size > kStampBytes && file.seek(MAX<int64>(size - kStampBytes, kStampBytes)))
+		length += file.read(data + length, size - file.pos());
+
+	// FNV-1a over the size and both ends of the file
+	uint32 hash = 2166136261u;
+	for (int i = 0; i < 8; i++)
+		hash = (hash ^ (byte)((uint64)size >> (i * 8))) * 16777619u;
+	for (uint32 i = 0; i < length; i++)
+		hash = (hash ^ data[i]) * 16777619u;
+
+	// 0 means that there is no stamp
+	return hash ? hash : 1;
+}
+
+/**
+ * Values read from save files, keyed by target and slot, together with the
+ * stamp of the file they were read from. When the values go over the byte
+ * budget, the least recently used ones are dropped.
+ */
+template<class T>
+class SaveMetaCache {
+public:
+	SaveMetaCache(uint32 maxSize) : _maxSize(maxSize), _size(0) {}
+
+	/**
+	 * Get the value of a key and mark it as the most recently used one.
+	 *
+	 * @return nullptr if the key is not known. The value stays valid until
+	 *         the next call of a non-const method.
+	 */
+	const T *find(const Common::String &key) {
+		typename EntryMap::iterator i = _index.find(key);
+		if (i == _index.end())
+			return nullptr;
+
+		touch(i->_value);
+		return &i->_value.value;
+	}
+
+	/** Whether the key is not known, or its value was not checked since the last invalidate(). */
+	bool needsCheck(const Common::String &key) const {
+		typename EntryMap::const_iterator i = _index.find(key);
+		return i == _index.end() || !i->_value.checked;
+	}
+
+	/** Get the stamp the value of a key was read with, 0 if the key is not known. */
+	uint32 getStamp(const Common::String &key) const {
+		typename EntryMap::const_iterator i = _index.find(key);
+		return i == _index.end() ? 0 : i->_value.stamp;
+	}
+
+	/**
+	 * Compare the stamp of the file of a key with the one its value was read
+	 * with. Files without a stamp never match.
+	 *
+	 * @return true if the value is still current, which marks it as checked.
+	 */
+	bool check(const Common::String &key, uint32 stamp) {
+		typename EntryMap::iterator i = _index.find(key);
+		if (i == _index.end() || !stamp || i->_value.stamp != stamp)
+			return false;
+
+		i->_value.checked = true;
+		return true;
+	}
+
+	/**
+	 * Keep the value of a key, read from a file with the given stamp, and
+	 * account `size` bytes for it. The value is kept even if it does not fit
+	 * on its own.
+	 */
+	void store(const Common::String &key, const T &value, uint32 stamp, uint32 size) {
+		remove(key);
+
+		_order.push_front(key);
+		Entry &entry = _index[key];
+		entry.value = value;
+		entry.stamp = stamp;
+		entry.size = size;
+		entry.checked = true;
+		entry.order = _order.begin();
+		_size += size;
+
+		evict(_maxSize > size ? _maxSize : size);
+	}
+
+	/** Have every value checked against its file again. */
+	void invalidate() {
+		for (typename EntryMap::iterator i = _index.begin(); i != _index.end(); ++i)
+			i->_value.checked = false;
+	}
+
+	void remove(const Common::String &key) {
+		typename EntryMap::iterator i = _index.find(key);
+		if (i == _index.end())
+			return;
+
+		_size -= i->_value.size;
+		_order.erase(i->_value.order);
+		_index.erase(i);
+	}
+
+	void clear() {
+		_index.clear();
+		_order.clear();
+		_size = 0;
+	}
+
+	uint32 getMaxSize() const { return _maxSize; }
+	uint32 getSize() const { return _size; }
+	uint getCount() const { return _index.size(); }
+
+private:
+	typedef Common::List<Common::String> KeyList;
+
+	struct Entry {
+		Entry() : stamp(0), size(0), checked(false) {}
+
+		T value;
+		uint32 stamp;     /*!< Stamp of the file the value was read from, 0 if unknown */
+		uint32 size;      /*!< Bytes accounted for the entry */
+		bool checked;     /*!< Stamp compared with the file since the last invalidate() */
+		KeyList::iterator order;
+	};
+
+	typedef Common::HashMap<Common::String, Entry> EntryMap;
+
+	void touch(Entry &entry) {
+		if (entry.order == _order.begin())
+			return;
+
+		_order.push_front(*entry.order);
+		_order.erase(entry.order);
+		entry.order = _order.begin();
+	}
+
+	/** Drop the least recently used values until the cache fits in `maxSize` bytes. */
+	void evict(uint32 maxSize) {
+		while (_size > maxSize && !_order.empty()) {
+			const Common::String key = _order.back();
+			remove(key);
+		}
+	}
+
+	EntryMap _index;
+	/** Keys from the most to the least recently used one. */
+	KeyList _order;
+	uint32 _maxSize;
+	uint32 _size;
+};
+
+} // End of namespace GUI
+
+#endif
@@ -214,9 +214,13 @@ void SaveLoadChooserDialog::open() {
 	setResult(-1);
 
 	_dialogWasShown = false;
+
+	// The saves may have changed since the dialog was shown last
+	_thumbnails.invalidate();
 }
 
 void SaveLoadChooserDialog::close() {
+	_thumbnails.stop();
 	Dialog::close();
 }
 
@@ -228,6 +232,7 @@ int SaveLoadChooserDialog::run(const Common::String &target, const MetaEngine *m
 	_thumbnailSupport = _metaInfoSupport && _metaEngine->hasFeature(MetaEngine::kSavesSupportThumbnail);
 	_saveDateSupport = _metaInfoSupport && _metaEngine->hasFeature(MetaEngine::kSavesSupportCreationDate);
 	_playTimeSupport = _metaInfoSupport && _metaEngine->hasFeature(MetaEngine::kSavesSupportPlayTime);
+	_thumbnails.setTarget(_metaEngine, _target);
 
 	return runIntern();
 }
@@ -321,6 +326,7 @@ void SaveLoadChooserDialog::updateSaveList() {
 	Common::Array<Common::String> files = CloudMan.getSyncingFiles(); //returns empty array if not syncing
 	g_system->getSavefileManager()->updateSavefilesList(files);
 #endif
+	_thumbnails.invalidate();
 	listSaves();
 }
 
@@ -526,6 +532,7 @@ void SaveLoadChooserSimple::handleCommand(CommandSender *sender, uint32 cmd, uin
 								_("Delete"), _("Cancel"));
 			if (alert.runModal() == kMessageOK) {
 				_metaEngine->removeSaveState(_target.c_str(), _saveList[selItem].getSaveSlot());
+				_thumbnails.remove(_saveList[selItem].getSaveSlot());
 
 				setResult(-1);
 				int scrollPos = _list->getCurrentScrollPos();
@@ -632,7 +639,7 @@ void SaveLoadChooserSimple::updateSelection(bool redraw) {
 	_playtime->setLabel(_("No playtime saved"));
 
 	if (selItem >= 0 && _metaInfoSupport) {
-		SaveStateDescriptor desc = (_saveList[selItem].getLocked() ? _saveList[selItem] : _metaEngine->querySaveMetaInfos(_target.c_str(), _saveList[selItem].getSaveSlot()));
+		SaveStateDescriptor desc = (_saveList[selItem].getLocked() ? _saveList[selItem] : _thumbnails.load(_saveList[selItem].getSaveSlot()));
 		if (!_saveList[selItem].getLocked() && desc.getSaveSlot() >= 0 && !desc.getDescription().empty())
 			_saveList[selItem] = desc;
 
@@ -897,6 +904,16 @@ void SaveLoadChooserGrid::handleMouseWheel(int x, int y, int direction) {
 	}
 }
 
+void SaveLoadChooserGrid::handleTickle() {
+	// Show the thumbnails as they come in
+	if (_thumbnails.update()) {
+		updateSaves();
+		g_gui.scheduleTopDialogRedraw();
+	}
+
+	SaveLoadChooserDialog::handleTickle();
+}
+
 void SaveLoadChooserGrid::updateSaveList() {
 	SaveLoadChooserDialog::updateSaveList();
 	updateSaves();
@@ -1145,13 +1162,19 @@ void SaveLoadChooserGrid::hideButtons() {
 void SaveLoadChooserGrid::updateSaves() {
 	hideButtons();
 
+	// Saves of other pages are not needed anymore
+	_thumbnails.cancel();
+
 	bool isWriteProtected = false;
 
 	for (uint i = _curPage * _entriesPerPage, curNum = 0; i < _saveList.size() && curNum < _entriesPerPage; ++i, ++curNum) {
 		const uint saveSlot = _saveList[i].getSaveSlot();
 
-		SaveStateDescriptor desc =  (_saveList[i].getLocked() ? _saveList[i] : _metaEngine->querySaveMetaInfos(_target.c_str(), saveSlot));
-		if (!_saveList[i].getLocked() && desc.getSaveSlot() >= 0 && !desc.getDescription().empty())
+		// Until the meta infos are loaded, the slot is shown with what the
+		// save list knows and an empty thumbnail
+		const SaveStateDescriptor *loaded = _saveList[i].getLocked() ? nullptr : _thumbnails.request(saveSlot);
+		SaveStateDescriptor desc = loaded ? *loaded : _saveList[i];
+		if (loaded && desc.getSaveSlot() >= 0 && !desc.getDescription().empty())
 			_saveList[i] = desc;
 		SlotButton &curButton = _buttons[curNum];
 		curButton.setVisible(true);
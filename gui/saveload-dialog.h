@@ -23,6 +23,7 @@
 #define GUI_SAVELOAD_DIALOG_H
 
 #include "gui/dialog.h"
+#include "gui/saveload-thumbnails.h"
 #include "gui/widgets/list.h"
 
 #include "engines/metaengine.h"
@@ -126,6 +127,9 @@ protected:
 	SaveStateList				_saveList;
 	Common::U32String			_resultString;
 
+	/** Meta infos of the saves, loaded in the background. */
+	SaveThumbnailLoader			_thumbnails;
+
 #ifndef DISABLE_SAVELOADCHOOSER_GRID
 	ButtonWidget *_listButton;
 	ButtonWidget *_gridButton;
@@ -219,6 +223,7 @@ public:
 protected:
 	void handleCommand(CommandSender *sender, uint32 cmd, uint32 data) override;
 	void handleMouseWheel(int x, int y, int direction) override;
+	void handleTickle() override;
 	void updateSaveList() override;
 private:
 	int runIntern() override;
@@ -0,0 +1,228 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "gui/saveload-thumbnails.h"
+
+#include "common/compression/deflate.h"
+#include "common/ptr.h"
+#include "common/savefile.h"
+#include "common/system.h"
+
+#include "engines/metaengine.h"
+
+#include "graphics/surface.h"
+
+namespace GUI {
+
+enum {
+	/** Bytes accounted for an entry, besides its thumbnail. */
+	kEntryOverhead = 256
+};
+
+SaveThumbnailLoader::SaveThumbnailLoader(uint32 maxSize)
+	: _metaEngine(nullptr), _cache(maxSize) {
+}
+
+SaveThumbnailLoader::~SaveThumbnailLoader() {
+	stop();
+}
+
+void SaveThumbnailLoader::setTarget(const MetaEngine *metaEngine, const Common::String &target) {
+	// The save being decoded is finished with the engine it was read for
+	if (metaEngine != _metaEngine || target != _target)
+		stop();
+
+	_metaEngine = metaEngine;
+	_target = target;
+}
+
+Common::String SaveThumbnailLoader::getKey(int slot) const {
+	return Common::String::format("%s:%d", _target.c_str(), slot);
+}
+
+const SaveStateDescriptor *SaveThumbnailLoader::request(int slot) {
+	if (!_metaEngine)
+		return nullptr;
+
+	const Common::String key = getKey(slot);
+	if (_cache.needsCheck(key) && key != _runningKey) {
+		bool queued = false;
+		for (uint j = 0; j < _queue.size() && !queued; j++)
+			queued = _queue[j] == slot;
+		if (!queued)
+			_queue.push_back(slot);
+	}
+
+	return _cache.find(key);
+}
+
+const SaveStateDescriptor &SaveThumbnailLoader::load(int slot) {
+	const Common::String key = getKey(slot);
+	if (key == _runningKey) {
+		_job.wait();
+		finish();
+	}
+
+	if (_cache.needsCheck(key))
+		loadSave(slot, false);
+
+	for (uint j = 0; j < _queue.size(); j++) {
+		if (_queue[j] == slot) {
+			_queue.remove_at(j);
+			break;
+		}
+	}
+
+	return *_cache.find(key);
+}
+
+void SaveThumbnailLoader::cancel() {
+	_queue.clear();
+}
+
+void SaveThumbnailLoader::stop() {
+	cancel();
+	if (!_runningKey.empty()) {
+		_job.wait();
+		finish();
+	}
+}
+
+void SaveThumbnailLoader::invalidate() {
+	_cache.invalidate();
+}
+
+void SaveThumbnailLoader::remove(int slot) {
+	const Common::String key = getKey(slot);
+	if (key == _runningKey) {
+		_job.wait();
+		finish();
+	}
+
+	_cache.remove(key);
+}
+
+void SaveThumbnailLoader::clear() {
+	stop();
+	_cache.clear();
+}
+
+bool SaveThumbnailLoader::update() {
+	bool changed = false;
+	if (!_runningKey.empty() && _job.isReady())
+		changed = finish();
+
+	if (_runningKey.empty() && !_queue.empty())
+		changed |= loadSave(_queue.remove_at(0), true);
+
+	return changed;
+}
+
+bool SaveThumbnailLoader::loadSave(int slot, bool inBackground) {
+	const Common::String key = getKey(slot);
+	Common::InSaveFile *file = g_system->getSavefileManager()->openRawFile(_metaEngine->getSavegameFile(slot, _target.c_str()));
+
+	if (file && inBackground && _metaEngine->hasFeature(MetaEngine::kSavesSupportBackgroundLoading)) {
+		// The job owns the file, and does all the reading
+		const uint32 knownStamp = _cache.getStamp(key);
+		_runningKey = key;
+		_job.start(g_system->getJobManager(), [=]() {
+			return decodeSave(file, slot, knownStamp);
+		});
+		return false;
+	}
+
+	// Saves which cannot be stamped are loaded every time
+	const uint32 stamp = file ? computeSaveStamp(*file) : 0;
+	delete file;
+	if (_cache.check(key, stamp))
+		return false;
+
+	store(key, querySave(slot), stamp);
+	return true;
+}
+
+SaveStateDescriptor SaveThumbnailLoader::querySave(int slot) const {
+	SaveStateDescriptor desc = _metaEngine->querySaveMetaInfos(_target.c_str(), slot);
+
+	// Entries may outlive the engine plugin, which the deleter of the
+	// thumbnail belongs to
+	const Graphics::Surface *thumbnail = desc.getThumbnail();
+	if (thumbnail) {
+		Graphics::Surface *copy = new Graphics::Surface();
+		copy->copyFrom(*thumbnail);
+		desc.setThumbnail(copy);
+	}
+
+	return desc;
+}
+
+SaveThumbnailLoader::DecodedHeader SaveThumbnailLoader::decodeSave(Common::SeekableReadStream *file, int slot, uint32 knownStamp) {
+	DecodedHeader result;
+	result.slot = slot;
+	result.stamp = computeSaveStamp(*file);
+	if (result.stamp == knownStamp) {
+		delete file;
+		result.unchanged = true;
+		return result;
+	}
+
+	// The same as MetaEngine::querySaveMetaInfos(), which goes through
+	// openForLoading()
+	file->seek(0);
+	Common::ScopedPtr<Common::SeekableReadStream> in(Common::wrapCompressedReadStream(file));
+	result.valid = in && MetaEngine::readSavegameHeader(in.get(), &result.header, false);
+	return result;
+}
+
+bool SaveThumbnailLoader::finish() {
+	DecodedHeader &result = _job.get();
+	if (result.unchanged) {
+		_cache.check(_runningKey, result.stamp);
+		_runningKey.clear();
+		result = DecodedHeader();
+		return false;
+	}
+
+	SaveStateDescriptor desc;
+	if (result.valid) {
+		desc = SaveStateDescriptor(_metaEngine, result.slot, Common::U32String());
+		MetaEngine::parseSavegameHeader(&result.header, &desc);
+		desc.setThumbnail(result.header.thumbnail);
+		desc.setAutosave(result.header.isAutosave);
+	} else if (result.header.thumbnail) {
+		result.header.thumbnail->free();
+		delete result.header.thumbnail;
+	}
+
+	store(_runningKey, desc, result.stamp);
+	_runningKey.clear();
+	result = DecodedHeader();
+	return true;
+}
+
+void SaveThumbnailLoader::store(const Common::String &key, const SaveStateDescriptor &desc, uint32 stamp) {
+	const Graphics::Surface *thumbnail = desc.getThumbnail();
+	_cache.store(key, desc, stamp, kEntryOverhead + (thumbnail ? thumbnail->pitch * thumbnail->h : 0));
+}
+
+} // End of namespace GUI
@@ -0,0 +1,159 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef GUI_SAVELOAD_THUMBNAILS_H
+#define GUI_SAVELOAD_THUMBNAILS_H
+
+#include "common/scummsys.h"
+#include "common/array.h"
+#include "common/jobs.h"
+#include "common/str.h"
+
+#include "engines/metaengine.h"
+#include "engines/savestate.h"
+
+#include "gui/saveload-cache.h"
+
+namespace GUI {
+
+/**
+ * Loads the meta infos of saved games, thumbnails included, and keeps them
+ * for the save/load choosers.
+ *
+ * Entries are kept in a SaveMetaCache with the stamp of their save file.
+ * Entries kept from an earlier listing are returned right away and checked
+ * against their file in update().
+ *
+ * The save manager and ConfMan are not thread-safe, so save files are only
+ * opened on the GUI thread. For engines supporting background loading, the
+ * open file is handed to the worker threads of the job manager, which stamp
+ * it, and decode its header and thumbnail if the stamp changed. The other
+ * engines only know their format in querySaveMetaInfos(), which is called
+ * on the GUI thread.
+ *
+ * Only one save is loaded at a time, and the next one is started from
+ * update(), so that the queue can be dropped when the user moves to
+ * another page. Without worker threads the job manager decodes the save in
+ * update() itself, which still spreads the work over several frames.
+ */
+class SaveThumbnailLoader {
+public:
+	enum {
+		/** Bytes of thumbnails kept for all targets. */
+		kDefaultMaxSize = 4 * 1024 * 1024
+	};
+
+	SaveThumbnailLoader(uint32 maxSize = kDefaultMaxSize);
+	~SaveThumbnailLoader();
+
+	/** Set the game whose saves are requested next. */
+	void setTarget(const MetaEngine *metaEngine, const Common::String &target);
+
+	/**
+	 * Get the meta infos of a slot of the current target, and queue loading
+	 * them if they are not known or need to be checked again.
+	 *
+	 * @return nullptr while the slot is being loaded. The descriptor stays
+	 *         valid until the next call of a non-const method.
+	 */
+	const SaveStateDescriptor *request(int slot);
+
+	/**
+	 * Get the meta infos of a slot of the current target, loading or
+	 * checking them on the calling thread if needed.
+	 */
+	const SaveStateDescriptor &load(int slot);
+
+	/**
+	 * Drop the queued requests, e.g. when the user leaves a page. The save
+	 * being decoded is still finished and kept.
+	 */
+	void cancel();
+
+	/** Cancel the queued requests and wait for the save being decoded. */
+	void stop();
+
+	/** Have every entry checked against its save file again. */
+	void invalidate();
+
+	/** Forget a slot of the current target, e.g. after deleting it. */
+	void remove(int slot);
+
+	/** Forget everything. */
+	void clear();
+
+	/**
+	 * Collect the save decoded in the background and start loading the next
+	 * one. Called from the tickle handler of the dialog.
+	 *
+	 * @return true if the meta infos of a slot changed.
+	 */
+	bool update();
+
+	uint32 getSize() const { return _cache.getSize(); }
+
+private:
+	/** Header of a save in the extended format, decoded by a job. */
+	struct DecodedHeader {
+		DecodedHeader() : slot(-1), stamp(0), unchanged(false), valid(false) {}
+
+		int slot;
+		uint32 stamp;
+		bool unchanged; /*!< The stamp matched, the header was not decoded */
+		bool valid;
+		ExtendedSavegameHeader header;
+	};
+
+	Common::String getKey(int slot) const;
+
+	/**
+	 * Check a slot against its save file, and load it again if it changed.
+	 * The file is checked and decoded by a job if `inBackground` is set and
+	 * the engine supports background loading.
+	 *
+	 * @return true if the meta infos of the slot changed.
+	 */
+	bool loadSave(int slot, bool inBackground);
+	SaveStateDescriptor querySave(int slot) const;
+	static DecodedHeader decodeSave(Common::SeekableReadStream *file, int slot, uint32 knownStamp);
+
+	bool finish();
+	void store(const Common::String &key, const SaveStateDescriptor &desc, uint32 stamp);
+
+	const MetaEngine *_metaEngine;
+	Common::String _target;
+
+	SaveMetaCache<SaveStateDescriptor> _cache;
+
+	/** Slots of the current target waiting to be loaded. */
+	Common::Array<int> _queue;
+	/**
+	 * Key of the save being decoded. Jobs do not get any string shared with
+	 * the GUI thread, since the reference counts are not atomic.
+	 */
+	Common::String _runningKey;
+	Common::Future<DecodedHeader> _job;
+};
+
+} // End of namespace GUI
+
+#endif
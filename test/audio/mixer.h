@@ -0,0 +1,221 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/mixer_intern.h"
+#include "audio/audiostream.h"
+#include "common/jobs.h"
+
+#include "helper.h"
+#include "../null_osystem.h"
+
+#if defined(HAS_PTHREADS)
+#include "backends/jobs/pthread/pthread-jobs.h"
+#endif
+
+// The mixer needs OSystem for its mutexes and timestamps
+#if NULL_OSYSTEM_IS_AVAILABLE
+
+struct MixerProducer {
+	Audio::Mixer *mixer;
+	int played;
+	int failures;
+};
+
+class MixerTestSuite : public CxxTest::TestSuite
+{
+private:
+	static Audio::SoundHandle play(Audio::Mixer &mixer, int id = -1, bool loop = false) {
+		Audio::SoundHandle handle;
+		Audio::SeekableAudioStream *sine = createSineStream<int16>(22050, 1, nullptr, false, false);
+		Audio::AudioStream *stream = loop ? Audio::makeLoopingAudioStream(sine, 0) : sine;
+		mixer.playStream(Audio::Mixer::kSFXSoundType, &handle, stream, id);
+		return handle;
+	}
+
+	static bool isSilent(const int16 *buffer, int count) {
+		for (int i = 0; i < count; i++) {
+			if (buffer[i])
+				return false;
+		}
+		return true;
+	}
+
+	/** Play, change and stop sounds, counting what did not stick. */
+	static void producerJob(void *data) {
+		MixerProducer *producer = (MixerProducer *)data;
+		Audio::Mixer &mixer = *producer->mixer;
+
+		for (int i = 0; i < 100; i++) {
+			// Looping, so that the sound does not end while this thread is
+			// preempted and the callback keeps mixing
+			Audio::SoundHandle handle = play(mixer, -1, true);
+
+			// Slots of stopped sounds are only reused once the mixer ran
+			if (!mixer.isSoundHandleActive(handle))
+				continue;
+
+			producer->played++;
+			mixer.setChannelVolume(handle, i);
+			mixer.setChannelBalance(handle, -i);
+			mixer.pauseHandle(handle, true);
+			mixer.pauseHandle(handle, false);
+			if (mixer.getChannelVolume(handle) != i || mixer.getChannelBalance(handle) != -i)
+				producer->failures++;
+
+			mixer.stopHandle(handle);
+			if (mixer.isSoundHandleActive(handle))
+				producer->failures++;
+		}
+	}
+
+public:
+	void setUp() {
+		if (!g_system)
+			Common::install_null_g_system();
+	}
+
+	void test_queued_changes_are_visible() {
+		Audio::MixerImpl mixer(44100);
+		mixer.setReady(true);
+
+		Audio::SoundHandle handle = play(mixer, 5);
+		TS_ASSERT(mixer.isSoundHandleActive(handle));
+		TS_ASSERT(mixer.isSoundIDActive(5));
+		TS_ASSERT_EQUALS(mixer.getSoundID(handle), 5);
+		TS_ASSERT(mixer.hasActiveChannelOfType(Audio::Mixer::kSFXSoundType));
+		TS_ASSERT(!mixer.hasActiveChannelOfType(Audio::Mixer::kMusicSoundType));
+		TS_ASSERT_EQUALS(mixer.getChannelRate(handle), 22050u);
+
+		mixer.setChannelVolume(handle, 100);
+		mixer.setChannelBalance(handle, -20);
+		mixer.setChannelRate(handle, 11025);
+		TS_ASSERT_EQUALS(mixer.getChannelVolume(handle), 100);
+		TS_ASSERT_EQUALS(mixer.getChannelBalance(handle), -20);
+		TS_ASSERT_EQUALS(mixer.getChannelRate(handle), 11025u);
+
+		mixer.resetChannelRate(handle);
+		TS_ASSERT_EQUALS(mixer.getChannelRate(handle), 22050u);
+
+		// A second sound with the same id is refused
+		Audio::SoundHandle duplicate = play(mixer, 5);
+		TS_ASSERT(!mixer.isSoundHandleActive(duplicate));
+
+		mixer.stopHandle(handle);
+		TS_ASSERT(!mixer.isSoundHandleActive(handle));
+		TS_ASSERT(!mixer.isSoundIDActive(5));
+		TS_ASSERT_EQUALS(mixer.getChannelVolume(handle), 0);
+	}
+
+	void test_finished_sounds_are_released() {
+		Audio::MixerImpl mixer(22050);
+		mixer.setReady(true);
+
+		Audio::SoundHandle handle = play(mixer);
+		TS_ASSERT(mixer.isSoundHandleActive(handle));
+
+		// One second of samples, plus one more callback to reap the channel
+		int16 buffer[2 * 1024];
+		for (int i = 0; i < 23 && mixer.isSoundHandleActive(handle); i++)
+			mixer.mixCallback((byte *)buffer, sizeof(buffer));
+
+		TS_ASSERT(!mixer.isSoundHandleActive(handle));
+	}
+
+	void test_many_queued_commands() {
+		Audio::MixerImpl mixer(44100);
+		mixer.setReady(true);
+
+		// More commands than the queue holds must not be lost
+		Audio::SoundHandle handle = play(mixer);
+		for (int i = 0; i < 1000; i++)
+			mixer.setChannelVolume(handle, i & 0xFF);
+		TS_ASSERT_EQUALS(mixer.getChannelVolume(handle), 999 & 0xFF);
+
+		mixer.stopAll();
+		TS_ASSERT(!mixer.isSoundHandleActive(handle));
+	}
+
+	void test_stale_handle_after_slot_reuse() {
+		Audio::MixerImpl mixer(44100);
+		mixer.setReady(true);
+
+		Audio::SoundHandle first = play(mixer);
+		mixer.stopHandle(first);
+
+		// The mixer releases the slot, which is the first free one again
+		int16 buffer[2 * 256];
+		mixer.mixCallback((byte *)buffer, sizeof(buffer));
+		Audio::SoundHandle second = play(mixer);
+		TS_ASSERT(mixer.isSoundHandleActive(second));
+
+		// Changes made through the old handle do not reach the new sound
+		mixer.setChannelVolume(first, 7);
+		mixer.setChannelRate(first, 11025);
+		TS_ASSERT_EQUALS(mixer.getChannelVolume(second), Audio::Mixer::kMaxChannelVolume);
+		TS_ASSERT_EQUALS(mixer.getChannelRate(second), 22050u);
+		TS_ASSERT(!mixer.isSoundHandleActive(first));
+	}
+
+	void test_full_queue_keeps_settings() {
+		Audio::MixerImpl mixer(44100);
+		mixer.setReady(true);
+
+		// The last volume is applied even if the queue overflowed
+		Audio::SoundHandle handle = play(mixer);
+		for (int i = 0; i < 1000; i++)
+			mixer.setChannelVolume(handle, (999 - i) & 0xFF);
+
+		int16 buffer[2 * 256];
+		mixer.mixCallback((byte *)buffer, sizeof(buffer));
+		TS_ASSERT(isSilent(buffer, ARRAYSIZE(buffer)));
+
+		for (int i = 0; i < 1000; i++)
+			mixer.setVolumeForSoundType(Audio::Mixer::kSFXSoundType, i & 0xFF);
+		mixer.setChannelVolume(handle, Audio::Mixer::kMaxChannelVolume);
+		mixer.mixCallback((byte *)buffer, sizeof(buffer));
+		TS_ASSERT(!isSilent(buffer, ARRAYSIZE(buffer)));
+	}
+
+#if defined(HAS_PTHREADS)
+	void test_concurrent_producers() {
+		Audio::MixerImpl mixer(22050);
+		mixer.setReady(true);
+
+		Common::JobManager *jobs = createPthreadJobManager(3);
+		MixerProducer producers[3];
+		Common::WaitGroup group;
+		for (int i = 0; i < 3; i++) {
+			producers[i].mixer = &mixer;
+			producers[i].played = producers[i].failures = 0;
+			jobs->submit(producerJob, &producers[i], &group);
+		}
+
+		// The callback keeps running while the producers change the channels
+		int16 buffer[2 * 64];
+		while (!jobs->isDone(group))
+			mixer.mixCallback((byte *)buffer, sizeof(buffer));
+		delete jobs;
+
+		for (int i = 0; i < 3; i++) {
+			TS_ASSERT_LESS_THAN(0, producers[i].played);
+			TS_ASSERT_EQUALS(producers[i].failures, 0);
+		}
+
+		mixer.mixCallback((byte *)buffer, sizeof(buffer));
+		TS_ASSERT(!mixer.hasActiveChannelOfType(Audio::Mixer::kSFXSoundType));
+	}
+#endif
+
+	void test_sound_type_volume() {
+		Audio::MixerImpl mixer(44100);
+		mixer.setReady(true);
+
+		mixer.setVolumeForSoundType(Audio::Mixer::kSpeechSoundType, 1000);
+		TS_ASSERT_EQUALS(mixer.getVolumeForSoundType(Audio::Mixer::kSpeechSoundType), Audio::Mixer::kMaxMixerVolume);
+
+		mixer.muteSoundType(Audio::Mixer::kSpeechSoundType, true);
+		TS_ASSERT(mixer.isSoundTypeMuted(Audio::Mixer::kSpeechSoundType));
+		TS_ASSERT(!mixer.isSoundTypeMuted(Audio::Mixer::kMusicSoundType));
+	}
+};
+
+#endif
@@ -0,0 +1,203 @@
+#include <cxxtest/TestSuite.h>
+#include "test/instrset_detect.h"
+
+#include "audio/audiostream.h"
+#include "audio/mixer.h"
+#include "audio/rate_intern.h"
+
+#include "../null_osystem.h"
+
+/** Noise, returned in reads of at most a given number of samples. */
+class ChunkedNoiseStream : public Audio::AudioStream {
+public:
+	ChunkedNoiseStream(bool stereo, int chunk) : _stereo(stereo), _chunk(chunk), _seed(1), _left(20000) {}
+
+	int readBuffer(int16 *buffer, const int numSamples) override {
+		const int count = MIN(MIN(numSamples, _chunk), _left);
+		for (int i = 0; i < count; i++) {
+			_seed = _seed * 1103515245 + 12345;
+			buffer[i] = (int16)(_seed >> 16);
+		}
+		_left -= count;
+		return count;
+	}
+
+	bool isStereo() const override { return _stereo; }
+	int getRate() const override { return 44100; }
+	bool endOfData() const override { return _left == 0; }
+
+private:
+	bool _stereo;
+	int _chunk;
+	uint32 _seed;
+	int _left;
+};
+
+class RateKernelsTestSuite : public CxxTest::TestSuite
+{
+public:
+	void test_mix_stereo() {
+		const Audio::RateKernels &kernels = Audio::getGenericRateKernels();
+
+		const int16 in[6] = { 1000, -1000, -1, -1, 32767, -32768 };
+		int16 out[6] = { 0, 0, 0, 0, 32000, -32000 };
+		kernels.mixStereo(out, in, 3, Audio::Mixer::kMaxMixerVolume / 2, Audio::Mixer::kMaxMixerVolume);
+
+		// Scaling rounds towards zero, accumulation saturates
+		TS_ASSERT_EQUALS(out[0], 500);
+		TS_ASSERT_EQUALS(out[1], -1000);
+		TS_ASSERT_EQUALS(out[2], 0);
+		TS_ASSERT_EQUALS(out[3], -1);
+		TS_ASSERT_EQUALS(out[4], 32767);
+		TS_ASSERT_EQUALS(out[5], -32768);
+	}
+
+	void test_mix_mono() {
+		const Audio::RateKernels &kernels = Audio::getGenericRateKernels();
+
+		const int16 in[2] = { 1000, -2000 };
+		int16 out[4] = { 0, 0, 0, 0 };
+		kernels.mixMono(out, in, 2, Audio::Mixer::kMaxMixerVolume, Audio::Mixer::kMaxMixerVolume / 4);
+
+		TS_ASSERT_EQUALS(out[0], 1000);
+		TS_ASSERT_EQUALS(out[1], 250);
+		TS_ASSERT_EQUALS(out[2], -2000);
+		TS_ASSERT_EQUALS(out[3], -500);
+	}
+
+	void test_interpolate() {
+		const Audio::RateKernels &kernels = Audio::getGenericRateKernels();
+
+		const int16 pairs[6] = { 0, 1000, -32768, 32767, 100, 200 };
+		const int16 weights[6] = { 32767 - 16384, 16384, 32767, 0, 32767 - 24576, 24576 };
+		int16 out[3];
+		kernels.interpolate(out, pairs, weights, 3);
+
+		TS_ASSERT_EQUALS(out[0], 500);
+		TS_ASSERT_EQUALS(out[1], -32768);
+		TS_ASSERT_EQUALS(out[2], 175);
+	}
+
+	void test_filter() {
+		const Audio::RateKernels &kernels = Audio::getGenericRateKernels();
+
+		const int16 window[Audio::kSincTaps] = { 1, 2, 3, 4000, 5000, 6, 7, 8 };
+		const int16 loud[Audio::kSincTaps] = { 0, 0, 0, 30000, 30000, 0, 0, 0 };
+		const int16 center[Audio::kSincTaps] = { 0, 0, 0, 1 << Audio::kSincCoeffBits, 0, 0, 0, 0 };
+		const int16 half[Audio::kSincTaps] = { 0, 0, 0, 1 << (Audio::kSincCoeffBits - 1), 1 << (Audio::kSincCoeffBits - 1), 0, 0, 0 };
+		const int16 both[Audio::kSincTaps] = { 0, 0, 0, 1 << Audio::kSincCoeffBits, 1 << Audio::kSincCoeffBits, 0, 0, 0 };
+
+		const int16 *windows[3] = { window, window, loud };
+		const int16 *coeffs[3] = { center, half, both };
+		int16 out[3];
+		kernels.filter(out, windows, coeffs, 3);
+
+		TS_ASSERT_EQUALS(out[0], 4000);
+		TS_ASSERT_EQUALS(out[1], 4500);
+		TS_ASSERT_EQUALS(out[2], 32767);
+	}
+
+#if NULL_OSYSTEM_IS_AVAILABLE
+	void test_sinc_read_sizes() {
+		// The kernels are selected through OSystem
+		if (!g_system)
+			Common::install_null_g_system();
+
+		for (int stereo = 0; stereo < 2; stereo++) {
+			int16 expected[2 * 12000], actual[2 * 12000];
+			convertSinc(expected, stereo, 512);
+			convertSinc(actual, stereo, stereo ? 2 : 1);
+			TS_ASSERT_EQUALS(memcmp(expected, actual, sizeof(expected)), 0);
+		}
+
+		// Incomplete stereo frames are dropped
+		int16 out[2 * 12000];
+		TS_ASSERT_LESS_THAN(0, convertSinc(out, true, 3));
+	}
+#endif
+
+	void test_simd_kernels() {
+#ifdef SCUMMVM_NEON
+		checkKernels(Audio::g_rateKernelsNEON);
+#endif
+#ifdef SCUMMVM_SSE2
+		if (instrset_detect() >= 2)
+			checkKernels(Audio::g_rateKernelsSSE2);
+#endif
+#ifdef SCUMMVM_AVX2
+		if (instrset_detect() >= 8)
+			checkKernels(Audio::g_rateKernelsAVX2);
+#endif
+	}
+
+private:
+	uint32 _seed;
+
+	/** Resample the noise to 48 kHz, return the number of frames written. */
+	static int convertSinc(int16 *out, bool stereo, int chunk) {
+		ChunkedNoiseStream stream(stereo, chunk);
+		Audio::RateConverter *converter = Audio::makeRateConverter(44100, 48000, stereo, true, false, Audio::kRateConverterSinc);
+		memset(out, 0, 2 * 12000 * sizeof(int16));
+
+		// Uneven requests, so that chunks end at different positions
+		int produced = 0;
+		for (int request = 1; produced + request <= 12000; request += 97)
+			produced += converter->convert(stream, out + 2 * produced, request, Audio::Mixer::kMaxMixerVolume, Audio::Mixer::kMaxMixerVolume);
+
+		delete converter;
+		return produced;
+	}
+
+	int16 nextSample() {
+		_seed = _seed * 1103515245 + 12345;
+		return (int16)(_seed >> 8);
+	}
+
+	/** Compare vectorized kernels against the generic ones, which must give identical results. */
+	void checkKernels(const Audio::RateKernels &simd) {
+		const Audio::RateKernels &generic = Audio::getGenericRateKernels();
+		enum { kSize = 512 };
+
+		_seed = 1;
+		for (uint iteration = 0; iteration < 100; iteration++) {
+			const uint count = (uint)(uint16)nextSample() % (kSize / 2);
+			const Audio::st_volume_t volL = (uint16)nextSample() % (Audio::Mixer::kMaxMixerVolume + 1);
+			const Audio::st_volume_t volR = (uint16)nextSample() % (Audio::Mixer::kMaxMixerVolume + 1);
+
+			int16 in[kSize], weights[kSize], taps[kSize], expected[kSize], actual[kSize];
+			for (uint i = 0; i < kSize; i++) {
+				in[i] = nextSample();
+				expected[i] = actual[i] = nextSample();
+			}
+
+			generic.mixStereo(expected, in, count, volL, volR);
+			simd.mixStereo(actual, in, count, volL, volR);
+			TS_ASSERT_EQUALS(memcmp(expected, actual, sizeof(expected)), 0);
+
+			generic.mixMono(expected, in, count, volL, volR);
+			simd.mixMono(actual, in, count, volL, volR);
+			TS_ASSERT_EQUALS(memcmp(expected, actual, sizeof(expected)), 0);
+
+			for (uint i = 0; i < kSize; i += 2) {
+				weights[i + 1] = (uint16)nextSample() % 32768;
+				weights[i] = 32767 - weights[i + 1];
+			}
+			generic.interpolate(expected, in, weights, count);
+			simd.interpolate(actual, in, weights, count);
+			TS_ASSERT_EQUALS(memcmp(expected, actual, sizeof(expected)), 0);
+
+			// Keep the taps small enough for the sums to fit into 32 bits
+			for (uint i = 0; i < kSize; i++)
+				taps[i] = nextSample() / 8;
+
+			const int16 *windows[kSize / 2], *coeffs[kSize / 2];
+			for (uint i = 0; i < kSize / 2; i++) {
+				windows[i] = in + (uint16)nextSample() % (kSize - Audio::kSincTaps);
+				coeffs[i] = taps + (uint16)nextSample() % (kSize - Audio::kSincTaps);
+			}
+			generic.filter(expected, windows, coeffs, count);
+			simd.filter(actual, windows, coeffs, count);
+			TS_ASSERT_EQUALS(memcmp(expected, actual, sizeof(expected)), 0);
+		}
+	}
+};
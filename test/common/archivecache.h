@@ -0,0 +1,159 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/archive.h"
+#include "common/stream.h"
+#include "common/system.h"
+#include "../null_osystem.h"
+
+// The cache needs OSystem for its mutex
+#if NULL_OSYSTEM_IS_AVAILABLE
+
+class CountingArchive : public Common::MemcachingCaseInsensitiveArchive {
+public:
+	CountingArchive() : _reads(0) {}
+
+	bool hasFile(const Common::Path &path) const override {
+		return getSize(path) != 0;
+	}
+
+	int listMembers(Common::ArchiveMemberList &list) const override {
+		return 0;
+	}
+
+	const Common::ArchiveMemberPtr getMember(const Common::Path &path) const override {
+		return Common::ArchiveMemberPtr();
+	}
+
+	Common::SharedArchiveContents readContentsForPath(const Common::Path &path) const override {
+		_reads++;
+
+		uint32 size = getSize(path);
+		if (!size)
+			return Common::SharedArchiveContents();
+
+		byte *data = new byte[size];
+		memset(data, path.toString()[0], size);
+		return Common::SharedArchiveContents(data, size);
+	}
+
+	void close() {
+		clearCache();
+	}
+
+	mutable int _reads;
+
+private:
+	static uint32 getSize(const Common::Path &path) {
+		if (path == Common::Path("small"))
+			return 100;
+		if (path == Common::Path("big1") || path == Common::Path("big2"))
+			return 2000;
+		return 0;
+	}
+};
+
+class ArchiveCacheTestSuite : public CxxTest::TestSuite {
+public:
+	void setUp() {
+		if (!g_system)
+			Common::install_null_g_system();
+
+		Common::ArchiveContentsCache &cache = Common::ArchiveContentsCache::instance();
+		cache.flush();
+		cache.resetStats();
+		cache.setBudget(4096);
+	}
+
+	void test_reopen_is_cached() {
+		CountingArchive archive;
+
+		delete archive.createReadStreamForMember("big1");
+		Common::SeekableReadStream *stream = archive.createReadStreamForMember("BIG1");
+		TS_ASSERT(stream);
+		TS_ASSERT_EQUALS(stream->size(), 2000);
+		TS_ASSERT_EQUALS(stream->readByte(), 'b');
+		delete stream;
+		TS_ASSERT_EQUALS(archive._reads, 1);
+
+		Common::ArchiveContentsCache::Stats stats = Common::ArchiveContentsCache::instance().getStats();
+		TS_ASSERT_EQUALS(stats.hits, 1u);
+		TS_ASSERT_EQUALS(stats.misses, 1u);
+		TS_ASSERT_EQUALS(stats.usedBytes, 2000u);
+	}
+
+	void test_missing_member() {
+		CountingArchive archive;
+
+		TS_ASSERT(!archive.createReadStreamForMember("missing"));
+		TS_ASSERT(!archive.createReadStreamForMember("missing"));
+		TS_ASSERT_EQUALS(archive._reads, 1);
+	}
+
+	void test_least_recently_used_is_evicted() {
+		Common::ArchiveContentsCache &cache = Common::ArchiveContentsCache::instance();
+		cache.setBudget(3000);
+		CountingArchive archive;
+
+		delete archive.createReadStreamForMember("big1");
+		delete archive.createReadStreamForMember("big2");
+		TS_ASSERT_EQUALS(archive._reads, 2);
+		TS_ASSERT_EQUALS(cache.getStats().evictions, 1u);
+
+		// big2 is still cached, big1 has to be extracted again
+		delete archive.createReadStreamForMember("big2");
+		TS_ASSERT_EQUALS(archive._reads, 2);
+		delete archive.createReadStreamForMember("big1");
+		TS_ASSERT_EQUALS(archive._reads, 3);
+
+		// Small members are always kept
+		delete archive.createReadStreamForMember("small");
+		cache.flush();
+		delete archive.createReadStreamForMember("small");
+		TS_ASSERT_EQUALS(archive._reads, 4);
+		TS_ASSERT_EQUALS(cache.getStats().usedBytes, 0u);
+	}
+
+	void test_open_streams_survive_eviction() {
+		Common::ArchiveContentsCache &cache = Common::ArchiveContentsCache::instance();
+		CountingArchive archive;
+
+		Common::SeekableReadStream *stream = archive.createReadStreamForMember("big1");
+		cache.flush();
+
+		// Still shared with the open stream
+		Common::SeekableReadStream *second = archive.createReadStreamForMember("big1");
+		TS_ASSERT_EQUALS(archive._reads, 1);
+		TS_ASSERT_EQUALS(cache.getStats().usedBytes, 2000u);
+
+		delete stream;
+		delete second;
+	}
+
+	void test_clear_cache() {
+		Common::ArchiveContentsCache &cache = Common::ArchiveContentsCache::instance();
+		CountingArchive archive;
+
+		delete archive.createReadStreamForMember("big1");
+		delete archive.createReadStreamForMember("small");
+		archive.close();
+		TS_ASSERT_EQUALS(cache.getStats().usedBytes, 0u);
+
+		// Both members have to be extracted again
+		delete archive.createReadStreamForMember("big1");
+		delete archive.createReadStreamForMember("small");
+		TS_ASSERT_EQUALS(archive._reads, 4);
+		TS_ASSERT_EQUALS(cache.getStats().usedBytes, 2000u);
+	}
+
+	void test_archive_destruction_releases_budget() {
+		Common::ArchiveContentsCache &cache = Common::ArchiveContentsCache::instance();
+		{
+			CountingArchive archive;
+			delete archive.createReadStreamForMember("big1");
+			TS_ASSERT_EQUALS(cache.getStats().usedBytes, 2000u);
+		}
+		TS_ASSERT_EQUALS(cache.getStats().usedBytes, 0u);
+	}
+};
+
+#endif
@@ -0,0 +1,110 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/compression/deflate.h"
+#include "common/crc.h"
+#include "common/jobs.h"
+#include "common/memstream.h"
+#include "common/ptr.h"
+
+#if defined(HAS_PTHREADS)
+#include "backends/jobs/pthread/pthread-jobs.h"
+#endif
+
+class DeflateTestSuite : public CxxTest::TestSuite {
+public:
+#if defined(USE_ZLIB)
+	void test_backward_seeks() {
+		// Enough data for several seek points
+		const uint32 size = 3 * 1024 * 1024 + 123;
+		byte *data = createData(size);
+		uint32 compressedSize;
+		byte *compressed = compress(data, size, compressedSize);
+
+		Common::ScopedPtr<Common::SeekableReadStream> stream(Common::wrapCompressedReadStream(
+			new Common::MemoryReadStream(compressed, compressedSize, DisposeAfterUse::NO)));
+		TS_ASSERT(stream);
+		TS_ASSERT_EQUALS(stream->size(), (int64)size);
+
+		// Jump around, going back most of the time
+		const uint32 positions[] = {
+			2000000, 100, 2999999, 1500000, 1499990, 600000, size - 10, 524288, 524287, 0, 1048577, size - 1, 1048575
+		};
+		byte buffer[64];
+		for (uint i = 0; i < ARRAYSIZE(positions); i++) {
+			TS_ASSERT(stream->seek(positions[i]));
+			TS_ASSERT_EQUALS(stream->pos(), (int64)positions[i]);
+			const uint32 length = MIN<uint32>(sizeof(buffer), size - positions[i]);
+			TS_ASSERT_EQUALS(stream->read(buffer, sizeof(buffer)), length);
+			TS_ASSERT(!stream->err());
+			TS_ASSERT_SAME_DATA(buffer, data + positions[i], length);
+		}
+
+		// Reading everything again from the start gives the same data
+		TS_ASSERT(stream->seek(0));
+		byte *copy = new byte[size];
+		TS_ASSERT_EQUALS(stream->read(copy, size), size);
+		TS_ASSERT_SAME_DATA(copy, data, size);
+
+		delete[] copy;
+		free(compressed);
+		delete[] data;
+	}
+
+	void test_inflate_crc() {
+		const uint32 size = 2 * 1024 * 1024 + 7;
+		byte *data = createData(size);
+		uint32 compressedSize;
+		byte *compressed = compress(data, size, compressedSize);
+		const uint32 expected = Common::CRC32().crcFast(data, size);
+
+		Common::JobManager serial;
+		checkInflateCRC(data, size, compressed, compressedSize, expected, nullptr);
+		checkInflateCRC(data, size, compressed, compressedSize, expected, &serial);
+#if defined(HAS_PTHREADS)
+		Common::JobManager *parallel = createPthreadJobManager(3);
+		checkInflateCRC(data, size, compressed, compressedSize, expected, parallel);
+		delete parallel;
+#endif
+
+		free(compressed);
+		delete[] data;
+	}
+#endif
+
+private:
+	/** Generate data which compresses a bit, but not too well. */
+	static byte *createData(uint32 size) {
+		byte *data = new byte[size];
+		uint32 seed = 1;
+		for (uint32 i = 0; i < size; i++) {
+			seed = seed * 1103515245 + 12345;
+			data[i] = (i >= 64 && (seed >> 28) < 10) ? data[i - 1 - ((seed >> 16) & 63)] : (byte)(seed >> 24);
+		}
+		return data;
+	}
+
+	/** Compress in the gzip format, the result needs to be freed with free(). */
+	static byte *compress(const byte *data, uint32 size, uint32 &compressedSize) {
+		Common::MemoryWriteStreamDynamic *output = new Common::MemoryWriteStreamDynamic(DisposeAfterUse::NO);
+		Common::WriteStream *stream = Common::wrapCompressedWriteStream(output);
+		stream->write(data, size);
+		stream->finalize();
+		byte *compressed = output->getData();
+		compressedSize = output->size();
+		delete stream;
+		return compressed;
+	}
+
+	static void checkInflateCRC(const byte *data, uint32 size, const byte *compressed, uint32 compressedSize, uint32 expected, Common::JobManager *jobs) {
+		// The raw deflate data is between the 10 bytes of the gzip header
+		// and the 8 bytes of the gzip footer
+		byte *output = new byte[size];
+		uint outputSize = size;
+		uint32 crc = 0;
+		TS_ASSERT(Common::inflateZlibHeaderlessCRC(output, &outputSize, compressed + 10, compressedSize - 18, &crc, jobs));
+		TS_ASSERT_EQUALS(outputSize, size);
+		TS_ASSERT_EQUALS(crc, expected);
+		TS_ASSERT_SAME_DATA(output, data, size);
+		delete[] output;
+	}
+};
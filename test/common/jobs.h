@@ -0,0 +1,150 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/jobs.h"
+
+#if defined(HAS_PTHREADS)
+#include "backends/jobs/pthread/pthread-jobs.h"
+#endif
+
+static void incrementJob(void *data) {
+	(*(int *)data)++;
+}
+
+class JobsTestSuite : public CxxTest::TestSuite {
+public:
+	void test_inline_submit() {
+		Common::JobManager jobs;
+		TS_ASSERT_EQUALS(jobs.getThreadCount(), 1u);
+
+		int value = 0;
+		Common::WaitGroup group;
+		jobs.submit(incrementJob, &value, &group);
+		TS_ASSERT(jobs.isDone(group));
+		TS_ASSERT_EQUALS(value, 1);
+	}
+
+	void test_inline_parallel_for() {
+		Common::JobManager jobs;
+		checkParallelFor(jobs);
+	}
+
+	void test_inline_current_thread() {
+		Common::JobManager jobs;
+		TS_ASSERT_EQUALS(jobs.getCurrentThread(), 0u);
+	}
+
+	void test_inline_future() {
+		Common::JobManager jobs;
+		checkFuture(jobs);
+	}
+
+#if defined(HAS_PTHREADS)
+	void test_threaded_submit() {
+		Common::JobManager *jobs = createPthreadJobManager(3);
+		TS_ASSERT_EQUALS(jobs->getThreadCount(), 4u);
+
+		int values[200];
+		Common::WaitGroup group;
+		for (int i = 0; i < 200; i++) {
+			values[i] = i;
+			jobs->submit(incrementJob, &values[i], &group);
+		}
+		jobs->wait(group);
+		TS_ASSERT(jobs->isDone(group));
+
+		for (int i = 0; i < 200; i++)
+			TS_ASSERT_EQUALS(values[i], i + 1);
+
+		delete jobs;
+	}
+
+	void test_threaded_parallel_for() {
+		Common::JobManager *jobs = createPthreadJobManager(3);
+		checkParallelFor(*jobs);
+		delete jobs;
+	}
+
+	void test_threaded_nested_parallel_for() {
+		Common::JobManager *jobs = createPthreadJobManager(2);
+
+		uint sums[8];
+		jobs->parallelFor(8, [&](uint begin, uint end) {
+			for (uint i = begin; i < end; i++) {
+				uint partial[4] = { 0, 0, 0, 0 };
+				jobs->parallelFor(4, [&](uint b, uint e) {
+					for (uint j = b; j < e; j++)
+						partial[j] = i * j;
+				});
+				sums[i] = partial[0] + partial[1] + partial[2] + partial[3];
+			}
+		});
+
+		for (uint i = 0; i < 8; i++)
+			TS_ASSERT_EQUALS(sums[i], i * 6);
+
+		delete jobs;
+	}
+
+	void test_threaded_future() {
+		Common::JobManager *jobs = createPthreadJobManager(1);
+		checkFuture(*jobs);
+		delete jobs;
+	}
+
+	void test_threaded_current_thread() {
+		Common::JobManager *jobs = createPthreadJobManager(3);
+		TS_ASSERT_EQUALS(jobs->getCurrentThread(), 0u);
+
+		// Jobs run on the workers, or on the waiting thread
+		uint threads[64];
+		jobs->parallelFor(64, [&](uint begin, uint end) {
+			for (uint i = begin; i < end; i++)
+				threads[i] = jobs->getCurrentThread();
+		});
+		for (uint i = 0; i < 64; i++)
+			TS_ASSERT_LESS_THAN(threads[i], 4u);
+
+		delete jobs;
+	}
+
+	void test_threaded_unwaited_jobs_finish() {
+		int values[16] = { 0 };
+		Common::JobManager *jobs = createPthreadJobManager(2);
+		for (int i = 0; i < 16; i++)
+			jobs->submit(incrementJob, &values[i]);
+		delete jobs;
+
+		for (int i = 0; i < 16; i++)
+			TS_ASSERT_EQUALS(values[i], 1);
+	}
+#endif
+
+private:
+	void checkParallelFor(Common::JobManager &jobs) {
+		byte visited[1000];
+		memset(visited, 0, sizeof(visited));
+
+		jobs.parallelFor(1000, [&](uint begin, uint end) {
+			for (uint i = begin; i < end; i++)
+				visited[i]++;
+		}, 16);
+
+		for (uint i = 0; i < 1000; i++)
+			TS_ASSERT_EQUALS(visited[i], 1);
+
+		// Empty ranges must not call the function at all
+		bool called = false;
+		jobs.parallelFor(0, [&](uint, uint) { called = true; });
+		TS_ASSERT(!called);
+	}
+
+	void checkFuture(Common::JobManager &jobs) {
+		Common::Future<int> future;
+		future.start(&jobs, []() { return 6 * 7; });
+		TS_ASSERT_EQUALS(future.get(), 42);
+		TS_ASSERT(future.isReady());
+
+		future.start(&jobs, []() { return 23; });
+		TS_ASSERT_EQUALS(future.get(), 23);
+	}
+};
@@ -63,6 +63,21 @@ class PathTestSuite : public CxxTest::TestSuite
 		TS_ASSERT(p != Common::Path(TEST_PATH));
 	}
 
+	void test_unshare() {
+		// Long enough not to be stored inside the string
+		Common::Path p("a/path/which/is/long/enough/to/be/allocated.txt");
+		Common::Path copy(p);
+		TS_ASSERT(copy._str.c_str() == p._str.c_str());
+
+		Common::Path unshared = p.unshare();
+		TS_ASSERT_EQUALS(unshared, p);
+		TS_ASSERT(unshared._str.c_str() != p._str.c_str());
+
+		Common::Path escaped("parent\\dir/file", '\\');
+		TS_ASSERT_EQUALS(escaped.unshare(), escaped);
+		TS_ASSERT_EQUALS(Common::Path().unshare(), Common::Path());
+	}
+
 	void test_getLastComponent() {
 		Common::Path p;
 		TS_ASSERT_EQUALS(p.getLastComponent().toString(), "");
@@ -0,0 +1,253 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/archive.h"
+#include "common/atomic.h"
+#include "common/jobs.h"
+#include "common/memstream.h"
+#include "common/system.h"
+
+#include "../null_osystem.h"
+
+#if defined(HAS_PTHREADS)
+#include "backends/jobs/pthread/pthread-jobs.h"
+#endif
+
+class NamedArchive : public Common::Archive {
+public:
+	NamedArchive(const char *files, byte tag) : _tag(tag) {
+		// Space separated file names
+		Common::String name;
+		for (const char *c = files;; c++) {
+			if (*c == ' ' || *c == '\0') {
+				if (!name.empty())
+					_files.push_back(Common::Path(name));
+				name.clear();
+				if (*c == '\0')
+					break;
+			} else {
+				name += *c;
+			}
+		}
+	}
+
+	bool hasFile(const Common::Path &path) const override {
+		_queries.fetchAdd(1);
+		for (uint i = 0; i < _files.size(); i++) {
+			if (_files[i].equalsIgnoreCase(path))
+				return true;
+		}
+		return false;
+	}
+
+	int listMembers(Common::ArchiveMemberList &list) const override {
+		return 0;
+	}
+
+	const Common::ArchiveMemberPtr getMember(const Common::Path &path) const override {
+		return Common::ArchiveMemberPtr();
+	}
+
+	Common::SeekableReadStream *createReadStreamForMember(const Common::Path &path) const override {
+		if (!hasFile(path))
+			return nullptr;
+		return new Common::MemoryReadStream(&_tag, 1);
+	}
+
+	void addFile(const char *name) { _files.push_back(Common::Path(name)); }
+
+	static Common::Atomic<int> _queries;
+
+private:
+	Common::Array<Common::Path> _files;
+	byte _tag;
+};
+
+Common::Atomic<int> NamedArchive::_queries;
+
+/** An archive which opens a file without reporting it in hasFile(). */
+class HiddenFileArchive : public NamedArchive {
+public:
+	HiddenFileArchive(const char *hidden, byte tag) : NamedArchive("", tag), _hidden(hidden), _tag(tag) {}
+
+	Common::SeekableReadStream *createReadStreamForMember(const Common::Path &path) const override {
+		if (!path.equalsIgnoreCase(_hidden))
+			return nullptr;
+		return new Common::MemoryReadStream(&_tag, 1);
+	}
+
+private:
+	Common::Path _hidden;
+	byte _tag;
+};
+
+class SearchSetTestSuite : public CxxTest::TestSuite {
+public:
+	// The index is locked with a mutex, which needs OSystem
+	void setUp() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		if (!g_system)
+			Common::install_null_g_system();
+#endif
+	}
+
+	void test_priorities() {
+		checkPriorities(false);
+#if NULL_OSYSTEM_IS_AVAILABLE
+		checkPriorities(true);
+#endif
+	}
+
+#if NULL_OSYSTEM_IS_AVAILABLE
+
+	void test_index_avoids_queries() {
+		Common::SearchSet set;
+		set.setUseIndex(true);
+		for (int i = 0; i < 10; i++)
+			set.add(Common::String::format("arc%d", i), new NamedArchive(i == 9 ? "last" : "other", i), 0);
+
+		TS_ASSERT(set.hasFile("last"));
+		TS_ASSERT(!set.hasFile("missing"));
+
+		NamedArchive::_queries.store(0);
+		TS_ASSERT(set.hasFile("last"));
+		TS_ASSERT(!set.hasFile("missing"));
+		TS_ASSERT_EQUALS(openTag(set, "last"), 9);
+
+		// Only the archive having the file is asked, once to verify the
+		// hit and once more by its createReadStreamForMember()
+		TS_ASSERT_EQUALS(NamedArchive::_queries.load(), 3);
+	}
+
+	void test_invalidate() {
+		Common::SearchSet set;
+		set.setUseIndex(true);
+		NamedArchive *archive = new NamedArchive("", 1);
+		set.add("arc", archive);
+
+		TS_ASSERT(!set.hasFile("late"));
+		archive->addFile("late");
+		set.invalidateIndex();
+		TS_ASSERT(set.hasFile("late"));
+	}
+
+	void test_index_miss_is_final() {
+		Common::SearchSet set;
+		set.add("named", new NamedArchive("a", 1), 1);
+		set.add("hidden", new HiddenFileArchive("secret", 2), 0);
+
+		// Without the index every archive is asked to open the file...
+		TS_ASSERT(!set.hasFile("secret"));
+		TS_ASSERT_EQUALS(openTag(set, "secret"), 2);
+
+		// ...with it only those reporting it in hasFile()
+		set.setUseIndex(true);
+		TS_ASSERT(!set.hasFile("secret"));
+		NamedArchive::_queries.store(0);
+		TS_ASSERT_EQUALS(openTag(set, "secret"), -1);
+		TS_ASSERT_EQUALS(openTag(set, "secret"), -1);
+		TS_ASSERT_EQUALS(NamedArchive::_queries.load(), 0);
+		TS_ASSERT_EQUALS(openTag(set, "a"), 1);
+	}
+
+	void test_index_nested_set() {
+		Common::SearchSet set;
+		set.setUseIndex(true);
+		Common::SearchSet *inner = new Common::SearchSet();
+		set.add("inner", inner, 1);
+		set.add("named", new NamedArchive("a", 1), 0);
+
+		// Files added to the inner set are found by the outer one
+		TS_ASSERT(!set.hasFile("late"));
+		TS_ASSERT_EQUALS(openTag(set, "a"), 1);
+		inner->add("late", new NamedArchive("late a", 2));
+		TS_ASSERT(set.hasFile("late"));
+		TS_ASSERT_EQUALS(openTag(set, "a"), 2);
+
+		// The index is used again without nested sets
+		set.remove("inner");
+		NamedArchive::_queries.store(0);
+		TS_ASSERT(!set.hasFile("missing"));
+		TS_ASSERT(!set.hasFile("missing"));
+		TS_ASSERT_EQUALS(NamedArchive::_queries.load(), 1);
+	}
+
+#if defined(HAS_PTHREADS)
+	void test_index_threads() {
+		Common::SearchSet set;
+		set.setUseIndex(true);
+		for (int i = 0; i < 8; i++)
+			set.add(Common::String::format("arc%d", i), new NamedArchive(Common::String::format("file%d", i).c_str(), i), 0);
+
+		Common::JobManager *jobs = createPthreadJobManager(4);
+		Common::Atomic<int> errors;
+		jobs->parallelFor(4000, [&](uint begin, uint end) {
+			for (uint i = begin; i < end; i++) {
+				// Hits, and misses with names long enough to be allocated
+				const uint arc = i % 10;
+				const Common::String name(arc < 8 ? Common::String::format("file%u", arc) : Common::String::format("a/long/path/to/a/missing/file%u", i));
+				// Not sharing the string of the name, as the tests do not lock
+				// the pool of reference counts
+				const Common::Path path(name.c_str());
+				if (set.hasFile(path) != (arc < 8))
+					errors.fetchAdd(1);
+			}
+		}, 100);
+		delete jobs;
+
+		TS_ASSERT_EQUALS(errors.load(), 0);
+	}
+#endif
+
+#endif
+
+private:
+	static int openTag(Common::SearchSet &set, const char *name) {
+		Common::SeekableReadStream *stream = set.createReadStreamForMember(name);
+		if (!stream)
+			return -1;
+		int tag = stream->readByte();
+		delete stream;
+		return tag;
+	}
+
+	void checkPriorities(bool useIndex) {
+		Common::SearchSet set;
+		set.setUseIndex(useIndex);
+
+		set.add("low", new NamedArchive("a b", 1), -1);
+		set.add("mid", new NamedArchive("a c", 2), 0);
+		set.add("mid2", new NamedArchive("a c d", 3), 0);
+
+		// Equal priorities are searched in insertion order
+		TS_ASSERT_EQUALS(openTag(set, "a"), 2);
+		TS_ASSERT_EQUALS(openTag(set, "b"), 1);
+		TS_ASSERT_EQUALS(openTag(set, "c"), 2);
+		TS_ASSERT_EQUALS(openTag(set, "d"), 3);
+		TS_ASSERT_EQUALS(openTag(set, "e"), -1);
+		TS_ASSERT(!set.hasFile("e"));
+
+		// A new archive hides files of lower priority ones...
+		set.add("high", new NamedArchive("a e", 4), 1);
+		TS_ASSERT_EQUALS(openTag(set, "a"), 4);
+		TS_ASSERT_EQUALS(openTag(set, "e"), 4);
+		TS_ASSERT(set.hasFile("e"));
+
+		// ...but not files of archives with the same priority
+		set.add("mid3", new NamedArchive("c", 5), 0);
+		TS_ASSERT_EQUALS(openTag(set, "c"), 2);
+
+		set.remove("mid");
+		TS_ASSERT_EQUALS(openTag(set, "c"), 3);
+		TS_ASSERT_EQUALS(openTag(set, "a"), 4);
+
+		set.setPriority("low", 2);
+		TS_ASSERT_EQUALS(openTag(set, "a"), 1);
+		TS_ASSERT_EQUALS(openTag(set, "c"), 3);
+
+		set.setPriority("low", -1);
+		TS_ASSERT_EQUALS(openTag(set, "a"), 4);
+
+		set.clear();
+		TS_ASSERT_EQUALS(openTag(set, "a"), -1);
+	}
+};
@@ -0,0 +1,124 @@
+#include <cxxtest/TestSuite.h>
+#include "test/instrset_detect.h"
+
+#include "common/md5.h"
+#include "common/memstream.h"
+#include "graphics/blit.h"
+#include "graphics/blit/blit-convert.h"
+
+class CrossBlitTestSuite : public CxxTest::TestSuite {
+public:
+	void test_kernels() {
+		checkKernels(&Graphics::getGenericCrossBlitKernels());
+#ifdef SCUMMVM_NEON
+		checkKernels(&Graphics::g_crossBlitKernelsNEON);
+#endif
+#ifdef SCUMMVM_SSE2
+		if (instrset_detect() >= 2)
+			checkKernels(&Graphics::g_crossBlitKernelsSSE2);
+#endif
+#ifdef SCUMMVM_AVX2
+		if (instrset_detect() >= 8)
+			checkKernels(&Graphics::g_crossBlitKernelsAVX2);
+#endif
+		Graphics::setCrossBlitKernels(nullptr);
+	}
+
+private:
+	enum {
+		kWidth = 45,
+		kHeight = 7,
+		kFormats = 7,
+		// Room for converting in place to 4 bytes per pixel
+		kPitch = kWidth * 4 + 12
+	};
+
+	/** Compare the row converters with the per pixel templates. */
+	static void checkKernels(const Graphics::CrossBlitKernels *kernels) {
+		const Graphics::PixelFormat formats[kFormats] = {
+			Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0),
+			Graphics::PixelFormat(2, 5, 5, 5, 0, 10, 5, 0, 0),
+			Graphics::PixelFormat(2, 4, 4, 4, 4, 8, 4, 0, 12),
+			Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0),
+			Graphics::PixelFormat(4, 8, 8, 8, 8, 8, 16, 24, 0),
+			Graphics::PixelFormat(4, 8, 8, 8, 0, 16, 8, 0, 0),
+			Graphics::PixelFormat(3, 8, 8, 8, 0, 16, 8, 0, 0)
+		};
+
+		for (int i = 0; i < kFormats; i++) {
+			for (int j = 0; j < kFormats; j++) {
+				for (int type = 0; type < 4; type++) {
+					Graphics::setCrossBlitKernels(nullptr);
+					Common::String expected = convert(type, formats[j], formats[i]);
+					Graphics::setCrossBlitKernels(kernels);
+					TS_ASSERT_EQUALS(convert(type, formats[j], formats[i]), expected);
+				}
+			}
+		}
+
+		for (uint bytesPerPixel = 1; bytesPerPixel <= 4; bytesPerPixel++) {
+			Graphics::setCrossBlitKernels(nullptr);
+			Common::String expected = map(bytesPerPixel);
+			Graphics::setCrossBlitKernels(kernels);
+			TS_ASSERT_EQUALS(map(bytesPerPixel), expected);
+		}
+	}
+
+	static void fill(byte *buffer, uint size, uint32 seed) {
+		for (uint i = 0; i < size; i++) {
+			seed = seed * 1103515245 + 12345;
+			buffer[i] = seed >> 24;
+		}
+	}
+
+	static Common::String hash(const byte *buffer, uint size) {
+		Common::MemoryReadStream stream(buffer, size);
+		return Common::computeStreamMD5AsString(stream);
+	}
+
+	/**
+	 * Convert generated pixels with crossBlit(), with a key, with a mask, or
+	 * in place, and return the hash of the result.
+	 */
+	static Common::String convert(int type, const Graphics::PixelFormat &dstFmt, const Graphics::PixelFormat &srcFmt) {
+		byte src[kPitch * kHeight], dst[kPitch * kHeight], mask[kWidth * kHeight];
+		fill(src, sizeof(src), 1);
+		fill(dst, sizeof(dst), 2);
+		fill(mask, sizeof(mask), 3);
+
+		// Use a color of the picture as the key
+		uint32 key = srcFmt.bytesPerPixel == 2 ? *(const uint16 *)(src + 6) : *(const uint32 *)(src + 8);
+		if (srcFmt.bytesPerPixel == 3)
+			key &= 0xFFFFFF;
+		for (int y = 0; y < kHeight; y++)
+			memcpy(src + y * kPitch + (y + 3) * srcFmt.bytesPerPixel, &key, srcFmt.bytesPerPixel);
+
+		bool result;
+		switch (type) {
+		case 0:
+			result = Graphics::crossBlit(dst, src, kPitch, kPitch, kWidth, kHeight, dstFmt, srcFmt);
+			break;
+		case 1:
+			result = Graphics::crossKeyBlit(dst, src, kPitch, kPitch, kWidth, kHeight, dstFmt, srcFmt, key);
+			break;
+		case 2:
+			result = Graphics::crossMaskBlit(dst, src, mask, kPitch, kPitch, kWidth, kWidth, kHeight, dstFmt, srcFmt);
+			break;
+		default:
+			result = Graphics::crossBlit(src, src, kPitch, kPitch, kWidth, kHeight, dstFmt, srcFmt);
+			return result ? hash(src, sizeof(src)) : Common::String();
+		}
+		return result ? hash(dst, sizeof(dst)) : Common::String();
+	}
+
+	/** Look up generated palette indices in place and return the hash of the result. */
+	static Common::String map(uint bytesPerPixel) {
+		byte buffer[kPitch * kHeight];
+		uint32 palette[256];
+		fill(buffer, sizeof(buffer), 4);
+		fill((byte *)palette, sizeof(palette), 5);
+
+		Graphics::crossBlitMap(buffer, buffer, kPitch, kPitch, kWidth, kHeight, bytesPerPixel, palette);
+		return hash(buffer, sizeof(buffer));
+	}
+};
@@ -0,0 +1,269 @@
+#include <cxxtest/TestSuite.h>
+#include "test/instrset_detect.h"
+
+#include "common/jobs.h"
+#include "common/md5.h"
+#include "common/memstream.h"
+#include "graphics/surface.h"
+
+#if defined(USE_HQ_SCALERS)
+#include "graphics/scaler/hq.h"
+#endif
+#if defined(USE_EDGE_SCALERS)
+#include "graphics/scaler/edge.h"
+#endif
+
+#if defined(HAS_PTHREADS)
+#include "backends/jobs/pthread/pthread-jobs.h"
+#endif
+
+class ScalerTestSuite : public CxxTest::TestSuite {
+public:
+#if defined(HAS_PTHREADS) && defined(USE_HQ_SCALERS)
+	void test_parallel_bands() {
+		// Scaling bands of rows on several threads must give the same picture
+		Common::JobManager serial;
+		Common::JobManager *parallel = createPthreadJobManager(3);
+
+		const Graphics::PixelFormat formats[2] = {
+			Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0),
+			Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0)
+		};
+
+		for (int i = 0; i < 2; i++) {
+			for (uint factor = 2; factor <= 3; factor++) {
+				HQScaler scaler(formats[i]);
+				scaler.setFactor(factor);
+				Common::String expected = scale(scaler, formats[i], factor, &serial);
+				TS_ASSERT_EQUALS(scale(scaler, formats[i], factor, parallel), expected);
+			}
+		}
+
+		delete parallel;
+	}
+#endif
+
+#if defined(USE_HQ_SCALERS)
+	void test_hq_kernels() {
+#ifdef SCUMMVM_NEON
+		checkHQKernels(g_hqKernelsNEON);
+#endif
+#ifdef SCUMMVM_SSE2
+		if (instrset_detect() >= 2)
+			checkHQKernels(g_hqKernelsSSE2);
+#endif
+#ifdef SCUMMVM_AVX2
+		if (instrset_detect() >= 8)
+			checkHQKernels(g_hqKernelsAVX2);
+#endif
+	}
+#endif
+
+#if defined(USE_HQ_SCALERS)
+	void test_hq_output() {
+		checkHQOutput(getGenericHQKernels());
+#ifdef SCUMMVM_NEON
+		checkHQOutput(g_hqKernelsNEON);
+#endif
+#ifdef SCUMMVM_SSE2
+		if (instrset_detect() >= 2)
+			checkHQOutput(g_hqKernelsSSE2);
+#endif
+#ifdef SCUMMVM_AVX2
+		if (instrset_detect() >= 8)
+			checkHQOutput(g_hqKernelsAVX2);
+#endif
+	}
+#endif
+
+#if defined(USE_EDGE_SCALERS)
+	void test_edge_output() {
+#ifdef SCUMMVM_NEON
+		checkEdgeOutput(edgeGreyDiffsNEON);
+#endif
+#ifdef SCUMMVM_SSE2
+		if (instrset_detect() >= 2)
+			checkEdgeOutput(edgeGreyDiffsSSE2);
+#endif
+	}
+
+	void test_edge_grey_diffs() {
+#ifdef SCUMMVM_NEON
+		checkEdgeGreyDiffs(edgeGreyDiffsNEON);
+#endif
+#ifdef SCUMMVM_SSE2
+		if (instrset_detect() >= 2)
+			checkEdgeGreyDiffs(edgeGreyDiffsSSE2);
+#endif
+	}
+#endif
+
+private:
+	enum {
+		kWidth = 80,
+		kHeight = 100,
+		kPadding = 2
+	};
+
+	/** Return the 565, 8888 or -8888 format. */
+	static Graphics::PixelFormat getFormat(int i) {
+		switch (i) {
+		case 0:
+			return Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0);
+		case 1:
+			return Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0);
+		default:
+			return Graphics::PixelFormat(4, 8, 8, 8, 8, 8, 16, 24, 0);
+		}
+	}
+
+	/** Scale a generated picture and return the hash of the result. */
+	static Common::String scale(Scaler &scaler, const Graphics::PixelFormat &format, uint factor, Common::JobManager *jobs) {
+		// Scalers look at the pixels around the rect
+		Graphics::Surface src;
+		src.create(kWidth + kPadding * 2, kHeight + kPadding * 2, format);
+
+		// Few colors, so that the scalers find some edges
+		uint32 seed = 1;
+		for (int y = 0; y < src.h; y++) {
+			for (int x = 0; x < src.w; x++) {
+				seed = seed * 1103515245 + 12345;
+				const byte c = (seed >> 28) & 3;
+				src.setPixel(x, y, format.RGBToColor(c * 80, (c & 1) * 255, 255 - c * 60));
+			}
+		}
+
+		Graphics::Surface dst;
+		dst.create(kWidth * factor, kHeight * factor, format);
+		scaler.scale((const uint8 *)src.getBasePtr(kPadding, kPadding), src.pitch,
+		             (uint8 *)dst.getPixels(), dst.pitch, kWidth, kHeight, 0, 0, jobs);
+
+		Common::MemoryReadStream stream((const byte *)dst.getPixels(), dst.pitch * dst.h);
+		Common::String hash = Common::computeStreamMD5AsString(stream);
+		src.free();
+		dst.free();
+		return hash;
+	}
+
+#if defined(USE_HQ_SCALERS)
+	enum {
+		kRowWidth = 45
+	};
+
+	/** HQ scaler using the given kernels, or the YUV lookup table without. */
+	class TestHQScaler : public HQScaler {
+	public:
+		TestHQScaler(const Graphics::PixelFormat &format, const HQKernels *kernels) : HQScaler(format) {
+			_kernels = kernels;
+		}
+	};
+
+	/**
+	 * Compare the 32bpp pictures scaled with the kernels with the ones scaled
+	 * with the lookup table, which is how they were scaled before.
+	 */
+	static void checkHQOutput(const HQKernels &kernels) {
+		Common::JobManager serial;
+		for (int i = 1; i < 3; i++) {
+			for (uint factor = 2; factor <= 3; factor++) {
+				TestHQScaler expected(getFormat(i), nullptr), actual(getFormat(i), &kernels);
+				expected.setFactor(factor);
+				actual.setFactor(factor);
+				TS_ASSERT_EQUALS(scale(actual, getFormat(i), factor, &serial), scale(expected, getFormat(i), factor, &serial));
+			}
+		}
+	}
+
+	/** Compare vectorized kernels with the generic ones. */
+	static void checkHQKernels(const HQKernels &kernels) {
+		const HQKernels &generic = getGenericHQKernels();
+
+		// Channel shifts of the 8888 and -8888 color masks
+		const int shifts[2][3] = { { 16, 8, 0 }, { 8, 16, 24 } };
+
+		uint32 seed = 1;
+		for (int i = 0; i < 2; i++) {
+			const int rShift = shifts[i][0], gShift = shifts[i][1], bShift = shifts[i][2];
+
+			// Noise around a few colors, to get near the limits of diffYUV()
+			uint32 pixels[3][kRowWidth + 2];
+			for (int y = 0; y < 3; y++) {
+				for (int x = 0; x < kRowWidth + 2; x++) {
+					seed = seed * 1103515245 + 12345;
+					const int base = (seed >> 28) & 1 ? 0x60 : 0xA0;
+					const int r = base + ((seed >> 8) & 0x3F) - 0x20;
+					const int g = base + ((seed >> 14) & 0x3F) - 0x20;
+					const int b = base + ((seed >> 20) & 0x3F) - 0x20;
+					pixels[y][x] = (r << rShift) | (g << gShift) | (b << bShift) | (seed & 0xFF) << (24 - bShift);
+				}
+			}
+
+			uint32 expected[3][kRowWidth + 2], actual[3][kRowWidth + 2];
+			for (int y = 0; y < 3; y++) {
+				generic.convertYUV(pixels[y], expected[y], kRowWidth + 2, rShift, gShift, bShift);
+				kernels.convertYUV(pixels[y], actual[y], kRowWidth + 2, rShift, gShift, bShift);
+				for (int x = 0; x < kRowWidth + 2; x++)
+					TS_ASSERT_EQUALS(actual[y][x], expected[y][x]);
+			}
+
+			uint8 expectedPatterns[kRowWidth], actualPatterns[kRowWidth];
+			generic.findPatterns(expected[0], expected[1], expected[2], expectedPatterns, kRowWidth);
+			kernels.findPatterns(expected[0], expected[1], expected[2], actualPatterns, kRowWidth);
+			for (int x = 0; x < kRowWidth; x++)
+				TS_ASSERT_EQUALS(actualPatterns[x], expectedPatterns[x]);
+		}
+	}
+#endif
+
+#if defined(USE_EDGE_SCALERS)
+	enum {
+		kEdgeWindows = 1000
+	};
+
+	/** Compare a vectorized version of the greyscale scoring with the generic one. */
+	static void checkEdgeGreyDiffs(EdgeGreyDiffsFunc greyDiffs) {
+		// Greyscale values go up to 1 << 12, flat windows score 0
+		Common::Array<int16> windows(kEdgeWindows * 9);
+		uint32 seed = 1;
+		for (int i = 0; i < kEdgeWindows; i++) {
+			const bool flat = (i % 10) == 0;
+			for (int j = 0; j < 9; j++) {
+				seed = seed * 1103515245 + 12345;
+				windows[i * 9 + j] = flat && j ? windows[i * 9] : (int16)((seed >> 16) % 4097);
+			}
+		}
+
+		Common::Array<int16> expectedDiffs(kEdgeWindows * 8), actualDiffs(kEdgeWindows * 8);
+		Common::Array<int32> expectedScores(kEdgeWindows), actualScores(kEdgeWindows);
+		edgeGreyDiffsGeneric(&windows[0], &expectedDiffs[0], &expectedScores[0], kEdgeWindows);
+		greyDiffs(&windows[0], &actualDiffs[0], &actualScores[0], kEdgeWindows);
+		TS_ASSERT(actualScores == expectedScores);
+		TS_ASSERT(actualDiffs == expectedDiffs);
+	}
+
+	/** Edge scaler using the given greyscale scoring. */
+	class TestEdgeScaler : public EdgeScaler {
+	public:
+		TestEdgeScaler(const Graphics::PixelFormat &format, EdgeGreyDiffsFunc greyDiffs) : EdgeScaler(format) {
+			_greyDiffs = greyDiffs;
+		}
+	};
+
+	/**
+	 * Compare the pictures scaled with a vectorized version of the greyscale
+	 * scoring with the ones of the generic version, which is the scalar code
+	 * the scaler used before.
+	 */
+	static void checkEdgeOutput(EdgeGreyDiffsFunc greyDiffs) {
+		Common::JobManager serial;
+		for (int i = 0; i < 2; i++) {
+			for (uint factor = 2; factor <= 3; factor++) {
+				TestEdgeScaler expected(getFormat(i), edgeGreyDiffsGeneric), actual(getFormat(i), greyDiffs);
+				expected.setFactor(factor);
+				actual.setFactor(factor);
+				TS_ASSERT_EQUALS(scale(actual, getFormat(i), factor, &serial), scale(expected, getFormat(i), factor, &serial));
+			}
+		}
+	}
+#endif
+};
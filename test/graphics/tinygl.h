@@ -0,0 +1,360 @@
+#include <cxxtest/TestSuite.h>
+#include "test/instrset_detect.h"
+
+#include "common/scummsys.h"
+
+#ifdef USE_TINYGL
+
+#include "common/jobs.h"
+#include "common/md5.h"
+#include "common/memstream.h"
+#include "common/system.h"
+#include "graphics/tinygl/tinygl.h"
+#include "graphics/tinygl/zgl.h"
+#include "graphics/tinygl/zspan.h"
+
+#include "../null_osystem.h"
+
+#if defined(HAS_PTHREADS)
+#include "backends/jobs/pthread/pthread-jobs.h"
+#endif
+
+class TinyGLSpanKernelsTestSuite : public CxxTest::TestSuite
+{
+public:
+	void test_shade() {
+		const TinyGL::SpanKernels &kernels = TinyGL::getGenericSpanKernels();
+		TinyGL::SpanState state = makeState(Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0), TGL_LESS, true);
+
+		// Interpolated colors are truncated, pixels failing the depth test are left alone
+		TinyGL::SpanInterpolants span = { 1000, 0x1080, 0x2000, 0x30ff, 0xff00, 100, 0x80, 0, 0, (uint)-0x100 };
+		uint32 pixels[3] = { 0, 0, 0 };
+		uint zbuf[3] = { 0, 5000, 0 };
+		kernels.shade(pixels, zbuf, 3, span, state);
+
+		TS_ASSERT_EQUALS(pixels[0], 0x102030ffu);
+		TS_ASSERT_EQUALS(pixels[1], 0u);
+		TS_ASSERT_EQUALS(pixels[2], 0x112030fdu);
+		TS_ASSERT_EQUALS(zbuf[0], 1000u);
+		TS_ASSERT_EQUALS(zbuf[1], 5000u);
+		TS_ASSERT_EQUALS(zbuf[2], 1200u);
+	}
+
+	void test_depth_precision() {
+		const TinyGL::SpanKernels &kernels = TinyGL::getGenericSpanKernels();
+		TinyGL::SpanState state = makeState(Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0), TGL_ALWAYS, true);
+
+		// Depth values go through a float like in FrameBuffer::writePixel()
+		TinyGL::SpanInterpolants span = { 0x7fffffff, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+		uint32 pixels[1];
+		uint zbuf[1] = { 0 };
+		kernels.shade(pixels, zbuf, 1, span, state);
+		TS_ASSERT_EQUALS(zbuf[0], 0x80000000u);
+	}
+
+	void test_texture() {
+		const TinyGL::SpanKernels &kernels = TinyGL::getGenericSpanKernels();
+		TinyGL::SpanState state = makeState(Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0), TGL_LESS, false);
+
+		TinyGL::SpanInterpolants span = { 0, 0x8000, 0xff00, 0x100000, 0xff00, 0, 0, 0, 0, 0 };
+		const uint32 texels[2] = { 0xff804020, 0x12345678 };
+		uint32 pixels[2] = { 0, 0 };
+		uint zbuf[2] = { 7, 7 };
+		kernels.texture(pixels, zbuf, 2, 1, texels, span, state, true);
+
+		// Only the lowest 8 bits of the modulated channels are kept
+		TS_ASSERT_EQUALS(pixels[0], 0x403f00feu);
+		TS_ASSERT_EQUALS(pixels[1], 0u);
+		TS_ASSERT_EQUALS(zbuf[0], 7u);
+	}
+
+	void test_simd_kernels() {
+#ifdef SCUMMVM_NEON
+		checkKernels(TinyGL::g_spanKernelsNEON);
+#endif
+#ifdef SCUMMVM_SSE2
+		if (instrset_detect() >= 2)
+			checkKernels(TinyGL::g_spanKernelsSSE2);
+#endif
+#ifdef SCUMMVM_AVX2
+		if (instrset_detect() >= 8)
+			checkKernels(TinyGL::g_spanKernelsAVX2);
+#endif
+	}
+
+private:
+	uint32 _seed;
+
+	uint32 nextValue() {
+		_seed = _seed * 1103515245 + 12345;
+		return (_seed >> 16) | (_seed << 16);
+	}
+
+	static TinyGL::SpanState makeState(const Graphics::PixelFormat &format, int depthFunc, bool depthWrite) {
+		TinyGL::SpanState state;
+		state.format = format;
+		state.depthTest = depthFunc != TGL_ALWAYS;
+		state.depthWrite = depthWrite;
+		state.depthFunc = depthFunc;
+		return state;
+	}
+
+	/** Compare vectorized kernels against the generic ones, which must give identical results. */
+	void checkKernels(const TinyGL::SpanKernels &simd) {
+		const TinyGL::SpanKernels &generic = TinyGL::getGenericSpanKernels();
+		const Graphics::PixelFormat formats[2] = {
+			Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0),
+			Graphics::PixelFormat(4, 8, 8, 8, 0, 16, 8, 0, 0)
+		};
+		const int depthFuncs[8] = { TGL_NEVER, TGL_LESS, TGL_EQUAL, TGL_LEQUAL, TGL_GREATER, TGL_NOTEQUAL, TGL_GEQUAL, TGL_ALWAYS };
+		enum { kSize = 64 };
+
+		_seed = 1;
+		for (uint iteration = 0; iteration < 200; iteration++) {
+			TinyGL::SpanState state = makeState(formats[iteration % 2], depthFuncs[(iteration / 2) % 8], (iteration / 16) % 2);
+			state.depthTest = (iteration / 32) % 4 != 0;
+
+			// Depth values are either anywhere or close to each other, to hit equal ones
+			TinyGL::SpanInterpolants span;
+			span.z = nextValue();
+			span.dzdx = (iteration & 1) ? nextValue() : nextValue() % 3 - 1;
+			span.r = nextValue();
+			span.g = nextValue();
+			span.b = nextValue();
+			span.a = nextValue();
+			span.drdx = nextValue() % 0x2000 - 0x1000;
+			span.dgdx = nextValue() % 0x2000 - 0x1000;
+			span.dbdx = nextValue() % 0x2000 - 0x1000;
+			span.dadx = nextValue();
+
+			uint32 texels[8], expectedPixels[kSize], actualPixels[kSize];
+			uint expectedZ[kSize], actualZ[kSize];
+			for (uint i = 0; i < kSize; i++) {
+				expectedPixels[i] = actualPixels[i] = nextValue();
+				expectedZ[i] = actualZ[i] = (iteration & 1) ? nextValue() : span.z + nextValue() % 3 - 1 + i * span.dzdx;
+			}
+			for (uint i = 0; i < 8; i++)
+				texels[i] = nextValue();
+
+			const int count = nextValue() % kSize;
+			generic.shade(expectedPixels, expectedZ, count, span, state);
+			simd.shade(actualPixels, actualZ, count, span, state);
+			TS_ASSERT_EQUALS(memcmp(expectedPixels, actualPixels, sizeof(expectedPixels)), 0);
+			TS_ASSERT_EQUALS(memcmp(expectedZ, actualZ, sizeof(expectedZ)), 0);
+
+			const int blockCount = count % 9;
+			const uint mask = generic.depthTest(expectedZ, blockCount, span, state);
+			TS_ASSERT_EQUALS(simd.depthTest(actualZ, blockCount, span, state), mask);
+
+			const bool modulate = iteration % 3 != 0;
+			generic.texture(expectedPixels, expectedZ, blockCount, mask, texels, span, state, modulate);
+			simd.texture(actualPixels, actualZ, blockCount, mask, texels, span, state, modulate);
+			TS_ASSERT_EQUALS(memcmp(expectedPixels, actualPixels, sizeof(expectedPixels)), 0);
+			TS_ASSERT_EQUALS(memcmp(expectedZ, actualZ, sizeof(expectedZ)), 0);
+		}
+	}
+};
+
+#if NULL_OSYSTEM_IS_AVAILABLE
+
+class TinyGLRasterizerTestSuite : public CxxTest::TestSuite
+{
+public:
+	void setUp() {
+		if (!g_system)
+			Common::install_null_g_system();
+	}
+
+	void test_span_kernels_match_pixel_loops() {
+		// Whole triangles drawn with the span kernels must give the same
+		// pixels and depth values as the per-pixel loops of fillTriangle()
+		Common::String expected = render(nullptr);
+		TS_ASSERT_EQUALS(render(&TinyGL::getGenericSpanKernels()), expected);
+#ifdef SCUMMVM_NEON
+		TS_ASSERT_EQUALS(render(&TinyGL::g_spanKernelsNEON), expected);
+#endif
+#ifdef SCUMMVM_SSE2
+		if (instrset_detect() >= 2)
+			TS_ASSERT_EQUALS(render(&TinyGL::g_spanKernelsSSE2), expected);
+#endif
+#ifdef SCUMMVM_AVX2
+		if (instrset_detect() >= 8)
+			TS_ASSERT_EQUALS(render(&TinyGL::g_spanKernelsAVX2), expected);
+#endif
+	}
+
+private:
+	enum {
+		kWidth = 97,
+		kHeight = 59,
+		kTextureSize = 8,
+		kPasses = 16
+	};
+
+	/** Draw a few triangles with random corners and colors. */
+	static void drawTriangles(uint32 &seed, int count, bool textured) {
+		tglBegin(TGL_TRIANGLES);
+		for (int i = 0; i < count * 3; i++) {
+			seed = seed * 1103515245 + 12345;
+			const float x = ((seed >> 8) & 0xFF) / 110.0f - 1.15f;
+			const float y = ((seed >> 16) & 0xFF) / 110.0f - 1.15f;
+			const float z = ((seed >> 24) & 0xFF) / 127.5f - 1.0f;
+			tglColor4f(((seed >> 4) & 0xF) / 15.0f, ((seed >> 12) & 0xF) / 15.0f, ((seed >> 20) & 0xF) / 15.0f, 1.0f);
+			if (textured)
+				tglTexCoord2f(((seed >> 3) & 0x1F) / 8.0f, ((seed >> 11) & 0x1F) / 8.0f);
+			tglVertex3f(x, y, z);
+		}
+		tglEnd();
+	}
+
+	/**
+	 * Draw shaded and textured triangles with various depth settings, and
+	 * return the hash of the pixels and depth values. The second frame only
+	 * changes some triangles, whose dirty rectangles then clip the others.
+	 */
+	static Common::String render(const TinyGL::SpanKernels *kernels) {
+		TinyGL::ContextHandle *context = TinyGL::createContext(kWidth, kHeight, Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0), 256, false, true);
+		TinyGL::setContext(context);
+		TinyGL::FrameBuffer *fb = TinyGL::gl_get_context()->fb;
+		fb->setSpanKernels(kernels);
+
+		byte texels[kTextureSize * kTextureSize * 4];
+		uint32 seed = 7;
+		for (uint i = 0; i < sizeof(texels); i++) {
+			seed = seed * 1103515245 + 12345;
+			texels[i] = seed >> 24;
+		}
+		TGLuint texture;
+		tglGenTextures(1, &texture);
+		tglBindTexture(TGL_TEXTURE_2D, texture);
+		tglTexParameteri(TGL_TEXTURE_2D, TGL_TEXTURE_MIN_FILTER, TGL_NEAREST);
+		tglTexParameteri(TGL_TEXTURE_2D, TGL_TEXTURE_MAG_FILTER, TGL_NEAREST);
+		tglTexImage2D(TGL_TEXTURE_2D, 0, TGL_RGBA, kTextureSize, kTextureSize, 0, TGL_RGBA, TGL_UNSIGNED_BYTE, texels);
+
+		// Serial, so that the frame is drawn in a single band
+		Common::JobManager serial;
+		const TGLenum depthFuncs[4] = { TGL_LESS, TGL_GEQUAL, TGL_EQUAL, TGL_NOTEQUAL };
+		for (int frame = 0; frame < 2; frame++) {
+			tglViewport(0, 0, kWidth, kHeight);
+			tglClearColor(0.1f, 0.2f, 0.3f, 1.0f);
+			tglClearDepth(0.5);
+			tglClear(TGL_COLOR_BUFFER_BIT | TGL_DEPTH_BUFFER_BIT);
+
+			seed = 1;
+			for (int pass = 0; pass < kPasses; pass++) {
+				if (pass & 1)
+					tglEnable(TGL_DEPTH_TEST);
+				else
+					tglDisable(TGL_DEPTH_TEST);
+				tglDepthFunc(depthFuncs[(pass >> 1) & 3]);
+				tglDepthMask((pass & 2) ? TGL_TRUE : TGL_FALSE);
+				tglShadeModel((pass & 4) ? TGL_FLAT : TGL_SMOOTH);
+
+				if (frame == 1 && pass % 5 == 0)
+					seed += 1;
+				tglDisable(TGL_TEXTURE_2D);
+				drawTriangles(seed, 3, false);
+				tglEnable(TGL_TEXTURE_2D);
+				drawTriangles(seed, 3, true);
+			}
+
+			Common::List<Common::Rect> dirtyAreas;
+			TinyGL::presentBuffer(dirtyAreas, &serial);
+		}
+
+		tglDeleteTextures(1, &texture);
+
+		Common::MemoryReadStream pixels(fb->getPixelBuffer(), fb->getPixelBufferPitch() * kHeight);
+		Common::MemoryReadStream depth((const byte *)fb->getZBuffer(), kWidth * kHeight * sizeof(uint));
+		Common::String hash = Common::computeStreamMD5AsString(pixels) + Common::computeStreamMD5AsString(depth);
+
+		TinyGL::destroyContext(context);
+		return hash;
+	}
+};
+
+#endif
+
+#if NULL_OSYSTEM_IS_AVAILABLE && defined(HAS_PTHREADS)
+
+class TinyGLBandsTestSuite : public CxxTest::TestSuite
+{
+public:
+	void setUp() {
+		if (!g_system)
+			Common::install_null_g_system();
+	}
+
+	void test_parallel_bands() {
+		// Rendering in bands on several threads must give the same picture,
+		// including when the number of bands changes between frames
+		Common::JobManager serial;
+		Common::JobManager *two = createPthreadJobManager(2);
+		Common::JobManager *four = createPthreadJobManager(4);
+		Common::JobManager *serialFrames[kFrames] = { &serial, &serial, &serial, &serial };
+		Common::JobManager *parallelFrames[kFrames] = { four, four, two, four };
+
+		for (int dirtyRects = 0; dirtyRects < 2; dirtyRects++) {
+			Common::String expected = render(serialFrames, dirtyRects);
+			TS_ASSERT_EQUALS(render(parallelFrames, dirtyRects), expected);
+		}
+
+		delete two;
+		delete four;
+	}
+
+private:
+	enum {
+		kWidth = 96,
+		kHeight = 160,
+		kFrames = 4
+	};
+
+	/** Render a few frames of overlapping triangles and return the hash of the last one. */
+	static Common::String render(Common::JobManager *const jobs[kFrames], bool dirtyRects) {
+		TinyGL::ContextHandle *context = TinyGL::createContext(kWidth, kHeight, Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0), 256, true, dirtyRects);
+		TinyGL::setContext(context);
+
+		for (int frame = 0; frame < kFrames; frame++) {
+			tglViewport(0, 0, kWidth, kHeight);
+			tglClearColor(0.1f, 0.2f, 0.3f, 1.0f);
+			tglClearDepth(1.0);
+			tglClear(TGL_COLOR_BUFFER_BIT | TGL_DEPTH_BUFFER_BIT);
+
+			tglEnable(TGL_DEPTH_TEST);
+			tglDepthFunc(TGL_LESS);
+			tglEnable(TGL_BLEND);
+			tglBlendFunc(TGL_SRC_ALPHA, TGL_ONE_MINUS_SRC_ALPHA);
+
+			// Triangles crossing the band boundaries, moving from frame to frame
+			uint32 seed = 1;
+			tglBegin(TGL_TRIANGLES);
+			for (int i = 0; i < 12; i++) {
+				for (int j = 0; j < 3; j++) {
+					seed = seed * 1103515245 + 12345;
+					const float x = ((seed >> 8) & 0xFF) / 127.5f - 1.0f;
+					const float y = ((seed >> 16) & 0xFF) / 127.5f - 1.0f + frame * 0.05f;
+					const float z = ((seed >> 24) & 0xFF) / 127.5f - 1.0f;
+					tglColor4f(j == 0 ? 1.0f : 0.2f, j == 1 ? 1.0f : 0.3f, j == 2 ? 1.0f : 0.4f, 0.5f + (i % 3) * 0.25f);
+					tglVertex3f(x, y, z);
+				}
+			}
+			tglEnd();
+
+			Common::List<Common::Rect> dirtyAreas;
+			TinyGL::presentBuffer(dirtyAreas, jobs[frame]);
+		}
+
+		Graphics::Surface surface;
+		TinyGL::getSurfaceRef(surface);
+		Common::MemoryReadStream stream((const byte *)surface.getPixels(), surface.pitch * surface.h);
+		Common::String hash = Common::computeStreamMD5AsString(stream);
+
+		TinyGL::destroyContext(context);
+		return hash;
+	}
+};
+
+#endif
+
+#endif
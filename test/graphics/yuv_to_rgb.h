@@ -0,0 +1,181 @@
+#include <cxxtest/TestSuite.h>
+#include "test/instrset_detect.h"
+
+#include "common/debug.h"
+#include "common/jobs.h"
+#include "common/md5.h"
+#include "common/memstream.h"
+#include "common/system.h"
+#include "graphics/yuv_to_rgb.h"
+#include "graphics/yuv_to_rgb_intern.h"
+
+#include "../null_osystem.h"
+
+#if NULL_OSYSTEM_IS_AVAILABLE
+#define BENCHMARK_TIME 1
+#else
+#define BENCHMARK_TIME 0
+#endif
+
+#if defined(HAS_PTHREADS)
+#include "backends/jobs/pthread/pthread-jobs.h"
+#endif
+
+class YUVToRGBTestSuite : public CxxTest::TestSuite {
+public:
+#if defined(HAS_PTHREADS)
+	void test_parallel_rows() {
+		// Converting rows on several threads must give the same frames
+		Common::JobManager serial;
+		Common::JobManager *parallel = createPthreadJobManager(3);
+
+		const Graphics::PixelFormat formats[2] = {
+			Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0),
+			Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0)
+		};
+
+		for (int i = 0; i < 2; i++) {
+			for (int type = 0; type < 5; type++) {
+				Common::String expected = convert(type, formats[i], kScaleITU, kWidth, &serial);
+				TS_ASSERT_EQUALS(convert(type, formats[i], kScaleITU, kWidth, parallel), expected);
+			}
+		}
+
+		delete parallel;
+	}
+#endif
+
+	void test_kernels() {
+		checkKernels(&Graphics::getGenericYUVToRGBKernels());
+#ifdef SCUMMVM_NEON
+		checkKernels(&Graphics::g_yuvToRGBKernelsNEON);
+#endif
+#ifdef SCUMMVM_SSE2
+		if (instrset_detect() >= 2)
+			checkKernels(&Graphics::g_yuvToRGBKernelsSSE2);
+#endif
+#ifdef SCUMMVM_AVX2
+		if (instrset_detect() >= 8)
+			checkKernels(&Graphics::g_yuvToRGBKernelsAVX2);
+#endif
+		YUVToRGBMan.setKernels(nullptr);
+	}
+
+	void test_speed() {
+#if BENCHMARK_TIME
+		Common::install_null_g_system();
+
+		const Graphics::YUVToRGBKernels *kernels = Graphics::getYUVToRGBKernels();
+		if (!kernels) {
+			debug("YUV to RGB: no vectorized converter for this CPU");
+			return;
+		}
+
+		const Graphics::PixelFormat formats[2] = {
+			Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0),
+			Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0)
+		};
+
+#ifdef SLOW_TESTS
+		const int iters = 2500;
+#else
+		const int iters = 1;
+#endif
+
+		for (int i = 0; i < 2; i++) {
+			for (int type = 0; type < 4; type++) {
+				YUVToRGBMan.setKernels(nullptr);
+				uint32 start = g_system->getMillis();
+				for (int iter = 0; iter < iters; iter++)
+					convert(type, formats[i], kScaleITU, kWidth, nullptr);
+				const uint32 tableTime = g_system->getMillis() - start;
+
+				YUVToRGBMan.setKernels(kernels);
+				start = g_system->getMillis();
+				for (int iter = 0; iter < iters; iter++)
+					convert(type, formats[i], kScaleITU, kWidth, nullptr);
+				const uint32 kernelTime = g_system->getMillis() - start;
+
+				debug("YUV to RGB type %d, %d bpp: tables %u ms, vectorized %u ms", type, formats[i].bytesPerPixel * 8, tableTime, kernelTime);
+			}
+		}
+
+		YUVToRGBMan.setKernels(nullptr);
+#endif
+	}
+
+private:
+	enum {
+		kWidth = 64,
+		kHeight = 200,
+		kPitch = kWidth + 8
+	};
+
+	static const Graphics::YUVToRGBManager::LuminanceScale kScaleITU = Graphics::YUVToRGBManager::kScaleITU;
+	static const Graphics::YUVToRGBManager::LuminanceScale kScaleFull = Graphics::YUVToRGBManager::kScaleFull;
+
+	/** Compare the row converters with the lookup tables, rows end in the middle of a vector. */
+	static void checkKernels(const Graphics::YUVToRGBKernels *kernels) {
+		const Graphics::PixelFormat formats[3] = {
+			Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0),
+			Graphics::PixelFormat(2, 4, 4, 4, 4, 0, 4, 8, 12),
+			Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0)
+		};
+		const Graphics::YUVToRGBManager::LuminanceScale scales[2] = { kScaleITU, kScaleFull };
+
+		for (int i = 0; i < 3; i++) {
+			for (int j = 0; j < 2; j++) {
+				for (int type = 0; type < 4; type++) {
+					YUVToRGBMan.setKernels(nullptr);
+					Common::String expected = convert(type, formats[i], scales[j], kWidth - 6, nullptr);
+					YUVToRGBMan.setKernels(kernels);
+					TS_ASSERT_EQUALS(convert(type, formats[i], scales[j], kWidth - 6, nullptr), expected);
+				}
+			}
+		}
+	}
+
+	/** Convert a generated picture and return the hash of the result. */
+	static Common::String convert(int type, const Graphics::PixelFormat &format, Graphics::YUVToRGBManager::LuminanceScale scale,
+	                              int width, Common::JobManager *jobs) {
+		// Leave an extra chroma row and column for YUV410
+		byte y[kPitch * kHeight], u[kPitch * (kHeight + 1)], v[kPitch * (kHeight + 1)], a[kPitch * kHeight];
+		uint32 seed = 1;
+		for (int i = 0; i < kPitch * kHeight; i++) {
+			seed = seed * 1103515245 + 12345;
+			y[i] = seed >> 24;
+			a[i] = seed >> 16;
+		}
+		for (int i = 0; i < kPitch * (kHeight + 1); i++) {
+			seed = seed * 1103515245 + 12345;
+			u[i] = seed >> 24;
+			v[i] = seed >> 16;
+		}
+
+		Graphics::Surface surface;
+		surface.create(width, kHeight, format);
+
+		switch (type) {
+		case 0:
+			YUVToRGBMan.convert444(&surface, scale, y, u, v, width, kHeight, kPitch, kPitch, jobs);
+			break;
+		case 1:
+			YUVToRGBMan.convert422(&surface, scale, y, u, v, width, kHeight, kPitch, kPitch, jobs);
+			break;
+		case 2:
+			YUVToRGBMan.convert420(&surface, scale, y, u, v, width, kHeight, kPitch, kPitch, jobs);
+			break;
+		case 3:
+			YUVToRGBMan.convert420Alpha(&surface, scale, y, u, v, a, width, kHeight, kPitch, kPitch, jobs);
+			break;
+		default:
+			YUVToRGBMan.convert410(&surface, scale, y, u, v, width, kHeight, kPitch, kPitch, jobs);
+			break;
+		}
+
+		Common::MemoryReadStream stream((const byte *)surface.getPixels(), surface.pitch * surface.h);
+		Common::String hash = Common::computeStreamMD5AsString(stream);
+		surface.free();
+		return hash;
+	}
+};
@@ -0,0 +1,116 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/memstream.h"
+#include "gui/saveload-cache.h"
+
+class SaveMetaCacheTestSuite : public CxxTest::TestSuite {
+public:
+	void test_stamp() {
+		byte data[1000];
+		for (int i = 0; i < 1000; i++)
+			data[i] = i * 7;
+
+		const uint32 stamp = stampOf(data, sizeof(data));
+		TS_ASSERT_DIFFERS(stamp, 0u);
+		TS_ASSERT_EQUALS(stampOf(data, sizeof(data)), stamp);
+
+		// Both ends and the size go into the stamp
+		data[10] ^= 1;
+		TS_ASSERT_DIFFERS(stampOf(data, sizeof(data)), stamp);
+		data[10] ^= 1;
+		data[990] ^= 1;
+		TS_ASSERT_DIFFERS(stampOf(data, sizeof(data)), stamp);
+		data[990] ^= 1;
+		TS_ASSERT_DIFFERS(stampOf(data, sizeof(data) - 1), stamp);
+
+		// Small files are hashed once
+		TS_ASSERT_DIFFERS(stampOf(data, 300), stampOf(data, 299));
+		TS_ASSERT_DIFFERS(stampOf(data, 0), 0u);
+	}
+
+	void test_hit() {
+		GUI::SaveMetaCache<int> cache(1000);
+		TS_ASSERT(!cache.find("monkey:1"));
+		TS_ASSERT(cache.needsCheck("monkey:1"));
+
+		cache.store("monkey:1", 17, 42, 100);
+		TS_ASSERT(!cache.needsCheck("monkey:1"));
+		TS_ASSERT(cache.find("monkey:1"));
+		TS_ASSERT_EQUALS(*cache.find("monkey:1"), 17);
+		TS_ASSERT_EQUALS(cache.getSize(), 100u);
+		TS_ASSERT(cache.check("monkey:1", 42));
+		TS_ASSERT_EQUALS(cache.getStamp("monkey:1"), 42u);
+		TS_ASSERT_EQUALS(cache.getStamp("monkey:2"), 0u);
+	}
+
+	void test_invalidate() {
+		GUI::SaveMetaCache<int> cache(1000);
+		cache.store("monkey:1", 17, 42, 100);
+		cache.store("monkey:2", 18, 43, 100);
+
+		cache.invalidate();
+		TS_ASSERT(cache.needsCheck("monkey:1"));
+		TS_ASSERT(cache.needsCheck("monkey:2"));
+
+		// The values are still returned while they are checked
+		TS_ASSERT(cache.find("monkey:1"));
+
+		// An unchanged file keeps its value
+		TS_ASSERT(cache.check("monkey:1", 42));
+		TS_ASSERT(!cache.needsCheck("monkey:1"));
+		TS_ASSERT_EQUALS(*cache.find("monkey:1"), 17);
+		TS_ASSERT(cache.needsCheck("monkey:2"));
+	}
+
+	void test_stale_stamp_reload() {
+		GUI::SaveMetaCache<int> cache(1000);
+		cache.store("monkey:1", 17, 42, 100);
+		cache.invalidate();
+
+		// A changed file has to be read again
+		TS_ASSERT(!cache.check("monkey:1", 99));
+		TS_ASSERT(cache.needsCheck("monkey:1"));
+		cache.store("monkey:1", 23, 99, 200);
+		TS_ASSERT(!cache.needsCheck("monkey:1"));
+		TS_ASSERT_EQUALS(*cache.find("monkey:1"), 23);
+		TS_ASSERT_EQUALS(cache.getSize(), 200u);
+		TS_ASSERT_EQUALS(cache.getCount(), 1u);
+
+		// Files without a stamp are read every time
+		cache.store("monkey:2", 18, 0, 100);
+		cache.invalidate();
+		TS_ASSERT(!cache.check("monkey:2", 0));
+	}
+
+	void test_eviction() {
+		GUI::SaveMetaCache<int> cache(300);
+		cache.store("monkey:1", 1, 1, 100);
+		cache.store("monkey:2", 2, 2, 100);
+		cache.store("monkey:3", 3, 3, 100);
+
+		// Slot 1 becomes the most recently used one, so slot 2 is dropped
+		TS_ASSERT(cache.find("monkey:1"));
+		cache.store("monkey:4", 4, 4, 100);
+		TS_ASSERT_EQUALS(cache.getSize(), 300u);
+		TS_ASSERT(cache.find("monkey:1"));
+		TS_ASSERT(!cache.find("monkey:2"));
+		TS_ASSERT(cache.find("monkey:3"));
+		TS_ASSERT(cache.find("monkey:4"));
+
+		// A value bigger than the budget is kept on its own
+		cache.store("monkey:5", 5, 5, 500);
+		TS_ASSERT_EQUALS(cache.getCount(), 1u);
+		TS_ASSERT_EQUALS(cache.getSize(), 500u);
+		TS_ASSERT(cache.find("monkey:5"));
+
+		cache.remove("monkey:5");
+		TS_ASSERT_EQUALS(cache.getCount(), 0u);
+		TS_ASSERT_EQUALS(cache.getSize(), 0u);
+	}
+
+private:
+	static uint32 stampOf(const byte *data, uint32 size) {
+		Common::MemoryReadStream stream(data, size);
+		return GUI::computeSaveStamp(stream);
+	}
+};
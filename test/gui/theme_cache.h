@@ -0,0 +1,125 @@
+#include <cxxtest/TestSuite.h>
+
+#include "graphics/managed_surface.h"
+#include "gui/ThemeCache.h"
+
+class ThemeCacheTestSuite : public CxxTest::TestSuite {
+public:
+	void setUp() {
+		_screen.create(kScreenSize, kScreenSize, Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0));
+	}
+
+	void tearDown() {
+		_screen.free();
+	}
+
+	void test_hit() {
+		GUI::ThemeCache cache;
+		const Common::Rect rect(8, 8, 48, 48);
+		drawCached(cache, 1, rect, kBackground, 0x11223344);
+		TS_ASSERT_EQUALS(cache.getCount(), 1u);
+
+		// The same widget on the same background comes from the cache
+		_screen.fillRect(rect, kBackground);
+		GUI::ThemeCache::Key key = makeKey(1);
+		TS_ASSERT(cache.restore(key, &_screen, rect));
+		TS_ASSERT_EQUALS(_screen.getPixel(8, 8), 0x11223344u);
+		TS_ASSERT_EQUALS(_screen.getPixel(47, 47), 0x11223344u);
+
+		// Also in another place of the screen
+		const Common::Rect moved(64, 32, 104, 72);
+		_screen.fillRect(moved, kBackground);
+		key = makeKey(1);
+		TS_ASSERT(cache.restore(key, &_screen, moved));
+		TS_ASSERT_EQUALS(_screen.getPixel(80, 50), 0x11223344u);
+	}
+
+	void test_miss_on_changed_background() {
+		GUI::ThemeCache cache;
+		const Common::Rect rect(8, 8, 48, 48);
+		drawCached(cache, 1, rect, kBackground, 0x11223344);
+
+		// A single changed pixel below the widget is a miss
+		_screen.fillRect(rect, kBackground);
+		_screen.setPixel(20, 30, kBackground + 1);
+		GUI::ThemeCache::Key key = makeKey(1);
+		TS_ASSERT(!cache.restore(key, &_screen, rect));
+		TS_ASSERT_EQUALS(_screen.getPixel(8, 8), kBackground);
+
+		// As is another widget on the same background
+		_screen.fillRect(rect, kBackground);
+		key = makeKey(2);
+		TS_ASSERT(!cache.restore(key, &_screen, rect));
+	}
+
+	void test_small_widgets() {
+		GUI::ThemeCache cache;
+		const Common::Rect rect(8, 8, 24, 24);
+		drawCached(cache, 1, rect, kBackground, 0x11223344);
+		TS_ASSERT_EQUALS(cache.getCount(), 0u);
+		TS_ASSERT_EQUALS(cache.getSize(), 0u);
+	}
+
+	void test_eviction() {
+		// Room for 4 widgets of 40x40 pixels with their backgrounds
+		const Common::Rect rect(8, 8, 48, 48);
+		const uint32 entrySize = rect.width() * rect.height() * 4 * 2;
+		GUI::ThemeCache cache(entrySize * 4);
+
+		for (int type = 1; type <= 4; type++)
+			drawCached(cache, type, rect, kBackground, type);
+		TS_ASSERT_EQUALS(cache.getCount(), 4u);
+		TS_ASSERT_EQUALS(cache.getSize(), entrySize * 4);
+
+		// Using the oldest widget again keeps it over the second one
+		_screen.fillRect(rect, kBackground);
+		GUI::ThemeCache::Key key = makeKey(1);
+		TS_ASSERT(cache.restore(key, &_screen, rect));
+
+		drawCached(cache, 5, rect, kBackground, 5);
+		TS_ASSERT_EQUALS(cache.getCount(), 4u);
+		TS_ASSERT_LESS_THAN_EQUALS(cache.getSize(), cache.getMaxSize());
+
+		const bool expected[6] = { false, true, false, true, true, true };
+		for (int type = 1; type <= 5; type++) {
+			_screen.fillRect(rect, kBackground);
+			key = makeKey(type);
+			TS_ASSERT_EQUALS(cache.restore(key, &_screen, rect), expected[type]);
+		}
+
+		cache.clear();
+		TS_ASSERT_EQUALS(cache.getCount(), 0u);
+		TS_ASSERT_EQUALS(cache.getSize(), 0u);
+	}
+
+private:
+	enum {
+		kScreenSize = 128,
+		kBackground = 0x808080FF
+	};
+
+	Graphics::ManagedSurface _screen;
+
+	static GUI::ThemeCache::Key makeKey(int type) {
+		GUI::ThemeCache::Key key;
+		memset(&key, 0, sizeof(key));
+		key.type = type;
+		key.width = 40;
+		key.height = 40;
+		return key;
+	}
+
+	/** Draw a widget like ThemeEngine::drawDD() does, going through the cache. */
+	void drawCached(GUI::ThemeCache &cache, int type, const Common::Rect &rect, uint32 background, uint32 color) {
+		_screen.fillRect(rect, background);
+		GUI::ThemeCache::Key key = makeKey(type);
+		if (cache.restore(key, &_screen, rect))
+			return;
+
+		Common::Rect inner(rect);
+		inner.grow(-1);
+		_screen.fillRect(inner, color);
+		_screen.frameRect(rect, color);
+		cache.store(key, &_screen, rect);
+	}
+};
@@ -0,0 +1,227 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/atomic.h"
+#include "common/jobs.h"
+#include "common/system.h"
+#include "graphics/surface.h"
+#include "video/video_decoder.h"
+
+#include "../null_osystem.h"
+
+#if defined(HAS_PTHREADS)
+#include "backends/jobs/pthread/pthread-jobs.h"
+#endif
+
+// The decoder needs OSystem for its timing
+#if NULL_OSYSTEM_IS_AVAILABLE && defined(HAS_PTHREADS)
+
+class SyntheticVideoDecoder : public Video::VideoDecoder {
+public:
+	/**
+	 * A video track whose frames are filled with their frame number. It can be
+	 * seeked and played in reverse, and counts the frames it decodes.
+	 */
+	class SyntheticVideoTrack : public FixedRateVideoTrack {
+	public:
+		SyntheticVideoTrack(int frameCount) : _frameCount(frameCount), _curFrame(-1), _reversed(false) {
+			_surface.create(4, 4, Graphics::PixelFormat::createFormatCLUT8());
+		}
+
+		~SyntheticVideoTrack() {
+			_surface.free();
+		}
+
+		bool endOfTrack() const override { return _reversed ? _curFrame <= 0 : _curFrame >= _frameCount - 1; }
+		uint16 getWidth() const override { return _surface.w; }
+		uint16 getHeight() const override { return _surface.h; }
+		Graphics::PixelFormat getPixelFormat() const override { return _surface.format; }
+		int getCurFrame() const override { return _curFrame; }
+		int getFrameCount() const override { return _frameCount; }
+
+		const Graphics::Surface *decodeNextFrame() override {
+			_curFrame += _reversed ? -1 : 1;
+			_surface.fillRect(Common::Rect(_surface.w, _surface.h), _curFrame);
+			_decoded.fetchAdd(1);
+			return &_surface;
+		}
+
+		bool isSeekable() const override { return true; }
+		bool seek(const Audio::Timestamp &time) override {
+			_curFrame = getFrameAtTime(time) - 1;
+			return true;
+		}
+
+		// The presented frame stays the current one when changing direction
+		bool setReverse(bool reverse) override {
+			_reversed = reverse;
+			return true;
+		}
+		bool isReversed() const override { return _reversed; }
+
+		/** Number of frames decoded so far, may be read from any thread. */
+		int getDecodedCount() const { return _decoded.load(); }
+
+	protected:
+		Common::Rational getFrameRate() const override { return 10; }
+
+	private:
+		Graphics::Surface _surface;
+		int _frameCount;
+		int _curFrame;
+		bool _reversed;
+		Common::Atomic<int> _decoded;
+	};
+
+	SyntheticVideoDecoder(int frameCount) {
+		_track = new SyntheticVideoTrack(frameCount);
+		addTrack(_track);
+	}
+
+	~SyntheticVideoDecoder() {
+		close();
+	}
+
+	bool loadStream(Common::SeekableReadStream *stream) override { return false; }
+
+	SyntheticVideoTrack *getSyntheticTrack() { return _track; }
+
+protected:
+	bool supportsReadAhead() const override { return true; }
+
+private:
+	SyntheticVideoTrack *_track;
+};
+
+class VideoDecoderTestSuite : public CxxTest::TestSuite {
+public:
+	void setUp() {
+		if (!g_system)
+			Common::install_null_g_system();
+		_jobs = createPthreadJobManager(1);
+	}
+
+	void tearDown() {
+		delete _jobs;
+	}
+
+	void test_read_ahead_plays_every_frame() {
+		SyntheticVideoDecoder decoder(20);
+		start(decoder);
+
+		for (int i = 0; i < 20; i++) {
+			TS_ASSERT(!decoder.endOfVideo());
+			TS_ASSERT_EQUALS(nextFrame(decoder), i);
+			TS_ASSERT_EQUALS(decoder.getCurFrame(), i);
+			TS_ASSERT_EQUALS(decoder.getFrameCount(), 20u);
+		}
+
+		TS_ASSERT(decoder.endOfVideo());
+		TS_ASSERT(!decoder.decodeNextFrame());
+	}
+
+	void test_read_ahead_seek() {
+		SyntheticVideoDecoder decoder(20);
+		start(decoder);
+
+		TS_ASSERT_EQUALS(nextFrame(decoder), 0);
+		TS_ASSERT_EQUALS(nextFrame(decoder), 1);
+		waitUntilAhead(decoder, 1);
+
+		TS_ASSERT(decoder.seekToFrame(10));
+		TS_ASSERT_EQUALS(nextFrame(decoder), 10);
+		TS_ASSERT_EQUALS(nextFrame(decoder), 11);
+		TS_ASSERT_EQUALS(decoder.getCurFrame(), 11);
+	}
+
+	void test_read_ahead_rewind() {
+		SyntheticVideoDecoder decoder(20);
+		start(decoder);
+
+		for (int i = 0; i < 5; i++)
+			nextFrame(decoder);
+		waitUntilAhead(decoder, 4);
+
+		TS_ASSERT(decoder.rewind());
+		TS_ASSERT_EQUALS(nextFrame(decoder), 0);
+		TS_ASSERT_EQUALS(nextFrame(decoder), 1);
+	}
+
+	void test_read_ahead_reverse() {
+		SyntheticVideoDecoder decoder(20);
+		start(decoder);
+
+		for (int i = 0; i < 6; i++)
+			nextFrame(decoder);
+		waitUntilAhead(decoder, 5);
+
+		// Reverse playback starts from the presented frame, not from the
+		// frames which were read ahead
+		TS_ASSERT(decoder.setReverse(true));
+		TS_ASSERT_EQUALS(decoder.getCurFrame(), 5);
+		TS_ASSERT_EQUALS(nextFrame(decoder), 4);
+		TS_ASSERT_EQUALS(nextFrame(decoder), 3);
+
+		// Frames are not read ahead in reverse
+		TS_ASSERT_EQUALS(decoder.getSyntheticTrack()->getCurFrame(), 3);
+
+		TS_ASSERT(decoder.setReverse(false));
+		TS_ASSERT_EQUALS(nextFrame(decoder), 4);
+		TS_ASSERT_EQUALS(nextFrame(decoder), 5);
+	}
+
+	void test_read_ahead_pause() {
+		SyntheticVideoDecoder decoder(20);
+		start(decoder);
+
+		TS_ASSERT_EQUALS(nextFrame(decoder), 0);
+		decoder.pauseVideo(true);
+		TS_ASSERT(decoder.isPaused());
+		TS_ASSERT_EQUALS(decoder.getCurFrame(), 0);
+		decoder.pauseVideo(false);
+
+		for (int i = 1; i < 20; i++)
+			TS_ASSERT_EQUALS(nextFrame(decoder), i);
+	}
+
+	void test_read_ahead_turned_off() {
+		SyntheticVideoDecoder decoder(20);
+		start(decoder);
+
+		TS_ASSERT_EQUALS(nextFrame(decoder), 0);
+		waitUntilAhead(decoder, 0);
+
+		// The queued frames are still returned, so no frame is skipped
+		TS_ASSERT(decoder.setReadAhead(0));
+		for (int i = 1; i < 20; i++)
+			TS_ASSERT_EQUALS(nextFrame(decoder), i);
+		TS_ASSERT(decoder.endOfVideo());
+	}
+
+private:
+	enum {
+		kReadAhead = 4
+	};
+
+	Common::JobManager *_jobs;
+
+	void start(SyntheticVideoDecoder &decoder) {
+		TS_ASSERT(decoder.setReadAhead(kReadAhead, _jobs));
+		decoder.start();
+	}
+
+	static int nextFrame(SyntheticVideoDecoder &decoder) {
+		const Graphics::Surface *surface = decoder.decodeNextFrame();
+		TS_ASSERT(surface);
+		return surface ? *(const byte *)surface->getBasePtr(3, 3) : -1;
+	}
+
+	/** Wait until the job has filled the queue after the presented frame. */
+	static void waitUntilAhead(SyntheticVideoDecoder &decoder, int presentedFrame) {
+		const int expected = MIN<int>(presentedFrame + 1 + kReadAhead, decoder.getSyntheticTrack()->getFrameCount());
+		for (int i = 0; i < 5000 && decoder.getSyntheticTrack()->getDecodedCount() < expected; i++)
+			g_system->delayMillis(1);
+		TS_ASSERT_EQUALS(decoder.getSyntheticTrack()->getDecodedCount(), expected);
+	}
+};
+
+#endif
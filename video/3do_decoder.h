@@ -57,6 +57,7 @@ public:
 
 protected:
 	void readNextPacket() override;
+	bool supportsReadAhead() const override { return true; }
 	bool supportsAudioTrackSwitching() const override { return true; }
 	AudioTrack *getAudioTrack(int index) override;
 
@@ -78,6 +78,7 @@ public:
 
 protected:
 	void readNextPacket();
+	bool supportsReadAhead() const { return true; }
 	bool supportsAudioTrackSwitching() const { return true; }
 	AudioTrack *getAudioTrack(int index);
 	bool seekIntern(const Audio::Timestamp &time);
@@ -48,6 +48,8 @@ public:
 	bool loadStream(Common::SeekableReadStream *stream);
 
 protected:
+	bool supportsReadAhead() const { return true; }
+
 	/**
 	 * Read the sound data out of the given DXA stream
 	 */
@@ -84,6 +84,7 @@ public:
 
 protected:
 	void readNextPacket();
+	bool supportsReadAhead() const { return true; }
 
 private:
 	class VPXVideoTrack : public VideoTrack {
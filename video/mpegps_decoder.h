@@ -61,6 +61,7 @@ public:
 
 protected:
 	void readNextPacket();
+	bool supportsReadAhead() const { return true; }
 	bool useAudioSync() const { return false; }
 
 private:
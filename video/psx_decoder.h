@@ -72,6 +72,7 @@ public:
 
 protected:
 	void readNextPacket();
+	bool supportsReadAhead() const { return true; }
 	bool useAudioSync() const;
 
 private:
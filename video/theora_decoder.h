@@ -75,6 +75,7 @@ public:
 
 protected:
 	void readNextPacket();
+	bool supportsReadAhead() const { return true; }
 
 private:
 	class TheoraVideoTrack : public VideoTrack {
@@ -26,8 +26,11 @@
 
 #include "common/rational.h"
 #include "common/file.h"
+#include "common/profiler.h"
 #include "common/system.h"
 
+#include "graphics/surface.h"
+
 namespace Video {
 
 VideoDecoder::VideoDecoder() {
@@ -47,9 +50,25 @@ VideoDecoder::VideoDecoder() {
 	_mainAudioTrack = 0;
 	_canSetDither = true;
 	_canSetDefaultFormat = true;
+	_readAheadFrames = 0;
+	_readAheadJobManager = nullptr;
+	_readAheadRunning = false;
+	_readAheadSurface = nullptr;
+	_readAheadStop = false;
+	_readAheadHurry = false;
+	_readAheadEnd = false;
+}
+
+VideoDecoder::~VideoDecoder() {
+	// Subclasses close the video in their destructor, this is a safety net
+	flushReadAhead();
+	freeReadAheadSurface();
 }
 
 void VideoDecoder::close() {
+	flushReadAhead();
+	freeReadAheadSurface();
+
 	if (isPlaying())
 		stop();
 
@@ -126,11 +145,13 @@ void VideoDecoder::pauseVideo(bool pause) {
 	}
 
 	if (_pauseLevel == 1 && pause) {
+		waitForReadAhead();
 		_pauseStartTime = g_system->getMillis(); // Store the starting time from pausing to keep it for later
 
 		for (TrackList::iterator it = _tracks.begin(); it != _tracks.end(); it++)
 			(*it)->pause(true);
 	} else if (_pauseLevel == 0) {
+		waitForReadAhead();
 		for (TrackList::iterator it = _tracks.begin(); it != _tracks.end(); it++)
 			(*it)->pause(false);
 
@@ -200,10 +221,39 @@ Graphics::PixelFormat VideoDecoder::getPixelFormat() const {
 }
 
 const Graphics::Surface *VideoDecoder::decodeNextFrame() {
+	PROFILE_ZONE("VideoDecoder::decodeNextFrame");
 	_needsUpdate = false;
 	_canSetDither = false;
 	_canSetDefaultFormat = false;
 
+	if (!_readAheadRunning && _readAheadFrames != 0 && _playbackRate > 0 && supportsReadAhead() &&
+	    !hasReversedVideoTrack() && getReadAheadJobManager()->getThreadCount() > 1) {
+		_readAheadState = getReadAheadState();
+		_readAheadRunning = true;
+	}
+
+	if (_readAheadRunning) {
+		ReadAheadFrame *frame = popReadAheadFrame();
+		if (frame) {
+			presentReadAheadFrame(frame);
+			refillReadAhead();
+			return _readAheadSurface;
+		}
+
+		// Either the job found that there is no frame left, or read-ahead
+		// was turned off and all queued frames have been returned. In the
+		// latter case, the tracks are at the presented frame again.
+		bool endReached;
+		{
+			Common::StackLock lock(_readAheadMutex);
+			endReached = _readAheadEnd;
+		}
+
+		flushReadAhead();
+		if (endReached)
+			return 0;
+	}
+
 	readNextPacket();
 
 	// If we have no next video track at this point, there shouldn't be
@@ -229,6 +279,10 @@ bool VideoDecoder::setReverse(bool reverse) {
 	if (reverse && hasAudio())
 		return false;
 
+	// Frames are only read ahead when playing forwards
+	if (reverse && !rewindReadAhead())
+		return false;
+
 	// Attempt to make sure all the tracks are in the requested direction
 	for (TrackList::iterator it = _tracks.begin(); it != _tracks.end(); it++) {
 		if ((*it)->getTrackType() == Track::kTrackTypeVideo && ((VideoTrack *)*it)->isReversed() != reverse) {
@@ -249,6 +303,9 @@ const byte *VideoDecoder::getPalette() {
 }
 
 int VideoDecoder::getCurFrame() const {
+	if (_readAheadRunning)
+		return _readAheadState.curFrame;
+
 	int32 frame = -1;
 
 	for (TrackList::const_iterator it = _tracks.begin(); it != _tracks.end(); it++)
@@ -259,6 +316,7 @@ int VideoDecoder::getCurFrame() const {
 }
 
 uint32 VideoDecoder::getFrameCount() const {
+	Common::StackLock lock(_readAheadTrackMutex);
 	int count = 0;
 
 	for (TrackList::const_iterator it = _tracks.begin(); it != _tracks.end(); it++)
@@ -290,6 +348,19 @@ uint32 VideoDecoder::getTime() const {
 }
 
 uint32 VideoDecoder::getTimeToNextFrame() const {
+	if (_readAheadRunning) {
+		if (endOfVideo() || _needsUpdate || !_readAheadState.hasNextVideoTrack)
+			return 0;
+
+		// Frames read ahead are always played forwards
+		uint32 currentTime = getTime();
+		uint32 nextFrameStartTime = _readAheadState.nextFrameStartTime;
+		if (nextFrameStartTime <= currentTime)
+			return 0;
+
+		return nextFrameStartTime - currentTime;
+	}
+
 	if (endOfVideo() || _needsUpdate || !_nextVideoTrack)
 		return 0;
 
@@ -312,9 +383,16 @@ uint32 VideoDecoder::getTimeToNextFrame() const {
 }
 
 bool VideoDecoder::endOfVideo() const {
+	if (_readAheadRunning && hasFramesLeft())
+		return false;
+
 	for (TrackList::const_iterator it = _tracks.begin(); it != _tracks.end(); it++) {
 		const Track *track = *it;
 
+		// The video tracks are ahead of the presented frame, see above
+		if (_readAheadRunning && track->getTrackType() == Track::kTrackTypeVideo)
+			continue;
+
 		bool videoEndTimeReached = _endTimeSet && track->getTrackType() == Track::kTrackTypeVideo && ((const VideoTrack *)track)->getNextFrameStartTime() >= (uint)_endTime.msecs();
 		bool endReached = track->endOfTrack() || (isPlaying() && videoEndTimeReached);
 		if (!endReached)
@@ -339,6 +417,8 @@ bool VideoDecoder::rewind() {
 	if (!isRewindable())
 		return false;
 
+	flushReadAhead();
+
 	// Stop all tracks so they can be rewound
 	if (isPlaying())
 		stopAudio();
@@ -373,6 +453,8 @@ bool VideoDecoder::seek(const Audio::Timestamp &time) {
 	if (!isSeekable())
 		return false;
 
+	flushReadAhead();
+
 	// Stop all tracks so they can be seeked
 	if (isPlaying())
 		stopAudio();
@@ -439,6 +521,9 @@ void VideoDecoder::stop() {
 	if (!isPlaying())
 		return;
 
+	// Queued frames are kept, in case playback is started again
+	waitForReadAhead();
+
 	// Stop audio here so we don't have it affect getTime()
 	stopAudio();
 
@@ -466,6 +551,8 @@ void VideoDecoder::setRate(const Common::Rational &rate) {
 	if (!isVideoLoaded() || _playbackRate == rate)
 		return;
 
+	waitForReadAhead();
+
 	if (rate == 0) {
 		stop();
 		return;
@@ -531,6 +618,7 @@ bool VideoDecoder::setDitheringPalette(const byte *palette) {
 	if (!_canSetDither)
 		return false;
 
+	Common::StackLock lock(_readAheadTrackMutex);
 	bool result = false;
 
 	for (TrackList::iterator it = _tracks.begin(); it != _tracks.end(); it++) {
@@ -548,6 +636,7 @@ bool VideoDecoder::setOutputPixelFormat(const Graphics::PixelFormat &format) {
 	if (!_canSetDefaultFormat)
 		return false;
 
+	Common::StackLock lock(_readAheadTrackMutex);
 	bool result = false;
 
 	for (TrackList::iterator it = _tracks.begin(); it != _tracks.end(); it++) {
@@ -783,6 +872,8 @@ bool VideoDecoder::StreamFileAudioTrack::loadFromFile(const Common::Path &baseNa
 }
 
 void VideoDecoder::addTrack(Track *track, bool isExternal) {
+	waitForReadAhead();
+
 	_tracks.push_back(track);
 
 	if (isExternal)
@@ -876,6 +967,8 @@ uint VideoDecoder::getAudioTrackCount() const {
 }
 
 void VideoDecoder::setEndTime(const Audio::Timestamp &endTime) {
+	waitForReadAhead();
+
 	Audio::Timestamp startTime = 0;
 
 	if (isPlaying()) {
@@ -938,6 +1031,9 @@ const VideoDecoder::Track *VideoDecoder::getTrack(uint track) const {
 }
 
 bool VideoDecoder::endOfVideoTracks() const {
+	if (_readAheadRunning)
+		return _readAheadState.endOfVideoTracks;
+
 	for (TrackList::const_iterator it = _tracks.begin(); it != _tracks.end(); it++)
 		if ((*it)->getTrackType() == Track::kTrackTypeVideo && !(*it)->endOfTrack())
 			return false;
@@ -1000,6 +1096,12 @@ bool VideoDecoder::hasFramesLeft() const {
 	// This is similar to endOfVideo(), except it doesn't take Audio into account (and returns true if not the end of the video)
 	// This is only used for needsUpdate() atm so that setEndTime() works properly
 	// And unlike endOfVideoTracks(), this takes into account _endTime
+	if (_readAheadRunning) {
+		const ReadAheadState &state = _readAheadState;
+		bool videoEndTimeReached = _endTimeSet && (!state.hasNextVideoTrack || state.nextFrameStartTime >= (uint)_endTime.msecs());
+		return !state.endOfVideoTracks && !(isPlaying() && videoEndTimeReached);
+	}
+
 	for (TrackList::const_iterator it = _tracks.begin(); it != _tracks.end(); it++) {
 		if ((*it)->getTrackType() != Track::kTrackTypeVideo)
 			continue;
@@ -1024,6 +1126,11 @@ bool VideoDecoder::hasAudio() const {
 }
 
 void VideoDecoder::eraseTrack(Track *track) {
+	// Queued frames stay valid when an audio track goes away
+	waitForReadAhead();
+	if (track->getTrackType() == Track::kTrackTypeVideo && !rewindReadAhead())
+		flushReadAhead();
+
 	for (uint idx = 0; idx < _externalTracks.size(); ++idx) {
 		if (_externalTracks[idx] == track)
 			_externalTracks.remove_at(idx);
@@ -1040,4 +1147,254 @@ void VideoDecoder::eraseTrack(Track *track) {
 	}
 }
 
+bool VideoDecoder::setReadAhead(uint frameCount, Common::JobManager *jobManager) {
+	if (!supportsReadAhead())
+		return false;
+
+	// Frames which are already queued are still returned, see decodeNextFrame()
+	waitForReadAhead();
+
+	Common::StackLock lock(_readAheadMutex);
+	_readAheadFrames = frameCount;
+	_readAheadJobManager = jobManager;
+	return true;
+}
+
+Common::JobManager *VideoDecoder::getReadAheadJobManager() const {
+	return _readAheadJobManager ? _readAheadJobManager : g_system->getJobManager();
+}
+
+bool VideoDecoder::hasReversedVideoTrack() const {
+	for (TrackList::const_iterator it = _tracks.begin(); it != _tracks.end(); it++)
+		if ((*it)->getTrackType() == Track::kTrackTypeVideo && ((const VideoTrack *)*it)->isReversed())
+			return true;
+
+	return false;
+}
+
+void VideoDecoder::readAheadProc(void *data) {
+	((VideoDecoder *)data)->readAhead();
+}
+
+void VideoDecoder::readAhead() {
+	for (;;) {
+		{
+			Common::StackLock lock(_readAheadMutex);
+			if (_readAheadStop || _readAheadEnd || (uint)_readAheadQueue.size() >= _readAheadFrames)
+				return;
+		}
+
+		ReadAheadFrame *frame = decodeReadAheadFrame();
+
+		Common::StackLock lock(_readAheadMutex);
+		if (!frame) {
+			_readAheadEnd = true;
+			return;
+		}
+
+		_readAheadQueue.push(frame);
+
+		// Someone is waiting for this frame
+		if (_readAheadHurry)
+			return;
+	}
+}
+
+VideoDecoder::ReadAheadFrame *VideoDecoder::decodeReadAheadFrame() {
+	Common::StackLock lock(_readAheadTrackMutex);
+
+	// This mirrors the synchronous path of decodeNextFrame()
+	readNextPacket();
+
+	if (!_nextVideoTrack)
+		return nullptr;
+
+	ReadAheadFrame *frame = new ReadAheadFrame();
+	frame->surface = nullptr;
+	frame->palette = nullptr;
+
+	// The track may reuse its surface for the next frame
+	const Graphics::Surface *surface = _nextVideoTrack->decodeNextFrame();
+	if (surface) {
+		frame->surface = new Graphics::Surface();
+		frame->surface->copyFrom(*surface);
+	}
+
+	if (_nextVideoTrack->hasDirtyPalette()) {
+		frame->palette = new byte[256 * 3];
+		memcpy(frame->palette, _nextVideoTrack->getPalette(), 256 * 3);
+	}
+
+	findNextVideoTrack();
+	frame->state = getReadAheadState();
+	return frame;
+}
+
+VideoDecoder::ReadAheadState VideoDecoder::getReadAheadState() const {
+	ReadAheadState state;
+	state.curFrame = -1;
+	state.endOfVideoTracks = true;
+
+	for (TrackList::const_iterator it = _tracks.begin(); it != _tracks.end(); it++) {
+		if ((*it)->getTrackType() == Track::kTrackTypeVideo) {
+			state.curFrame += ((VideoTrack *)*it)->getCurFrame() + 1;
+			if (!(*it)->endOfTrack())
+				state.endOfVideoTracks = false;
+		}
+	}
+
+	state.hasNextVideoTrack = _nextVideoTrack != 0;
+	state.nextFrameStartTime = _nextVideoTrack ? _nextVideoTrack->getNextFrameStartTime() : 0;
+	return state;
+}
+
+VideoDecoder::ReadAheadFrame *VideoDecoder::popReadAheadFrame() {
+	Common::JobManager *jobManager = getReadAheadJobManager();
+
+	bool hurry = false;
+
+	{
+		Common::StackLock lock(_readAheadMutex);
+		if (_readAheadQueue.empty()) {
+			if (_readAheadEnd || _readAheadFrames == 0)
+				return nullptr;
+
+			// Have the job return as soon as it has the next frame
+			_readAheadHurry = hurry = true;
+		}
+	}
+
+	if (hurry) {
+		if (jobManager->isDone(_readAheadGroup))
+			jobManager->submit(readAheadProc, this, &_readAheadGroup);
+		jobManager->wait(_readAheadGroup);
+
+		Common::StackLock lock(_readAheadMutex);
+		_readAheadHurry = false;
+	}
+
+	Common::StackLock lock(_readAheadMutex);
+	if (_readAheadQueue.empty())
+		return nullptr;
+
+	return _readAheadQueue.pop();
+}
+
+void VideoDecoder::presentReadAheadFrame(ReadAheadFrame *frame) {
+	freeReadAheadSurface();
+	_readAheadSurface = frame->surface;
+
+	if (frame->palette) {
+		memcpy(_readAheadPalette, frame->palette, 256 * 3);
+		delete[] frame->palette;
+		_palette = _readAheadPalette;
+		_dirtyPalette = true;
+	}
+
+	_readAheadState = frame->state;
+	delete frame;
+}
+
+void VideoDecoder::refillReadAhead() {
+	Common::JobManager *jobManager = getReadAheadJobManager();
+	if (!jobManager->isDone(_readAheadGroup))
+		return;
+
+	{
+		Common::StackLock lock(_readAheadMutex);
+		if (_readAheadEnd || (uint)_readAheadQueue.size() >= _readAheadFrames)
+			return;
+	}
+
+	jobManager->submit(readAheadProc, this, &_readAheadGroup);
+}
+
+void VideoDecoder::waitForReadAhead() {
+	if (!_readAheadRunning)
+		return;
+
+	Common::JobManager *jobManager = getReadAheadJobManager();
+	if (jobManager->isDone(_readAheadGroup))
+		return;
+
+	{
+		Common::StackLock lock(_readAheadMutex);
+		_readAheadStop = true;
+	}
+
+	jobManager->wait(_readAheadGroup);
+
+	Common::StackLock lock(_readAheadMutex);
+	_readAheadStop = false;
+}
+
+void VideoDecoder::flushReadAhead() {
+	if (!_readAheadRunning)
+		return;
+
+	waitForReadAhead();
+
+	while (!_readAheadQueue.empty()) {
+		ReadAheadFrame *frame = _readAheadQueue.pop();
+		if (frame->surface) {
+			frame->surface->free();
+			delete frame->surface;
+		}
+		delete[] frame->palette;
+		delete frame;
+	}
+
+	_readAheadEnd = false;
+	_readAheadRunning = false;
+}
+
+bool VideoDecoder::rewindReadAhead() {
+	if (!_readAheadRunning)
+		return true;
+
+	waitForReadAhead();
+
+	// Without queued frames, the tracks are at the presented frame
+	if (!_readAheadQueue.empty()) {
+		// Like seekToFrame(), this needs a single video track. Audio tracks
+		// would be seeked as well, away from the playback time.
+		if (hasAudio() || !isSeekable())
+			return false;
+
+		VideoTrack *track = nullptr;
+		for (TrackList::iterator it = _tracks.begin(); it != _tracks.end(); it++) {
+			if ((*it)->getTrackType() == Track::kTrackTypeVideo) {
+				if (track)
+					return false;
+
+				track = (VideoTrack *)*it;
+			}
+		}
+
+		if (!track)
+			return false;
+
+		// Seek so that the frame after the presented one is decoded next
+		Audio::Timestamp time = track->getFrameTime(_readAheadState.curFrame + 1);
+		if (time < 0)
+			return false;
+
+		flushReadAhead();
+		bool result = seekIntern(time);
+		findNextVideoTrack();
+		return result;
+	}
+
+	flushReadAhead();
+	return true;
+}
+
+void VideoDecoder::freeReadAheadSurface() {
+	if (_readAheadSurface) {
+		_readAheadSurface->free();
+		delete _readAheadSurface;
+		_readAheadSurface = nullptr;
+	}
+}
+
 } // End of namespace Video
@@ -25,7 +25,10 @@
 #include "audio/mixer.h"
 #include "audio/timestamp.h"	// TODO: Move this to common/ ?
 #include "common/array.h"
+#include "common/jobs.h"
+#include "common/mutex.h"
 #include "common/path.h"
+#include "common/queue.h"
 #include "common/rational.h"
 #include "common/str.h"
 #include "graphics/pixelformat.h"
@@ -52,7 +55,7 @@ namespace Video {
 class VideoDecoder {
 public:
 	VideoDecoder();
-	virtual ~VideoDecoder() {}
+	virtual ~VideoDecoder();
 
 	/////////////////////////////////////////
 	// Opening/Closing a Video
@@ -395,6 +398,38 @@ public:
 	 */
 	bool setOutputPixelFormat(const Graphics::PixelFormat &format);
 
+	/**
+	 * Decode frames ahead of their presentation time.
+	 *
+	 * While the video is playing forwards, up to @p frameCount frames are
+	 * decoded by a background job into a queue, from which decodeNextFrame()
+	 * then returns copies. This smoothes playback of videos with frames that
+	 * are expensive to decode. Audio is not affected.
+	 *
+	 * Seeking and rewinding discard the queued frames. Playing in reverse
+	 * moves the video tracks back to the presented frame first, and fails if
+	 * they cannot be seeked. When read-ahead is turned off during playback,
+	 * the queued frames are still returned before decoding continues as
+	 * usual, so no frame is skipped.
+	 *
+	 * A frame count of 0, the default, decodes every frame when it is asked
+	 * for. Read-ahead is also skipped if the decoder does not support it, see
+	 * supportsReadAhead(), or if the job manager cannot run jobs on another
+	 * thread. This setting is kept by close().
+	 *
+	 * @param frameCount The maximum number of frames to decode in advance
+	 * @param jobManager The job manager to decode with, or nullptr for the
+	 *                   one of the backend
+	 * @return false if the decoder does not support read-ahead
+	 */
+	bool setReadAhead(uint frameCount, Common::JobManager *jobManager = nullptr);
+
+	/**
+	 * Get the maximum number of frames decoded in advance.
+	 * @see setReadAhead()
+	 */
+	uint getReadAhead() const { return _readAheadFrames; }
+
 	/////////////////////////////////////////
 	// Audio Control
 	/////////////////////////////////////////
@@ -988,6 +1023,16 @@ protected:
 	bool hasFramesLeft() const;
 	bool hasAudio() const;
 
+	/**
+	 * Whether frames can be decoded by a background job, see setReadAhead().
+	 *
+	 * The job uses the tracks through the VideoDecoder interface only, while
+	 * the presented frame lags behind them. Decoders which access their tracks
+	 * in other ways, or which return data about the last decoded frame (like
+	 * dirty rects), must keep the default.
+	 */
+	virtual bool supportsReadAhead() const { return false; }
+
 	Audio::Timestamp _lastTimeChange;
 	int32 _startTime;
 
@@ -999,6 +1044,51 @@ private:
 	Audio::Mixer::SoundType _soundType;
 
 	AudioTrack *_mainAudioTrack;
+
+	// Read-ahead decoding, see setReadAhead()
+	struct ReadAheadState {
+		int curFrame;
+		bool endOfVideoTracks;
+		bool hasNextVideoTrack;
+		uint32 nextFrameStartTime;
+	};
+
+	struct ReadAheadFrame {
+		Graphics::Surface *surface;
+		byte *palette;
+		ReadAheadState state;
+	};
+
+	static void readAheadProc(void *data);
+	void readAhead();
+	ReadAheadFrame *decodeReadAheadFrame();
+	ReadAheadState getReadAheadState() const;
+	ReadAheadFrame *popReadAheadFrame();
+	void presentReadAheadFrame(ReadAheadFrame *frame);
+	void refillReadAhead();
+	void waitForReadAhead();
+	void flushReadAhead();
+	bool rewindReadAhead();
+	void freeReadAheadSurface();
+	bool hasReversedVideoTrack() const;
+	Common::JobManager *getReadAheadJobManager() const;
+
+	uint _readAheadFrames;
+	Common::JobManager *_readAheadJobManager;
+	bool _readAheadRunning;
+	ReadAheadState _readAheadState;
+	Graphics::Surface *_readAheadSurface;
+	byte _readAheadPalette[256 * 3];
+
+	// Shared with the read-ahead job. The track mutex is held while the job
+	// decodes, for queries of the tracks from the main thread.
+	Common::Mutex _readAheadMutex;
+	mutable Common::Mutex _readAheadTrackMutex;
+	Common::Queue<ReadAheadFrame *> _readAheadQueue;
+	bool _readAheadStop;
+	bool _readAheadHurry;
+	bool _readAheadEnd;
+	Common::WaitGroup _readAheadGroup;
 };
 
 } // End of namespace Video